@@ -12,13 +12,20 @@
 
 
 // Standard library headers
+#include <algorithm>
+#include <sstream>
 #include <stdexcept>
 
+// POSIX headers
+#include <pthread.h>
+
 // SFTA headers
 #include <sfta/cudd_facade.hh>
 #include <sfta/sfta.hh>
 #include <sfta/convert.hh>
 #include <sfta/fake_file.hh>
+#include <sfta/operation_context.hh>
+#include <sfta/trace.hh>
 
 // CUDD headers
 #include <util.h>
@@ -130,12 +137,150 @@ namespace SFTA
 		{
 			return isConstantCUDD(toCUDD(sfta_value));
 		}
+
+
+		/**
+		 * @brief  Dispatcher of CUDD hooks
+		 *
+		 * CUDD passes only the manager to a hook, therefore the dispatcher keeps
+		 * the map of managers to their facades and forwards the invocation of
+		 * a hook to the facade of the manager. The map is shared by all
+		 * threads (each of them using its own managers), so it is only
+		 * accessed under a lock.
+		 */
+		struct CUDDHookDispatcher
+		{
+			typedef std::map<DdManager*, CUDDFacade*> FacadeMapType;
+
+			/**
+			 * @brief  Lock of the map of facades
+			 *
+			 * Holds the mutex of the map for the lifetime of the lock.
+			 */
+			class Lock
+			{
+			private:  // Private methods
+
+				Lock(const Lock&);
+				Lock& operator=(const Lock&);
+
+				static pthread_mutex_t& mutex()
+				{
+					static pthread_mutex_t facadesMutex = PTHREAD_MUTEX_INITIALIZER;
+					return facadesMutex;
+				}
+
+			public:   // Public methods
+
+				Lock()
+				{
+					pthread_mutex_lock(&mutex());
+				}
+
+				~Lock()
+				{
+					pthread_mutex_unlock(&mutex());
+				}
+			};
+
+			static FacadeMapType& facades()
+			{
+				static FacadeMapType facadeMap;
+				return facadeMap;
+			}
+
+			static void registerFacade(DdManager* manager, CUDDFacade* facade)
+			{
+				Lock lock;
+				facades()[manager] = facade;
+			}
+
+			static void unregisterFacade(DdManager* manager)
+			{
+				Lock lock;
+				facades().erase(manager);
+			}
+
+			static int dispatch(DdManager* manager, CUDDFacade::HookType type)
+			{
+				CUDDFacade* facade = static_cast<CUDDFacade*>(0);
+				{
+					Lock lock;
+					FacadeMapType::const_iterator itFacade = facades().find(manager);
+					if (itFacade != facades().end())
+					{	// in case the facade is known
+						facade = itFacade->second;
+					}
+				}
+
+				// the hooks run in the thread of the manager, without the lock
+				if (facade != static_cast<CUDDFacade*>(0))
+				{
+					facade->invokeHooks(type);
+				}
+
+				return 1;
+			}
+
+			static int preGC(DdManager* manager, const char*, void*)
+			{
+				return dispatch(manager, CUDDFacade::HOOK_PRE_GC);
+			}
+
+			static int postGC(DdManager* manager, const char*, void*)
+			{
+				return dispatch(manager, CUDDFacade::HOOK_POST_GC);
+			}
+		};
 	}
 }
 
 
+CUDDFacade::Telemetry::Telemetry()
+	: liveNodes(0),
+		deadNodes(0),
+		peakNodes(0),
+		uniqueSlots(0),
+		uniqueLoad(0),
+		cacheSlots(0),
+		cacheLookups(0),
+		cacheHits(0),
+		cacheHitRate(0),
+		garbageCollections(0),
+		garbageCollectionTime(0),
+		reorderings(0),
+		reorderingTime(0),
+		memoryInUse(0)
+{ }
+
+
+std::string CUDDFacade::Telemetry::ToString() const
+{
+	std::ostringstream os;
+
+	os << "{\"live_nodes\": " << liveNodes
+		<< ", \"dead_nodes\": " << deadNodes
+		<< ", \"peak_nodes\": " << peakNodes
+		<< ", \"unique_slots\": " << uniqueSlots
+		<< ", \"unique_load\": " << uniqueLoad
+		<< ", \"cache_slots\": " << cacheSlots
+		<< ", \"cache_lookups\": " << cacheLookups
+		<< ", \"cache_hits\": " << cacheHits
+		<< ", \"cache_hit_rate\": " << cacheHitRate
+		<< ", \"gc_count\": " << garbageCollections
+		<< ", \"gc_time\": " << garbageCollectionTime
+		<< ", \"reorderings\": " << reorderings
+		<< ", \"reordering_time\": " << reorderingTime
+		<< ", \"memory_in_use\": " << memoryInUse << "}";
+
+	return os.str();
+}
+
+
 CUDDFacade::CUDDFacade()
-	: manager_(static_cast<Manager*>(0))
+	: manager_(static_cast<Manager*>(0)),
+		preGCHooks_(),
+		postGCHooks_()
 {
 	// Create the manager
 	if ((manager_ = fromCUDD(Cudd_Init(0, 0, CUDD_UNIQUE_SLOTS, CUDD_CACHE_SLOTS, 0)))
@@ -145,6 +290,8 @@ CUDDFacade::CUDDFacade()
 		SFTA_LOGGER_FATAL(error_msg);
 		throw std::runtime_error(error_msg);
 	}
+
+	CUDDHookDispatcher::registerFacade(toCUDD(manager_), this);
 }
 
 
@@ -259,6 +406,200 @@ unsigned CUDDFacade::GetDagSize(Node* node) const
 }
 
 
+unsigned CUDDFacade::GetNodeCount() const
+{
+	// Assertions
+	assert(manager_ != static_cast<Manager*>(0));
+
+	long count = Cudd_ReadNodeCount(toCUDD(manager_));
+	assert(count >= 0);
+
+	return static_cast<unsigned>(count);
+}
+
+
+size_t CUDDFacade::GetNodeSize()
+{
+	return sizeof(DdNode);
+}
+
+
+void CUDDFacade::SetOutOfMemoryHandler(OutOfMemoryHandlerType handler)
+{
+	// Assertions
+	assert(handler != static_cast<OutOfMemoryHandlerType>(0));
+
+	MMoutOfMemory = handler;
+}
+
+
+void CUDDFacade::ReorderSift() const
+{
+	// Assertions
+	assert(manager_ != static_cast<Manager*>(0));
+
+	if (Cudd_ReduceHeap(toCUDD(manager_), CUDD_REORDER_SIFT, 0) == 0)
+	{	// in case the reordering failed
+		throw std::runtime_error(__func__ + std::string(": reordering failed"));
+	}
+}
+
+
+std::vector<unsigned> CUDDFacade::GetVariableOrder() const
+{
+	// Assertions
+	assert(manager_ != static_cast<Manager*>(0));
+
+	std::vector<unsigned> order(GetVarCount());
+	for (unsigned level = 0; level < order.size(); ++level)
+	{	// read the variable at each level
+		int index = Cudd_ReadInvPerm(toCUDD(manager_), static_cast<int>(level));
+		assert(index >= 0);
+
+		order[level] = static_cast<unsigned>(index);
+	}
+
+	return order;
+}
+
+
+void CUDDFacade::SetVariableOrder(const std::vector<unsigned>& order) const
+{
+	// Assertions
+	assert(manager_ != static_cast<Manager*>(0));
+
+	if (order.size() != GetVarCount())
+	{	// in case the order does not cover all variables
+		throw std::runtime_error(__func__ +
+			std::string(": the order needs to contain all variables"));
+	}
+
+	std::vector<int> permutation(order.begin(), order.end());
+	if ((!permutation.empty()) &&
+		(Cudd_ShuffleHeap(toCUDD(manager_), &permutation[0]) == 0))
+	{	// in case the reordering failed
+		throw std::runtime_error(__func__ + std::string(": reordering failed"));
+	}
+}
+
+
+CUDDFacade::Telemetry CUDDFacade::GetTelemetry() const
+{
+	// Assertions
+	assert(manager_ != static_cast<Manager*>(0));
+
+	DdManager* manager = toCUDD(manager_);
+
+	Telemetry result;
+
+	// Cudd_ReadNodeCount() clears the death row, i.e. it may dereference
+	// nodes, which is not allowed during garbage collection, where this is
+	// called from hooks
+	result.liveNodes = manager->keys - manager->dead;
+	result.deadNodes = Cudd_ReadDead(manager);
+	result.peakNodes = static_cast<unsigned long>(Cudd_ReadPeakNodeCount(manager));
+
+	result.uniqueSlots = Cudd_ReadSlots(manager);
+	if (result.uniqueSlots > 0)
+	{
+		result.uniqueLoad = static_cast<double>(Cudd_ReadKeys(manager)) /
+			result.uniqueSlots;
+	}
+
+	result.cacheSlots = Cudd_ReadCacheSlots(manager);
+	result.cacheLookups = Cudd_ReadCacheLookUps(manager);
+	result.cacheHits = Cudd_ReadCacheHits(manager);
+	if (result.cacheLookups > 0)
+	{
+		result.cacheHitRate = result.cacheHits / result.cacheLookups;
+	}
+
+	// CUDD measures times in milliseconds
+	result.garbageCollections =
+		static_cast<unsigned long>(Cudd_ReadGarbageCollections(manager));
+	result.garbageCollectionTime =
+		Cudd_ReadGarbageCollectionTime(manager) / 1000.0;
+	result.reorderings = static_cast<unsigned long>(Cudd_ReadReorderings(manager));
+	result.reorderingTime = Cudd_ReadReorderingTime(manager) / 1000.0;
+
+	result.memoryInUse = static_cast<unsigned long>(Cudd_ReadMemoryInUse(manager));
+
+	return result;
+}
+
+
+void CUDDFacade::AddHook(HookType type, AbstractHookFunctor* hook)
+{
+	// Assertions
+	assert(manager_ != static_cast<Manager*>(0));
+	assert(hook != static_cast<AbstractHookFunctor*>(0));
+
+	HookVector& hooks = (type == HOOK_PRE_GC)? preGCHooks_ : postGCHooks_;
+
+	if (hooks.empty())
+	{	// in case the CUDD hook is not installed yet
+		int res = (type == HOOK_PRE_GC)?
+			Cudd_AddHook(toCUDD(manager_), &CUDDHookDispatcher::preGC, CUDD_PRE_GC_HOOK) :
+			Cudd_AddHook(toCUDD(manager_), &CUDDHookDispatcher::postGC, CUDD_POST_GC_HOOK);
+
+		if (res == 0)
+		{	// in case the hook could not be installed
+			throw std::runtime_error(__func__ + std::string(": cannot add hook"));
+		}
+	}
+
+	hooks.push_back(hook);
+}
+
+
+void CUDDFacade::RemoveHook(HookType type, AbstractHookFunctor* hook)
+{
+	// Assertions
+	assert(manager_ != static_cast<Manager*>(0));
+
+	HookVector& hooks = (type == HOOK_PRE_GC)? preGCHooks_ : postGCHooks_;
+
+	HookVector::iterator itHook = std::find(hooks.begin(), hooks.end(), hook);
+	if (itHook == hooks.end())
+	{	// in case the hook is not registered
+		throw std::runtime_error(__func__ + std::string(": unknown hook"));
+	}
+
+	hooks.erase(itHook);
+
+	if (hooks.empty())
+	{	// in case the CUDD hook is not needed any more
+		if (type == HOOK_PRE_GC)
+		{
+			Cudd_RemoveHook(toCUDD(manager_), &CUDDHookDispatcher::preGC, CUDD_PRE_GC_HOOK);
+		}
+		else
+		{
+			Cudd_RemoveHook(toCUDD(manager_), &CUDDHookDispatcher::postGC, CUDD_POST_GC_HOOK);
+		}
+	}
+}
+
+
+void CUDDFacade::invokeHooks(HookType type)
+{
+	const HookVector& hooks = (type == HOOK_PRE_GC)? preGCHooks_ : postGCHooks_;
+
+	if (!hooks.empty())
+	{	// in case there is some hook to be invoked
+		Telemetry telemetry = GetTelemetry();
+
+		// copy the hooks so that a hook may remove itself
+		HookVector hooksCopy = hooks;
+		for (HookVector::const_iterator itHook = hooksCopy.begin();
+			itHook != hooksCopy.end(); ++itHook)
+		{
+			(**itHook)(type, telemetry);
+		}
+	}
+}
+
+
 CUDDFacade::Node* CUDDFacade::Times(Node* lhs, Node* rhs) const
 {
 	// Assertions
@@ -292,6 +633,107 @@ CUDDFacade::Node* CUDDFacade::Times(Node* lhs, Node* rhs) const
 }
 
 
+CUDDFacade::Node* CUDDFacade::Ite(Node* cond, Node* thenNode,
+	Node* elseNode) const
+{
+	// Assertions
+	assert(manager_ != static_cast<Manager*>(0));
+	assert(cond != static_cast<Node*>(0));
+	assert(thenNode != static_cast<Node*>(0));
+	assert(elseNode != static_cast<Node*>(0));
+
+	Node* res = fromCUDD(Cudd_addIte(toCUDD(manager_), toCUDD(cond),
+		toCUDD(thenNode), toCUDD(elseNode)));
+
+	// check the return value
+	assert(res != static_cast<Node*>(0));
+
+	return res;
+}
+
+
+namespace
+{
+	/**
+	 * @brief  Guard of the nesting depth of Apply operations
+	 *
+	 * Apply functors may call Apply operations themselves (e.g. in the
+	 * downward inclusion checking). The guard keeps track of the nesting so
+	 * that an interruption is reported only from the outermost Apply, which
+	 * is not called from a CUDD callback. The depth is kept per thread, as
+	 * is the current operation context.
+	 */
+	class ApplyDepthGuard
+	{
+	private:  // Private data members
+
+		static size_t& depth()
+		{
+			static __thread size_t applyDepth = 0;
+			return applyDepth;
+		}
+
+	private:  // Private methods
+
+		ApplyDepthGuard(const ApplyDepthGuard&);
+		ApplyDepthGuard& operator=(const ApplyDepthGuard&);
+
+	public:   // Public methods
+
+		ApplyDepthGuard()
+		{
+			++depth();
+		}
+
+		~ApplyDepthGuard()
+		{
+			--depth();
+		}
+
+		static inline bool IsOutermost()
+		{
+			return depth() == 1;
+		}
+	};
+}
+
+
+/**
+ * @brief  Discards the result of an interrupted Apply
+ *
+ * If the current operation was interrupted during an Apply operation, the
+ * result of the Apply is bogus (the leaves were not computed by the functor).
+ * The result is released and the computed table is flushed, as it may
+ * contain bogus results keyed by the address of the functor, and
+ * SFTA::OperationInterrupted is thrown. The exception is not thrown directly
+ * from the callbacks (nor from nested Apply operations), as it must not pass
+ * through CUDD; nested Apply operations return their bogus result to the
+ * functor, which is expected to poll the context as well.
+ *
+ * @param[in]  manager  The CUDD manager
+ * @param[in]  res      The result of the Apply operation
+ */
+void discardIfInterrupted(CUDDFacade::Manager* manager, CUDDFacade::Node* res)
+{
+	SFTA::OperationContext* context = SFTA::OperationContext::GetCurrent();
+	if ((context == static_cast<SFTA::OperationContext*>(0)) ||
+		!ApplyDepthGuard::IsOutermost())
+	{	// in case the operation is not limited or the Apply is nested
+		return;
+	}
+
+	if (context->Poll() != SFTA::OperationInterrupted::NotInterrupted)
+	{	// in case the operation was interrupted
+		DdManager* dd = toCUDD(manager);
+		Cudd_Ref(toCUDD(res));
+		Cudd_RecursiveDeref(dd, toCUDD(res));
+		cuddCacheFlush(dd);
+
+		SFTA::OperationContext::ThrowIfInterrupted();
+	}
+}
+
+
 DdNode* applyCallback(DdManager* dd, DdNode** f, DdNode** g, void* data)
 {
 	// Assertions
@@ -311,6 +753,12 @@ DdNode* applyCallback(DdManager* dd, DdNode** f, DdNode** g, void* data)
 	if (isConstantCUDD(F) && isConstantCUDD(G))
 	{	// in case we are at leaves
 
+		if (SFTA::OperationContext::PollCurrent() !=
+			SFTA::OperationInterrupted::NotInterrupted)
+		{	// in case the operation is interrupted, finish with any valid leaf
+			return F;
+		}
+
 		// get the functor from the container
 		CUDDFacade::AbstractApplyFunctor& func =
 			*(static_cast<CUDDFacade::AbstractApplyFunctor*>(data));
@@ -351,6 +799,12 @@ DdNode* ternaryApplyCallback(DdManager* dd, DdNode** f, DdNode** g, DdNode** h,
 	if (isConstantCUDD(F) && isConstantCUDD(G) && isConstantCUDD(H))
 	{	// in case we are at leaves
 
+		if (SFTA::OperationContext::PollCurrent() !=
+			SFTA::OperationInterrupted::NotInterrupted)
+		{	// in case the operation is interrupted, finish with any valid leaf
+			return F;
+		}
+
 		// get the functor from the container
 		CUDDFacade::AbstractTernaryApplyFunctor& func =
 			*(static_cast<CUDDFacade::AbstractTernaryApplyFunctor*>(data));
@@ -379,6 +833,12 @@ DdNode* monadicApplyCallback(DdManager* dd, DdNode* f, void* data)
 	if (isConstantCUDD(f))
 	{	// in case we are at leaves
 
+		if (SFTA::OperationContext::PollCurrent() !=
+			SFTA::OperationInterrupted::NotInterrupted)
+		{	// in case the operation is interrupted, finish with any valid leaf
+			return f;
+		}
+
 		// get the functor from the container
 		CUDDFacade::AbstractMonadicApplyFunctor& func =
 			*(static_cast<CUDDFacade::AbstractMonadicApplyFunctor*>(data));
@@ -406,12 +866,17 @@ CUDDFacade::Node* CUDDFacade::Apply(Node* lhs, Node* rhs,
 	assert(rhs != static_cast<Node*>(0));
 	assert(func != static_cast<AbstractApplyFunctor*>(0));
 
+	SFTA_TRACE_SPAN("CUDDFacade::Apply");
+	ApplyDepthGuard depthGuard;
+
 	Node* res = fromCUDD(Cudd_addApplyWithData(
 		toCUDD(manager_), applyCallback, toCUDD(lhs), toCUDD(rhs), func));
 
 	// check the return value
 	assert(res != static_cast<Node*>(0));
 
+	discardIfInterrupted(manager_, res);
+
 	return res;
 }
 
@@ -426,12 +891,17 @@ CUDDFacade::Node* CUDDFacade::TernaryApply(Node* lhs, Node* mhs, Node* rhs,
 	assert(rhs != static_cast<Node*>(0));
 	assert(func != static_cast<AbstractTernaryApplyFunctor*>(0));
 
+	SFTA_TRACE_SPAN("CUDDFacade::TernaryApply");
+	ApplyDepthGuard depthGuard;
+
 	Node* res = fromCUDD(Cudd_addTernaryApplyWithData(toCUDD(manager_),
 		ternaryApplyCallback, toCUDD(lhs), toCUDD(mhs), toCUDD(rhs), func));
 
 	// check the return value
 	assert(res != static_cast<Node*>(0));
 
+	discardIfInterrupted(manager_, res);
+
 	return res;
 }
 
@@ -444,12 +914,17 @@ CUDDFacade::Node* CUDDFacade::MonadicApply(Node* root,
 	assert(root != static_cast<Node*>(0));
 	assert(func != static_cast<AbstractMonadicApplyFunctor*>(0));
 
+	SFTA_TRACE_SPAN("CUDDFacade::MonadicApply");
+	ApplyDepthGuard depthGuard;
+
 	Node* res = fromCUDD(Cudd_addMonadicApplyWithData(
 		toCUDD(manager_), monadicApplyCallback, toCUDD(root), func));
 
 	// check the return value
 	assert(res != static_cast<Node*>(0));
 
+	discardIfInterrupted(manager_, res);
+
 	return res;
 }
 
@@ -889,6 +1364,8 @@ CUDDFacade::~CUDDFacade()
 		SFTA_LOGGER_WARN("Still " + Convert::ToString(unrefed) + " nodes unreferenced!");
 	}
 
+	CUDDHookDispatcher::unregisterFacade(toCUDD(manager_));
+
 	// Delete the manager
 	Cudd_Quit(toCUDD(manager_));
 	manager_ = static_cast<Manager*>(0);
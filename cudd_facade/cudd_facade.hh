@@ -23,7 +23,7 @@
 
 
 // insert the class into proper namespace
-namespace SFTA { namespace Private { class CUDDFacade; } }
+namespace SFTA { namespace Private { class CUDDFacade; struct CUDDHookDispatcher; } }
 
 
 /**
@@ -114,6 +114,15 @@ public:  // Public types
 	typedef ParentClass::AbstractMonadicApplyFunctor AbstractMonadicApplyFunctor;
 
 
+	/**
+	 * @brief  Type of the handler of exhausted memory
+	 *
+	 * The type of the function that CUDD calls with the number of bytes it
+	 * failed to allocate.
+	 */
+	typedef void (*OutOfMemoryHandlerType)(long);
+
+
 	/**
 	 * @brief  The abstract class for a functor for predicates over nodes
 	 *
@@ -156,6 +165,92 @@ public:  // Public types
 	};
 
 
+	/**
+	 * @brief  Telemetry of the manager
+	 *
+	 * A snapshot of the counters of the CUDD manager describing the state of
+	 * the node table, the computed table, garbage collection and reordering.
+	 * Times are in seconds, memory is in bytes.
+	 */
+	struct Telemetry
+	{
+		unsigned long liveNodes;
+		unsigned long deadNodes;
+		unsigned long peakNodes;
+		unsigned long uniqueSlots;
+		double uniqueLoad;              ///< nodes per slot of the unique table
+		unsigned long cacheSlots;
+		double cacheLookups;
+		double cacheHits;
+		double cacheHitRate;
+		unsigned long garbageCollections;
+		double garbageCollectionTime;
+		unsigned long reorderings;
+		double reorderingTime;
+		unsigned long memoryInUse;
+
+		Telemetry();
+
+		/**
+		 * @brief  Serializes the telemetry
+		 *
+		 * Returns the telemetry as a JSON object.
+		 */
+		std::string ToString() const;
+	};
+
+
+	/**
+	 * @brief  Type of a hook
+	 *
+	 * The moment when a hook is invoked.
+	 */
+	enum HookType
+	{
+		HOOK_PRE_GC,      ///< before garbage collection
+		HOOK_POST_GC      ///< after garbage collection
+	};
+
+
+	/**
+	 * @brief  The abstract class for a hook
+	 *
+	 * This is an abstract class defining the interface of functors that are
+	 * invoked by the manager, e.g., around garbage collection.
+	 */
+	class AbstractHookFunctor
+	{
+	public:   // Public methods
+
+		/**
+		 * @brief  The hook operator
+		 *
+		 * This operation is invoked by the manager. It must not create or
+		 * dereference any nodes.
+		 *
+		 * @param[in]  type       The moment of invocation
+		 * @param[in]  telemetry  The telemetry of the manager at the moment
+		 */
+		virtual void operator()(HookType type, const Telemetry& telemetry) = 0;
+
+
+		/**
+		 * @brief  Destructor
+		 *
+		 * Virtual destructor
+		 */
+		virtual ~AbstractHookFunctor()
+		{ }
+	};
+
+
+private: // Private data types
+
+	typedef std::vector<AbstractHookFunctor*> HookVector;
+
+	friend struct SFTA::Private::CUDDHookDispatcher;
+
+
 private: // Private data members
 
 	/**
@@ -166,6 +261,18 @@ private: // Private data members
 	Manager* manager_;
 
 
+	/**
+	 * @brief  Hooks invoked before garbage collection
+	 */
+	HookVector preGCHooks_;
+
+
+	/**
+	 * @brief  Hooks invoked after garbage collection
+	 */
+	HookVector postGCHooks_;
+
+
 private: // Private methods
 
 	/**
@@ -186,6 +293,16 @@ private: // Private methods
 	CUDDFacade& operator=(const CUDDFacade& rhs);
 
 
+	/**
+	 * @brief  Invokes hooks
+	 *
+	 * Invokes all hooks registered for given moment.
+	 *
+	 * @param[in]  type  The moment of invocation
+	 */
+	void invokeHooks(HookType type);
+
+
 public:  // Public methods
 
 	/**
@@ -316,6 +433,125 @@ public:  // Public methods
 	unsigned GetDagSize(Node* node) const;
 
 
+	/**
+	 * @brief  Gets the number of live nodes
+	 *
+	 * Returns the number of nodes that are currently alive in the manager,
+	 * i.e., the number of nodes of all MTBDDs in the manager.
+	 *
+	 * @returns  The number of live nodes
+	 */
+	unsigned GetNodeCount() const;
+
+
+	/**
+	 * @brief  Gets the size of a node
+	 *
+	 * Returns the number of bytes occupied by a single node of an MTBDD.
+	 *
+	 * @returns  The size of a node
+	 */
+	static size_t GetNodeSize();
+
+
+	/**
+	 * @brief  Sets the handler of exhausted memory
+	 *
+	 * Sets the function that CUDD calls when it fails to allocate memory
+	 * (the default one prints a message and exits the process). The handler
+	 * is global for all managers. It is called from C code, so it must not
+	 * throw; it may, e.g., terminate the process with a distinct exit code.
+	 *
+	 * @param[in]  handler  The new handler
+	 */
+	static void SetOutOfMemoryHandler(OutOfMemoryHandlerType handler);
+
+
+	/**
+	 * @brief  Reorders variables using sifting
+	 *
+	 * Reorders the variables of the manager using Rudell's sifting algorithm
+	 * in order to reduce the number of nodes. All MTBDDs that are to survive
+	 * need to be referenced. The method must not be called during an Apply
+	 * operation.
+	 *
+	 * @see  GetVariableOrder()
+	 */
+	void ReorderSift() const;
+
+
+	/**
+	 * @brief  Gets the order of variables
+	 *
+	 * Returns the current order of variables, i.e., the vector of variable
+	 * indices from the top level of the MTBDD to the bottom.
+	 *
+	 * @see  SetVariableOrder()
+	 *
+	 * @returns  Vector of indices of variables in the order of levels
+	 */
+	std::vector<unsigned> GetVariableOrder() const;
+
+
+	/**
+	 * @brief  Sets the order of variables
+	 *
+	 * Reorders the variables of the manager to given order. The order needs
+	 * to be a permutation of all variables of the manager.
+	 *
+	 * @see  GetVariableOrder()
+	 *
+	 * @param[in]  order  Vector of indices of variables in the order of levels
+	 */
+	void SetVariableOrder(const std::vector<unsigned>& order) const;
+
+
+	/**
+	 * @brief  Gets the telemetry of the manager
+	 *
+	 * Returns a snapshot of the counters of the manager: live, dead and peak
+	 * nodes, the load of the unique table, the hit rate of the computed
+	 * table, the number and time of garbage collections and reorderings and
+	 * the memory in use. It does not dereference any node, so it is safe to
+	 * call during garbage collection (e.g. from a hook). The live nodes
+	 * include the constants and the projection functions of variables.
+	 *
+	 * @see  AddHook()
+	 *
+	 * @returns  The telemetry of the manager
+	 */
+	Telemetry GetTelemetry() const;
+
+
+	/**
+	 * @brief  Adds a hook
+	 *
+	 * Registers a hook that is invoked by the manager at given moment (e.g.
+	 * before or after garbage collection) with the telemetry at that moment.
+	 * The hook is not owned by the facade and needs to outlive it or to be
+	 * removed by RemoveHook().
+	 *
+	 * @see  RemoveHook()
+	 *
+	 * @param[in]  type  The moment of invocation
+	 * @param[in]  hook  The hook
+	 */
+	void AddHook(HookType type, AbstractHookFunctor* hook);
+
+
+	/**
+	 * @brief  Removes a hook
+	 *
+	 * Removes a hook previously registered by AddHook().
+	 *
+	 * @see  AddHook()
+	 *
+	 * @param[in]  type  The moment of invocation
+	 * @param[in]  hook  The hook
+	 */
+	void RemoveHook(HookType type, AbstractHookFunctor* hook);
+
+
 	/**
 	 * @brief  Multiplication of two nodes
 	 *
@@ -334,6 +570,22 @@ public:  // Public methods
 	Node* Times(Node* lhs, Node* rhs) const;
 
 
+	/**
+	 * @brief  If-then-else
+	 *
+	 * Creates the MTBDD that is equal to @p thenNode where the Boolean
+	 * expression @p cond holds and to @p elseNode elsewhere. Unlike creating
+	 * a node directly, this respects the current order of variables.
+	 *
+	 * @param[in]  cond      Boolean expression (e.g. a variable)
+	 * @param[in]  thenNode  The MTBDD for the case @p cond holds
+	 * @param[in]  elseNode  The MTBDD for the case @p cond does not hold
+	 *
+	 * @returns  The resulting MTBDD
+	 */
+	Node* Ite(Node* cond, Node* thenNode, Node* elseNode) const;
+
+
 	/**
 	 * @brief  Apply operation
 	 *
@@ -0,0 +1,155 @@
+/*****************************************************************************
+ *  Symbolic Finite Tree Automata Library
+ *
+ *  Description:
+ *    File with the BitmapSet class.
+ *
+ *****************************************************************************/
+
+#ifndef _SFTA_BITMAP_SET_HH_
+#define _SFTA_BITMAP_SET_HH_
+
+// Standard library headers
+#include <vector>
+
+// Boost library headers
+#include <boost/cstdint.hpp>
+
+
+// insert the class into proper namespace
+namespace SFTA
+{
+	namespace Private
+	{
+		template
+		<
+			typename Element
+		>
+		class BitmapSet;
+	}
+}
+
+
+/**
+ * @brief   Set of small integers stored as a bitmap
+ *
+ * Set of nonnegative integers (e.g. internal identifiers of states) that is
+ * stored as a bitmap, so that insertion and membership tests take constant
+ * time. The bitmap grows with the largest inserted element.
+ *
+ * @tparam  Element  The type of elements (an unsigned integral type).
+ */
+template
+<
+	typename Element
+>
+class SFTA::Private::BitmapSet
+{
+public:   // Public data types
+
+	typedef Element ElementType;
+
+private:  // Private data types
+
+	typedef boost::uint64_t WordType;
+
+	typedef std::vector<WordType> WordVector;
+
+	enum
+	{
+		// the number of bits in a word
+		BitsInWord = 64
+	};
+
+private:  // Private data members
+
+	WordVector words_;
+
+private:  // Private methods
+
+	static inline size_t getIndexOfWord(const ElementType& x)
+	{
+		return static_cast<size_t>(x) / BitsInWord;
+	}
+
+	static inline WordType getBitOfElement(const ElementType& x)
+	{
+		return static_cast<WordType>(1) << (static_cast<size_t>(x) % BitsInWord);
+	}
+
+public:   // Public methods
+
+	BitmapSet()
+		: words_()
+	{ }
+
+	inline void insert(const ElementType& x)
+	{
+		size_t index = getIndexOfWord(x);
+		if (index >= words_.size())
+		{	// in case the bitmap needs to grow
+			words_.resize(index + 1, 0);
+		}
+
+		words_[index] |= getBitOfElement(x);
+	}
+
+	void insert(const BitmapSet& rhs)
+	{
+		if (rhs.words_.size() > words_.size())
+		{	// in case the bitmap needs to grow
+			words_.resize(rhs.words_.size(), 0);
+		}
+
+		for (size_t i = 0; i < rhs.words_.size(); ++i)
+		{	// unite word by word
+			words_[i] |= rhs.words_[i];
+		}
+	}
+
+	inline bool Contains(const ElementType& x) const
+	{
+		size_t index = getIndexOfWord(x);
+		return (index < words_.size()) &&
+			((words_[index] & getBitOfElement(x)) != 0);
+	}
+
+	/**
+	 * @brief  Checks whether any element of a range is in the set
+	 *
+	 * Checks whether some element of given range of elements is in the set.
+	 *
+	 * @param[in]  first  The beginning of the range
+	 * @param[in]  last   The end of the range
+	 *
+	 * @returns  @p true if some element of the range is in the set, @p false
+	 *           otherwise
+	 */
+	template <class InputIterator>
+	bool ContainsAnyOf(InputIterator first, InputIterator last) const
+	{
+		for ( ; first != last; ++first)
+		{
+			if (Contains(*first))
+			{
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	/**
+	 * @brief  Memory used by the set
+	 *
+	 * Returns the number of bytes allocated by the bitmap on the heap.
+	 *
+	 * @returns  The number of bytes
+	 */
+	inline size_t GetMemoryUsage() const
+	{
+		return words_.capacity() * sizeof(WordType);
+	}
+};
+
+#endif
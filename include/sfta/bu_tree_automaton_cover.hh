@@ -21,9 +21,13 @@
 #include <sfta/dual_map_leaf_allocator.hh>
 #include <sfta/dual_hash_table_leaf_allocator.hh>
 #include <sfta/map_root_allocator.hh>
+#include <sfta/memory_usage.hh>
 #include <sfta/mtbdd_transition_table_wrapper.hh>
 #include <sfta/nd_symbolic_bu_tree_automaton.hh>
+#include <sfta/operation_context.hh>
+#include <sfta/operation_statistics.hh>
 #include <sfta/set.hh>
+#include <sfta/slab_leaf_allocator.hh>
 #include <sfta/symbol_dictionary.hh>
 #include <sfta/vector.hh>
 
@@ -39,25 +43,6 @@ namespace SFTA
 }
 
 
-namespace boost
-{
-	template <class T>
-	std::size_t hash_value(const SFTA::Private::ElemOrVector<T>& v)
-	{
-		if (v.IsElement())
-		{
-			const T& ref = v.GetElement();
-			return boost::hash_value(ref);
-		}
-		else
-		{
-			const std::vector<T>& ref = v.GetVector();
-			return boost::hash_range(ref.begin(), ref.end());
-		}
-	}
-}
-
-
 namespace std
 {
 	namespace tr1
@@ -70,27 +55,8 @@ namespace std
 		GCC_DIAG_ON(effc++)
 			std::size_t operator()(const SFTA::OrderedVector<SFTA::Private::ElemOrVector<T> >& val) const
 			{
-				//return boost::hash_range(val.begin(), val.end());
-				size_t seed = 0;
-
-				for (typename SFTA::OrderedVector<SFTA::Private::ElemOrVector<T> >::const_iterator first = val.begin(); first != val.end(); ++first)
-				{
-					size_t newHash;
-					if (first->IsElement())
-					{
-						const T& ref = first->GetElement();
-						newHash = boost::hash_value(ref);
-					}
-					else
-					{
-						const std::vector<T>& ref = first->GetVector();
-						newHash = boost::hash_range(ref.begin(), ref.end());
-					}
-
-					boost::hash_combine(seed, newHash);
-				}
-
-				return seed;
+				// the hash is maintained by the container
+				return val.HashValue();
 			}
 		};
 	}
@@ -136,7 +102,7 @@ private:  // Private data types
 		MTBDDRootType,
 		InternalRightHandSideType,
 		InternalSymbolType,
-		SFTA::Private::DualHashTableLeafAllocator,
+		SFTA::Private::SlabLeafAllocator,
 		SFTA::Private::MapRootAllocator
 	> SharedMTBDD;
 
@@ -179,6 +145,38 @@ public:   // Public data types
 
 	typedef Loki::SmartPtr<SymbolDictionaryType> SymbolDictionaryPtrType;
 
+	typedef typename SymbolDictionaryType::RankedSymbolType RankedSymbolType;
+	typedef typename SymbolDictionaryType::RankedSymbolVector RankedSymbolVector;
+
+	/**
+	 * @brief  Simulations used by downward inclusion checking
+	 */
+	enum InclusionSimulationType
+	{
+		INCLUSION_SIM_SEPARATE,   ///< simulation preorder of each automaton
+		INCLUSION_SIM_BOTH,       ///< simulation preorder of their union
+		INCLUSION_SIM_NONE        ///< identity relations
+	};
+
+	/**
+	 * @brief  Durations of phases of inclusion checking
+	 *
+	 * Thread CPU time (in seconds) spent in the individual phases of
+	 * downward inclusion checking.
+	 */
+	struct InclusionProfile
+	{
+		double simulation;
+		double conversion;
+		double check;
+
+		InclusionProfile()
+			: simulation(0),
+				conversion(0),
+				check(0)
+		{ }
+	};
+
 	/**
 	 * @brief  Class with operations
 	 *
@@ -187,8 +185,36 @@ public:   // Public data types
 	 */
 	class Operation
 	{
+	private:  // Private data members
+
+		/**
+		 * @brief  Statistics of the last operation
+		 *
+		 * Statistics collected during the last operation performed by the
+		 * object.
+		 */
+		mutable OperationStatistics statistics_;
+
+		/**
+		 * @brief  Context of operations
+		 *
+		 * The context with limits of operations performed by the object, or
+		 * null pointer if the operations are not limited.
+		 */
+		OperationContext* context_;
+
+	private:  // Private methods
+
+		Operation(const Operation&);
+		Operation& operator=(const Operation&);
+
 	public:   // Public methods
 
+		Operation()
+			: statistics_(),
+				context_(static_cast<OperationContext*>(0))
+		{ }
+
 		Type* Union(Type* lhs, Type* rhs) const;
 
 		Type* Intersection(Type* lhs, Type* rhs) const;
@@ -210,6 +236,51 @@ public:   // Public data types
 
 		bool DoesLanguageInclusionHoldDownwardsWithoutSim(const Type* lhs,
 			const Type* rhs, timespec* start) const;
+
+		/**
+		 * @brief  Checks downward language inclusion
+		 *
+		 * Checks whether the language of @p lhs is included in the language of
+		 * @p rhs using the downward algorithm with simulations given by
+		 * @p simulation and records durations of its phases to @p profile. The
+		 * other downward variants are shortcuts for this method.
+		 *
+		 * @param[out]  checkStart  If not null, set to the thread CPU time at
+		 *                          which the check itself starts
+		 */
+		bool DoesLanguageInclusionHoldDownwardsProfiled(const Type* lhs,
+			const Type* rhs, InclusionSimulationType simulation,
+			InclusionProfile* profile,
+			timespec* checkStart = static_cast<timespec*>(0)) const;
+
+		/**
+		 * @brief  Returns statistics
+		 *
+		 * Returns the statistics collected during the last operation performed
+		 * by the object. The statistics are empty unless the library is
+		 * compiled with SFTA_ENABLE_STATISTICS defined.
+		 *
+		 * @returns  Statistics of the last operation
+		 */
+		inline const OperationStatistics& GetStatistics() const
+		{
+			return statistics_;
+		}
+
+		/**
+		 * @brief  Sets the context of operations
+		 *
+		 * Makes subsequent operations performed by the object check the
+		 * deadline, the cancellation flag and the memory budget of @p context
+		 * (which needs to outlive the operations). An interrupted operation
+		 * throws SFTA::OperationInterrupted, i.e., its result is unknown.
+		 *
+		 * @param[in]  context  The context, or null pointer for no limits
+		 */
+		inline void SetContext(OperationContext* context)
+		{
+			context_ = context;
+		}
 	};
 
 
@@ -223,9 +294,6 @@ private:  // Private data members
 
 	SymbolDictionaryPtrType symbolDict_;
 
-	size_t bddSize_;
-
-	InternalSymbolType nextSymbol_;
 
 private:  // Private methods
 
@@ -244,43 +312,42 @@ private:  // Private methods
 
 	std::string finalStatesToString(const InternalStateVector& vec) const;
 
-	static std::string symbolsToString(const std::vector<SymbolType>& vec);
+	static std::string symbolsToString(const RankedSymbolVector& vec);
 
 
 public:   // Public methods
 
-	explicit BUTreeAutomatonCover(size_t bddSize)
+	BUTreeAutomatonCover()
 		: automaton_(new NDSymbolicBUTreeAutomaton()),
 			state2internalStateMap_(),
 			areStatesFromOutside_(true),
-			symbolDict_(),
-			bddSize_(bddSize),
-			nextSymbol_(bddSize, 0)
+			symbolDict_()
 	{ }
 
-	BUTreeAutomatonCover(size_t bddSize, TTWrapperPtr wrapper, SymbolDictionaryPtrType symbolDict)
+	BUTreeAutomatonCover(TTWrapperPtr wrapper, SymbolDictionaryPtrType symbolDict)
 		: automaton_(new NDSymbolicBUTreeAutomaton(wrapper)),
 			state2internalStateMap_(),
 			areStatesFromOutside_(true),
-			symbolDict_(symbolDict),
-			bddSize_(bddSize),
-			nextSymbol_(bddSize, 0)
+			symbolDict_(symbolDict)
 	{ }
 
-	BUTreeAutomatonCover(size_t bddSize, NDSymbolicBUTreeAutomaton* automaton, SymbolDictionaryPtrType symbolDict)
+	BUTreeAutomatonCover(NDSymbolicBUTreeAutomaton* automaton, SymbolDictionaryPtrType symbolDict)
 		: automaton_(automaton),
 			state2internalStateMap_(),
 			areStatesFromOutside_(false),
-			symbolDict_(symbolDict),
-			bddSize_(bddSize),
-			nextSymbol_(bddSize, 0)
+			symbolDict_(symbolDict)
 	{ }
 
 	void AddState(const StateType& state);
 
-	inline void AddSymbol(const SymbolType& symbol)
+	inline void AddSymbol(const SymbolType& symbol, size_t arity)
 	{
-		symbolDict_->Translate(symbol);
+		symbolDict_->Translate(symbol, arity);
+	}
+
+	inline void AddSymbols(const RankedSymbolVector& symbols)
+	{
+		symbolDict_->TranslateAll(symbols);
 	}
 
 	void AddTransition(const LeftHandSideType& lhs, const SymbolType& symbol,
@@ -293,14 +360,41 @@ public:   // Public methods
 		return automaton_->GetTTWrapper();
 	}
 
-	inline Operation* GetOperation() const
+	/**
+	 * @brief  Reorders variables of the MTBDD
+	 *
+	 * Reorders the variables of the shared MTBDD of the automaton (and all
+	 * automata sharing it) using sifting.
+	 */
+	inline void ReorderVariables()
 	{
-		return new Operation();
+		automaton_->GetTTWrapper()->GetMTBDD()->ReorderVariables();
+	}
+
+	inline size_t GetMTBDDNodeCount()
+	{
+		return automaton_->GetTTWrapper()->GetMTBDD()->GetNodeCount();
 	}
 
-	inline size_t GetBDDSize() const
+	inline SFTA::Private::CUDDFacade::Telemetry GetMTBDDTelemetry()
 	{
-		return bddSize_;
+		return automaton_->GetTTWrapper()->GetMTBDD()->GetTelemetry();
+	}
+
+	/**
+	 * @brief  Returns the memory footprint of the shared MTBDD
+	 *
+	 * Returns the footprint of the whole shared MTBDD of the automaton (and
+	 * all automata sharing it).
+	 */
+	inline MTBDDMemoryUsage GetMTBDDMemoryUsage()
+	{
+		return automaton_->GetTTWrapper()->GetMTBDD()->GetMemoryUsage();
+	}
+
+	inline Operation* GetOperation() const
+	{
+		return new Operation();
 	}
 
 	inline SymbolDictionaryPtrType GetSymbolDictionary() const
@@ -308,6 +402,15 @@ public:   // Public methods
 		return symbolDict_;
 	}
 
+	/**
+	 * @brief  Returns the memory footprint of the automaton
+	 *
+	 * Returns the estimated memory used by the automaton, including the map
+	 * of names of states and the part of the shared MTBDD reachable only from
+	 * the automaton.
+	 */
+	MemoryUsage GetMemoryUsage() const;
+
 	std::string ToString() const;
 };
 #endif
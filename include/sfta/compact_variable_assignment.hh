@@ -14,11 +14,17 @@
 
 // Standard library headers
 #include <cassert>
+#include <algorithm>
+#include <ostream>
 #include <string>
 #include <vector>
 #include <stdexcept>
 
 
+// Boost library headers
+#include <boost/cstdint.hpp>
+
+
 // insert class into correct namespace
 namespace SFTA
 {
@@ -37,6 +43,15 @@ namespace SFTA
  * A class that represents assignments to Boolean variables in a compact way.
  * Assigned values can be one of '0', '1' and 'X', where 'X' means <em>don't
  * care</em>.
+ *
+ * The assignment is kept in two bit-planes of 64-bit words: the @e care
+ * plane has the bit of a variable set iff the variable is not a don't care
+ * and the @e value plane holds the value of such variable. The bits of
+ * don't care variables and the bits above the number of variables are
+ * always zero in both planes, so that comparison, incrementation and
+ * matching can be carried out on whole words. Assignments of up to
+ * InlineWordsCount words per plane are stored inline without any heap
+ * allocation.
  */
 struct SFTA::Private::CompactVariableAssignment
 {
@@ -52,23 +67,21 @@ public:   // Public data types
 
 	typedef std::vector<CompactVariableAssignment> AssignmentList;
 
-private:  // Private data types
+	class ConcreteSymbolIterator;
 
-	enum
-	{
-		BitsPerVariable = 2
-	};
+private:  // Private data types
 
+	typedef boost::uint64_t WordType;
 
 	enum
 	{
-		// needs to be multiple of BitsPerVariable
-		BitsInChar = 8
+		BitsInWord = 64
 	};
 
 	enum
 	{
-		DefaultMask = 0x03
+		// the number of words of a plane that are stored inline
+		InlineWordsCount = 1
 	};
 
 
@@ -85,104 +98,242 @@ private:  // Private data members
 
 
 	/**
-	 * @brief  The value of the assignment
+	 * @brief  The number of words reserved for a plane
+	 *
+	 * The number of words reserved for a single plane. The value plane starts
+	 * at this offset from the start of the care plane.
+	 */
+	size_t capacity_;
+
+
+	/**
+	 * @brief  Inline storage
+	 *
+	 * The storage for both planes in case the assignment is short enough.
+	 */
+	WordType inlineWords_[2 * InlineWordsCount];
+
+
+	/**
+	 * @brief  Heap storage
 	 *
-	 * Array of characters representing the value of the assignment.
+	 * The storage for both planes in case the assignment does not fit into
+	 * the inline storage, otherwise a null pointer.
 	 */
-	std::vector<char> vars_;
+	WordType* heapWords_;
 
 
 private:  // Private methods
 
-	static inline size_t numberOfChars(size_t varCount)
+	static inline size_t numberOfWords(size_t varCount)
 	{
-		if (varCount == 0)
-		{
-			return 0;
-		}
-		else
-		{
-			return (varCount * BitsPerVariable - 1) / BitsInChar + 1;
-		}
+		return (varCount + BitsInWord - 1) / BitsInWord;
 	}
 
 	/**
-	 * @brief  Gets index of @c char at given variable index
+	 * @brief  Gets index of the word at given variable index
 	 *
-	 * Returns index of the @c char that holds the value of variable at given
-	 * index.
+	 * Returns index of the word (in both planes) that holds the value of
+	 * variable at given index.
 	 *
-	 * @see  getIndexInsideChar()
+	 * @see  getBitOfVariable()
 	 *
 	 * @param[in]  index  Index of the Boolean variable
 	 *
-	 * @returns  Index of the @c char in which the variable has value
+	 * @returns  Index of the word in which the variable has value
 	 */
-	static inline size_t getIndexOfChar(size_t index)
+	static inline size_t getIndexOfWord(size_t index)
 	{
-		return (index * BitsPerVariable) / BitsInChar;
+		return index / BitsInWord;
 	}
 
 
 	/**
-	 * @brief  Gets index of bit inside a @c char for given variable index
+	 * @brief  Gets the bit of a variable inside a word
 	 *
-	 * Returns index of a bit in a @c char that starts the block of bits that
-	 * hold the value of variable at given index.
+	 * Returns a word with the only bit set at the position of the variable
+	 * with given index.
 	 *
-	 * @see  getIndexOfChar()
+	 * @see  getIndexOfWord()
 	 *
 	 * @param[in]  index  Index of the Boolean variable
 	 *
-	 * @returns  Index of the bit that holds the value of the variable
+	 * @returns  The word with the bit of the variable set
 	 */
-	static inline size_t getIndexInsideChar(size_t index)
+	static inline WordType getBitOfVariable(size_t index)
 	{
-		return (index * BitsPerVariable) % BitsInChar;
+		return static_cast<WordType>(1) << (index % BitsInWord);
 	}
 
-	static void getAllSymbols(CompactVariableAssignment& var,
-		std::vector<CompactVariableAssignment>& vec, size_t pos)
+
+	/**
+	 * @brief  Isolates the highest set bit of a word
+	 *
+	 * Returns a word that has set only the highest bit that is set in @p word.
+	 *
+	 * @param[in]  word  The word (needs to be nonzero)
+	 *
+	 * @returns  The word with only the highest bit set
+	 */
+	static inline WordType getHighestBit(WordType word)
 	{
-		if (pos == var.VariablesCount())
-		{
-			vec.push_back(var);
+		// Assertions
+		assert(word != 0);
+
+		word |= word >> 1;
+		word |= word >> 2;
+		word |= word >> 4;
+		word |= word >> 8;
+		word |= word >> 16;
+		word |= word >> 32;
+
+		return word ^ (word >> 1);
+	}
+
+
+	/**
+	 * @brief  The rank of a variable value in the ordering
+	 *
+	 * Returns the rank of the value of a variable given by its care and value
+	 * bit in the ordering ZERO < DONT_CARE < ONE used by operator<().
+	 */
+	static inline int getRankOfValue(bool care, bool value)
+	{
+		return (care)? ((value)? 2 : 0) : 1;
+	}
+
+	inline size_t wordsCount() const
+	{
+		return numberOfWords(variablesCount_);
+	}
+
+	/**
+	 * @brief  Mask of valid bits of a word
+	 *
+	 * Returns the mask that has set those bits of the word at index @p word
+	 * that correspond to some variable.
+	 *
+	 * @param[in]  word  Index of the word
+	 *
+	 * @returns  The mask of valid bits
+	 */
+	inline WordType getWordMask(size_t word) const
+	{
+		// Assertions
+		assert(word < wordsCount());
+
+		size_t remainder = variablesCount_ % BitsInWord;
+		if ((word + 1 < wordsCount()) || (remainder == 0))
+		{	// in case the whole word is used
+			return ~static_cast<WordType>(0);
 		}
-		else
-		{
-			if (var.GetIthVariableValue(pos) == DONT_CARE)
-			{	// in case we fork
-				var.SetIthVariableValue(pos, ZERO);
-				getAllSymbols(var, vec, pos + 1);
-				var.SetIthVariableValue(pos, ONE);
-				getAllSymbols(var, vec, pos + 1);
-			}
-			else
-			{
-				getAllSymbols(var, vec, pos + 1);
+
+		return (static_cast<WordType>(1) << remainder) - 1;
+	}
+
+	inline WordType* careWords()
+	{
+		return (heapWords_ != static_cast<WordType*>(0))? heapWords_ : inlineWords_;
+	}
+
+	inline const WordType* careWords() const
+	{
+		return (heapWords_ != static_cast<WordType*>(0))? heapWords_ : inlineWords_;
+	}
+
+	inline WordType* valueWords()
+	{
+		return careWords() + capacity_;
+	}
+
+	inline const WordType* valueWords() const
+	{
+		return careWords() + capacity_;
+	}
+
+	/**
+	 * @brief  Reserves storage
+	 *
+	 * Makes sure that both planes can hold @p words words. Newly reserved
+	 * words are zero, i.e., the variables in them are don't care.
+	 *
+	 * @param[in]  words  The number of words of a plane
+	 */
+	void reserveWords(size_t words)
+	{
+		if (words <= capacity_)
+		{	// in case there is enough space
+			return;
+		}
+
+		WordType* newWords = new WordType[2 * words]();
+
+		// the number of words that already hold some variables
+		size_t used = std::min(wordsCount(), capacity_);
+
+		std::copy(careWords(), careWords() + used, newWords);
+		std::copy(valueWords(), valueWords() + used, newWords + words);
+
+		delete [] heapWords_;
+		heapWords_ = newWords;
+		capacity_ = words;
+	}
+
+	/**
+	 * @brief  Moves to the next concrete symbol
+	 *
+	 * Treats the bits of the value plane at the positions in @p dontCares as a
+	 * binary counter and increments it, using the <tt>(s - m) & m</tt> trick
+	 * on whole words.
+	 *
+	 * @param[in]  dontCares  The plane of don't care variables
+	 *
+	 * @returns  @c false in case the counter overflowed, @c true otherwise
+	 */
+	bool incrementDontCares(const WordType* dontCares)
+	{
+		WordType* value = valueWords();
+		for (size_t i = 0; i < wordsCount(); ++i)
+		{	// increment the counter in the don't care positions of the words
+			WordType subset = ((value[i] & dontCares[i]) - dontCares[i]) & dontCares[i];
+			value[i] = (value[i] & ~dontCares[i]) | subset;
+			if (subset != 0)
+			{	// in case there is no carry
+				return true;
 			}
 		}
+
+		return false;
 	}
 
 public:   // Public methods
 
 	explicit CompactVariableAssignment(size_t size)
 		: variablesCount_(size),
-			vars_(numberOfChars(size))
+			capacity_(InlineWordsCount),
+			inlineWords_(),
+			heapWords_(static_cast<WordType*>(0))
 	{
-		for (size_t i = 0; i < size; ++i)
-		{	// for each variable
-			SetIthVariableValue(i, DONT_CARE);
-		}
+		// all variables are don't care when all bits are zero
+		reserveWords(numberOfWords(size));
 	}
 
 	CompactVariableAssignment(size_t size, size_t n)
 		: variablesCount_(size),
-			vars_(numberOfChars(size))
+			capacity_(InlineWordsCount),
+			inlineWords_(),
+			heapWords_(static_cast<WordType*>(0))
 	{
-		for (size_t i = 0; i < size; ++i)
-		{	// for each variable
-			SetIthVariableValue(i, ((n & (1 << i)) != 0)? ONE : ZERO);
+		reserveWords(numberOfWords(size));
+
+		for (size_t i = 0; i < wordsCount(); ++i)
+		{	// all variables are cared about
+			careWords()[i] = getWordMask(i);
+		}
+
+		if (size > 0)
+		{	// set the value of variables according to n
+			valueWords()[0] = static_cast<WordType>(n) & getWordMask(0);
 		}
 	}
 
@@ -197,33 +348,77 @@ public:   // Public methods
 	 */
 	explicit CompactVariableAssignment(const std::string& value)
 		: variablesCount_(value.length()),
-			vars_(numberOfChars(value.length()))
+			capacity_(InlineWordsCount),
+			inlineWords_(),
+			heapWords_(static_cast<WordType*>(0))
 	{
+		reserveWords(numberOfWords(value.length()));
+
+		WordType* care = careWords();
+		WordType* val = valueWords();
+
 		for (size_t i = 0; i < value.length(); ++i)
-		{	// load the string into the array of variables
-			char val = 0;
+		{	// load the string into the planes
+			WordType bit = getBitOfVariable(i);
 			switch (value[i])
 			{
-				case '0': val = ZERO;      break;
-				case '1': val = ONE;       break;
-				case 'X': val = DONT_CARE; break;
+				case '0': care[getIndexOfWord(i)] |= bit; break;
+				case '1': care[getIndexOfWord(i)] |= bit;
+				          val[getIndexOfWord(i)] |= bit;  break;
+				case 'X': break;
 				default: throw std::runtime_error("Invalid input value!");
 			}
+		}
+	}
+
+	CompactVariableAssignment(const CompactVariableAssignment& asgn)
+		: variablesCount_(asgn.variablesCount_),
+			capacity_(InlineWordsCount),
+			inlineWords_(),
+			heapWords_(static_cast<WordType*>(0))
+	{
+		reserveWords(wordsCount());
 
-			// prepare the mask
-			char mask = (DefaultMask << getIndexInsideChar(i)) ^ static_cast<char>(-1);
+		std::copy(asgn.careWords(), asgn.careWords() + wordsCount(), careWords());
+		std::copy(asgn.valueWords(), asgn.valueWords() + wordsCount(),
+			valueWords());
+	}
 
-			// mask out bits at given position by the mask
-			vars_[getIndexOfChar(i)] &= mask;
+	CompactVariableAssignment& operator=(const CompactVariableAssignment& rhs)
+	{
+		if (&rhs != this)
+		{
+			CompactVariableAssignment tmp(rhs);
+			Swap(tmp);
+		}
 
-			// prepare new value of given bits
-			val <<= getIndexInsideChar(i);
+		return *this;
+	}
 
-			// insert the value of given bits
-			vars_[getIndexOfChar(i)] |= val;
+	/**
+	 * @brief  Swaps two assignments
+	 *
+	 * Exchanges the content of two assignments without copying heap storage.
+	 *
+	 * @param[in,out]  asgn  The other assignment
+	 */
+	void Swap(CompactVariableAssignment& asgn)
+	{
+		std::swap(variablesCount_, asgn.variablesCount_);
+		std::swap(capacity_, asgn.capacity_);
+		std::swap(heapWords_, asgn.heapWords_);
+
+		for (size_t i = 0; i < 2 * InlineWordsCount; ++i)
+		{	// swap the inline storage
+			std::swap(inlineWords_[i], asgn.inlineWords_[i]);
 		}
 	}
 
+	~CompactVariableAssignment()
+	{
+		delete [] heapWords_;
+	}
+
 
 	/**
 	 * @brief  Returns value of variable at given index
@@ -239,7 +434,13 @@ public:   // Public methods
 		// Assertions
 		assert(i < VariablesCount());
 
-		return (vars_[getIndexOfChar(i)] >> getIndexInsideChar(i)) & DefaultMask;
+		WordType bit = getBitOfVariable(i);
+		if ((careWords()[getIndexOfWord(i)] & bit) == 0)
+		{	// in case the variable is don't care
+			return DONT_CARE;
+		}
+
+		return ((valueWords()[getIndexOfWord(i)] & bit) != 0)? ONE : ZERO;
 	}
 
 
@@ -248,40 +449,26 @@ public:   // Public methods
 		// Assertions
 		assert(i < VariablesCount());
 
+		WordType bit = getBitOfVariable(i);
+		WordType& care = careWords()[getIndexOfWord(i)];
+		WordType& val = valueWords()[getIndexOfWord(i)];
+
 		switch (value)
 		{
-			case ZERO:      break;
-			case ONE:       break;
-			case DONT_CARE: break;
+			case ZERO:      care |= bit; val &= ~bit; break;
+			case ONE:       care |= bit; val |= bit;  break;
+			case DONT_CARE: care &= ~bit; val &= ~bit; break;
 			default:        throw std::runtime_error("Invalid input value!");
 		}
-
-		// prepare the mask
-		char mask = (DefaultMask << getIndexInsideChar(i)) ^ static_cast<char>(-1);
-
-		// mask out bits at given position by the mask
-		vars_[getIndexOfChar(i)] &= mask;
-
-		// prepare new value of given bits
-		value <<= getIndexInsideChar(i);
-
-		// insert the value of given bits
-		vars_[getIndexOfChar(i)] |= value;
 	}
 
 	void AddVariablesUpTo(size_t maxVariableIndex)
 	{
 		size_t newVariablesCount = maxVariableIndex + 1;
 		if (newVariablesCount > VariablesCount())
-		{
-			size_t oldVariablesCount = variablesCount_;
+		{	// new variables are don't care as their bits are zero
+			reserveWords(numberOfWords(newVariablesCount));
 			variablesCount_ = newVariablesCount;
-			vars_.resize(numberOfChars(newVariablesCount));
-
-			for (size_t i = oldVariablesCount; i < newVariablesCount; ++i)
-			{
-				SetIthVariableValue(i, DONT_CARE);
-			}
 		}
 	}
 
@@ -299,6 +486,138 @@ public:   // Public methods
 	}
 
 
+	/**
+	 * @brief  Checks whether the assignment matches a symbol
+	 *
+	 * Checks whether every variable that is not a don't care in the
+	 * assignment has the same value in @p symbol, i.e., whether the set of
+	 * concrete symbols denoted by @p symbol is a subset of those denoted by
+	 * the assignment. Variables missing in one of the assignments are taken
+	 * as don't care.
+	 *
+	 * @param[in]  symbol  The symbol to be matched
+	 *
+	 * @returns  @c true if the symbol is matched, @c false otherwise
+	 */
+	bool Matches(const CompactVariableAssignment& symbol) const
+	{
+		const WordType* care = careWords();
+		const WordType* val = valueWords();
+		const WordType* symCare = symbol.careWords();
+		const WordType* symVal = symbol.valueWords();
+
+		for (size_t i = 0; i < wordsCount(); ++i)
+		{	// check all words of the assignment
+			WordType sc = (i < symbol.wordsCount())? symCare[i] : 0;
+			WordType sv = (i < symbol.wordsCount())? symVal[i] : 0;
+
+			if (((care[i] & ~sc) | ((val[i] ^ sv) & care[i])) != 0)
+			{	// in case there is a variable with a different value
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+
+	/**
+	 * @brief  Checks whether two assignments overlap
+	 *
+	 * Checks whether there is a concrete symbol denoted by both assignments,
+	 * i.e., whether every variable that is cared about by both of them has
+	 * the same value in both. Variables missing in one of the assignments are
+	 * taken as don't care.
+	 *
+	 * @param[in]  asgn  The other assignment
+	 *
+	 * @returns  @c true if the assignments overlap, @c false otherwise
+	 */
+	bool Overlaps(const CompactVariableAssignment& asgn) const
+	{
+		const WordType* care = careWords();
+		const WordType* val = valueWords();
+		const WordType* asgnCare = asgn.careWords();
+		const WordType* asgnVal = asgn.valueWords();
+
+		size_t words = std::min(wordsCount(), asgn.wordsCount());
+		for (size_t i = 0; i < words; ++i)
+		{	// check the words present in both assignments
+			if ((care[i] & asgnCare[i] & (val[i] ^ asgnVal[i])) != 0)
+			{	// in case a variable has different values
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+
+	/**
+	 * @brief  The number of don't care variables
+	 *
+	 * Returns the number of variables that are don't care.
+	 *
+	 * @returns  The number of don't care variables
+	 */
+	size_t DontCaresCount() const
+	{
+		size_t result = 0;
+
+		for (size_t i = 0; i < wordsCount(); ++i)
+		{	// count zero bits of the care plane
+			WordType dontCares = getWordMask(i) & ~careWords()[i];
+			for (; dontCares != 0; dontCares &= dontCares - 1)
+			{	// clear the lowest set bit
+				++result;
+			}
+		}
+
+		return result;
+	}
+
+
+	/**
+	 * @brief  The index of a concrete assignment
+	 *
+	 * Returns the value of a concrete assignment read as a binary number with
+	 * the variable with the lowest index being the least significant, i.e.
+	 * the number of increments (see operator++()) of the all-zero assignment
+	 * needed to reach this assignment.
+	 *
+	 * @returns  The index of the assignment
+	 */
+	size_t ToIndex() const
+	{
+		size_t result = 0;
+
+		for (size_t i = 0; i < wordsCount(); ++i)
+		{	// check the words and compose the index
+			if (careWords()[i] != getWordMask(i))
+			{
+				throw std::runtime_error(__func__ +
+					std::string(": the assignment contains don't care variables"));
+			}
+
+			WordType value = valueWords()[i];
+			if (value == 0)
+			{
+				continue;
+			}
+
+			if ((i > 0) || (value != static_cast<WordType>(static_cast<size_t>(value))))
+			{
+				throw std::runtime_error(__func__ +
+					std::string(": the index does not fit into size_t"));
+			}
+
+			result = static_cast<size_t>(value);
+		}
+
+		return result;
+	}
+
+
 	/**
 	 * @brief  Returns string representation
 	 *
@@ -311,6 +630,7 @@ public:   // Public methods
 	std::string ToString() const
 	{
 		std::string result;
+		result.reserve(VariablesCount());
 
 		for (size_t i = 0; i < VariablesCount(); ++i)
 		{	// append all variables to the string
@@ -340,52 +660,52 @@ public:   // Public methods
 	 */
 	static AssignmentList GetAllAssignments(size_t variablesCount)
 	{
-		std::string str;
-		for (size_t i = 0; i < variablesCount; ++i)
-		{	// for all variables
-			str += 'X';
-		}
-
 		AssignmentList lst;
-		lst.push_back(CompactVariableAssignment(str));
+		lst.push_back(CompactVariableAssignment(variablesCount));
 		return lst;
 	}
 
 
 	CompactVariableAssignment& operator++()
 	{
-		for (size_t i = 0; i < VariablesCount(); ++i)
-		{	// for each variable
-			char value = GetIthVariableValue(i);
-			if (value == ZERO)
-			{	// in case we can stop here
-				SetIthVariableValue(i, ONE);
-				return *this;
-			}
-			else if (value == ONE)
-			{	// we change to zero and continue to search zero
-				SetIthVariableValue(i, ZERO);
-			}
-			else
-			{	// otherwise
+		WordType* value = valueWords();
+
+		for (size_t i = 0; i < wordsCount(); ++i)
+		{	// check that there is no don't care variable
+			if (careWords()[i] != getWordMask(i))
+			{
 				throw std::runtime_error(
 					"An attempt to increment assignment with invalid states");
 			}
 		}
 
+		for (size_t i = 0; i < wordsCount(); ++i)
+		{	// add one to the value plane
+			value[i] = (value[i] + 1) & getWordMask(i);
+			if (value[i] != 0)
+			{	// in case there is no carry
+				break;
+			}
+		}
+
 		return *this;
 	}
 
-	inline std::vector<CompactVariableAssignment> GetVectorOfConcreteSymbols() const
-	{
-		std::vector<CompactVariableAssignment> result;
-
-		CompactVariableAssignment newVar = *this;
-
-		getAllSymbols(newVar, result, 0);
-
-		return result;
-	}
+	/**
+	 * @brief  Expands don't care variables
+	 *
+	 * Returns the vector of all concrete assignments (without don't care
+	 * variables) that are matched by the assignment. The assignments are
+	 * enumerated by incrementing the don't care positions as a binary counter
+	 * with the variable with the lowest index being the least significant.
+	 * Consumers that do not need all the symbols at once should rather use
+	 * ConcreteSymbolIterator, which does not materialise them.
+	 *
+	 * @see  ConcreteSymbolIterator
+	 *
+	 * @returns  The vector of concrete assignments
+	 */
+	std::vector<CompactVariableAssignment> GetVectorOfConcreteSymbols() const;
 
 
 	/**
@@ -406,57 +726,38 @@ public:   // Public methods
 		return (os << asgn.ToString());
 	}
 
+	friend bool operator==(const CompactVariableAssignment& lhs,
+		const CompactVariableAssignment& rhs)
+	{
+		return (lhs.VariablesCount() == rhs.VariablesCount()) &&
+			std::equal(lhs.careWords(), lhs.careWords() + lhs.wordsCount(),
+				rhs.careWords()) &&
+			std::equal(lhs.valueWords(), lhs.valueWords() + lhs.wordsCount(),
+				rhs.valueWords());
+	}
+
 	friend bool operator<(const CompactVariableAssignment& lhs,
 		const CompactVariableAssignment& rhs)
 	{
-		if ((lhs.VariablesCount() < rhs.VariablesCount()) ||
-			rhs.VariablesCount() < lhs.VariablesCount())
+		if (lhs.VariablesCount() != rhs.VariablesCount())
 		{
 			return lhs.VariablesCount() < rhs.VariablesCount();
 		}
 
-		for (size_t i = 0; i < lhs.VariablesCount(); ++i)
-		{
-			char lhsIthValue = lhs.GetIthVariableValue(lhs.VariablesCount() - i - 1);
-			char rhsIthValue = rhs.GetIthVariableValue(rhs.VariablesCount() - i - 1);
+		for (size_t i = lhs.wordsCount(); i > 0; --i)
+		{	// from the word with the highest variables
+			WordType lhsCare = lhs.careWords()[i - 1];
+			WordType rhsCare = rhs.careWords()[i - 1];
+			WordType lhsValue = lhs.valueWords()[i - 1];
+			WordType rhsValue = rhs.valueWords()[i - 1];
 
-			switch (lhsIthValue)
-			{
-				case ZERO:
-					switch (rhsIthValue)
-					{
-						case ZERO: continue; break;
-						case ONE: return true; break;
-						case DONT_CARE: return true; break;
-						default: throw std::runtime_error("Invalid variable assignment value");
-							break;
-					}
-					break;
-
-				case ONE:
-					switch (rhsIthValue)
-					{
-						case ZERO: return false; break;
-						case ONE: continue; break;
-						case DONT_CARE: return false; break;
-						default: throw std::runtime_error("Invalid variable assignment value");
-							break;
-					}
-					break;
-
-				case DONT_CARE:
-					switch (rhsIthValue)
-					{
-						case ZERO: return false; break;
-						case ONE: return true; break;
-						case DONT_CARE: continue; break;
-						default: throw std::runtime_error("Invalid variable assignment value");
-							break;
-					}
-					break;
-
-				default: throw std::runtime_error("Invalid variable assignment value");
-					break;
+			WordType diff = (lhsCare ^ rhsCare) | (lhsValue ^ rhsValue);
+			if (diff != 0)
+			{	// the highest differing variable decides
+				WordType bit = getHighestBit(diff);
+
+				return getRankOfValue((lhsCare & bit) != 0, (lhsValue & bit) != 0) <
+					getRankOfValue((rhsCare & bit) != 0, (rhsValue & bit) != 0);
 			}
 		}
 
@@ -467,8 +768,107 @@ public:   // Public static methods
 
 	static CompactVariableAssignment GetUniversalSymbol()
 	{
-		return CompactVariableAssignment(0);
+		return CompactVariableAssignment(static_cast<size_t>(0));
+	}
+};
+
+
+/**
+ * @brief   Iterator over concrete symbols of an assignment
+ *
+ * Lazily enumerates all concrete assignments (without don't care variables)
+ * that are matched by given assignment. Only the current symbol is kept, the
+ * next one is obtained by incrementing the bits of the value plane under the
+ * don't care mask, so that iterating over @f$2^k@f$ symbols of a pattern
+ * with @f$k@f$ don't cares needs no additional memory. The symbols are
+ * enumerated in the same order as by
+ * CompactVariableAssignment::GetVectorOfConcreteSymbols().
+ */
+class SFTA::Private::CompactVariableAssignment::ConcreteSymbolIterator
+{
+private:  // Private data members
+
+	/**
+	 * @brief  The current symbol
+	 */
+	CompactVariableAssignment symbol_;
+
+
+	/**
+	 * @brief  The don't care mask
+	 *
+	 * Assignment the care plane of which holds the mask of don't care
+	 * variables of the pattern.
+	 */
+	CompactVariableAssignment dontCares_;
+
+
+	/**
+	 * @brief  Is the iterator valid?
+	 *
+	 * @c false after all symbols have been enumerated.
+	 */
+	bool valid_;
+
+public:   // Public methods
+
+	explicit ConcreteSymbolIterator(const CompactVariableAssignment& pattern)
+		: symbol_(pattern),
+			dontCares_(pattern.VariablesCount()),
+			valid_(true)
+	{
+		for (size_t i = 0; i < pattern.wordsCount(); ++i)
+		{	// the symbol cares about all variables
+			dontCares_.careWords()[i] =
+				pattern.getWordMask(i) & ~pattern.careWords()[i];
+			symbol_.careWords()[i] = pattern.getWordMask(i);
+		}
+	}
+
+	inline bool IsValid() const
+	{
+		return valid_;
+	}
+
+	inline const CompactVariableAssignment& operator*() const
+	{
+		// Assertions
+		assert(valid_);
+
+		return symbol_;
+	}
+
+	inline const CompactVariableAssignment* operator->() const
+	{
+		// Assertions
+		assert(valid_);
+
+		return &symbol_;
+	}
+
+	inline ConcreteSymbolIterator& operator++()
+	{
+		// Assertions
+		assert(valid_);
+
+		valid_ = symbol_.incrementDontCares(dontCares_.careWords());
+
+		return *this;
 	}
 };
 
+
+inline std::vector<SFTA::Private::CompactVariableAssignment>
+	SFTA::Private::CompactVariableAssignment::GetVectorOfConcreteSymbols() const
+{
+	std::vector<CompactVariableAssignment> result;
+
+	for (ConcreteSymbolIterator itSym(*this); itSym.IsValid(); ++itSym)
+	{	// enumerate all concrete symbols
+		result.push_back(*itSym);
+	}
+
+	return result;
+}
+
 #endif
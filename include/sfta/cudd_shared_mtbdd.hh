@@ -13,14 +13,18 @@
 
 // Standard library headers
 #include <cassert>
+#include <set>
 #include <vector>
 #include <algorithm>
+#include <tr1/unordered_map>
 
 // SFTA headers
 #include <sfta/sfta.hh>
 #include <sfta/abstract_shared_mtbdd.hh>
 #include <sfta/cudd_facade.hh>
 #include <sfta/convert.hh>
+#include <sfta/memory_usage.hh>
+#include <sfta/operation_statistics.hh>
 
 
 // insert the class into proper namespace
@@ -262,6 +266,16 @@ private:   // Private data types
 	typedef std::vector<typename RA::RootType> RootArray;
 
 
+	/**
+	 * @brief  Translation of nodes
+	 *
+	 * The type of a map that translates nodes of another shared MTBDD to nodes
+	 * of this shared MTBDD.
+	 */
+	typedef std::tr1::unordered_map<CUDDFacade::Node*, CUDDFacade::Node*>
+		NodeTranslationMap;
+
+
 	/**
 	 * @brief  Generic Apply functor
 	 *
@@ -598,6 +612,16 @@ private:  // Private data members
 	CUDDFacade cudd_;
 
 
+	/**
+	 * @brief  The order of variables
+	 *
+	 * The order of variables (indices of variables from the top level to the
+	 * bottom) after the last reordering. An empty vector denotes the initial
+	 * order, in which the level of a variable is equal to its index.
+	 */
+	std::vector<unsigned> variableOrder_;
+
+
 private:  // Private methods
 
 
@@ -684,8 +708,6 @@ private:  // Private methods
 	CUDDFacade::Node* createMTBDDForVariableAssignment(
 		const VariableAssignmentType& vars, const LeafType& value)
 	{
-		assert(vars.VariablesCount() <= GetMaxSize());
-
 		CUDDFacade::ValueType leaf = LA::createLeaf(value);
 		CUDDFacade::Node* node = cudd_.AddConst(leaf);
 		cudd_.Ref(node);
@@ -724,8 +746,6 @@ private:  // Private methods
 	CUDDFacade::Node* createMTBDDForVariableProjection(
 		const VariableAssignmentType& vars)
 	{
-		assert(vars.VariablesCount() <= GetMaxSize());
-
 		CUDDFacade::Node* node = cudd_.AddConst(1);
 		cudd_.Ref(node);
 
@@ -769,6 +789,90 @@ private:  // Private methods
 		cudd_.RecursiveDeref(root);
 	}
 
+	/**
+	 * @brief  Transfers a node from another shared MTBDD
+	 *
+	 * Recursively creates a copy of the MTBDD rooted at @p node of the shared
+	 * MTBDD @p source in this shared MTBDD. Leaves are translated using @p
+	 * func (if any). Every node is transferred only once, the translation is
+	 * remembered in @p memo together with a reference to the created node.
+	 *
+	 * @param[in]     source  The shared MTBDD the node belongs to
+	 * @param[in]     node    The node to be transferred
+	 * @param[in]     func    Translation of leaves (may be null)
+	 * @param[in,out] memo    Nodes that have already been transferred
+	 *
+	 * @returns  The node in this shared MTBDD
+	 */
+	CUDDFacade::Node* transferNode(const CUDDSharedMTBDD& source,
+		CUDDFacade::Node* node, AbstractMonadicApplyFunctorType* func,
+		NodeTranslationMap& memo)
+	{
+		// Assertions
+		assert(node != static_cast<CUDDFacade::Node*>(0));
+
+		typename NodeTranslationMap::const_iterator itMemo = memo.find(node);
+		if (itMemo != memo.end())
+		{	// in case the node has already been transferred
+			return itMemo->second;
+		}
+
+		CUDDFacade::Node* result = static_cast<CUDDFacade::Node*>(0);
+		if (source.cudd_.IsNodeConstant(node))
+		{	// in case the node is a leaf
+			CUDDFacade::ValueType handle = source.cudd_.GetNodeValue(node);
+			if (handle == LA::BOTTOM)
+			{	// the bottom is the same in both shared MTBDDs
+				result = cudd_.ReadBackground();
+			}
+			else
+			{	// other leaves are translated
+				const LeafType& leaf = source.LA::getLeafOfHandle(handle);
+				result = cudd_.AddConst(LA::createLeaf(
+					(func == static_cast<AbstractMonadicApplyFunctorType*>(0))?
+					leaf : (*func)(leaf)));
+			}
+
+			cudd_.Ref(result);
+		}
+		else
+		{	// in case the node is internal
+			CUDDFacade::Node* thenNode = transferNode(source,
+				source.cudd_.GetThenChild(node), func, memo);
+			CUDDFacade::Node* elseNode = transferNode(source,
+				source.cudd_.GetElseChild(node), func, memo);
+
+			// build the node using ITE so that the order of variables in this
+			// shared MTBDD need not be the same as in the source
+			CUDDFacade::Node* var = getIthVariable(source.cudd_.GetNodeIndex(node));
+			result = cudd_.Ite(var, thenNode, elseNode);
+			cudd_.Ref(result);
+			cudd_.RecursiveDeref(var);
+		}
+
+		memo.insert(std::make_pair(node, result));
+
+		return result;
+	}
+
+	void collectNodes(CUDDFacade::Node* node,
+		std::set<CUDDFacade::Node*>& nodes) const
+	{
+		// Assertions
+		assert(node != static_cast<CUDDFacade::Node*>(0));
+
+		if (!nodes.insert(node).second)
+		{	// in case the node has already been visited
+			return;
+		}
+
+		if (!cudd_.IsNodeConstant(node))
+		{
+			collectNodes(cudd_.GetThenChild(node), nodes);
+			collectNodes(cudd_.GetElseChild(node), nodes);
+		}
+	}
+
 	void getNodeDescription(CUDDFacade::Node* node, VariableAssignmentType asgn,
 		DescriptionType& desc) const
 	{
@@ -797,13 +901,20 @@ private:  // Private methods
 	}
 
 
+	/**
+	 * @brief  Returns the number of variables
+	 *
+	 * Returns the number of variables of the shared MTBDD. Variables are
+	 * created on demand when they are first referenced by a variable
+	 * assignment, so the number follows the width of the widest assignment
+	 * rather than any fixed bound. Shorter assignments leave the variables
+	 * above their width as don't care.
+	 *
+	 * @returns  The number of variables
+	 */
 	size_t GetMaxSize() const
 	{
-		// TODO: declare a private field maxSize_ that remembers the maximum
-		// possible size of the MTBDD, i.e., if a new variable is first
-		// referenced, the value is increased, and if a variable is removed (or
-		// renamed), the value is possibly decreased.
-		return 64;
+		return cudd_.GetVarCount();
 	}
 
 public:   // Public methods
@@ -814,10 +925,269 @@ public:   // Public methods
 	 *
 	 * The constructor of CUDDSharedMTBDD.
 	 */
-	CUDDSharedMTBDD() : cudd_()
+	CUDDSharedMTBDD()
+		: cudd_(),
+			variableOrder_()
 	{ }
 
 
+	/**
+	 * @brief  Reorders variables
+	 *
+	 * Reorders the variables of the shared MTBDD using sifting in order to
+	 * reduce the number of nodes and records the resulting permutation. The
+	 * method must not be called during an operation on the MTBDD.
+	 *
+	 * @see  GetVariableOrder()
+	 */
+	void ReorderVariables()
+	{
+		cudd_.ReorderSift();
+		variableOrder_ = cudd_.GetVariableOrder();
+	}
+
+
+	/**
+	 * @brief  Sets the order of variables
+	 *
+	 * Reorders the variables of the shared MTBDD to given order (e.g. an
+	 * order obtained by GetVariableOrder() from another shared MTBDD).
+	 *
+	 * @param[in]  order  Indices of variables from the top level to the bottom
+	 */
+	void SetVariableOrder(const std::vector<unsigned>& order)
+	{
+		cudd_.SetVariableOrder(order);
+		variableOrder_ = order;
+	}
+
+
+	/**
+	 * @brief  Returns the order of variables
+	 *
+	 * Returns the order of variables after the last reordering.
+	 *
+	 * @returns  Indices of variables from the top level to the bottom, or an
+	 *           empty vector if the variables were never reordered
+	 */
+	inline const std::vector<unsigned>& GetVariableOrder() const
+	{
+		return variableOrder_;
+	}
+
+
+	/**
+	 * @brief  Returns the number of nodes
+	 *
+	 * Returns the number of live nodes of all MTBDDs in the shared MTBDD.
+	 *
+	 * @returns  The number of nodes
+	 */
+	inline size_t GetNodeCount() const
+	{
+		return cudd_.GetNodeCount();
+	}
+
+
+	/**
+	 * @brief  Returns the telemetry of the manager
+	 *
+	 * Returns a snapshot of the counters of the underlying CUDD manager.
+	 *
+	 * @see  SFTA::Private::CUDDFacade::GetTelemetry()
+	 *
+	 * @returns  The telemetry of the manager
+	 */
+	inline CUDDFacade::Telemetry GetTelemetry() const
+	{
+		return cudd_.GetTelemetry();
+	}
+
+
+	/**
+	 * @brief  Adds a hook to the manager
+	 *
+	 * @copydetails  SFTA::Private::CUDDFacade::AddHook()
+	 */
+	inline void AddHook(CUDDFacade::HookType type,
+		CUDDFacade::AbstractHookFunctor* hook)
+	{
+		cudd_.AddHook(type, hook);
+	}
+
+
+	/**
+	 * @brief  Removes a hook from the manager
+	 *
+	 * @copydetails  SFTA::Private::CUDDFacade::RemoveHook()
+	 */
+	inline void RemoveHook(CUDDFacade::HookType type,
+		CUDDFacade::AbstractHookFunctor* hook)
+	{
+		cudd_.RemoveHook(type, hook);
+	}
+
+
+	/**
+	 * @brief  Returns the memory footprint of roots
+	 *
+	 * Traverses the MTBDDs with given roots and with all other roots of the
+	 * shared MTBDD in order to find out which nodes and leaves are reachable
+	 * only from given roots. The traversal visits the whole shared MTBDD, so
+	 * the method is meant for reporting rather than for hot paths.
+	 *
+	 * @param[in]  roots  The roots (e.g. of an automaton)
+	 *
+	 * @returns  The footprint of the MTBDDs with given roots
+	 */
+	MTBDDMemoryUsage GetMemoryUsage(const RootArray& roots) const
+	{
+		typedef std::set<RootType> RootSet;
+		typedef std::set<CUDDFacade::Node*> NodeSet;
+
+		RootSet rootSet(roots.begin(), roots.end());
+
+		NodeSet nodes;
+		for (typename RootSet::const_iterator itRoots = rootSet.begin();
+			itRoots != rootSet.end(); ++itRoots)
+		{	// collect nodes reachable from given roots
+			collectNodes(RA::getHandleOfRoot(*itRoots), nodes);
+		}
+
+		NodeSet otherNodes;
+		RootArray allRoots = RA::getAllRoots();
+		for (typename RootArray::const_iterator itRoots = allRoots.begin();
+			itRoots != allRoots.end(); ++itRoots)
+		{	// collect nodes reachable from the other roots
+			if (rootSet.find(*itRoots) == rootSet.end())
+			{
+				collectNodes(RA::getHandleOfRoot(*itRoots), otherNodes);
+			}
+		}
+
+		MTBDDMemoryUsage usage;
+		usage.roots = rootSet.size();
+		usage.nodes = nodes.size();
+
+		for (typename NodeSet::const_iterator itNodes = nodes.begin();
+			itNodes != nodes.end(); ++itNodes)
+		{
+			bool isLeaf = cudd_.IsNodeConstant(*itNodes);
+			bool isExclusive = (otherNodes.find(*itNodes) == otherNodes.end());
+
+			if (isLeaf)
+			{
+				++usage.leaves;
+			}
+
+			if (isExclusive)
+			{
+				++usage.exclusiveNodes;
+				usage.exclusiveNodeBytes += CUDDFacade::GetNodeSize();
+
+				if (isLeaf)
+				{	// leaves are also kept by the leaf allocator
+					const LeafType& leaf = LA::getLeafOfHandle(cudd_.GetNodeValue(*itNodes));
+
+					++usage.exclusiveLeaves;
+					usage.exclusiveLeafBytes += sizeof(LeafType) +
+						SFTA::Private::MemoryEstimate::Of(leaf);
+				}
+			}
+		}
+
+		return usage;
+	}
+
+
+	/**
+	 * @brief  Returns the memory footprint of the shared MTBDD
+	 *
+	 * Returns the footprint of the MTBDDs with all roots of the shared MTBDD.
+	 *
+	 * @see  GetMemoryUsage(const RootArray&)
+	 *
+	 * @returns  The footprint of the shared MTBDD
+	 */
+	inline MTBDDMemoryUsage GetMemoryUsage() const
+	{
+		return GetMemoryUsage(RA::getAllRoots());
+	}
+
+
+	/**
+	 * @brief  Transfers roots from another shared MTBDD
+	 *
+	 * Copies the MTBDDs with given roots from another (independent) shared
+	 * MTBDD into this one, so that automata loaded in separate shared MTBDDs
+	 * (e.g. by separate threads) can be combined. Leaves can be translated on
+	 * the way, e.g. to rename states. Nodes shared by several of the roots
+	 * are transferred only once. The source shared MTBDD is not modified.
+	 *
+	 * @param[in]  source  The shared MTBDD the roots belong to
+	 * @param[in]  roots   The roots to be transferred
+	 * @param[in]  func    Translation of leaves (null means identity)
+	 *
+	 * @returns  The roots in this shared MTBDD, in the order of @p roots
+	 */
+	RootArray TransferRoots(const CUDDSharedMTBDD& source, const RootArray& roots,
+		AbstractMonadicApplyFunctorType* func =
+		static_cast<AbstractMonadicApplyFunctorType*>(0))
+	{
+		if (&source == this)
+		{	// in case there is nothing to transfer
+			throw std::runtime_error(__func__ +
+				std::string(": cannot transfer roots into the same shared MTBDD"));
+		}
+
+		NodeTranslationMap memo;
+		RootArray result;
+		result.reserve(roots.size());
+
+		for (typename RootArray::const_iterator itRoots = roots.begin();
+			itRoots != roots.end(); ++itRoots)
+		{	// transfer all roots
+			CUDDFacade::Node* node = transferNode(source,
+				source.RA::getHandleOfRoot(*itRoots), func, memo);
+			cudd_.Ref(node);
+
+			SFTA_STATISTICS(RecordRootCount(RA::getRootCount() + 1));
+
+			result.push_back(RA::allocateRoot(node));
+		}
+
+		for (typename NodeTranslationMap::const_iterator itMemo = memo.begin();
+			itMemo != memo.end(); ++itMemo)
+		{	// release references held by the translation
+			cudd_.RecursiveDeref(itMemo->second);
+		}
+
+		return result;
+	}
+
+
+	/**
+	 * @brief  Transfers a root from another shared MTBDD
+	 *
+	 * Copies the MTBDD with given root from another shared MTBDD into this
+	 * one.
+	 *
+	 * @see  TransferRoots()
+	 *
+	 * @param[in]  source  The shared MTBDD the root belongs to
+	 * @param[in]  root    The root to be transferred
+	 * @param[in]  func    Translation of leaves (null means identity)
+	 *
+	 * @returns  The root in this shared MTBDD
+	 */
+	RootType TransferRoot(const CUDDSharedMTBDD& source, const RootType& root,
+		AbstractMonadicApplyFunctorType* func =
+		static_cast<AbstractMonadicApplyFunctorType*>(0))
+	{
+		return TransferRoots(source, RootArray(1, root), func).front();
+	}
+
+
 	virtual void SetValue(const RootType& root,
 		const VariableAssignmentType& asgn, const LeafType& value)
 	{
@@ -931,6 +1301,8 @@ public:   // Public methods
 		assert(func
 			!= static_cast<typename ParentClass::AbstractApplyFunctorType*>(0));
 
+		SFTA_STATISTICS(CountApply(typeid(*func)));
+
 		GenericApplyFunctor applier(this, func);
 
 		// carry out the Apply operation
@@ -939,6 +1311,8 @@ public:   // Public methods
 
 		cudd_.Ref(res);
 
+		SFTA_STATISTICS(RecordRootCount(RA::getRootCount() + 1));
+
 		return RA::allocateRoot(res);
 	}
 
@@ -955,6 +1329,8 @@ public:   // Public methods
 		assert(func
 			!= static_cast<typename ParentClass::AbstractTernaryApplyFunctorType*>(0));
 
+		SFTA_STATISTICS(CountApply(typeid(*func)));
+
 		GenericTernaryApplyFunctor applier(this, func);
 
 		// carry out the ternary Apply operation
@@ -963,6 +1339,8 @@ public:   // Public methods
 
 		cudd_.Ref(res);
 
+		SFTA_STATISTICS(RecordRootCount(RA::getRootCount() + 1));
+
 		return RA::allocateRoot(res);
 	}
 
@@ -979,6 +1357,8 @@ public:   // Public methods
 		assert(func
 			!= static_cast<typename ParentClass::AbstractMonadicApplyFunctorType*>(0));
 
+		SFTA_STATISTICS(CountApply(typeid(*func)));
+
 		GenericMonadicApplyFunctor applier(this, func);
 
 		// carry out the monadic Apply operation
@@ -987,6 +1367,8 @@ public:   // Public methods
 
 		cudd_.Ref(res);
 
+		SFTA_STATISTICS(RecordRootCount(RA::getRootCount() + 1));
+
 		return RA::allocateRoot(res);
 	}
 
@@ -996,6 +1378,8 @@ public:   // Public methods
 		CUDDFacade::Node* node = cudd_.ReadBackground();
 		cudd_.Ref(node);
 
+		SFTA_STATISTICS(RecordRootCount(RA::getRootCount() + 1));
+
 		return RA::allocateRoot(node);
 	}
 
@@ -1082,7 +1466,9 @@ public:   // Public methods
 		CUDDFacade::Node* newRoot = RA::getHandleOfRoot(root);
 		cudd_.Ref(newRoot);
 
-		for (VariableType i = 0; i < GetMaxSize(); ++i)
+		// renaming may create new variables, only the original ones are renamed
+		const VariableType maxSize = GetMaxSize();
+		for (VariableType i = 0; i < maxSize; ++i)
 		{	// rename all variables according to given renaming functor
 			VariableType newName;
 			if ((newName = (*func)(i)) != i)
@@ -1094,6 +1480,8 @@ public:   // Public methods
 			}
 		}
 
+		SFTA_STATISTICS(RecordRootCount(RA::getRootCount() + 1));
+
 		return RA::allocateRoot(newRoot);
 	}
 
@@ -1142,6 +1530,8 @@ public:   // Public methods
 			&predFunc, &mergeFunc);
 		cudd_.RecursiveDeref(oldRoot);
 
+		SFTA_STATISTICS(RecordRootCount(RA::getRootCount() + 1));
+
 		return RA::allocateRoot(newRoot);
 	}
 
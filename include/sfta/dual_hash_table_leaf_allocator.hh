@@ -11,6 +11,10 @@
 #ifndef _SFTA_DUAL_HASH_TABLE_LEAF_ALLOCATOR_HH_
 #define _SFTA_DUAL_HASH_TABLE_LEAF_ALLOCATOR_HH_
 
+// SFTA headers
+#include <sfta/monotonic_arena.hh>
+#include <sfta/operation_statistics.hh>
+
 // Standard library header files
 #include <tr1/unordered_map>
 
@@ -81,9 +85,11 @@ private:  // Private data types
 	/**
 	 * @brief  Structure for handle <-> leaf pair
 	 *
-	 * This structure contains the pair of handle and leaf
+	 * This structure contains the pair of handle and leaf. Descriptors are
+	 * allocated in the arena of the allocator.
 	 */
 	struct LeafDescriptor
+		: public SFTA::Private::ArenaObject
 	{
 	public:   // public data members
 		/**
@@ -167,6 +173,15 @@ private:   // Private data types
 private:  // Private data members
 
 
+	/**
+	 * @brief  Arena for leaf descriptors
+	 *
+	 * Arena that holds leaf descriptors. It is declared first so that it
+	 * outlives both maps.
+	 */
+	SFTA::Private::MonotonicArena arena_;
+
+
 	/**
 	 * Mapping of handles to leaf descriptors.
 	 */
@@ -245,7 +260,7 @@ protected:// Protected methods
 	 * The default constructor
 	 */
 	DualHashTableLeafAllocator()
-		: handles_(), leaves_(), nextIndex_(BOTTOM + 1),
+		: arena_(), handles_(), leaves_(), nextIndex_(BOTTOM + 1),
 		releaser_(new ReleaserMonadicApplyFunctor(this))
 	{ }
 
@@ -263,7 +278,7 @@ protected:// Protected methods
 	 */
 	void setBottom(const LeafType& leaf)
 	{
-		LeafDescriptor* leafDesc = new LeafDescriptor(BOTTOM, leaf);
+		LeafDescriptor* leafDesc = new (arena_) LeafDescriptor(BOTTOM, leaf);
 		insertLeafDescriptor(leafDesc);
 	}
 
@@ -288,10 +303,12 @@ protected:// Protected methods
 			// create new descriptor
 			HandleType handle = nextIndex_;
 			++nextIndex_;
-			LeafDescriptor* leafDesc = new LeafDescriptor(handle, leaf);
+			LeafDescriptor* leafDesc = new (arena_) LeafDescriptor(handle, leaf);
 
 			insertLeafDescriptor(leafDesc);
 
+			SFTA_STATISTICS(CountLeafCreated());
+
 			return handle;
 		}
 		else
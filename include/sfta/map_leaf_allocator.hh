@@ -11,6 +11,9 @@
 #ifndef _SFTA_MAP_LEAF_ALLOCATOR_HH_
 #define _SFTA_MAP_LEAF_ALLOCATOR_HH_
 
+// SFTA headers
+#include <sfta/operation_statistics.hh>
+
 
 // insert the class into proper namespace
 namespace SFTA
@@ -200,6 +203,9 @@ protected:// Protected methods
 		// otherwise create a new leaf
 		asocArr_[nextIndex_] = leaf;
 		++nextIndex_;
+
+		SFTA_STATISTICS(CountLeafCreated());
+
 		return nextIndex_ - 1;
 	}
 
@@ -222,6 +222,19 @@ protected:// protected methods
 	}
 
 
+	/**
+	 * @brief  Returns the number of roots
+	 *
+	 * The method that returns the number of roots which are allocated.
+	 *
+	 * @returns  The number of allocated roots
+	 */
+	inline size_t getRootCount() const
+	{
+		return arr_.size();
+	}
+
+
 	/**
 	 * @brief  Erases a root
 	 *
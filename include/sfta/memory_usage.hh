@@ -0,0 +1,301 @@
+/*****************************************************************************
+ *  Symbolic Finite Tree Automata Library
+ *
+ *  Description:
+ *    Header file with structures describing the memory footprint of automata
+ *    and shared MTBDDs and with the MemoryEstimate class, which estimates the
+ *    memory allocated by containers.
+ *
+ *****************************************************************************/
+
+#ifndef _SFTA_MEMORY_USAGE_HH_
+#define _SFTA_MEMORY_USAGE_HH_
+
+// Standard library headers
+#include <map>
+#include <set>
+#include <sstream>
+#include <string>
+#include <tr1/unordered_map>
+#include <utility>
+#include <vector>
+
+
+// insert the classes into proper namespace
+namespace SFTA
+{
+	struct MTBDDMemoryUsage;
+	struct MemoryUsage;
+
+	template <class Key> class OrderedVector;
+	template <typename T> class Vector;
+	template <typename KeyElement, typename Value> class VectorMap;
+
+	namespace Private
+	{
+		struct MemoryEstimate;
+
+		template <typename Element> class BitmapSet;
+		template <typename T> class ElemOrVector;
+	}
+}
+
+
+/**
+ * @brief   Memory footprint of MTBDDs
+ *
+ * Describes the part of a shared MTBDD that is reachable from a set of roots
+ * (e.g. the roots of an automaton). Nodes and leaves that are reachable only
+ * from the set are @e exclusive, i.e., they would be released if the roots
+ * were erased, the others are shared with other roots. Leaves are counted
+ * both as nodes (constant nodes of the MTBDD) and separately as leaves.
+ */
+struct SFTA::MTBDDMemoryUsage
+{
+	/// The number of roots
+	size_t roots;
+
+	/// The number of nodes reachable from the roots
+	size_t nodes;
+
+	/// The number of nodes reachable only from the roots
+	size_t exclusiveNodes;
+
+	/// The number of leaves reachable from the roots
+	size_t leaves;
+
+	/// The number of leaves reachable only from the roots
+	size_t exclusiveLeaves;
+
+	/// The estimated number of bytes of exclusive nodes
+	size_t exclusiveNodeBytes;
+
+	/// The estimated number of bytes of exclusive leaves
+	size_t exclusiveLeafBytes;
+
+	MTBDDMemoryUsage()
+		: roots(0),
+			nodes(0),
+			exclusiveNodes(0),
+			leaves(0),
+			exclusiveLeaves(0),
+			exclusiveNodeBytes(0),
+			exclusiveLeafBytes(0)
+	{ }
+
+	inline size_t GetTotal() const
+	{
+		return exclusiveNodeBytes + exclusiveLeafBytes;
+	}
+
+	/**
+	 * @brief  Serializes the footprint
+	 *
+	 * Returns the footprint as a JSON object.
+	 */
+	std::string ToString() const
+	{
+		std::ostringstream os;
+
+		os << "{\"roots\": " << roots
+			<< ", \"nodes\": " << nodes
+			<< ", \"exclusive_nodes\": " << exclusiveNodes
+			<< ", \"leaves\": " << leaves
+			<< ", \"exclusive_leaves\": " << exclusiveLeaves
+			<< ", \"exclusive_node_bytes\": " << exclusiveNodeBytes
+			<< ", \"exclusive_leaf_bytes\": " << exclusiveLeafBytes << "}";
+
+		return os.str();
+	}
+};
+
+
+/**
+ * @brief   Memory footprint of an automaton
+ *
+ * Breakdown of the memory used by an automaton (in bytes, estimated from the
+ * sizes of containers). The symbol dictionary is usually shared by all
+ * automata of a transition table wrapper, so it is not included in the
+ * total.
+ */
+struct SFTA::MemoryUsage
+{
+	/// Sets (and bitmaps) of states and final or initial states
+	size_t stateContainers;
+
+	/// The map from left-hand sides to roots of MTBDDs
+	size_t rootMap;
+
+	/// The map from names of states to internal states
+	size_t stateNames;
+
+	/// The (shared) symbol dictionary
+	size_t symbolDictionary;
+
+	/// The part of the shared MTBDD reachable from the automaton
+	MTBDDMemoryUsage mtbdd;
+
+	MemoryUsage()
+		: stateContainers(0),
+			rootMap(0),
+			stateNames(0),
+			symbolDictionary(0),
+			mtbdd()
+	{ }
+
+	inline size_t GetTotal() const
+	{
+		return stateContainers + rootMap + stateNames + mtbdd.GetTotal();
+	}
+
+	/**
+	 * @brief  Serializes the footprint
+	 *
+	 * Returns the footprint as a JSON object.
+	 */
+	std::string ToString() const
+	{
+		std::ostringstream os;
+
+		os << "{\"total\": " << GetTotal()
+			<< ", \"state_containers\": " << stateContainers
+			<< ", \"root_map\": " << rootMap
+			<< ", \"state_names\": " << stateNames
+			<< ", \"symbol_dictionary\": " << symbolDictionary
+			<< ", \"mtbdd\": " << mtbdd.ToString() << "}";
+
+		return os.str();
+	}
+};
+
+
+/**
+ * @brief   Estimates of memory used by containers
+ *
+ * Static methods that estimate the number of bytes a value allocates on the
+ * heap (not including the size of the value itself). Containers of the
+ * library provide the estimate by their GetMemoryUsage() method, containers
+ * of the standard library are estimated from their sizes and the typical
+ * overhead of their nodes (strings are counted without the small string
+ * optimization).
+ */
+struct SFTA::Private::MemoryEstimate
+{
+private:  // Private data types
+
+	enum
+	{
+		// the bookkeeping of a node of a red-black tree (colour and 3 links)
+		TreeNodeOverhead = 4 * sizeof(void*),
+
+		// the bookkeeping of a node of a hash table (link and cached hash)
+		HashNodeOverhead = 2 * sizeof(void*)
+	};
+
+public:   // Public methods
+
+	template <typename T>
+	static inline size_t Of(const T&)
+	{
+		return 0;
+	}
+
+	static inline size_t Of(const std::string& str)
+	{
+		return str.capacity() + 1;
+	}
+
+	template <typename T1, typename T2>
+	static inline size_t Of(const std::pair<T1, T2>& pr)
+	{
+		return Of(pr.first) + Of(pr.second);
+	}
+
+	template <typename T, class Alloc>
+	static size_t Of(const std::vector<T, Alloc>& vec)
+	{
+		size_t result = vec.capacity() * sizeof(T);
+		for (typename std::vector<T, Alloc>::const_iterator it = vec.begin();
+			it != vec.end(); ++it)
+		{
+			result += Of(*it);
+		}
+
+		return result;
+	}
+
+	template <typename Key, class Compare, class Alloc>
+	static size_t Of(const std::set<Key, Compare, Alloc>& st)
+	{
+		size_t result = st.size() * (TreeNodeOverhead + sizeof(Key));
+		for (typename std::set<Key, Compare, Alloc>::const_iterator it = st.begin();
+			it != st.end(); ++it)
+		{
+			result += Of(*it);
+		}
+
+		return result;
+	}
+
+	template <typename Key, typename T, class Compare, class Alloc>
+	static size_t Of(const std::map<Key, T, Compare, Alloc>& mp)
+	{
+		typedef std::map<Key, T, Compare, Alloc> MapType;
+
+		size_t result = mp.size() *
+			(TreeNodeOverhead + sizeof(typename MapType::value_type));
+		for (typename MapType::const_iterator it = mp.begin(); it != mp.end(); ++it)
+		{
+			result += Of(it->first) + Of(it->second);
+		}
+
+		return result;
+	}
+
+	template <typename Key, typename T, class Hash, class Pred, class Alloc>
+	static size_t Of(const std::tr1::unordered_map<Key, T, Hash, Pred, Alloc>& mp)
+	{
+		typedef std::tr1::unordered_map<Key, T, Hash, Pred, Alloc> MapType;
+
+		size_t result = mp.bucket_count() * sizeof(void*) + mp.size() *
+			(HashNodeOverhead + sizeof(typename MapType::value_type));
+		for (typename MapType::const_iterator it = mp.begin(); it != mp.end(); ++it)
+		{
+			result += Of(it->first) + Of(it->second);
+		}
+
+		return result;
+	}
+
+	template <class Key>
+	static inline size_t Of(const SFTA::OrderedVector<Key>& vec)
+	{
+		return vec.GetMemoryUsage();
+	}
+
+	template <typename T>
+	static inline size_t Of(const SFTA::Vector<T>& vec)
+	{
+		return Of(static_cast<const std::vector<T>&>(vec));
+	}
+
+	template <typename KeyElement, typename Value>
+	static inline size_t Of(const SFTA::VectorMap<KeyElement, Value>& vecMap)
+	{
+		return vecMap.GetMemoryUsage();
+	}
+
+	template <typename Element>
+	static inline size_t Of(const SFTA::Private::BitmapSet<Element>& bitmap)
+	{
+		return bitmap.GetMemoryUsage();
+	}
+
+	template <typename T>
+	static inline size_t Of(const SFTA::Private::ElemOrVector<T>& eov)
+	{
+		return eov.GetMemoryUsage();
+	}
+};
+
+#endif
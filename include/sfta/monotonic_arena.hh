@@ -0,0 +1,401 @@
+/*****************************************************************************
+ *  Symbolic Finite Tree Automata Library
+ *
+ *  Description:
+ *    File with the MonotonicArena class and allocators that use it.
+ *
+ *****************************************************************************/
+
+#ifndef _SFTA_MONOTONIC_ARENA_HH_
+#define _SFTA_MONOTONIC_ARENA_HH_
+
+// Standard library headers
+#include <cassert>
+#include <cstddef>
+#include <limits>
+#include <new>
+#include <utility>
+#include <vector>
+
+// Boost library headers
+#include <boost/type_traits/alignment_of.hpp>
+
+
+// insert the classes into proper namespace
+namespace SFTA
+{
+	namespace Private
+	{
+		class MonotonicArena;
+
+		template
+		<
+			typename T
+		>
+		class ArenaAllocator;
+
+		class ArenaObject;
+	}
+}
+
+
+/**
+ * @brief   Monotonic memory arena
+ *
+ * Memory arena that serves allocations by bumping a pointer in large blocks
+ * and never releases single allocations. All memory is released at once when
+ * the arena is destroyed (or Release() is called). An arena is meant to be
+ * bound to a single operation (such as an inclusion check) and to hold its
+ * short-lived data structures.
+ *
+ * Allocations of a nested computation that is finished before the enclosing
+ * one continues (e.g. a recursive call) can be reclaimed early by a Scope
+ * guard, so that a single arena can serve many such computations.
+ *
+ * Note that the arena does not call destructors of objects allocated in it.
+ */
+class SFTA::Private::MonotonicArena
+{
+public:   // Public data types
+
+	/**
+	 * @brief  Guard of a nested computation
+	 *
+	 * Remembers the state of the arena at its construction and reclaims all
+	 * memory allocated since then at its destruction. Guards need to be
+	 * nested (which is the case for guards on the stack).
+	 */
+	class Scope
+	{
+	private:  // Private data members
+
+		MonotonicArena& arena_;
+
+		size_t blocks_;
+
+		char* current_;
+
+		size_t remaining_;
+
+	private:  // Private methods
+
+		Scope(const Scope&);
+		Scope& operator=(const Scope&);
+
+	public:   // Public methods
+
+		explicit Scope(MonotonicArena& arena)
+			: arena_(arena),
+				blocks_(arena.blocks_.size()),
+				current_(arena.current_),
+				remaining_(arena.remaining_)
+		{ }
+
+		~Scope()
+		{
+			arena_.rewind(blocks_, current_, remaining_);
+		}
+	};
+
+	friend class Scope;
+
+private:  // Private data types
+
+	/// Blocks with their sizes
+	typedef std::vector<std::pair<char*, size_t> > BlockVector;
+
+	/**
+	 * @brief  Type with the strictest alignment
+	 *
+	 * Type that has the alignment suitable for all basic types.
+	 */
+	union MaxAlignType
+	{
+		long double ld;
+		long l;
+		double d;
+		void* p;
+		void (*fp)();
+	};
+
+	enum
+	{
+		// the default size of a block
+		DefaultBlockSize = 64 * 1024
+	};
+
+private:  // Private data members
+
+	BlockVector blocks_;
+
+	char* current_;
+
+	size_t remaining_;
+
+	size_t blockSize_;
+
+	size_t allocatedBytes_;
+
+private:  // Private methods
+
+	MonotonicArena(const MonotonicArena&);
+	MonotonicArena& operator=(const MonotonicArena&);
+
+	char* allocateBlock(size_t size)
+	{
+		char* block = static_cast<char*>(::operator new(size));
+		blocks_.push_back(std::make_pair(block, size));
+		allocatedBytes_ += size;
+
+		return block;
+	}
+
+	void rewind(size_t blocks, char* current, size_t remaining)
+	{
+		// Assertions
+		assert(blocks <= blocks_.size());
+
+		while (blocks_.size() > blocks)
+		{	// release blocks allocated in the scope
+			::operator delete(blocks_.back().first);
+			allocatedBytes_ -= blocks_.back().second;
+			blocks_.pop_back();
+		}
+
+		current_ = current;
+		remaining_ = remaining;
+	}
+
+public:   // Public methods
+
+	explicit MonotonicArena(size_t blockSize = DefaultBlockSize)
+		: blocks_(),
+			current_(static_cast<char*>(0)),
+			remaining_(0),
+			blockSize_(blockSize),
+			allocatedBytes_(0)
+	{ }
+
+	/**
+	 * @brief  Allocates memory
+	 *
+	 * Allocates a chunk of memory of given size with given alignment.
+	 *
+	 * @param[in]  size       The size of the chunk
+	 * @param[in]  alignment  The alignment of the chunk (a power of 2)
+	 *
+	 * @returns  Pointer to the chunk
+	 */
+	void* Allocate(size_t size,
+		size_t alignment = boost::alignment_of<MaxAlignType>::value)
+	{
+		// Assertions
+		assert((alignment & (alignment - 1)) == 0);
+
+		size_t padding = (alignment - reinterpret_cast<size_t>(current_) % alignment)
+			% alignment;
+
+		if ((current_ == static_cast<char*>(0)) || (padding + size > remaining_))
+		{	// in case the current block is not sufficient
+			if (size > blockSize_ / 4)
+			{	// large chunks get a block of their own
+				return allocateBlock(size);
+			}
+
+			current_ = allocateBlock(blockSize_);
+			remaining_ = blockSize_;
+			padding = 0;
+		}
+
+		char* result = current_ + padding;
+		current_ += padding + size;
+		remaining_ -= padding + size;
+
+		return result;
+	}
+
+	/**
+	 * @brief  Releases all memory
+	 *
+	 * Releases all memory allocated by the arena.
+	 */
+	void Release()
+	{
+		for (BlockVector::iterator itBlocks = blocks_.begin();
+			itBlocks != blocks_.end(); ++itBlocks)
+		{	// release all blocks
+			::operator delete(itBlocks->first);
+		}
+
+		blocks_.clear();
+		current_ = static_cast<char*>(0);
+		remaining_ = 0;
+		allocatedBytes_ = 0;
+	}
+
+	/**
+	 * @brief  The amount of memory held by the arena
+	 *
+	 * Returns the number of bytes that the arena obtained from the system.
+	 *
+	 * @returns  The number of bytes
+	 */
+	inline size_t GetAllocatedBytes() const
+	{
+		return allocatedBytes_;
+	}
+
+	~MonotonicArena()
+	{
+		Release();
+	}
+};
+
+
+/**
+ * @brief   STL allocator that uses a MonotonicArena
+ *
+ * STL allocator that takes memory from a MonotonicArena. Deallocation is a
+ * no-op, the memory is reclaimed when the arena is released. A default
+ * constructed allocator is not bound to any arena and uses the global
+ * operator new and operator delete.
+ *
+ * @tparam  T  The type of allocated objects.
+ */
+template
+<
+	typename T
+>
+class SFTA::Private::ArenaAllocator
+{
+public:   // Public data types
+
+	typedef T value_type;
+	typedef T* pointer;
+	typedef const T* const_pointer;
+	typedef T& reference;
+	typedef const T& const_reference;
+	typedef size_t size_type;
+	typedef ptrdiff_t difference_type;
+
+	template <typename U>
+	struct rebind
+	{
+		typedef ArenaAllocator<U> other;
+	};
+
+private:  // Private data members
+
+	MonotonicArena* arena_;
+
+public:   // Public methods
+
+	ArenaAllocator()
+		: arena_(static_cast<MonotonicArena*>(0))
+	{ }
+
+	explicit ArenaAllocator(MonotonicArena* arena)
+		: arena_(arena)
+	{ }
+
+	template <typename U>
+	ArenaAllocator(const ArenaAllocator<U>& alloc)
+		: arena_(alloc.GetArena())
+	{ }
+
+	inline MonotonicArena* GetArena() const
+	{
+		return arena_;
+	}
+
+	inline pointer address(reference x) const
+	{
+		return &x;
+	}
+
+	inline const_pointer address(const_reference x) const
+	{
+		return &x;
+	}
+
+	pointer allocate(size_type n, const void* = 0)
+	{
+		if (arena_ == static_cast<MonotonicArena*>(0))
+		{	// in case there is no arena
+			return static_cast<pointer>(::operator new(n * sizeof(T)));
+		}
+
+		return static_cast<pointer>(
+			arena_->Allocate(n * sizeof(T), boost::alignment_of<T>::value));
+	}
+
+	inline void deallocate(pointer p, size_type)
+	{
+		if (arena_ == static_cast<MonotonicArena*>(0))
+		{	// in case there is no arena
+			::operator delete(p);
+		}
+	}
+
+	inline size_type max_size() const
+	{
+		return std::numeric_limits<size_type>::max() / sizeof(T);
+	}
+
+	inline void construct(pointer p, const T& val)
+	{
+		new (p) T(val);
+	}
+
+	inline void destroy(pointer p)
+	{
+		p->~T();
+	}
+};
+
+
+namespace SFTA
+{
+	namespace Private
+	{
+		template <typename T, typename U>
+		inline bool operator==(const ArenaAllocator<T>& lhs,
+			const ArenaAllocator<U>& rhs)
+		{
+			return lhs.GetArena() == rhs.GetArena();
+		}
+
+		template <typename T, typename U>
+		inline bool operator!=(const ArenaAllocator<T>& lhs,
+			const ArenaAllocator<U>& rhs)
+		{
+			return lhs.GetArena() != rhs.GetArena();
+		}
+	}
+}
+
+
+/**
+ * @brief   Base class for objects allocated in a MonotonicArena
+ *
+ * Classes derived from this class can only be created using
+ * <tt>new (arena) Class(...)</tt>. Deleting such an object calls its
+ * destructor, the memory is reclaimed when the arena is released.
+ */
+class SFTA::Private::ArenaObject
+{
+public:   // Public methods
+
+	static inline void* operator new(size_t size, MonotonicArena& arena)
+	{
+		return arena.Allocate(size);
+	}
+
+	static inline void operator delete(void*, MonotonicArena&)
+	{ }
+
+	static inline void operator delete(void*)
+	{ }
+};
+
+#endif
@@ -13,10 +13,17 @@
 
 // SFTA headers
 #include <sfta/inflatable_vector.hh>
+#include <sfta/monotonic_arena.hh>
+#include <sfta/operation_context.hh>
+#include <sfta/operation_statistics.hh>
+#include <sfta/root_guard.hh>
 #include <sfta/symbolic_bu_tree_automaton.hh>
+#include <sfta/trace.hh>
 #include <sfta/nd_symbolic_td_tree_automaton.hh>
 
 // Standard library headers
+#include <deque>
+#include <memory>
 #include <queue>
 #include <tr1/unordered_map>
 
@@ -154,12 +161,25 @@ public:   // Public data types
 
 			typedef OrderedVector<StateType> StateSetType;
 			typedef std::pair<size_t, StateSetType> NumberSetType;
-			typedef std::list<NumberSetType> StateSetListType;
-			typedef std::tr1::unordered_map<StateType, StateSetListType>
+			typedef SFTA::Private::ArenaAllocator<NumberSetType> NumberSetAllocatorType;
+			typedef std::list<NumberSetType, NumberSetAllocatorType> StateSetListType;
+			typedef std::list<NumberSetType> StateSetListCopyType;
+			typedef std::tr1::unordered_map<StateType, StateSetListType,
+				boost::hash<StateType>, std::equal_to<StateType>,
+				SFTA::Private::ArenaAllocator<std::pair<const StateType, StateSetListType> > >
 				StateToStateSetListHashTableType;
 			typedef std::pair<StateType, NumberSetType> AntichainPairType;
-			typedef std::queue<AntichainPairType> PairQueueType;
-			typedef std::set<size_t> RevokedSetType;
+			typedef std::deque<AntichainPairType,
+				SFTA::Private::ArenaAllocator<AntichainPairType> > PairDequeType;
+			typedef std::queue<AntichainPairType, PairDequeType> PairQueueType;
+			typedef std::set<size_t, std::less<size_t>,
+				SFTA::Private::ArenaAllocator<size_t> > RevokedSetType;
+
+			enum
+			{
+				// the initial number of buckets of the antichain
+				InitialBucketsCount = 64
+			};
 
 		private:  // Private data members
 
@@ -225,6 +245,15 @@ public:   // Public data types
 					{
 						if (!failed_)
 						{	// in case there is some sense in doing the following
+							// the set of states of the bigger automaton (possibly to be added to
+							// the antichain)
+							StateSetType biggerStates;
+							for (typename LeafType::const_iterator itRhs = rhs.begin();
+								itRhs != rhs.end(); ++itRhs)
+							{
+								biggerStates.insert(itRhs->GetElement());
+							}
+
 							for (typename LeafType::const_iterator itLhs = lhs.begin();
 								itLhs != lhs.end() && !(failed_); ++itLhs)
 							{
@@ -232,8 +261,6 @@ public:   // Public data types
 
 								bool addSet = false;         // flag that indicates that the following
 								                             // variable should be checked for finality
-								StateSetType biggerStates;   // contains newly added set to antichain
-								                             // (if such exists)
 
 								typename StateToStateSetListHashTableType::iterator itHT;
 								if ((itHT = antichain_->find(smallerState)) != antichain_->end())
@@ -249,28 +276,11 @@ public:   // Public data types
 										const StateSetType& listItem = itList->second;
 
 										// check if 'listItem' is a subset of 'rhs'
-										typename LeafType::const_iterator itRhs = rhs.begin();
-										for (typename StateSetType::const_iterator itAntichainSet
-											= listItem.begin(); itAntichainSet != listItem.end();
-											++itAntichainSet)
-										{
-											while ((itRhs != rhs.end()) &&
-												(itRhs->GetElement() < *itAntichainSet))
-											{
-												++itRhs;
-											}
-
-											if ((itRhs == rhs.end()) || (itRhs->GetElement() != *itAntichainSet))
-											{	// in case the 'listItem' is not a subset of 'rhs'
-												isSubset = false;
-												break;
-											}
-										}
-
-										assert(!isSubset || (itRhs != rhs.end()) || rhs.empty());
+										isSubset = listItem.IsSubsetOf(biggerStates);
 
 										if (isSubset)
 										{	// in case we found some subset
+											SFTA_STATISTICS(CountSubsumptionHit());
 											break;
 										}
 									}
@@ -290,33 +300,12 @@ public:   // Public data types
 											const StateSetType& listItem = itList->second;
 
 											// check if 'rhs' is a subset of 'listItem'
-											bool rhsIsSubset = true;
-											typename StateSetType::const_iterator itAntichainSet
-												= listItem.begin();
-											for (typename LeafType::const_iterator itRhs = rhs.begin();
-												itRhs != rhs.end(); ++itRhs)
-											{
-												while ((itAntichainSet != listItem.end()) &&
-													(*itAntichainSet < itRhs->GetElement()))
-												{
-													++itAntichainSet;
-												}
-
-												if ((itAntichainSet == listItem.end()) ||
-													(*itAntichainSet != itRhs->GetElement()))
-												{	// in case the 'rhs' is not a subset of 'listItem'
-													rhsIsSubset = false;
-													break;
-												}
-											}
-
-											assert(!rhsIsSubset || (itAntichainSet != listItem.end()));
-
-											if (rhsIsSubset)
+											if (biggerStates.IsSubsetOf(listItem))
 											{	// in case 'rhs' is smaller, remove 'listItem' from antichain
 												itList = biggerSetList.erase(itList);
 												revokedNumbers_->insert(itList->first);
 												incrementIterator = false;
+												SFTA_STATISTICS(AntichainRemove());
 											}
 										}
 									}
@@ -324,35 +313,22 @@ public:   // Public data types
 								else
 								{	// if there isn't any list for smallerState
 									addSet = true;
-									itHT = antichain_->insert(std::make_pair(smallerState, StateSetListType())).first;
+									itHT = antichain_->insert(std::make_pair(smallerState, StateSetListType(
+										NumberSetAllocatorType(antichain_->get_allocator())))).first;
 								}
 
 								if (addSet)
 								{
 									//SFTA_LOGGER_INFO("Adding pair " + Convert::ToString(std::make_pair(smallerState, Convert::ToString(rhs))));
-									for (typename LeafType::const_iterator itRhs = rhs.begin();
-										itRhs != rhs.end(); ++itRhs)
-									{
-										biggerStates.insert(itRhs->GetElement());
-									}
-
 									AntichainPairType newPair = std::make_pair(smallerState,
 										std::make_pair(getNewNumber(), biggerStates));
 									itHT->second.push_back(newPair.second);
 									pairQueue_->push(newPair);
+									SFTA_STATISTICS(AntichainInsert());
 
 									if (smallerAut_->IsStateFinal(smallerState))
 									{	// in case the state from the smaller automaton is final
-										failed_ = true;
-										for (typename LeafType::const_iterator itRhs = rhs.begin();
-											itRhs != rhs.end(); ++itRhs)
-										{
-											if (biggerAut_->IsStateFinal(itRhs->GetElement()))
-											{
-												failed_ = false;
-												break;
-											}
-										}
+										failed_ = !biggerAut_->ContainsFinalState(biggerStates);
 
 										if (failed_)
 										{
@@ -391,13 +367,22 @@ public:   // Public data types
 
 				UnionApplyFunctor unionFunc;
 
+				// the arena for the data structures of the operation (needs to be
+				// declared first so that it outlives them)
+				SFTA::Private::MonotonicArena arena;
+
+				NumberSetAllocatorType arenaAllocator(&arena);
+
 				// the antichain
-				StateToStateSetListHashTableType antichain;
+				StateToStateSetListHashTableType antichain(InitialBucketsCount,
+					boost::hash<StateType>(), std::equal_to<StateType>(), arenaAllocator);
 				// queue of pairs (state, state_set) added to antichain
 				// TODO: try stack here (compare with the queue)
-				PairQueueType pairQueue;
+				PairDequeType pairDeque(arenaAllocator);
+				PairQueueType pairQueue(pairDeque);
 				// set of numbers of revoked pairs
-				RevokedSetType revokedNumbers;
+				std::less<size_t> revokedCompare;
+				RevokedSetType revokedNumbers(revokedCompare, arenaAllocator);
 
 				CollectorApplyFunctor collector(smallerAut_, biggerAut_, &antichain,
 					&pairQueue, &revokedNumbers);
@@ -415,6 +400,8 @@ public:   // Public data types
 
 				while (!collector.Failed() && !pairQueue.empty())
 				{
+					OperationContext::CheckCurrent();
+
 					AntichainPairType nextPair = pairQueue.front();
 					pairQueue.pop();
 
@@ -422,6 +409,8 @@ public:   // Public data types
 
 					if (revokedNumbers.find(nextPair.second.first) == revokedNumbers.end())
 					{	// in case this pair has not been revoked
+						SFTA_STATISTICS(CountPairProcessed());
+
 						//SFTA_LOGGER_INFO("Processing pair: " + Convert::ToString(nextPair));
 
 						StateType& smallerState = nextPair.first;
@@ -445,13 +434,14 @@ public:   // Public data types
 
 								// collect vector of lists of possible values
 								bool allComponentsInAntichain = true;
-								std::vector<StateSetListType> listVector;
+								std::vector<StateSetListCopyType> listVector;
 								for (size_t arityIndex = 0; arityIndex < arity; ++arityIndex)
 								{
 									typename StateToStateSetListHashTableType::const_iterator itHT;
 									if ((itHT = antichain.find(lhsIV.first[arityIndex])) != antichain.end())
 									{
-										listVector.push_back(itHT->second);
+										listVector.push_back(StateSetListCopyType(
+											itHT->second.begin(), itHT->second.end()));
 									}
 									else
 									{
@@ -469,8 +459,8 @@ public:   // Public data types
 									assert(listVector.size() == arity);
 
 									// initialize vector of iterators
-									std::vector<typename StateSetListType::const_iterator> vecIterator;
-									for (typename std::vector<StateSetListType>::const_iterator itList
+									std::vector<typename StateSetListCopyType::const_iterator> vecIterator;
+									for (typename std::vector<StateSetListCopyType>::const_iterator itList
 										= listVector.begin(); itList != listVector.end(); ++itList)
 									{
 										vecIterator.push_back(itList->begin());
@@ -484,7 +474,7 @@ public:   // Public data types
 									{	// until the most significant component overflows
 
 										std::string tmpString = "(";
-										for (typename std::vector<typename StateSetListType::const_iterator>
+										for (typename std::vector<typename StateSetListCopyType::const_iterator>
 											::const_iterator itItVec = vecIterator.begin();
 											itItVec != vecIterator.end(); ++itItVec)
 										{
@@ -497,7 +487,7 @@ public:   // Public data types
 
 										// initialize vector of set iterators
 										std::vector<typename StateSetType::const_iterator> setVecIterator;
-										for (typename std::vector<typename StateSetListType::const_iterator>
+										for (typename std::vector<typename StateSetListCopyType::const_iterator>
 											::const_iterator itItVec = vecIterator.begin();
 											itItVec != vecIterator.end(); ++itItVec)
 										{
@@ -647,7 +637,7 @@ public:   // Public data types
 			};
 
 
-			Type* result = new Type(a1);
+			std::auto_ptr<Type> result(new Type(a1));
 			result->CopyStates(a2);
 
 			RootType lhsMtbdd = a1.getRoot(LeftHandSideType());
@@ -659,7 +649,7 @@ public:   // Public data types
 
 			result->setRoot(LeftHandSideType(), resultRoot);
 
-			return result;
+			return result.release();
 		}
 
 
@@ -749,12 +739,16 @@ public:   // Public data types
 
 
 			// create structure for output automaton
-			Type* result = new Type(a1.GetTTWrapper());
+			std::auto_ptr<Type> result(new Type(a1.GetTTWrapper()));
+
+			// the roots of the result are erased in case the operation fails
+			SFTA::Private::RootGuard<SharedMTBDDType> rootGuard(result->GetTTWrapper()->GetMTBDD());
+			rootGuard.Add(result->getSinkSuperState());
 
 			// create used data structures
 			NewStatesQueueType newStates;
 			StatePairToStateTable productStatesTable;
-			IntersectionApplyFunctor intersectionFunc(result, &newStates,
+			IntersectionApplyFunctor intersectionFunc(result.get(), &newStates,
 				&productStatesTable);
 
 			// get rules for leaves
@@ -762,8 +756,8 @@ public:   // Public data types
 			RootType rhsMtbdd = a2.getRoot(LeftHandSideType());
 
 			// carry out the initial apply operation on leaves
-			RootType resultRoot = result->GetTTWrapper()->GetMTBDD()->Apply(
-				lhsMtbdd, rhsMtbdd, &intersectionFunc);
+			RootType resultRoot = rootGuard.Add(result->GetTTWrapper()->GetMTBDD()->Apply(
+				lhsMtbdd, rhsMtbdd, &intersectionFunc));
 			result->setRoot(LeftHandSideType(), resultRoot);
 
 			while (!newStates.empty())
@@ -821,8 +815,8 @@ public:   // Public data types
 								rhsMtbdd = a2.getRoot(a2Lhss[arity][a2index].first);
 
 								// carry out the apply operation on leaves
-								resultRoot = result->GetTTWrapper()->GetMTBDD()->Apply(
-									lhsMtbdd, rhsMtbdd, &intersectionFunc);
+								resultRoot = rootGuard.Add(result->GetTTWrapper()->GetMTBDD()->Apply(
+									lhsMtbdd, rhsMtbdd, &intersectionFunc));
 								result->setRoot(newLhs, resultRoot);
 							}
 						}
@@ -830,8 +824,9 @@ public:   // Public data types
 				}
 			}
 
+			rootGuard.Release();
 
-			return result;
+			return result.release();
 		}
 
 
@@ -839,11 +834,15 @@ public:   // Public data types
 
 		virtual Type* Union(const HierarchyRoot* a1, const HierarchyRoot* a2) const
 		{
+			SFTA_TRACE_SPAN("NDSymbolicBUTreeAutomaton::Operation::Union");
+
 			return safelyPerformOperation(&Operation::langUnion, a1, a2);
 		}
 
 		virtual Type* Intersection(const HierarchyRoot* a1, const HierarchyRoot* a2) const
 		{
+			SFTA_TRACE_SPAN("NDSymbolicBUTreeAutomaton::Operation::Intersection");
+
 			return safelyPerformOperation(&Operation::langIntersection, a1, a2);
 		}
 
@@ -883,11 +882,14 @@ public:   // Public data types
 			// Assertions
 			assert(aut != static_cast<Type*>(0));
 
+			SFTA_TRACE_SPAN("NDSymbolicBUTreeAutomaton::Operation::ComputeSimulationPreorder");
+
 			typedef typename HierarchyRoot::Operation::SimulationRelationType SimType;
 			typedef LeftHandSideType StateVector;
 			typedef std::pair<StateVector, StateVector> StateVectorPair;
 			typedef VectorMap<StateType, RootType> CountersType;
-			typedef std::set<StateVectorPair> RemoveSetType;
+			typedef std::set<StateVectorPair, std::less<StateVectorPair>,
+				SFTA::Private::ArenaAllocator<StateVectorPair> > RemoveSetType;
 			typedef SFTA::InflatableVector<SFTA::Vector<StateVector> >
 				InflatableListOfVectorsType;
 			typedef SFTA::InflatableVector<InflatableListOfVectorsType>
@@ -921,10 +923,9 @@ public:   // Public data types
 					{
 						LeafType newRhs = rhs;
 
-						SFTA::Vector<StateType> newVec;
-						newVec.push_back(state_);
-						newVec.push_back(lhs.size());
-						newRhs.insert(newVec);
+						StateType newVec[2] = {state_, static_cast<StateType>(lhs.size())};
+						newRhs.insert(
+							SFTA::Private::ElemOrVector<StateType>(newVec, newVec + 2));
 
 						return newRhs;
 					}
@@ -1069,7 +1070,8 @@ public:   // Public data types
 					for (typename LeafType::const_iterator itCntQ = cntQ.begin();
 						itCntQ != cntQ.end(); ++itCntQ)
 					{
-						const SFTA::Vector<StateType>& vec = itCntQ->GetVector();
+						typename SFTA::Private::ElemOrVector<StateType>::VectorView vec =
+							itCntQ->GetVector();
 
 						// we assert that the counters are in correct format
 						assert(vec.size() == 2);
@@ -1078,13 +1080,14 @@ public:   // Public data types
 
 						if (preR.find(s) != preR.end())
 						{	// in case the counter is to be decremented
-							SFTA::Vector<StateType> newVec(vec);
+							StateType newVec[2] = {vec[0], vec[1]};
 
 							// we assert that we do not make mistakes in the algorithm :-)
 							assert(newVec[1] > 0);
 
 							--newVec[1];
-							newCntQ.insert(newVec);
+							newCntQ.insert(
+								SFTA::Private::ElemOrVector<StateType>(newVec, newVec + 2));
 
 							if (newVec[1] == 0)
 							{	// in case we break the simulation relation
@@ -1103,7 +1106,7 @@ public:   // Public data types
 						}
 						else
 						{	// the counter is to be copied only
-							newCntQ.insert(vec);
+							newCntQ.insert(*itCntQ);
 						}
 					}
 
@@ -1123,8 +1126,9 @@ public:   // Public data types
 			//                         INITIALIZATION
 			// ********************************************************************
 
-			// the simulation relation
-			SimType* sim = new SimType();
+			// the simulation relation (released in case the computation is
+			// interrupted)
+			std::auto_ptr<SimType> sim(new SimType());
 
 			//SFTA_LOGGER_INFO("Started computing top-down automaton");
 
@@ -1135,11 +1139,20 @@ public:   // Public data types
 			// used MTBDD
 			SharedMTBDDType* mtbdd = autSym->GetTTWrapper()->GetMTBDD();
 
+			// the arena for the nodes of set "remove" (declared first so that it
+			// outlives the set); erased nodes are reclaimed when the run finishes
+			SFTA::Private::MonotonicArena arena;
+
 			// set "remove"
-			RemoveSetType remove;
+			std::less<StateVectorPair> removeCompare;
+			RemoveSetType remove(removeCompare,
+				typename RemoveSetType::allocator_type(&arena));
+
+			// temporary roots are erased in case the computation is interrupted
+			SFTA::Private::RootGuard<SharedMTBDDType> rootGuard(mtbdd);
 
 			// initial value of counters
-			RootType initCnt = mtbdd->CreateRoot();
+			RootType initCnt = rootGuard.Add(mtbdd->CreateRoot());
 
 			// array of states
 			std::vector<StateType> states = autSym->GetVectorOfStates();
@@ -1177,7 +1190,7 @@ public:   // Public data types
 			// create necessary apply functors
 			SimulationCounterInitializationApplyFunctor simulationCounterInitializer;
 			SimulationDetectorApplyFunctor simulationDetector;
-			SimulationRefinementApplyFunctor simulationRefineFunc(sim, &remove, &stateToLhss);
+			SimulationRefinementApplyFunctor simulationRefineFunc(sim.get(), &remove, &stateToLhss);
 
 			//SFTA_LOGGER_INFO("Started computing initial refinement");
 
@@ -1191,9 +1204,9 @@ public:   // Public data types
 				RootType qRoot = topDown->getRoot(q);
 
 				// accumulate the initial counters
-				RootType newCnt = mtbdd->Apply(qRoot, initCnt,
-						&simulationCounterInitializer);
-				mtbdd->EraseRoot(initCnt);
+				RootType newCnt = rootGuard.Add(mtbdd->Apply(qRoot, initCnt,
+						&simulationCounterInitializer));
+				rootGuard.Erase(initCnt);
 				initCnt = newCnt;
 
 				for (typename std::vector<StateType>::const_iterator itHigherStates = states.begin();
@@ -1292,7 +1305,7 @@ public:   // Public data types
 			}
 
 			// TODO: prepare for erasing
-			mtbdd->EraseRoot(initCnt);
+			rootGuard.Erase(initCnt);
 
 
 			// ********************************************************************
@@ -1305,6 +1318,8 @@ public:   // Public data types
 			//SFTA_LOGGER_INFO("Started computation");
 			while (!remove.empty())
 			{	// while there is a need for backwards propagation of cut simulations
+				OperationContext::CheckCurrent();
+
 				StateVectorPair cutRel = *(remove.begin());
 				remove.erase(remove.begin());
 
@@ -1342,7 +1357,7 @@ public:   // Public data types
 //				mtbdd->EraseRoot(itCounters->second);
 //			}
 
-			return sim;
+			return sim.release();
 		}
 
 		virtual bool CheckLanguageInclusion(const HierarchyRoot* a1,
@@ -1372,6 +1387,8 @@ public:   // Public data types
 				throw std::runtime_error(__func__ + std::string(": Invalid type"));
 			}
 
+			SFTA_TRACE_SPAN("NDSymbolicBUTreeAutomaton::Operation::CheckLanguageInclusion");
+
 			InclusionCheckingFunctor inclFunc(a1Sym, a2Sym);
 			return inclFunc();
 		}
@@ -1407,6 +1424,8 @@ public:   // Public methods
 
 	NDSymbolicTDTreeAutomatonType* GetTopDownAutomaton() const
 	{
+		SFTA_TRACE_SPAN("NDSymbolicBUTreeAutomaton::GetTopDownAutomaton");
+
 		typedef typename SharedMTBDDType::RootType RootType;
 
 		class CollectorApplyFunctor
@@ -1455,8 +1474,12 @@ public:   // Public methods
 
 		CollectorApplyFunctor collectorFunc;
 
-		NDSymbolicTDTreeAutomatonType* tdAut =
-			new NDSymbolicTDTreeAutomatonType(this->GetTTWrapper());
+		std::auto_ptr<NDSymbolicTDTreeAutomatonType> tdAut(
+			new NDSymbolicTDTreeAutomatonType(this->GetTTWrapper()));
+
+		// the roots of the result are erased in case the conversion fails
+		SFTA::Private::RootGuard<SharedMTBDDType> rootGuard(tdAut->GetTTWrapper()->GetMTBDD());
+		rootGuard.Add(tdAut->getSinkState());
 
 		std::vector<StateType> states = this->GetVectorOfStates();
 
@@ -1474,7 +1497,7 @@ public:   // Public methods
 				tdAut->SetStateInitial(newState);
 			}
 
-			RootType tdRoot = tdAut->getRoot(newState);
+			RootType tdRoot = rootGuard.Add(tdAut->getRoot(newState));
 
 			collectorFunc.SetWantedState(newState);
 
@@ -1482,16 +1505,18 @@ public:   // Public methods
 				itSuperStates != rootMap.end(); ++itSuperStates)
 			{
 				collectorFunc.SetAddedSuperState(itSuperStates->first);
-				RootType newRoot = tdAut->GetTTWrapper()->GetMTBDD()->Apply(
-					itSuperStates->second, tdRoot, &collectorFunc);
-				tdAut->GetTTWrapper()->GetMTBDD()->EraseRoot(tdRoot);
+				RootType newRoot = rootGuard.Add(tdAut->GetTTWrapper()->GetMTBDD()->Apply(
+					itSuperStates->second, tdRoot, &collectorFunc));
+				rootGuard.Erase(tdRoot);
 				tdRoot = newRoot;
 			}
 
 			tdAut->setRoot(newState, tdRoot);
 		}
 
-		return tdAut;
+		rootGuard.Release();
+
+		return tdAut.release();
 	}
 
 };
@@ -12,15 +12,24 @@
 #define _ND_SYMBOLIC_TD_TREE_AUTOMATON_HH_
 
 // SFTA headers
+#include <sfta/monotonic_arena.hh>
+#include <sfta/operation_context.hh>
+#include <sfta/operation_statistics.hh>
 #include <sfta/symbolic_td_tree_automaton.hh>
+#include <sfta/trace.hh>
 #include <sfta/vector.hh>
 
 // Standard library headers
+#include <algorithm>
+#include <memory>
+#include <new>
 #include <queue>
 #include <tr1/unordered_map>
 
 // Boost libraries
+#include <boost/aligned_storage.hpp>
 #include <boost/functional/hash.hpp>
+#include <boost/type_traits/alignment_of.hpp>
 
 
 // insert the class into proper namespace
@@ -52,6 +61,18 @@ namespace SFTA
 {
 	namespace Private
 	{
+		/**
+		 * @brief  An element or a vector of elements
+		 *
+		 * Compact tagged representation of either a single element or a vector
+		 * of elements (e.g. a tuple of states). The single element and vectors
+		 * of at most @c InlineCapacity elements are stored inline, longer
+		 * vectors are stored in a single heap block. In all cases the elements
+		 * form a contiguous array so that comparison and hashing use a single
+		 * code path.
+		 *
+		 * @tparam  T  The type of elements.
+		 */
 		template <typename T>
 		class ElemOrVector
 		{
@@ -59,95 +80,291 @@ namespace SFTA
 			typedef T Type;
 			typedef SFTA::Vector<T> VectorType;
 
+			/**
+			 * @brief  Read-only view of the vector
+			 *
+			 * A read-only view of the elements of a vector stored in an
+			 * ElemOrVector. The view is valid as long as the ElemOrVector is.
+			 */
+			class VectorView
+			{
+			public:
+				typedef const T* const_iterator;
+
+			private:
+				const T* data_;
+				size_t size_;
+
+			public:
+				VectorView(const T* data, size_t size)
+					: data_(data), size_(size)
+				{ }
+
+				inline const_iterator begin() const
+				{
+					return data_;
+				}
+
+				inline const_iterator end() const
+				{
+					return data_ + size_;
+				}
+
+				inline size_t size() const
+				{
+					return size_;
+				}
+
+				inline bool empty() const
+				{
+					return size_ == 0;
+				}
+
+				inline const T& operator[](size_t n) const
+				{
+					// Assertions
+					assert(n < size_);
+
+					return data_[n];
+				}
+			};
+
 		private:
-			bool isElem;               // if true, elem is valid, if false, elemVector is valid
-			Type elem;
-			VectorType elemVector;
+			enum
+			{
+				// the maximum number of elements stored inline
+				InlineCapacity = 4
+			};
+
+			enum
+			{
+				// the tag of an element, a vector of size n has the tag n + 1
+				ElementTag = 0
+			};
+
+			typedef typename boost::aligned_storage
+			<
+				InlineCapacity * sizeof(T),
+				boost::alignment_of<T>::value
+			>::type InlineStorageType;
+
+			union StorageType
+			{
+				InlineStorageType inlineStorage;
+				T* heapData;
+			};
+
+			size_t tag_;               // ElementTag for an element, size + 1 for a vector
+			StorageType storage_;
+
+		private:
+			static inline size_t sizeOfTag(size_t tag)
+			{
+				return (tag == ElementTag)? 1 : tag - 1;
+			}
+
+			inline size_t dataSize() const
+			{
+				return sizeOfTag(tag_);
+			}
+
+			inline bool isInline() const
+			{
+				return dataSize() <= InlineCapacity;
+			}
+
+			inline T* inlineData()
+			{
+				return static_cast<T*>(static_cast<void*>(&storage_.inlineStorage));
+			}
+
+			inline const T* inlineData() const
+			{
+				return static_cast<const T*>(static_cast<const void*>(&storage_.inlineStorage));
+			}
+
+			inline const T* data() const
+			{
+				return isInline()? inlineData() : storage_.heapData;
+			}
+
+			static T* copyToHeap(const T* first, size_t size)
+			{
+				T* dst = static_cast<T*>(::operator new(size * sizeof(T)));
+				try
+				{
+					std::uninitialized_copy(first, first + size, dst);
+				}
+				catch (...)
+				{	// the copied elements are destroyed by uninitialized_copy()
+					::operator delete(dst);
+					throw;
+				}
+
+				return dst;
+			}
+
+			void init(const T* first, size_t tag)
+			{
+				size_t size = sizeOfTag(tag);
+				if (size > InlineCapacity)
+				{	// in case the elements do not fit inline
+					storage_.heapData = copyToHeap(first, size);
+				}
+				else
+				{
+					std::uninitialized_copy(first, first + size, inlineData());
+				}
+
+				// the tag is set only once the elements are in place
+				tag_ = tag;
+			}
+
+			void destroy()
+			{
+				T* elements = isInline()? inlineData() : storage_.heapData;
+				for (size_t i = 0; i < dataSize(); ++i)
+				{	// destroy all elements
+					elements[i].~T();
+				}
+
+				if (!isInline())
+				{	// in case the elements are on the heap
+					::operator delete(storage_.heapData);
+				}
+			}
 
 		public:
 			ElemOrVector()
-				: isElem(true), elem(), elemVector()
-			{	}
+				: tag_(ElementTag), storage_()
+			{
+				new (inlineData()) T();
+			}
 
 			ElemOrVector(const Type& el)
-				: isElem(true), elem(el), elemVector()
-			{ }
+				: tag_(ElementTag), storage_()
+			{
+				new (inlineData()) T(el);
+			}
 
 			ElemOrVector(const VectorType& elVec)
-				: isElem(false), elem(), elemVector(elVec)
-			{ }
+				: tag_(ElementTag), storage_()
+			{
+				init(elVec.empty()? static_cast<const T*>(0) : &elVec[0],
+					elVec.size() + 1);
+			}
+
+			ElemOrVector(const Type* first, const Type* last)
+				: tag_(ElementTag), storage_()
+			{
+				init(first, static_cast<size_t>(last - first) + 1);
+			}
+
+			ElemOrVector(const ElemOrVector& eov)
+				: tag_(ElementTag), storage_()
+			{
+				init(eov.data(), eov.tag_);
+			}
+
+			ElemOrVector& operator=(const ElemOrVector& eov)
+			{
+				if (this != &eov)
+				{
+					if (!eov.isInline())
+					{	// the new elements are copied before the old ones are destroyed
+						T* heapData = copyToHeap(eov.data(), eov.dataSize());
+						destroy();
+						storage_.heapData = heapData;
+						tag_ = eov.tag_;
+					}
+					else
+					{	// an empty vector owns nothing in case copying throws
+						destroy();
+						tag_ = ElementTag + 1;
+						init(eov.data(), eov.tag_);
+					}
+				}
+
+				return *this;
+			}
+
+			~ElemOrVector()
+			{
+				destroy();
+			}
 
 			inline bool IsElement() const
 			{
-				return isElem;
+				return tag_ == ElementTag;
 			}
 
 			const Type& GetElement() const
 			{
-				if (!isElem)
+				if (!IsElement())
 				{
 					throw std::runtime_error(__func__ +
 						std::string(": an attempt to get an element from vector"));
 				}
 
-				return elem;
+				return *inlineData();
 			}
 
-			const VectorType& GetVector() const
+			VectorView GetVector() const
 			{
-				if (isElem)
+				if (IsElement())
 				{
 					throw std::runtime_error(__func__ +
 						std::string(": an attempt to get a vector from element"));
 				}
-				return elemVector;
+				return VectorView(data(), dataSize());
+			}
+
+			inline size_t GetMemoryUsage() const
+			{
+				return isInline()? 0 : dataSize() * sizeof(T);
 			}
 
 			friend bool operator<(const ElemOrVector<T>& lhs, const ElemOrVector<T>& rhs)
 			{
-				if (lhs.isElem && !rhs.isElem)
-				{
-					return true;    // elements are smaller than vectors
-				}
-				else if (!lhs.isElem && rhs.isElem)
-				{
-					return false;   // elements are smaller than vectors
-				}
-				else if (lhs.isElem)
-				{
-					return lhs.elem < rhs.elem;
-				}
-				else
+				// elements are smaller than vectors and shorter vectors are smaller
+				// than longer ones, so that only data of equal size are compared
+				if (lhs.tag_ != rhs.tag_)
 				{
-					return lhs.elemVector < rhs.elemVector;
+					return lhs.tag_ < rhs.tag_;
 				}
+
+				const T* lhsData = lhs.data();
+				const T* rhsData = rhs.data();
+				std::pair<const T*, const T*> mism =
+					std::mismatch(lhsData, lhsData + lhs.dataSize(), rhsData);
+
+				return (mism.first != lhsData + lhs.dataSize()) &&
+					(*mism.first < *mism.second);
 			}
 
 			friend bool operator==(const ElemOrVector<T>& lhs, const ElemOrVector<T>& rhs)
 			{
-				if ((lhs.isElem && !rhs.isElem) || (!lhs.isElem && rhs.isElem))
-				{
-					return false;
-				}
-				else if (lhs.isElem)
-				{
-					return lhs.elem == rhs.elem;
-				}
-				else
-				{
-					return lhs.elemVector == rhs.elemVector;
-				}
+				return (lhs.tag_ == rhs.tag_) &&
+					std::equal(lhs.data(), lhs.data() + lhs.dataSize(), rhs.data());
+			}
+
+			friend size_t hash_value(const ElemOrVector<T>& eov)
+			{
+				size_t seed = eov.tag_;
+				boost::hash_range(seed, eov.data(), eov.data() + eov.dataSize());
+				return seed;
 			}
 
 			friend std::ostream& operator<<(std::ostream& os, const ElemOrVector& eov)
 			{
-				if (eov.isElem)
+				if (eov.IsElement())
 				{
-					os << eov.elem;
+					os << eov.GetElement();
 				}
 				else
 				{
-					os << eov.elemVector;
+					os << SFTA::Private::Convert::ToString(
+						std::vector<T>(eov.data(), eov.data() + eov.dataSize()));
 				}
 
 				return os;
@@ -269,6 +486,7 @@ public:   // Public data types
 				struct AndNode;
 
 				struct OrNode
+					: public SFTA::Private::ArenaObject
 				{
 					std::vector<AndNode*> parents_;
 					std::vector<AndNode*> disjuncts_;
@@ -308,6 +526,7 @@ public:   // Public data types
 				typedef std::pair<ChoiceFunctionType, OrNode*> ChoiceFunctionNodeType;
 
 				struct AndNode
+					: public SFTA::Private::ArenaObject
 				{
 				private:
 
@@ -367,6 +586,15 @@ public:   // Public data types
 			const SimulationRelationType* simSmaller_;
 			const SimulationRelationType* simBigger_;
 
+			/**
+			 * @brief  The arena for the nodes of AND-OR trees
+			 *
+			 * The arena is shared by all (nested) checks of inclusion of leaves,
+			 * each of which reclaims its nodes when it finishes, and is released
+			 * when the whole inclusion check finishes.
+			 */
+			SFTA::Private::MonotonicArena arena_;
+
 		private:  // Private methods
 
 			InclusionCheckingFunctor(const InclusionCheckingFunctor&);
@@ -521,6 +749,7 @@ public:   // Public data types
 				}
 
 				itHashTable->second.push_back(disjunct.second);
+				SFTA_STATISTICS(AntichainInsert());
 			}
 
 			void removeFromWorkset(const DisjunctType& disjunct)
@@ -542,6 +771,7 @@ public:   // Public data types
 				}
 
 				stateSetList.erase(itStateSetList);
+				SFTA_STATISTICS(AntichainRemove());
 			}
 
 			void addToChildren(DisjunctListType& children,
@@ -581,19 +811,35 @@ public:   // Public data types
 
 			bool expandDisjunct(const DisjunctType& disjunct)
 			{
+				if (OperationContext::PollCurrent() != OperationInterrupted::NotInterrupted)
+				{	// in case the operation is interrupted (the method is called from
+					// Apply callbacks, so the exception is thrown after the Apply)
+					return false;
+				}
+
+				SFTA_STATISTICS(CountPairProcessed());
+
 /*				if (isInclusionCached(disjunct))
 				{
 					return true;
 				}
 				else */if (isNoninclusionCached(disjunct))
 				{
+					SFTA_STATISTICS(CountCache(true));
 					return false;
 				}
-				else if (isImpliedByWorkset(disjunct))
+
+				SFTA_STATISTICS(CountCache(false));
+
+				if (isImpliedByWorkset(disjunct))
 				{
+					SFTA_STATISTICS(CountWorkset(true));
 					return true;
 				}
-				else if (expandSubset(disjunct))
+
+				SFTA_STATISTICS(CountWorkset(false));
+
+				if (expandSubset(disjunct))
 				{
 //					cacheInclusion(disjunct);
 					return true;
@@ -614,10 +860,7 @@ public:   // Public data types
 
 					virtual LeafType operator()(const LeafType& lhs, const LeafType& rhs)
 					{
-						LeafType result = lhs;
-						result.insert(rhs);
-
-						return result;
+						return lhs.Union(rhs);
 					}
 				};
 
@@ -884,17 +1127,22 @@ public:   // Public data types
 					}
 
 
-					bool checkInclusion(const std::vector<StateType>& sm,
-						const std::vector<SFTA::Private::ElemOrVector<StateType> >& bigger)
+					bool checkInclusion(
+						const typename SFTA::Private::ElemOrVector<StateType>::VectorView& sm,
+						const LeafType& bigger)
 					{
 						unsigned arity = sm.size();
 
+						// the nodes of the AND-OR tree are reclaimed at the end of the check
+						SFTA::Private::MonotonicArena& arena = inclFunc_->arena_;
+						SFTA::Private::MonotonicArena::Scope arenaScope(arena);
+
 						// the workqueue
 						std::queue<OrNode*> nodeQueue;
 
 						// create the root nodes
-						OrNode* root = new OrNode();
-						root->disjuncts_.push_back(new AndNode(root, 1, bigger.size()));
+						OrNode* root = new (arena) OrNode();
+						root->disjuncts_.push_back(new (arena) AndNode(root, 1, bigger.size()));
 
 						typedef std::tr1::unordered_map<ChoiceFunctionType, OrNode*, HasherNnary>
 						 	CFOrHashTableType;
@@ -945,6 +1193,7 @@ public:   // Public data types
 										// andNode->choiceFunctions_ and 'realPosition' is the
 										// absolute position of the AndNode
 										incrementIndex = true;
+										SFTA_STATISTICS(CountChoiceFunction());
 
 										const ChoiceFunctionType& cf = andNode->choiceFunctions_[index].first;
 										assert(andNode->choiceFunctions_[index].second == static_cast<OrNode*>(0));
@@ -979,7 +1228,7 @@ public:   // Public data types
 											}
 											else
 											{	// in case we haven't seen the OrNode yet
-												OrNode* newOrNode = new OrNode(andNode);
+												OrNode* newOrNode = new (arena) OrNode(andNode);
 												andNode->choiceFunctions_[index].second = newOrNode;
 
 												bool foundNew = false;
@@ -988,7 +1237,7 @@ public:   // Public data types
 													if (cf[i] == 0)
 													{
 														foundNew = true;
-														AndNode* newAnd = new AndNode(newOrNode, arity, cf);
+														AndNode* newAnd = new (arena) AndNode(newOrNode, arity, cf);
 														for (size_t ind = 0; ind < arity; ++ind)
 														{
 															newAnd->choiceFunctions_[ind].first[i] = ind + 1;
@@ -1061,13 +1310,10 @@ public:   // Public data types
 							}
 						}
 
-						const std::vector<SFTA::Private::ElemOrVector<StateType> >& rhsVector =
-							rhs.ToVector();
-
 						for (typename LeafType::const_iterator itLhs = lhs.begin();
 							itLhs != lhs.end(); ++itLhs)
 						{
-							if (!checkInclusion(itLhs->GetVector(), rhsVector))
+							if (!checkInclusion(itLhs->GetVector(), rhs))
 							{
 								doesInclusionHold_ = false;
 								break;
@@ -1085,7 +1331,7 @@ public:   // Public data types
 				RootType unionBigger = mtbdd->CreateRoot();
 				UnionApplyFunctor unionFunc;
 
-				for (typename StateVector::const_iterator itBiggerStates =
+				for (typename StateSetType::const_iterator itBiggerStates =
 					biggerSetOfStates.begin(); itBiggerStates != biggerSetOfStates.end();
 					++itBiggerStates)
 				{
@@ -1121,7 +1367,8 @@ public:   // Public data types
 					includedNodes_(),
 					nonincludedNodes_(),
 					simSmaller_(simSmaller),
-					simBigger_(simBigger)
+					simBigger_(simBigger),
+					arena_()
 			{
 				// Assertions
 				assert(smallerAut_ != static_cast<Type*>(0));
@@ -1184,10 +1431,10 @@ public:   // Public data types
 
 		Type* langUnion(const Type& a1, const Type& a2) const
 		{
-			Type* result = new Type(a1);
+			std::auto_ptr<Type> result(new Type(a1));
 			result->CopyStates(a2);
 
-			return result;
+			return result.release();
 		}
 
 		Type* langIntersection(const Type& a1, const Type& a2) const
@@ -1201,11 +1448,15 @@ public:   // Public data types
 
 		virtual Type* Union(const HierarchyRoot* a1, const HierarchyRoot* a2) const
 		{
+			SFTA_TRACE_SPAN("NDSymbolicTDTreeAutomaton::Operation::Union");
+
 			return safelyPerformOperation(&Operation::langUnion, a1, a2);
 		}
 
 		virtual Type* Intersection(const HierarchyRoot* a1, const HierarchyRoot* a2) const
 		{
+			SFTA_TRACE_SPAN("NDSymbolicTDTreeAutomaton::Operation::Intersection");
+
 			return safelyPerformOperation(&Operation::langIntersection, a1, a2);
 		}
 
@@ -1266,8 +1517,15 @@ public:   // Public data types
 				throw std::runtime_error(__func__ + std::string(": Invalid type"));
 			}
 
+			SFTA_TRACE_SPAN("NDSymbolicTDTreeAutomaton::Operation::CheckLanguageInclusion");
+
 			InclusionCheckingFunctor inclFunc(a1Sym, a2Sym, simA1, simA2);
-			return inclFunc();
+			bool result = inclFunc();
+
+			// the result is unknown in case the operation was interrupted
+			OperationContext::ThrowIfInterrupted();
+
+			return result;
 		}
 	};
 
@@ -0,0 +1,385 @@
+/*****************************************************************************
+ *  Symbolic Finite Tree Automata Library
+ *
+ *  Description:
+ *    Header file with the OperationContext class, which carries a deadline,
+ *    a cancellation flag and a memory budget of an operation, and with the
+ *    OperationInterrupted exception.
+ *
+ *****************************************************************************/
+
+#ifndef _SFTA_OPERATION_CONTEXT_HH_
+#define _SFTA_OPERATION_CONTEXT_HH_
+
+// Standard library headers
+#include <csignal>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+
+// POSIX headers
+#include <time.h>
+#include <unistd.h>
+
+// Boost headers
+#include <boost/cstdint.hpp>
+
+
+// insert the classes into proper namespace
+namespace SFTA
+{
+	class OperationContext;
+	class OperationInterrupted;
+}
+
+
+/**
+ * @brief   Exception of an interrupted operation
+ *
+ * The exception thrown by an operation that was interrupted at a safe point
+ * because the deadline of its SFTA::OperationContext passed, the context was
+ * cancelled or the memory budget was exceeded. The result of the operation
+ * is then unknown; automata that were arguments of the operation are left
+ * intact.
+ */
+class SFTA::OperationInterrupted : public std::runtime_error
+{
+public:   // Public data types
+
+	enum Reason
+	{
+		NotInterrupted,
+		DeadlineExpired,
+		Cancelled,
+		MemoryBudgetExceeded
+	};
+
+private:  // Private data members
+
+	Reason reason_;
+
+public:   // Public methods
+
+	explicit OperationInterrupted(Reason reason)
+		: std::runtime_error(ReasonToString(reason)),
+			reason_(reason)
+	{ }
+
+	inline Reason GetReason() const
+	{
+		return reason_;
+	}
+
+	static const char* ReasonToString(Reason reason)
+	{
+		switch (reason)
+		{
+			case DeadlineExpired:      return "deadline";
+			case Cancelled:            return "cancelled";
+			case MemoryBudgetExceeded: return "memory";
+			default:                   return "not interrupted";
+		}
+	}
+};
+
+
+/**
+ * @brief   Context of an operation
+ *
+ * Limits of a long running operation: a deadline (measured by the monotonic
+ * clock), a cooperative cancellation flag (which may be set from a signal
+ * handler or another thread) and a budget of the resident memory of the
+ * process. The operation polls the context made current by a Scope guard at
+ * safe points (the worklists of inclusion checking, the refinement loop of
+ * simulation computation and Apply callbacks) and is interrupted by
+ * SFTA::OperationInterrupted once any of the limits is hit.
+ *
+ * The clock and the memory are sampled only every CheckInterval polls, so
+ * that a poll usually costs a test of the cancellation flag and an
+ * increment of a counter.
+ */
+class SFTA::OperationContext
+{
+public:   // Public data types
+
+	/**
+	 * @brief  Guard of the current context
+	 *
+	 * Makes given context current in the calling thread for the lifetime of
+	 * the guard and restores the previously current context afterwards.
+	 */
+	class Scope
+	{
+	private:  // Private data members
+
+		OperationContext* previous_;
+
+	private:  // Private methods
+
+		Scope(const Scope&);
+		Scope& operator=(const Scope&);
+
+	public:   // Public methods
+
+		explicit Scope(OperationContext* context)
+			: previous_(current())
+		{
+			if (context != static_cast<OperationContext*>(0))
+			{	// in case the operation is limited
+				current() = context;
+			}
+		}
+
+		~Scope()
+		{
+			current() = previous_;
+		}
+	};
+
+private:  // Private data types
+
+	enum
+	{
+		// the number of polls between two samples of the clock and memory
+		CheckInterval = 256
+	};
+
+private:  // Private data members
+
+	/// The deadline in microseconds of the monotonic clock (0 for none)
+	boost::uint64_t deadline_;
+
+	/// The memory budget in bytes (0 for none)
+	size_t memoryBudget_;
+
+	volatile std::sig_atomic_t cancelled_;
+
+	OperationInterrupted::Reason reason_;
+
+	size_t pollCounter_;
+
+private:  // Private methods
+
+	OperationContext(const OperationContext&);
+	OperationContext& operator=(const OperationContext&);
+
+	/**
+	 * @brief  The current context of the thread
+	 *
+	 * Every thread has its own current context, so that operations on
+	 * independent managers running in different threads do not see each
+	 * other's limits.
+	 */
+	static OperationContext*& current()
+	{
+		static __thread OperationContext* context = static_cast<OperationContext*>(0);
+		return context;
+	}
+
+	static boost::uint64_t now()
+	{
+		timespec now;
+		clock_gettime(CLOCK_MONOTONIC, &now);
+
+		return static_cast<boost::uint64_t>(now.tv_sec) * 1000000 +
+			static_cast<boost::uint64_t>(now.tv_nsec) / 1000;
+	}
+
+	/**
+	 * @brief  Returns the resident memory of the process
+	 *
+	 * Returns the resident set size of the process in bytes (read from
+	 * /proc/self/statm), or 0 if it is not available.
+	 */
+	static size_t residentMemory()
+	{
+		std::FILE* statm = std::fopen("/proc/self/statm", "r");
+		if (statm == static_cast<std::FILE*>(0))
+		{	// in case the file is not available
+			return 0;
+		}
+
+		unsigned long size = 0;
+		unsigned long resident = 0;
+		if (std::fscanf(statm, "%lu %lu", &size, &resident) != 2)
+		{
+			resident = 0;
+		}
+
+		std::fclose(statm);
+
+		return static_cast<size_t>(resident) *
+			static_cast<size_t>(sysconf(_SC_PAGESIZE));
+	}
+
+	void sample()
+	{
+		if ((deadline_ != 0) && (now() >= deadline_))
+		{
+			reason_ = OperationInterrupted::DeadlineExpired;
+		}
+		else if ((memoryBudget_ != 0) && (residentMemory() > memoryBudget_))
+		{
+			reason_ = OperationInterrupted::MemoryBudgetExceeded;
+		}
+	}
+
+public:   // Public methods
+
+	OperationContext()
+		: deadline_(0),
+			memoryBudget_(0),
+			cancelled_(0),
+			reason_(OperationInterrupted::NotInterrupted),
+			pollCounter_(0)
+	{ }
+
+	/**
+	 * @brief  Sets the deadline
+	 *
+	 * Sets the deadline to @p seconds from now. Non-positive @p seconds
+	 * remove the deadline.
+	 *
+	 * @param[in]  seconds  The time available to the operation
+	 */
+	void SetTimeout(double seconds)
+	{
+		deadline_ = (seconds > 0)?
+			now() + static_cast<boost::uint64_t>(seconds * 1000000) : 0;
+	}
+
+	/**
+	 * @brief  Sets the memory budget
+	 *
+	 * Sets the maximum resident memory of the process. Zero @p bytes remove
+	 * the budget.
+	 *
+	 * @param[in]  bytes  The budget in bytes
+	 */
+	inline void SetMemoryBudget(size_t bytes)
+	{
+		memoryBudget_ = bytes;
+	}
+
+	/**
+	 * @brief  Cancels the operation
+	 *
+	 * Requests the operation to stop at the next safe point. Only sets
+	 * a flag, so it is safe to be called from a signal handler.
+	 */
+	inline void Cancel()
+	{
+		cancelled_ = 1;
+	}
+
+	/**
+	 * @brief  Clears the interruption
+	 *
+	 * Clears the cancellation flag and a recorded interruption so that the
+	 * context can be reused (the deadline and the budget are kept).
+	 */
+	void Reset()
+	{
+		cancelled_ = 0;
+		reason_ = OperationInterrupted::NotInterrupted;
+		pollCounter_ = 0;
+	}
+
+	/**
+	 * @brief  Polls the context
+	 *
+	 * Checks the limits and returns the reason of the interruption, or
+	 * OperationInterrupted::NotInterrupted if the operation may continue.
+	 * Once the operation is interrupted, the reason is kept until Reset().
+	 */
+	inline OperationInterrupted::Reason Poll()
+	{
+		if (reason_ == OperationInterrupted::NotInterrupted)
+		{
+			if (cancelled_ != 0)
+			{
+				reason_ = OperationInterrupted::Cancelled;
+			}
+			else if (++pollCounter_ % CheckInterval == 0)
+			{
+				sample();
+			}
+		}
+
+		return reason_;
+	}
+
+	/**
+	 * @brief  Checks the context
+	 *
+	 * Throws SFTA::OperationInterrupted if the operation is to be
+	 * interrupted.
+	 */
+	inline void Check()
+	{
+		OperationInterrupted::Reason reason = Poll();
+		if (reason != OperationInterrupted::NotInterrupted)
+		{
+			throw OperationInterrupted(reason);
+		}
+	}
+
+	/**
+	 * @brief  Returns the current context
+	 *
+	 * Returns the context of the operation currently running in the calling
+	 * thread, or null pointer if the operation is not limited.
+	 */
+	static inline OperationContext* GetCurrent()
+	{
+		return current();
+	}
+
+	/**
+	 * @brief  Polls the current context
+	 *
+	 * Does not throw, so that it may be used in callbacks called from C
+	 * code.
+	 *
+	 * @see  Poll()
+	 */
+	static inline OperationInterrupted::Reason PollCurrent()
+	{
+		OperationContext* context = current();
+		return (context == static_cast<OperationContext*>(0))?
+			OperationInterrupted::NotInterrupted : context->Poll();
+	}
+
+	/**
+	 * @brief  Checks the current context
+	 *
+	 * @see  Check()
+	 */
+	static inline void CheckCurrent()
+	{
+		OperationContext* context = current();
+		if (context != static_cast<OperationContext*>(0))
+		{
+			context->Check();
+		}
+	}
+
+	/**
+	 * @brief  Checks for an interruption seen by a poll
+	 *
+	 * Throws SFTA::OperationInterrupted if a previous poll of the current
+	 * context found out that the operation is to be interrupted, without
+	 * polling again.
+	 */
+	static inline void ThrowIfInterrupted()
+	{
+		OperationContext* context = current();
+		if ((context != static_cast<OperationContext*>(0)) &&
+			(context->reason_ != OperationInterrupted::NotInterrupted))
+		{
+			throw OperationInterrupted(context->reason_);
+		}
+	}
+};
+
+#endif
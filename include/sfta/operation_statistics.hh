@@ -0,0 +1,453 @@
+/*****************************************************************************
+ *  Symbolic Finite Tree Automata Library
+ *
+ *  Description:
+ *    File with the OperationStatistics class and macros for collecting
+ *    statistics of operations.
+ *
+ *****************************************************************************/
+
+#ifndef _SFTA_OPERATION_STATISTICS_HH_
+#define _SFTA_OPERATION_STATISTICS_HH_
+
+// Standard library headers
+#include <cstdlib>
+#include <cxxabi.h>
+#include <map>
+#include <sstream>
+#include <string>
+#include <typeinfo>
+#include <utility>
+#include <vector>
+
+
+// insert the class into proper namespace
+namespace SFTA
+{
+	class OperationStatistics;
+}
+
+
+/**
+ * @brief  Records statistics of an operation
+ *
+ * Runs @p call as a method call on the statistics object of the currently
+ * running operation (if there is any). Compiles to nothing unless
+ * SFTA_ENABLE_STATISTICS is defined.
+ */
+#ifdef SFTA_ENABLE_STATISTICS
+# define SFTA_STATISTICS(call) \
+	do \
+	{ \
+		SFTA::OperationStatistics* sftaStatistics = \
+			SFTA::OperationStatistics::GetCurrent(); \
+		if (sftaStatistics != static_cast<SFTA::OperationStatistics*>(0)) \
+		{ \
+			sftaStatistics->call; \
+		} \
+	} while (false)
+#else
+# define SFTA_STATISTICS(call) static_cast<void>(0)
+#endif
+
+
+/**
+ * @brief  Makes statistics current for the rest of the block
+ *
+ * Declares a guard that makes @p stats the statistics object of the currently
+ * running operation until the end of the enclosing block. Compiles to
+ * nothing unless SFTA_ENABLE_STATISTICS is defined.
+ */
+#ifdef SFTA_ENABLE_STATISTICS
+# define SFTA_STATISTICS_SCOPE(stats) \
+	SFTA::OperationStatistics::Scope sftaStatisticsScope(stats)
+#else
+# define SFTA_STATISTICS_SCOPE(stats) static_cast<void>(0)
+#endif
+
+
+/**
+ * @brief   Statistics of an operation
+ *
+ * Class that collects counters describing the run of an operation on
+ * automata: the size of the antichain over time, the number of processed
+ * pairs, subsumption hits, hits and misses of the caches of the downward
+ * inclusion, the number of enumerated choice functions, the number of
+ * Apply calls per functor type, the number of created leaves and the
+ * high-water mark of MTBDD roots.
+ *
+ * The counters are updated only through the SFTA_STATISTICS() macro, which
+ * refers to the statistics made current by SFTA_STATISTICS_SCOPE(), so that
+ * the collection compiles to nothing unless SFTA_ENABLE_STATISTICS is
+ * defined.
+ */
+class SFTA::OperationStatistics
+{
+public:   // Public data types
+
+	/**
+	 * @brief  Sample of the size of the antichain
+	 *
+	 * The number of pairs processed so far and the size of the antichain at
+	 * that moment.
+	 */
+	typedef std::pair<size_t, size_t> SampleType;
+
+	typedef std::vector<SampleType> SampleVector;
+
+	typedef std::map<std::string, size_t> CounterMap;
+
+
+	/**
+	 * @brief  Guard of current statistics
+	 *
+	 * Makes given statistics current in the calling thread for the lifetime
+	 * of the guard and restores the previously current statistics
+	 * afterwards.
+	 */
+	class Scope
+	{
+	private:  // Private data members
+
+		OperationStatistics* previous_;
+
+	private:  // Private methods
+
+		Scope(const Scope&);
+		Scope& operator=(const Scope&);
+
+	public:   // Public methods
+
+		explicit Scope(OperationStatistics* stats)
+			: previous_(current())
+		{
+			current() = stats;
+		}
+
+		~Scope()
+		{
+			current() = previous_;
+		}
+	};
+
+private:  // Private data types
+
+	enum
+	{
+		// the maximum number of kept samples of the antichain size
+		MaxSamples = 256
+	};
+
+private:  // Private data members
+
+	size_t pairsProcessed_;
+	size_t antichainSize_;
+	size_t antichainMaximum_;
+	size_t subsumptionHits_;
+	size_t worksetHits_;
+	size_t worksetMisses_;
+	size_t cacheHits_;
+	size_t cacheMisses_;
+	size_t choiceFunctions_;
+	size_t leavesCreated_;
+	size_t rootHighWaterMark_;
+
+	CounterMap applyCalls_;
+
+	SampleVector antichainSamples_;
+
+	/**
+	 * @brief  Sampling interval
+	 *
+	 * The number of processed pairs between two samples of the antichain
+	 * size. Doubles whenever the number of samples reaches MaxSamples so that
+	 * the memory needed for the samples is bounded.
+	 */
+	size_t sampleInterval_;
+
+private:  // Private methods
+
+	static OperationStatistics*& current()
+	{
+		// every thread collects the statistics of its own operation
+		static __thread OperationStatistics* stats =
+			static_cast<OperationStatistics*>(0);
+		return stats;
+	}
+
+	static std::string shortTypeName(const std::string& mangled)
+	{
+		// types with internal linkage are marked with a leading asterisk
+		std::string symbol = mangled.substr(
+			(!mangled.empty() && (mangled[0] == '*'))? 1 : 0);
+
+		int status = 0;
+		char* demangled = abi::__cxa_demangle(symbol.c_str(),
+			static_cast<char*>(0), static_cast<size_t*>(0), &status);
+
+		std::string name = (status == 0)? demangled : symbol;
+		std::free(demangled);
+
+		// strip the (usually very long) enclosing scopes
+		size_t start = 0;
+		int depth = 0;
+		for (size_t i = 0; i + 1 < name.size(); ++i)
+		{
+			switch (name[i])
+			{
+				case '<': case '(': ++depth; break;
+				case '>': case ')': --depth; break;
+				case ':':
+					if ((depth == 0) && (name[i + 1] == ':'))
+					{
+						start = i + 2;
+						++i;
+					}
+					break;
+				default: break;
+			}
+		}
+
+		return name.substr(start);
+	}
+
+	void sampleAntichain()
+	{
+		antichainSamples_.push_back(std::make_pair(pairsProcessed_, antichainSize_));
+
+		if (antichainSamples_.size() >= MaxSamples)
+		{	// drop every other sample
+			for (size_t i = 0; 2 * i < antichainSamples_.size(); ++i)
+			{
+				antichainSamples_[i] = antichainSamples_[2 * i];
+			}
+
+			antichainSamples_.resize((antichainSamples_.size() + 1) / 2);
+			sampleInterval_ *= 2;
+		}
+	}
+
+public:   // Public methods
+
+	OperationStatistics()
+		: pairsProcessed_(0),
+			antichainSize_(0),
+			antichainMaximum_(0),
+			subsumptionHits_(0),
+			worksetHits_(0),
+			worksetMisses_(0),
+			cacheHits_(0),
+			cacheMisses_(0),
+			choiceFunctions_(0),
+			leavesCreated_(0),
+			rootHighWaterMark_(0),
+			applyCalls_(),
+			antichainSamples_(),
+			sampleInterval_(1)
+	{ }
+
+	/**
+	 * @brief  Returns current statistics
+	 *
+	 * Returns the statistics of the operation currently running in the
+	 * calling thread, or null pointer if no statistics are being collected.
+	 */
+	static OperationStatistics* GetCurrent()
+	{
+		return current();
+	}
+
+	/**
+	 * @brief  Are statistics collected?
+	 *
+	 * Returns true if the library was compiled with SFTA_ENABLE_STATISTICS.
+	 */
+	static bool IsEnabled()
+	{
+#ifdef SFTA_ENABLE_STATISTICS
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	inline void CountPairProcessed()
+	{
+		if (pairsProcessed_ % sampleInterval_ == 0)
+		{
+			sampleAntichain();
+		}
+
+		++pairsProcessed_;
+	}
+
+	inline void AntichainInsert()
+	{
+		++antichainSize_;
+		if (antichainSize_ > antichainMaximum_)
+		{
+			antichainMaximum_ = antichainSize_;
+		}
+	}
+
+	inline void AntichainRemove()
+	{
+		if (antichainSize_ > 0)
+		{
+			--antichainSize_;
+		}
+	}
+
+	inline void CountSubsumptionHit()
+	{
+		++subsumptionHits_;
+	}
+
+	inline void CountWorkset(bool hit)
+	{
+		++(hit? worksetHits_ : worksetMisses_);
+	}
+
+	inline void CountCache(bool hit)
+	{
+		++(hit? cacheHits_ : cacheMisses_);
+	}
+
+	inline void CountChoiceFunction()
+	{
+		++choiceFunctions_;
+	}
+
+	inline void CountApply(const std::type_info& functorType)
+	{
+		++applyCalls_[functorType.name()];
+	}
+
+	inline void CountLeafCreated()
+	{
+		++leavesCreated_;
+	}
+
+	inline void RecordRootCount(size_t roots)
+	{
+		if (roots > rootHighWaterMark_)
+		{
+			rootHighWaterMark_ = roots;
+		}
+	}
+
+	inline size_t GetPairsProcessed() const
+	{
+		return pairsProcessed_;
+	}
+
+	inline size_t GetAntichainMaximum() const
+	{
+		return antichainMaximum_;
+	}
+
+	inline const SampleVector& GetAntichainSamples() const
+	{
+		return antichainSamples_;
+	}
+
+	inline size_t GetSubsumptionHits() const
+	{
+		return subsumptionHits_;
+	}
+
+	inline size_t GetWorksetHits() const
+	{
+		return worksetHits_;
+	}
+
+	inline size_t GetWorksetMisses() const
+	{
+		return worksetMisses_;
+	}
+
+	inline size_t GetCacheHits() const
+	{
+		return cacheHits_;
+	}
+
+	inline size_t GetCacheMisses() const
+	{
+		return cacheMisses_;
+	}
+
+	inline size_t GetChoiceFunctions() const
+	{
+		return choiceFunctions_;
+	}
+
+	/**
+	 * @brief  Returns the numbers of Apply calls
+	 *
+	 * Returns the numbers of Apply calls indexed by the (mangled) name of the
+	 * type of the Apply functor.
+	 */
+	inline const CounterMap& GetApplyCalls() const
+	{
+		return applyCalls_;
+	}
+
+	inline size_t GetLeavesCreated() const
+	{
+		return leavesCreated_;
+	}
+
+	inline size_t GetRootHighWaterMark() const
+	{
+		return rootHighWaterMark_;
+	}
+
+	/**
+	 * @brief  Clears all counters
+	 */
+	void Reset()
+	{
+		*this = OperationStatistics();
+	}
+
+	/**
+	 * @brief  Serializes the statistics
+	 *
+	 * Returns the statistics as a JSON object.
+	 */
+	std::string ToString() const
+	{
+		std::ostringstream os;
+
+		os << "{\"enabled\": " << (IsEnabled()? "true" : "false")
+			<< ", \"pairs_processed\": " << pairsProcessed_
+			<< ", \"antichain\": {\"max\": " << antichainMaximum_
+			<< ", \"final\": " << antichainSize_ << ", \"samples\": [";
+		for (size_t i = 0; i < antichainSamples_.size(); ++i)
+		{
+			os << ((i == 0)? "" : ", ") << "[" << antichainSamples_[i].first
+				<< ", " << antichainSamples_[i].second << "]";
+		}
+
+		os << "]}, \"subsumption_hits\": " << subsumptionHits_
+			<< ", \"workset\": {\"hits\": " << worksetHits_
+			<< ", \"misses\": " << worksetMisses_ << "}"
+			<< ", \"noninclusion_cache\": {\"hits\": " << cacheHits_
+			<< ", \"misses\": " << cacheMisses_ << "}"
+			<< ", \"choice_functions\": " << choiceFunctions_
+			<< ", \"apply_calls\": {";
+		for (CounterMap::const_iterator itApply = applyCalls_.begin();
+			itApply != applyCalls_.end(); ++itApply)
+		{
+			os << ((itApply == applyCalls_.begin())? "" : ", ") << "\""
+				<< shortTypeName(itApply->first) << "\": " << itApply->second;
+		}
+
+		os << "}, \"leaves_created\": " << leavesCreated_
+			<< ", \"root_high_water_mark\": " << rootHighWaterMark_ << "}";
+
+		return os.str();
+	}
+};
+
+#endif
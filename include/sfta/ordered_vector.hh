@@ -12,11 +12,20 @@
 #define _SFTA_ORDERED_VECTOR_HH_
 
 // Standard library header files
+#include <cassert>
+#include <new>
 #include <vector>
 #include <algorithm>
+#include <memory>
+
+// Boost library headers
+#include <boost/aligned_storage.hpp>
+#include <boost/functional/hash.hpp>
+#include <boost/type_traits/alignment_of.hpp>
 
 // SFTA header files
 #include <sfta/convert.hh>
+#include <sfta/memory_usage.hh>
 
 
 // insert the class into proper namespace
@@ -36,6 +45,16 @@ namespace SFTA
  * This class implements the interface of a set (the same interface as
  * std::set) using ordered vector as the underlying data structure.
  *
+ * Small sets (up to InlineCapacity elements, i.e. at most 8 elements and 64
+ * bytes) are stored inline in the object and do not allocate any memory on
+ * the heap. Operations on two sets (union, intersection, difference and
+ * subset test) are linear merges of the underlying arrays.
+ *
+ * The set also maintains its hash value incrementally (as a sum of mixed
+ * hashes of its elements, so that it does not depend on the order), which
+ * makes hashing of a set constant-time and speeds up comparison of
+ * different sets. Elements therefore need to be hashable by boost::hash.
+ *
  * @tparam  Key  Key type: type of the elements contained in the container.
  *               Each elements in a set is also its key.
  */
@@ -51,25 +70,117 @@ private:  // Private data types
 
 	typedef std::vector<Key> VectorType;
 
+	enum
+	{
+		InlineBytes = 64,
+		MaxInlineCapacity = 8
+	};
+
+	enum
+	{
+		InlineCapacity = (sizeof(Key) >= InlineBytes)? 1 :
+			((InlineBytes / sizeof(Key) > static_cast<size_t>(MaxInlineCapacity))?
+			static_cast<size_t>(MaxInlineCapacity) : InlineBytes / sizeof(Key))
+	};
+
+	typedef typename boost::aligned_storage
+		<
+			InlineCapacity * sizeof(Key),
+			boost::alignment_of<Key>::value
+		>::type InlineStorageType;
+
 public:   // Public data types
 
-	typedef typename VectorType::iterator iterator;
-	typedef typename VectorType::const_iterator const_iterator;
-	typedef typename VectorType::const_reference const_reference;
+	typedef Key* iterator;
+	typedef const Key* const_iterator;
+	typedef const Key& const_reference;
 
 private:  // Private data members
 
-	VectorType vec_;
+
+	/**
+	 * @brief  Inline storage
+	 *
+	 * Raw storage for the elements in case there is at most InlineCapacity of
+	 * them.
+	 */
+	InlineStorageType inlineStorage_;
+
+
+	/**
+	 * @brief  The array of elements
+	 *
+	 * Points either to the inline storage or to a block on the heap.
+	 */
+	Key* data_;
+
+
+	/**
+	 * @brief  The number of elements
+	 */
+	size_t size_;
+
+
+	/**
+	 * @brief  The number of elements the array can hold
+	 */
+	size_t capacity_;
+
+
+	/**
+	 * @brief  The hash value of the set
+	 *
+	 * The sum of elementHash() of all elements of the set.
+	 */
+	size_t hash_;
 
 
 private:  // Private methods
 
+	inline Key* inlineData()
+	{
+		return static_cast<Key*>(static_cast<void*>(&inlineStorage_));
+	}
+
+	inline const Key* inlineData() const
+	{
+		return static_cast<const Key*>(static_cast<const void*>(&inlineStorage_));
+	}
+
+	inline bool isInline() const
+	{
+		return data_ == inlineData();
+	}
+
+	/**
+	 * @brief  Hash of an element
+	 *
+	 * Returns the hash of an element with well mixed bits, so that the sum of
+	 * such hashes is a reasonable hash of the whole set.
+	 *
+	 * @param[in]  x  The element
+	 *
+	 * @returns  The hash of the element
+	 */
+	static inline size_t elementHash(const Key& x)
+	{
+		size_t hash = boost::hash<Key>()(x);
+
+		// the finalizer of MurmurHash3
+		hash ^= hash >> 16;
+		hash *= 0x85ebca6b;
+		hash ^= hash >> 13;
+		hash *= 0xc2b2ae35;
+		hash ^= hash >> 16;
+
+		return hash;
+	}
+
 	bool vectorIsSorted() const
 	{
-		for (typename VectorType::const_iterator itVec = vec_.begin() + 1;
-			itVec < vec_.end(); ++itVec)
+		for (size_t i = 1; i < size_; ++i)
 		{	// check that the vector is sorted
-			if (!(*(itVec - 1) < *itVec))
+			if (!(data_[i - 1] < data_[i]))
 			{	// in case there is an unordered pair (or there is one element twice)
 				return false;
 			}
@@ -78,11 +189,163 @@ private:  // Private methods
 		return true;
 	}
 
+	/**
+	 * @brief  Destroys all elements
+	 *
+	 * Calls destructors of all elements, the storage is kept.
+	 */
+	void destroyElements()
+	{
+		for (size_t i = 0; i < size_; ++i)
+		{	// destroy all elements
+			data_[i].~Key();
+		}
+
+		size_ = 0;
+	}
+
+	/**
+	 * @brief  Makes sure there is enough space
+	 *
+	 * Makes sure that the array can hold at least @p capacity elements. In
+	 * case the array needs to be reallocated, its capacity is at least
+	 * doubled.
+	 *
+	 * @param[in]  capacity  The desired capacity
+	 */
+	void reserve(size_t capacity)
+	{
+		if (capacity <= capacity_)
+		{	// in case there is enough space
+			return;
+		}
+
+		capacity = std::max(capacity, 2 * capacity_);
+
+		Key* newData = static_cast<Key*>(::operator new(capacity * sizeof(Key)));
+
+		try
+		{
+			std::uninitialized_copy(data_, data_ + size_, newData);
+		}
+		catch (...)
+		{
+			::operator delete(newData);
+			throw;
+		}
+
+		size_t size = size_;
+		destroyElements();
+		if (!isInline())
+		{	// in case the old array is on the heap
+			::operator delete(data_);
+		}
+
+		data_ = newData;
+		size_ = size;
+		capacity_ = capacity;
+	}
+
+	/**
+	 * @brief  Appends an element
+	 *
+	 * Appends an element at the end of the array. The caller needs to make
+	 * sure that there is enough space and that the array stays sorted.
+	 *
+	 * @param[in]  x  The element
+	 */
+	inline void pushBack(const Key& x)
+	{
+		// Assertions
+		assert(size_ < capacity_);
+
+		new (data_ + size_) Key(x);
+		++size_;
+	}
+
+	/**
+	 * @brief  Stores an element at given position
+	 *
+	 * Stores the element at given position of the array, constructing it in
+	 * case the position is beyond the @p constructed first elements.
+	 */
+	inline void putAt(size_t pos, const Key& x, size_t constructed)
+	{
+		if (pos < constructed)
+		{	// in case there is an element in the place
+			data_[pos] = x;
+		}
+		else
+		{	// in case the place is raw memory
+			new (data_ + pos) Key(x);
+		}
+	}
+
+	/**
+	 * @brief  Copies elements of other set
+	 *
+	 * Copies all elements of @p rhs into the (empty) set.
+	 */
+	void copyElements(const OrderedVector& rhs)
+	{
+		// Assertions
+		assert(size_ == 0);
+
+		reserve(rhs.size_);
+		std::uninitialized_copy(rhs.data_, rhs.data_ + rhs.size_, data_);
+		size_ = rhs.size_;
+		hash_ = rhs.hash_;
+	}
+
+	/**
+	 * @brief  Size of union
+	 *
+	 * Computes the number of elements of the union with @p rhs without
+	 * actually constructing the union.
+	 *
+	 * @param[in]   rhs         The other set
+	 * @param[out]  commonHash  The sum of hashes of common elements
+	 *
+	 * @returns  The number of elements of the union
+	 */
+	size_t unionSize(const OrderedVector& rhs, size_t& commonHash) const
+	{
+		size_t result = size_ + rhs.size_;
+		commonHash = 0;
+
+		const Key* lhsIt = data_;
+		const Key* rhsIt = rhs.data_;
+		while ((lhsIt != end()) && (rhsIt != rhs.end()))
+		{	// subtract the number of common elements
+			if (*lhsIt < *rhsIt)
+			{
+				++lhsIt;
+			}
+			else if (*rhsIt < *lhsIt)
+			{
+				++rhsIt;
+			}
+			else
+			{	// in case they are equal
+				--result;
+				commonHash += elementHash(*lhsIt);
+				++lhsIt;
+				++rhsIt;
+			}
+		}
+
+		return result;
+	}
+
 
 public:   // Public methods
 
 	OrderedVector()
-		: vec_()
+		: inlineStorage_(),
+			data_(inlineData()),
+			size_(0),
+			capacity_(InlineCapacity),
+			hash_(0)
 	{
 		// Assertions
 		assert(vectorIsSorted());
@@ -90,19 +353,45 @@ public:   // Public methods
 
 
 	explicit OrderedVector(const VectorType& vec)
-		: vec_(vec)
+		: inlineStorage_(),
+			data_(inlineData()),
+			size_(0),
+			capacity_(InlineCapacity),
+			hash_(0)
 	{
+		VectorType sorted(vec);
+
 		// sort
-		std::sort(vec_.begin(), vec_.end());
+		std::sort(sorted.begin(), sorted.end());
 
 		// remove duplicates
-		typename VectorType::iterator it = std::unique(vec_.begin(), vec_.end());
-		vec_.resize(it - vec_.begin());
+		typename VectorType::iterator it = std::unique(sorted.begin(), sorted.end());
+
+		reserve(it - sorted.begin());
+		for (typename VectorType::const_iterator itVec = sorted.begin();
+			itVec != it; ++itVec)
+		{	// copy the unique elements
+			pushBack(*itVec);
+			hash_ += elementHash(*itVec);
+		}
 
 		// Assertions
 		assert(vectorIsSorted());
 	}
 
+	OrderedVector(const OrderedVector& vec)
+		: inlineStorage_(),
+			data_(inlineData()),
+			size_(0),
+			capacity_(InlineCapacity),
+			hash_(0)
+	{
+		// Assertions
+		assert(vec.vectorIsSorted());
+
+		copyElements(vec);
+	}
+
 	OrderedVector& operator=(const OrderedVector& rhs)
 	{
 		// Assertions
@@ -110,7 +399,8 @@ public:   // Public methods
 
 		if (&rhs != this)
 		{
-			vec_ = rhs.vec_;
+			destroyElements();
+			copyElements(rhs);
 		}
 
 		// Assertions
@@ -119,73 +409,233 @@ public:   // Public methods
 		return *this;
 	}
 
+	~OrderedVector()
+	{
+		destroyElements();
+		if (!isInline())
+		{	// in case the array is on the heap
+			::operator delete(data_);
+		}
+	}
 
-	void insert(const Key& x)
+
+	/**
+	 * @brief  Swaps two sets
+	 *
+	 * Exchanges the content of two sets. Arrays on the heap are never copied,
+	 * only their pointers are exchanged; only the (at most InlineCapacity)
+	 * elements of inline sets are copied. This can therefore be used instead
+	 * of copying when the source set is not needed any more.
+	 *
+	 * @param[in,out]  rhs  The other set
+	 */
+	void Swap(OrderedVector& rhs)
 	{
 		// Assertions
 		assert(vectorIsSorted());
+		assert(rhs.vectorIsSorted());
 
-		// perform binary search (cannot use std::binary_search because it is
-		// ineffective due to not returning the iterator to the position of the
-		// desirable insertion in case the searched element is not present in the
-		// range)
-		size_t first = 0;
-		size_t last = vec_.size();
-
-		if ((last != 0) && (vec_[last-1] < x))
-		{	// for the case which would be prevalent
-			vec_.push_back(x);
+		if (&rhs == this)
+		{
 			return;
 		}
 
-		while (first < last)
-		{	// while the pointers do not overlap
-			size_t middle = first + (last - first) / 2;
-			if (vec_[middle] == x)
-			{	// in case we found x
-				return;
+		if (!isInline() && !rhs.isInline())
+		{	// in case both arrays are on the heap
+			std::swap(data_, rhs.data_);
+			std::swap(size_, rhs.size_);
+			std::swap(capacity_, rhs.capacity_);
+			std::swap(hash_, rhs.hash_);
+		}
+		else if (isInline() && rhs.isInline())
+		{	// in case both sets are small, no memory is allocated
+			OrderedVector tmp(rhs);
+			rhs = *this;
+			*this = tmp;
+		}
+		else
+		{	// in case one array is on the heap, it is passed to the inline set
+			OrderedVector& inlineSet = isInline()? *this : rhs;
+			OrderedVector& heapSet = isInline()? rhs : *this;
+
+			Key* heapData = heapSet.data_;
+			heapSet.data_ = heapSet.inlineData();
+			try
+			{
+				std::uninitialized_copy(inlineSet.data_,
+					inlineSet.data_ + inlineSet.size_, heapSet.data_);
 			}
-			else if (vec_[middle] < x)
-			{	// in case middle is less than x
-				first = middle + 1;
+			catch (...)
+			{
+				heapSet.data_ = heapData;
+				throw;
 			}
-			else
-			{	// in case middle is greater than x
-				last = middle;
+
+			std::swap(heapSet.size_, inlineSet.size_);
+			std::swap(heapSet.capacity_, inlineSet.capacity_);
+			std::swap(heapSet.hash_, inlineSet.hash_);
+
+			// the copied inline elements are now counted by heapSet
+			for (size_t i = 0; i < heapSet.size_; ++i)
+			{
+				inlineSet.data_[i].~Key();
 			}
+
+			inlineSet.data_ = heapData;
 		}
 
-		vec_.resize(vec_.size() + 1);
-		std::copy_backward(vec_.begin() + first, vec_.end() - 1, vec_.end());
+		// Assertions
+		assert(vectorIsSorted());
+		assert(rhs.vectorIsSorted());
+	}
 
-		// insert the new element
-		vec_[first] = x;
+
+	void insert(const Key& x)
+	{
+		// Assertions
+		assert(vectorIsSorted());
+
+		if ((size_ != 0) && (data_[size_ - 1] < x))
+		{	// for the case which would be prevalent
+			reserve(size_ + 1);
+			pushBack(x);
+			hash_ += elementHash(x);
+			return;
+		}
+
+		size_t pos = std::lower_bound(data_, data_ + size_, x) - data_;
+		if ((pos != size_) && (data_[pos] == x))
+		{	// in case x is already there (this also holds if x is a reference
+			// to some element of the set, so reallocation cannot invalidate x)
+			return;
+		}
+
+		reserve(size_ + 1);
+
+		if (pos == size_)
+		{	// in case we append at the end
+			pushBack(x);
+		}
+		else
+		{	// shift the tail by one position
+			new (data_ + size_) Key(data_[size_ - 1]);
+			std::copy_backward(data_ + pos, data_ + size_ - 1, data_ + size_);
+			++size_;
+
+			// insert the new element
+			data_[pos] = x;
+		}
+
+		hash_ += elementHash(x);
 
 		// Assertions
 		assert(vectorIsSorted());
 	}
 
 
+	/**
+	 * @brief  Inserts all elements of another set
+	 *
+	 * Inserts all elements of @p vec into the set. The union is merged in
+	 * place from the back of the array so that no temporary set is created.
+	 *
+	 * @param[in]  vec  The set the elements of which are to be inserted
+	 */
 	void insert(const OrderedVector& vec)
 	{
 		// Assertions
 		assert(vectorIsSorted());
 		assert(vec.vectorIsSorted());
 
-		OrderedVector result = this->Union(vec);
-		vec_ = result.vec_;
+		if ((&vec == this) || vec.empty())
+		{	// in case there is nothing to be done
+			return;
+		}
+
+		if (empty() || (data_[size_ - 1] < vec.data_[0]))
+		{	// in case the elements can be simply appended
+			reserve(size_ + vec.size_);
+			std::uninitialized_copy(vec.data_, vec.data_ + vec.size_, data_ + size_);
+			size_ += vec.size_;
+			hash_ += vec.hash_;
+			return;
+		}
+
+		size_t commonHash = 0;
+		size_t newSize = unionSize(vec, commonHash);
+		if (newSize == size_)
+		{	// in case vec is a subset
+			return;
+		}
+
+		reserve(newSize);
+
+		// merge from the back
+		size_t lhsIndex = size_;
+		size_t rhsIndex = vec.size_;
+		size_t resIndex = newSize;
+		while (rhsIndex > 0)
+		{	// until all elements of vec are inserted
+			--resIndex;
+			if ((lhsIndex > 0) && (vec.data_[rhsIndex - 1] < data_[lhsIndex - 1]))
+			{
+				--lhsIndex;
+				putAt(resIndex, data_[lhsIndex], size_);
+			}
+			else
+			{
+				if ((lhsIndex > 0) && !(data_[lhsIndex - 1] < vec.data_[rhsIndex - 1]))
+				{	// in case they are equal
+					--lhsIndex;
+				}
+
+				--rhsIndex;
+				putAt(resIndex, vec.data_[rhsIndex], size_);
+			}
+		}
+
+		// the rest of the original elements are already in place
+		assert(resIndex == lhsIndex);
+
+		size_ = newSize;
+		hash_ += vec.hash_ - commonHash;
 
 		// Assertions
 		assert(vectorIsSorted());
 	}
 
 
+	/**
+	 * @brief  Inserts a range of elements
+	 *
+	 * Inserts all elements from the range [@p first, @p last), which does not
+	 * need to be sorted.
+	 *
+	 * @param[in]  first  The beginning of the range
+	 * @param[in]  last   The end of the range
+	 */
+	template <class InputIterator>
+	void insert(InputIterator first, InputIterator last)
+	{
+		OrderedVector vec((VectorType(first, last)));
+		if (empty())
+		{	// in case the new set can be taken over
+			Swap(vec);
+		}
+		else
+		{
+			insert(vec);
+		}
+	}
+
+
 	inline void clear()
 	{
 		// Assertions
 		assert(vectorIsSorted());
 
-		vec_.clear();
+		destroyElements();
+		hash_ = 0;
 	}
 
 
@@ -194,7 +644,7 @@ public:   // Public methods
 		// Assertions
 		assert(vectorIsSorted());
 
-		return vec_.size();
+		return size_;
 	}
 
 
@@ -204,77 +654,196 @@ public:   // Public methods
 		assert(vectorIsSorted());
 		assert(rhs.vectorIsSorted());
 
-		VectorType newVector;
+		OrderedVector result;
+		result.reserve(size_ + rhs.size_);
+		result.hash_ = hash_ + rhs.hash_;
 
-		typename VectorType::const_iterator lhsIt = vec_.begin();
-		typename VectorType::const_iterator rhsIt = rhs.vec_.begin();
+		const Key* lhsIt = data_;
+		const Key* rhsIt = rhs.data_;
 
-		while ((lhsIt != vec_.end()) || (rhsIt != rhs.vec_.end()))
-		{	// until we get to the end of both vectors
-			if (lhsIt == vec_.end())
-			{	// if we are finished with the left-hand side vector
-				newVector.push_back(*rhsIt);
+		while ((lhsIt != end()) && (rhsIt != rhs.end()))
+		{	// until we get to the end of one of the vectors
+			if (*lhsIt < *rhsIt)
+			{
+				result.pushBack(*lhsIt);
+				++lhsIt;
+			}
+			else if (*rhsIt < *lhsIt)
+			{
+				result.pushBack(*rhsIt);
 				++rhsIt;
 			}
-			else if (rhsIt == rhs.vec_.end())
-			{	// if we are finished with the right-hand side vector
-				newVector.push_back(*lhsIt);
+			else
+			{	// in case they are equal
+				result.pushBack(*rhsIt);
+				result.hash_ -= elementHash(*rhsIt);
+				++rhsIt;
 				++lhsIt;
 			}
-			else
+		}
+
+		for (; lhsIt != end(); ++lhsIt)
+		{	// if we are finished with the right-hand side vector
+			result.pushBack(*lhsIt);
+		}
+
+		for (; rhsIt != rhs.end(); ++rhsIt)
+		{	// if we are finished with the left-hand side vector
+			result.pushBack(*rhsIt);
+		}
+
+		// Assertions
+		assert(result.vectorIsSorted());
+
+		return result;
+	}
+
+
+	/**
+	 * @brief  Intersection of sets
+	 *
+	 * Returns the set of elements that are both in the set and in @p rhs.
+	 *
+	 * @param[in]  rhs  The other set
+	 *
+	 * @returns  The intersection
+	 */
+	OrderedVector Intersection(const OrderedVector& rhs) const
+	{
+		// Assertions
+		assert(vectorIsSorted());
+		assert(rhs.vectorIsSorted());
+
+		OrderedVector result;
+		result.reserve(std::min(size_, rhs.size_));
+
+		const Key* lhsIt = data_;
+		const Key* rhsIt = rhs.data_;
+
+		while ((lhsIt != end()) && (rhsIt != rhs.end()))
+		{	// until we get to the end of one of the vectors
+			if (*lhsIt < *rhsIt)
 			{
-				if (*lhsIt < *rhsIt)
-				{
-					newVector.push_back(*lhsIt);
-					++lhsIt;
-				}
-				else if (*rhsIt < *lhsIt)
-				{
-					newVector.push_back(*rhsIt);
-					++rhsIt;
-				}
-				else
-				{	// in case they are equal
-					newVector.push_back(*rhsIt);
-					++rhsIt;
-					++lhsIt;
-				}
+				++lhsIt;
+			}
+			else if (*rhsIt < *lhsIt)
+			{
+				++rhsIt;
+			}
+			else
+			{	// in case they are equal
+				result.pushBack(*lhsIt);
+				result.hash_ += elementHash(*lhsIt);
+				++lhsIt;
+				++rhsIt;
 			}
 		}
 
-		OrderedVector result(newVector);
-
 		// Assertions
 		assert(result.vectorIsSorted());
 
 		return result;
 	}
 
-	const_iterator find(const Key& key) const
+
+	/**
+	 * @brief  Difference of sets
+	 *
+	 * Returns the set of elements that are in the set but not in @p rhs.
+	 *
+	 * @param[in]  rhs  The other set
+	 *
+	 * @returns  The difference
+	 */
+	OrderedVector Difference(const OrderedVector& rhs) const
 	{
 		// Assertions
 		assert(vectorIsSorted());
+		assert(rhs.vectorIsSorted());
+
+		OrderedVector result;
+		result.reserve(size_);
+		result.hash_ = hash_;
 
-		size_t first = 0;
-		size_t last = vec_.size();
+		const Key* lhsIt = data_;
+		const Key* rhsIt = rhs.data_;
 
-		while (first < last)
-		{	// while the pointers do not overlap
-			size_t middle = first + (last - first) / 2;
-			if (vec_[middle] == key)
-			{	// in case we found x
-				return const_iterator(&vec_[middle]);
+		while (lhsIt != end())
+		{	// until we get to the end of the left-hand side vector
+			if ((rhsIt == rhs.end()) || (*lhsIt < *rhsIt))
+			{
+				result.pushBack(*lhsIt);
+				++lhsIt;
 			}
-			else if (vec_[middle] < key)
-			{	// in case middle is less than x
-				first = middle + 1;
+			else if (*rhsIt < *lhsIt)
+			{
+				++rhsIt;
 			}
 			else
-			{	// in case middle is greater than x
-				last = middle;
+			{	// in case they are equal
+				result.hash_ -= elementHash(*lhsIt);
+				++lhsIt;
+				++rhsIt;
 			}
 		}
 
+		// Assertions
+		assert(result.vectorIsSorted());
+
+		return result;
+	}
+
+
+	/**
+	 * @brief  Subset test
+	 *
+	 * Checks whether all elements of the set are also in @p rhs.
+	 *
+	 * @param[in]  rhs  The other set
+	 *
+	 * @returns  @c true if the set is a subset of @p rhs, @c false otherwise
+	 */
+	bool IsSubsetOf(const OrderedVector& rhs) const
+	{
+		// Assertions
+		assert(vectorIsSorted());
+		assert(rhs.vectorIsSorted());
+
+		if (size_ > rhs.size_)
+		{	// a bigger set cannot be a subset
+			return false;
+		}
+
+		const Key* rhsIt = rhs.data_;
+		for (const Key* lhsIt = data_; lhsIt != end(); ++lhsIt)
+		{	// try to find every element in rhs
+			while ((rhsIt != rhs.end()) && (*rhsIt < *lhsIt))
+			{
+				++rhsIt;
+			}
+
+			if ((rhsIt == rhs.end()) || (*lhsIt < *rhsIt))
+			{	// in case the element is missing
+				return false;
+			}
+
+			++rhsIt;
+		}
+
+		return true;
+	}
+
+	const_iterator find(const Key& key) const
+	{
+		// Assertions
+		assert(vectorIsSorted());
+
+		const Key* it = std::lower_bound(data_, data_ + size_, key);
+		if ((it != end()) && (*it == key))
+		{	// in case we found the key
+			return it;
+		}
+
 		return end();
 	}
 
@@ -284,7 +853,7 @@ public:   // Public methods
 		// Assertions
 		assert(vectorIsSorted());
 
-		return vec_.empty();
+		return size_ == 0;
 	}
 
 	inline const_iterator begin() const
@@ -292,7 +861,7 @@ public:   // Public methods
 		// Assertions
 		assert(vectorIsSorted());
 
-		return vec_.begin();
+		return data_;
 	}
 
 	inline const_iterator end() const
@@ -300,7 +869,15 @@ public:   // Public methods
 		// Assertions
 		assert(vectorIsSorted());
 
-		return vec_.end();
+		return data_ + size_;
+	}
+
+	inline const_reference operator[](size_t index) const
+	{
+		// Assertions
+		assert(index < size_);
+
+		return data_[index];
 	}
 
 	/**
@@ -322,8 +899,7 @@ public:   // Public methods
 
 		std::string result = "{";
 
-		for (typename VectorType::const_iterator it = vec.begin();
-			it != vec.end(); ++it)
+		for (const_iterator it = vec.begin(); it != vec.end(); ++it)
 		{
 			result += ((it != vec.begin())? ", " : " ") + Convert::ToString(*it);
 		}
@@ -337,7 +913,8 @@ public:   // Public methods
 		assert(vectorIsSorted());
 		assert(rhs.vectorIsSorted());
 
-		return (vec_ == rhs.vec_);
+		return (size_ == rhs.size_) && (hash_ == rhs.hash_) &&
+			std::equal(begin(), end(), rhs.begin());
 	}
 
 	bool operator<(const OrderedVector& rhs) const
@@ -346,13 +923,49 @@ public:   // Public methods
 		assert(vectorIsSorted());
 		assert(rhs.vectorIsSorted());
 
-		return std::lexicographical_compare(vec_.begin(), vec_.end(),
-			rhs.vec_.begin(), rhs.vec_.end());
+		return std::lexicographical_compare(begin(), end(),
+			rhs.begin(), rhs.end());
+	}
+
+	/**
+	 * @brief  Hash value of the set
+	 *
+	 * Returns the hash value of the set, which is maintained incrementally,
+	 * so this method runs in constant time.
+	 *
+	 * @returns  The hash value
+	 */
+	inline size_t HashValue() const
+	{
+		return hash_;
+	}
+
+	friend size_t hash_value(const OrderedVector& vec)
+	{
+		return vec.HashValue();
+	}
+
+	/**
+	 * @brief  Memory used by the set
+	 *
+	 * Returns the estimated number of bytes allocated by the set on the heap.
+	 *
+	 * @returns  The number of bytes
+	 */
+	size_t GetMemoryUsage() const
+	{
+		size_t result = isInline()? 0 : capacity_ * sizeof(Key);
+		for (const_iterator it = begin(); it != end(); ++it)
+		{
+			result += SFTA::Private::MemoryEstimate::Of(*it);
+		}
+
+		return result;
 	}
 
-	const std::vector<Key>& ToVector() const
+	std::vector<Key> ToVector() const
 	{
-		return vec_;
+		return std::vector<Key>(begin(), end());
 	}
 };
 
@@ -0,0 +1,557 @@
+/*****************************************************************************
+ *  Symbolic Finite Tree Automata Library
+ *
+ *  Description:
+ *    File with the RandomTAGenerator class.
+ *
+ *****************************************************************************/
+
+#ifndef _SFTA_RANDOM_TA_GENERATOR_HH_
+#define _SFTA_RANDOM_TA_GENERATOR_HH_
+
+// Standard library headers
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <ostream>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Boost headers
+#include <boost/cstdint.hpp>
+
+// SFTA headers
+#include <sfta/convert.hh>
+
+
+// insert the class into proper namespace
+namespace SFTA
+{
+	class RandomTAGenerator;
+}
+
+
+/**
+ * @brief   Generator of random tree automata
+ *
+ * Class that generates random nondeterministic bottom-up tree automata
+ * according to the Tabakov-Vardi model: for a set of @e n states and every
+ * symbol of the alphabet, <em>r * n</em> distinct transitions (where @e r is
+ * the transition density) are chosen uniformly at random, and <em>f * n</em>
+ * states (where @e f is the final density, but at least one) are final.
+ * Symbols can be either plain names, or symbolic strings over {0, 1, X} that
+ * start with the binary encoding of the arity (as produced by
+ * random_symbolic_timbuk_converter.awk).
+ *
+ * The generator is deterministic: the same parameters (including the seed)
+ * give the same automaton on every platform. The automaton is written in the
+ * Timbuk format (see WriteTimbuk()).
+ */
+class SFTA::RandomTAGenerator
+{
+public:   // Public data types
+
+	typedef std::string StateType;
+	typedef std::string SymbolType;
+
+	typedef std::pair<SymbolType, size_t> RankedSymbolType;
+	typedef std::vector<RankedSymbolType> RankedSymbolVector;
+
+	/**
+	 * @brief  Parameters of the generator
+	 */
+	struct Parameters
+	{
+		size_t states;                  ///< the number of states
+		std::vector<size_t> arities;    ///< the arity of every symbol
+		double transitionDensity;       ///< transitions per state and symbol
+		double finalDensity;            ///< the ratio of final states
+		size_t symbolBits;              ///< the length of symbolic symbols (0 = names)
+		double dontCareDensity;         ///< the ratio of X in symbolic symbols
+		boost::uint64_t seed;
+
+		Parameters()
+			: states(10),
+				arities(),
+				transitionDensity(2.0),
+				finalDensity(0.5),
+				symbolBits(0),
+				dontCareDensity(0.3),
+				seed(0)
+		{
+			arities.push_back(0);
+			arities.push_back(2);
+		}
+	};
+
+private:  // Private data types
+
+	typedef std::vector<size_t> StateTuple;
+	typedef std::set<size_t> StateIndexSet;
+	typedef std::map<StateTuple, StateIndexSet> TupleToStatesMap;
+
+	/**
+	 * @brief  Pseudo-random number generator
+	 *
+	 * The SplitMix64 generator, which (unlike std::rand()) gives the same
+	 * sequence for a seed everywhere.
+	 */
+	class Random
+	{
+	private:  // Private data members
+
+		boost::uint64_t state_;
+
+		static inline boost::uint64_t constant(boost::uint32_t high,
+			boost::uint32_t low)
+		{
+			return (static_cast<boost::uint64_t>(high) << 32) | low;
+		}
+
+	public:   // Public methods
+
+		explicit Random(boost::uint64_t seed)
+			: state_(seed)
+		{ }
+
+		boost::uint64_t Next()
+		{
+			state_ += constant(0x9E3779B9, 0x7F4A7C15);
+			boost::uint64_t z = state_;
+			z = (z ^ (z >> 30)) * constant(0xBF58476D, 0x1CE4E5B9);
+			z = (z ^ (z >> 27)) * constant(0x94D049BB, 0x133111EB);
+			return z ^ (z >> 31);
+		}
+
+		/**
+		 * @brief  Returns a random number in [0, bound)
+		 *
+		 * Numbers below <em>2^64 mod bound</em> are rejected, so that every
+		 * residue has the same number of preimages (there is no modulo bias).
+		 */
+		boost::uint64_t Below(boost::uint64_t bound)
+		{
+			assert(bound > 0);
+
+			// 2^64 mod bound
+			boost::uint64_t threshold = (static_cast<boost::uint64_t>(0) - bound) % bound;
+
+			boost::uint64_t result;
+			do
+			{
+				result = Next();
+			} while (result < threshold);
+
+			return result % bound;
+		}
+
+		/**
+		 * @brief  Returns a random number in [0, 1)
+		 */
+		inline double Uniform()
+		{
+			return static_cast<double>(Next() >> 11) / 9007199254740992.0;
+		}
+	};
+
+	enum
+	{
+		// the largest number of candidates that is enumerated when sampling
+		MaxEnumeratedCandidates = 1 << 22
+	};
+
+private:  // Private data members
+
+	Parameters params_;
+
+private:  // Private methods
+
+	static inline StateType stateName(size_t index)
+	{
+		return "q" + SFTA::Private::Convert::ToString(index);
+	}
+
+	/**
+	 * @brief  Returns the number of candidate transitions
+	 *
+	 * Returns the number <em>n^(k+1)</em> of transitions of a symbol of arity
+	 * @e k over @e n states, or the maximum value in case of an overflow.
+	 */
+	static boost::uint64_t candidateCount(boost::uint64_t states, size_t arity)
+	{
+		const boost::uint64_t max = std::numeric_limits<boost::uint64_t>::max();
+
+		boost::uint64_t result = states;
+		for (size_t i = 0; i < arity; ++i)
+		{
+			if (result > max / states)
+			{	// in case of an overflow
+				return max;
+			}
+
+			result *= states;
+		}
+
+		return result;
+	}
+
+	/**
+	 * @brief  Adds a candidate transition given by its index
+	 *
+	 * Decodes the index of a transition of a symbol of given arity (the digits
+	 * in base @e n are the right-hand side state and the left-hand side
+	 * tuple) and stores the transition.
+	 */
+	void addCandidate(boost::uint64_t index, size_t arity,
+		TupleToStatesMap& transitions) const
+	{
+		size_t rhs = static_cast<size_t>(index % params_.states);
+		index /= params_.states;
+
+		StateTuple lhs(arity);
+		for (size_t i = 0; i < arity; ++i)
+		{
+			lhs[i] = static_cast<size_t>(index % params_.states);
+			index /= params_.states;
+		}
+
+		transitions[lhs].insert(rhs);
+	}
+
+	/**
+	 * @brief  Chooses random transitions of a symbol
+	 *
+	 * Chooses given number of distinct transitions of a symbol of given arity
+	 * uniformly at random. Small sets of candidates are sampled without
+	 * replacement, large ones by rejection of repeated transitions. Repeated
+	 * transitions are recognized by their states, as the index of
+	 * a transition may not fit into 64 bits.
+	 */
+	TupleToStatesMap chooseTransitions(Random& random, size_t arity,
+		boost::uint64_t count) const
+	{
+		TupleToStatesMap transitions;
+
+		boost::uint64_t candidates = candidateCount(params_.states, arity);
+		count = std::min(count, candidates);
+
+		if ((candidates <= static_cast<boost::uint64_t>(MaxEnumeratedCandidates)) &&
+			(2 * count >= candidates))
+		{	// in case a large part of the candidates is chosen
+			std::vector<boost::uint64_t> indices(static_cast<size_t>(candidates));
+			for (size_t i = 0; i < indices.size(); ++i)
+			{
+				indices[i] = i;
+			}
+
+			for (size_t i = 0; i < count; ++i)
+			{	// partial Fisher-Yates shuffle
+				size_t j = i + static_cast<size_t>(random.Below(indices.size() - i));
+				std::swap(indices[i], indices[j]);
+				addCandidate(indices[i], arity, transitions);
+			}
+
+			return transitions;
+		}
+
+		boost::uint64_t chosen = 0;
+		StateTuple lhs(arity);
+		while (chosen < count)
+		{	// until there are enough distinct transitions
+			size_t rhs = static_cast<size_t>(random.Below(params_.states));
+			for (size_t i = 0; i < arity; ++i)
+			{	// draw the states in the order of the digits of the index
+				lhs[i] = static_cast<size_t>(random.Below(params_.states));
+			}
+
+			if (transitions[lhs].insert(rhs).second)
+			{	// in case the transition is new
+				++chosen;
+			}
+		}
+
+		return transitions;
+	}
+
+	SymbolType symbolicName(Random& random, size_t arity,
+		size_t arityBits) const
+	{
+		SymbolType result;
+		for (size_t i = 0; i < arityBits; ++i)
+		{	// the arity goes first (least significant bit first)
+			result += ((arity >> i) & 1)? '1' : '0';
+		}
+
+		for (size_t i = arityBits; i < params_.symbolBits; ++i)
+		{	// the rest is random
+			if (random.Uniform() < params_.dontCareDensity)
+			{
+				result += 'X';
+			}
+			else
+			{
+				result += (random.Below(2) == 0)? '0' : '1';
+			}
+		}
+
+		return result;
+	}
+
+	RankedSymbolVector generateSymbols(Random& random) const
+	{
+		size_t maxArity = 0;
+		for (size_t i = 0; i < params_.arities.size(); ++i)
+		{
+			maxArity = std::max(maxArity, params_.arities[i]);
+		}
+
+		size_t arityBits = 1;
+		while ((static_cast<size_t>(1) << arityBits) <= maxArity)
+		{
+			++arityBits;
+		}
+
+		if ((params_.symbolBits > 0) && (params_.symbolBits < arityBits))
+		{
+			throw std::runtime_error(__func__ +
+				std::string(": symbols too short for the encoding of arities"));
+		}
+
+		RankedSymbolVector result;
+		std::set<SymbolType> names;
+		for (size_t i = 0; i < params_.arities.size(); ++i)
+		{	// for each symbol
+			SymbolType name;
+			if (params_.symbolBits == 0)
+			{
+				name = "a" + SFTA::Private::Convert::ToString(i);
+			}
+			else
+			{
+				size_t attempts = 0;
+				do
+				{	// symbolic names need to be distinct
+					if (++attempts > 1000)
+					{
+						throw std::runtime_error(__func__ +
+							std::string(": too many symbols for the length of symbols"));
+					}
+
+					name = symbolicName(random, params_.arities[i], arityBits);
+				} while (names.count(name) > 0);
+			}
+
+			names.insert(name);
+			result.push_back(RankedSymbolType(name, params_.arities[i]));
+		}
+
+		return result;
+	}
+
+	/**
+	 * @brief  Writer of the Timbuk format
+	 *
+	 * Class with the interface of builders that writes the automaton in the
+	 * Timbuk format.
+	 */
+	class TimbukWriter
+	{
+	public:   // Public data types
+
+		typedef std::vector<StateType> LeftHandSideType;
+		typedef std::set<StateType> RightHandSideType;
+
+		typedef SFTA::RandomTAGenerator::RankedSymbolVector RankedSymbolVector;
+
+	private:  // Private data members
+
+		std::ostream& os_;
+
+		std::string states_;
+		std::string finalStates_;
+
+	private:  // Private methods
+
+		TimbukWriter(const TimbukWriter&);
+		TimbukWriter& operator=(const TimbukWriter&);
+
+	public:   // Public methods
+
+		explicit TimbukWriter(std::ostream& os)
+			: os_(os),
+				states_(),
+				finalStates_()
+		{ }
+
+		void AddSymbols(const RankedSymbolVector& symbols)
+		{
+			os_ << "Ops";
+			for (size_t i = 0; i < symbols.size(); ++i)
+			{
+				os_ << " " << symbols[i].first << ":" << symbols[i].second;
+			}
+
+			os_ << "\n\nAutomaton random\n\n";
+		}
+
+		inline void AddState(const StateType& state)
+		{
+			states_ += " " + state + ":0";
+		}
+
+		inline void SetStateFinal(const StateType& state)
+		{
+			finalStates_ += " " + state;
+		}
+
+		void AddTransition(const LeftHandSideType& lhs, const SymbolType& symbol,
+			const RightHandSideType& rhs)
+		{
+			if (!states_.empty() || !finalStates_.empty())
+			{	// states are written before the first transition
+				os_ << "States" << states_ << "\n\n";
+				os_ << "Final States" << finalStates_ << "\n\n";
+				os_ << "Transitions\n";
+				states_.clear();
+				finalStates_.clear();
+			}
+
+			std::string left = symbol;
+			if (!lhs.empty())
+			{
+				left += "(";
+				for (size_t i = 0; i < lhs.size(); ++i)
+				{
+					left += ((i > 0)? "," : "") + lhs[i];
+				}
+
+				left += ")";
+			}
+
+			for (RightHandSideType::const_iterator itRhs = rhs.begin();
+				itRhs != rhs.end(); ++itRhs)
+			{
+				os_ << left << " -> " << *itRhs << "\n";
+			}
+		}
+
+		void Finish()
+		{
+			if (!states_.empty() || !finalStates_.empty())
+			{	// in case there are no transitions
+				os_ << "States" << states_ << "\n\n";
+				os_ << "Final States" << finalStates_ << "\n\n";
+				os_ << "Transitions\n";
+			}
+		}
+	};
+
+public:   // Public methods
+
+	explicit RandomTAGenerator(const Parameters& params)
+		: params_(params)
+	{
+		if (params_.states == 0)
+		{
+			throw std::runtime_error(__func__ +
+				std::string(": the automaton needs at least one state"));
+		}
+
+		if ((params_.transitionDensity < 0) || (params_.finalDensity < 0) ||
+			(params_.finalDensity > 1) || (params_.dontCareDensity < 0) ||
+			(params_.dontCareDensity > 1))
+		{
+			throw std::runtime_error(__func__ +
+				std::string(": invalid density"));
+		}
+	}
+
+	/**
+	 * @brief  Generates an automaton
+	 *
+	 * Builds the random automaton in @p automaton using the interface of
+	 * builders of bottom-up tree automata (AddSymbols(), AddState(),
+	 * SetStateFinal() and AddTransition()).
+	 *
+	 * @param[out]  automaton  The automaton to be built
+	 */
+	template <class BUTreeAutomaton>
+	void Generate(BUTreeAutomaton* automaton) const
+	{
+		// Assertions
+		assert(automaton != static_cast<BUTreeAutomaton*>(0));
+
+		typedef typename BUTreeAutomaton::LeftHandSideType LeftHandSideType;
+		typedef typename BUTreeAutomaton::RightHandSideType RightHandSideType;
+		typedef typename BUTreeAutomaton::RankedSymbolVector OutputSymbolVector;
+
+		Random random(params_.seed);
+
+		RankedSymbolVector symbols = generateSymbols(random);
+		automaton->AddSymbols(OutputSymbolVector(symbols.begin(), symbols.end()));
+
+		for (size_t i = 0; i < params_.states; ++i)
+		{
+			automaton->AddState(stateName(i));
+		}
+
+		// final states are sampled like nullary transitions
+		size_t finalCount = std::max(static_cast<size_t>(1), static_cast<size_t>(
+			std::floor(params_.finalDensity * params_.states + 0.5)));
+		TupleToStatesMap finalStates = chooseTransitions(random, 0, finalCount);
+		const StateIndexSet& finals = finalStates[StateTuple()];
+		for (StateIndexSet::const_iterator itFinals = finals.begin();
+			itFinals != finals.end(); ++itFinals)
+		{
+			automaton->SetStateFinal(stateName(*itFinals));
+		}
+
+		boost::uint64_t transitionCount = static_cast<boost::uint64_t>(
+			std::floor(params_.transitionDensity * params_.states + 0.5));
+		for (size_t i = 0; i < symbols.size(); ++i)
+		{	// for each symbol
+			TupleToStatesMap transitions =
+				chooseTransitions(random, symbols[i].second, transitionCount);
+
+			for (typename TupleToStatesMap::const_iterator itTrans =
+				transitions.begin(); itTrans != transitions.end(); ++itTrans)
+			{	// for each left-hand side
+				LeftHandSideType lhs;
+				for (size_t j = 0; j < itTrans->first.size(); ++j)
+				{
+					lhs.push_back(stateName(itTrans->first[j]));
+				}
+
+				RightHandSideType rhs;
+				for (StateIndexSet::const_iterator itRhs = itTrans->second.begin();
+					itRhs != itTrans->second.end(); ++itRhs)
+				{
+					rhs.insert(stateName(*itRhs));
+				}
+
+				automaton->AddTransition(lhs, symbols[i].first, rhs);
+			}
+		}
+	}
+
+	/**
+	 * @brief  Writes the automaton in the Timbuk format
+	 *
+	 * Writes the same automaton as would be built by Generate() in the Timbuk
+	 * format to @p os.
+	 *
+	 * @param[out]  os  The output stream
+	 */
+	void WriteTimbuk(std::ostream& os) const
+	{
+		TimbukWriter writer(os);
+		Generate(&writer);
+		writer.Finish();
+	}
+};
+
+#endif
@@ -0,0 +1,128 @@
+/*****************************************************************************
+ *  Symbolic Finite Tree Automata Library
+ *
+ *  Description:
+ *    Header file with the RootGuard class, which erases roots of a shared
+ *    MTBDD created by an operation that did not finish.
+ *
+ *****************************************************************************/
+
+#ifndef _SFTA_ROOT_GUARD_HH_
+#define _SFTA_ROOT_GUARD_HH_
+
+// Standard library headers
+#include <cassert>
+#include <vector>
+
+
+// insert the class into proper namespace
+namespace SFTA
+{
+	namespace Private
+	{
+		template <class SharedMTBDD>
+		class RootGuard;
+	}
+}
+
+
+/**
+ * @brief   Guard of roots created by an operation
+ *
+ * Keeps the roots of a shared MTBDD that an operation created (for its result
+ * or temporarily) and erases them when the guard is destroyed, unless they
+ * were released. An operation that is left by an exception (e.g. an
+ * SFTA::OperationInterrupted) thus does not leak roots.
+ *
+ * @tparam  SharedMTBDD  The type of the shared MTBDD
+ */
+template <class SharedMTBDD>
+class SFTA::Private::RootGuard
+{
+public:   // Public data types
+
+	typedef typename SharedMTBDD::RootType RootType;
+
+private:  // Private data types
+
+	typedef std::vector<RootType> RootVector;
+
+private:  // Private data members
+
+	SharedMTBDD* mtbdd_;
+
+	RootVector roots_;
+
+private:  // Private methods
+
+	RootGuard(const RootGuard&);
+	RootGuard& operator=(const RootGuard&);
+
+public:   // Public methods
+
+	explicit RootGuard(SharedMTBDD* mtbdd)
+		: mtbdd_(mtbdd),
+			roots_()
+	{
+		// Assertions
+		assert(mtbdd_ != static_cast<SharedMTBDD*>(0));
+	}
+
+	/**
+	 * @brief  Guards a root
+	 *
+	 * @param[in]  root  The root to be erased unless released
+	 *
+	 * @returns  @p root
+	 */
+	inline const RootType& Add(const RootType& root)
+	{
+		roots_.push_back(root);
+		return root;
+	}
+
+	/**
+	 * @brief  Erases a guarded root
+	 *
+	 * Erases @p root from the shared MTBDD and stops guarding it. Roots are
+	 * searched from the most recently added one, which is usually the one
+	 * being replaced.
+	 *
+	 * @param[in]  root  The root to be erased
+	 */
+	void Erase(const RootType& root)
+	{
+		for (typename RootVector::size_type i = roots_.size(); i > 0; --i)
+		{
+			if (roots_[i - 1] == root)
+			{
+				roots_.erase(roots_.begin() + (i - 1));
+				break;
+			}
+		}
+
+		mtbdd_->EraseRoot(root);
+	}
+
+	/**
+	 * @brief  Releases all roots
+	 *
+	 * Stops guarding all roots, i.e., the operation finished and the roots
+	 * are kept.
+	 */
+	inline void Release()
+	{
+		roots_.clear();
+	}
+
+	~RootGuard()
+	{
+		for (typename RootVector::const_iterator itRoots = roots_.begin();
+			itRoots != roots_.end(); ++itRoots)
+		{
+			mtbdd_->EraseRoot(*itRoots);
+		}
+	}
+};
+
+#endif
@@ -5,7 +5,7 @@
  *
  *  Description:
  *    Header file with global declarations. It contains:
- *      * macros for easy logging
+ *      * macros for easy logging (with a compile-time minimum level)
  *
  *****************************************************************************/
 
@@ -19,16 +19,97 @@
 
 #define SFTA_LOGGER_PREFIX (std::string(__FILE__ ":" + SFTA::Private::Convert::ToString(__LINE__) + ": "))
 
-#define SFTA_LOGGER_LOG_MESSAGE(severity, msg) (log4cpp::Category::getInstance(SFTA_LOG_CATEGORY_NAME).severity((SFTA_LOGGER_PREFIX) + (msg)))
+/*
+ * The minimum severity of messages that are compiled in. Messages that are
+ * less severe than SFTA_LOG_LEVEL are compiled out, so that neither their
+ * arguments nor the check of the priority of the category are evaluated
+ * (the arguments are still type-checked). The levels have the values of
+ * log4cpp::Priority.
+ */
+#define SFTA_LOG_LEVEL_FATAL   0
+#define SFTA_LOG_LEVEL_ALERT   100
+#define SFTA_LOG_LEVEL_CRIT    200
+#define SFTA_LOG_LEVEL_ERROR   300
+#define SFTA_LOG_LEVEL_WARN    400
+#define SFTA_LOG_LEVEL_NOTICE  500
+#define SFTA_LOG_LEVEL_INFO    600
+#define SFTA_LOG_LEVEL_DEBUG   700
 
-#define SFTA_LOGGER_DEBUG(msg)  (SFTA_LOGGER_LOG_MESSAGE(debug, msg))
-#define SFTA_LOGGER_INFO(msg)   (SFTA_LOGGER_LOG_MESSAGE(info, msg))
-#define SFTA_LOGGER_NOTICE(msg) (SFTA_LOGGER_LOG_MESSAGE(notice, msg))
-#define SFTA_LOGGER_WARN(msg)   (SFTA_LOGGER_LOG_MESSAGE(warn, msg))
-#define SFTA_LOGGER_ERROR(msg)  (SFTA_LOGGER_LOG_MESSAGE(error, msg))
-#define SFTA_LOGGER_CRIT(msg)   (SFTA_LOGGER_LOG_MESSAGE(crit, msg))
-#define SFTA_LOGGER_ALERT(msg)  (SFTA_LOGGER_LOG_MESSAGE(alert, msg))
-#define SFTA_LOGGER_FATAL(msg)  (SFTA_LOGGER_LOG_MESSAGE(fatal, msg))
+#ifndef SFTA_LOG_LEVEL
+# define SFTA_LOG_LEVEL SFTA_LOG_LEVEL_DEBUG
+#endif
+
+/*
+ * Logs the message only if the category has the priority enabled; the
+ * message (and the prefix) is not built otherwise.
+ */
+#define SFTA_LOGGER_LOG_MESSAGE(severity, priority, msg) \
+	do \
+	{ \
+		log4cpp::Category& sftaLogCategory = \
+			log4cpp::Category::getInstance(SFTA_LOG_CATEGORY_NAME); \
+		if (sftaLogCategory.isPriorityEnabled(log4cpp::Priority::priority)) \
+		{ \
+			sftaLogCategory.severity((SFTA_LOGGER_PREFIX) + (msg)); \
+		} \
+	} while (false)
+
+/*
+ * Discards the message. The message stays in a dead branch, so that it is
+ * still type-checked but never built.
+ */
+#define SFTA_LOGGER_DISCARD_MESSAGE(msg) \
+	do \
+	{ \
+		if (false) \
+		{ \
+			static_cast<void>((SFTA_LOGGER_PREFIX) + (msg)); \
+		} \
+	} while (false)
+
+#if SFTA_LOG_LEVEL >= SFTA_LOG_LEVEL_DEBUG
+# define SFTA_LOGGER_DEBUG(msg)  SFTA_LOGGER_LOG_MESSAGE(debug, DEBUG, msg)
+#else
+# define SFTA_LOGGER_DEBUG(msg)  SFTA_LOGGER_DISCARD_MESSAGE(msg)
+#endif
+
+#if SFTA_LOG_LEVEL >= SFTA_LOG_LEVEL_INFO
+# define SFTA_LOGGER_INFO(msg)   SFTA_LOGGER_LOG_MESSAGE(info, INFO, msg)
+#else
+# define SFTA_LOGGER_INFO(msg)   SFTA_LOGGER_DISCARD_MESSAGE(msg)
+#endif
+
+#if SFTA_LOG_LEVEL >= SFTA_LOG_LEVEL_NOTICE
+# define SFTA_LOGGER_NOTICE(msg) SFTA_LOGGER_LOG_MESSAGE(notice, NOTICE, msg)
+#else
+# define SFTA_LOGGER_NOTICE(msg) SFTA_LOGGER_DISCARD_MESSAGE(msg)
+#endif
+
+#if SFTA_LOG_LEVEL >= SFTA_LOG_LEVEL_WARN
+# define SFTA_LOGGER_WARN(msg)   SFTA_LOGGER_LOG_MESSAGE(warn, WARN, msg)
+#else
+# define SFTA_LOGGER_WARN(msg)   SFTA_LOGGER_DISCARD_MESSAGE(msg)
+#endif
+
+#if SFTA_LOG_LEVEL >= SFTA_LOG_LEVEL_ERROR
+# define SFTA_LOGGER_ERROR(msg)  SFTA_LOGGER_LOG_MESSAGE(error, ERROR, msg)
+#else
+# define SFTA_LOGGER_ERROR(msg)  SFTA_LOGGER_DISCARD_MESSAGE(msg)
+#endif
+
+#if SFTA_LOG_LEVEL >= SFTA_LOG_LEVEL_CRIT
+# define SFTA_LOGGER_CRIT(msg)   SFTA_LOGGER_LOG_MESSAGE(crit, CRIT, msg)
+#else
+# define SFTA_LOGGER_CRIT(msg)   SFTA_LOGGER_DISCARD_MESSAGE(msg)
+#endif
+
+#if SFTA_LOG_LEVEL >= SFTA_LOG_LEVEL_ALERT
+# define SFTA_LOGGER_ALERT(msg)  SFTA_LOGGER_LOG_MESSAGE(alert, ALERT, msg)
+#else
+# define SFTA_LOGGER_ALERT(msg)  SFTA_LOGGER_DISCARD_MESSAGE(msg)
+#endif
+
+#define SFTA_LOGGER_FATAL(msg)  SFTA_LOGGER_LOG_MESSAGE(fatal, FATAL, msg)
 
 #if ((__GNUC__ * 100) + __GNUC_MINOR__) >= 402
 #define GCC_DIAG_STR(s) #s
@@ -0,0 +1,567 @@
+/*****************************************************************************
+ *  Symbolic Finite Tree Automata Library
+ *
+ *  Description:
+ *    File with SlabLeafAllocator policy for CUDDSharedMTBDD
+ *
+ *****************************************************************************/
+
+#ifndef _SFTA_SLAB_LEAF_ALLOCATOR_HH_
+#define _SFTA_SLAB_LEAF_ALLOCATOR_HH_
+
+// Standard library header files
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Boost library headers
+#include <boost/functional/hash.hpp>
+
+// SFTA header files
+#include <sfta/convert.hh>
+#include <sfta/operation_statistics.hh>
+
+// insert the class into proper namespace
+namespace SFTA
+{
+	namespace Private
+	{
+		template
+		<
+			typename Leaf,
+			typename Handle,
+			class AbstractMonadicApplyFunctor
+		>
+		struct SlabLeafAllocator;
+	}
+}
+
+
+/**
+ * @brief   Leaf allocator that uses a slab and an open addressing table
+ *
+ * This is a @c LeafAllocator policy for SFTA::CUDDSharedMTBDD that stores
+ * leaves in a contiguous slab (an array of fixed-size blocks, so that leaves
+ * never move in memory) and interns them using a hash table with open
+ * addressing and linear probing. The handle of a leaf is its index in the
+ * slab, so that translation of a handle to a leaf is a simple array access.
+ * Hashes of leaves are stored next to the slab, so that probing compares
+ * leaves only in case their hashes match and the table can be grown without
+ * hashing the leaves again.
+ *
+ * The hash of a leaf is obtained using boost::hash, therefore leaf types
+ * that maintain their hash value (such as SFTA::OrderedVector) are hashed in
+ * constant time.
+ *
+ * @see  SFTA::CUDDSharedMTBDD
+ *
+ * @tparam  Leaf                         The type of leaf.
+ * @tparam  Handle                       The type of handle.
+ * @tparam  AbstractMonadicApplyFunctor  The type of the monadic Apply functor
+ *                                       of the underlying MTBDD package
+ *                                       facade.
+ */
+template
+<
+	typename Leaf,
+	typename Handle,
+	class AbstractMonadicApplyFunctor
+>
+struct SFTA::Private::SlabLeafAllocator
+{
+public:   // Public data types
+
+	/**
+	 * @brief  Type of leaf
+	 *
+	 * The data type of leaf.
+	 */
+	typedef Leaf LeafType;
+
+
+	/**
+	 * @brief  Type of leaf handle
+	 *
+	 * The data type of leaf handle.
+	 */
+	typedef Handle HandleType;
+
+private:  // Private data types
+
+	enum
+	{
+		// the number of leaves in one block of the slab
+		LeavesInBlock = 1024
+	};
+
+	enum
+	{
+		// the initial number of buckets (needs to be a power of 2)
+		InitialBucketsCount = 1024
+	};
+
+
+	/**
+	 * Container of blocks of the slab
+	 */
+	typedef std::vector<LeafType*> BlockVector;
+
+
+	/**
+	 * Container of hashes of leaves
+	 */
+	typedef std::vector<size_t> HashVector;
+
+
+	/**
+	 * Container of buckets (0 for an empty bucket, otherwise the index of the
+	 * leaf increased by 1)
+	 */
+	typedef std::vector<size_t> BucketVector;
+
+
+	/**
+	 * @brief  The type of the Convert class
+	 *
+	 * The type of the Convert class.
+	 */
+	typedef SFTA::Private::Convert Convert;
+
+
+private:   // Private data types
+
+
+	/**
+	 * @brief  Leaf releaser
+	 *
+	 * Monadic Apply functor that properly releases leaves.
+	 */
+	class ReleaserMonadicApplyFunctor : public AbstractMonadicApplyFunctor
+	{
+	private:
+
+		SlabLeafAllocator* allocator_;
+
+		ReleaserMonadicApplyFunctor(const ReleaserMonadicApplyFunctor& func);
+		ReleaserMonadicApplyFunctor& operator=(
+			const ReleaserMonadicApplyFunctor& func);
+
+
+	public:
+
+		ReleaserMonadicApplyFunctor(SlabLeafAllocator* allocator)
+			: allocator_(allocator)
+		{
+			// Assertions
+			assert(allocator_ != static_cast<SlabLeafAllocator*>(0));
+		}
+
+		virtual HandleType operator()(const HandleType& val)
+		{
+			return val;
+		}
+	};
+
+
+private:  // Private data members
+
+
+	/**
+	 * Blocks of the slab with leaves.
+	 */
+	BlockVector blocks_;
+
+
+	/**
+	 * Hashes of leaves (indexed the same way as leaves).
+	 */
+	HashVector hashes_;
+
+
+	/**
+	 * The open addressing table.
+	 */
+	BucketVector buckets_;
+
+
+	/**
+	 * The number of leaves in the slab.
+	 */
+	size_t leavesCount_;
+
+
+	/**
+	 * @brief  Leaf releaser
+	 *
+	 * Monadic Apply functor that is used when a leaf is released.
+	 */
+	AbstractMonadicApplyFunctor* releaser_;
+
+
+protected:// Protected data memebers
+
+	/**
+	 * @brief  The bottom of the MTBDD
+	 *
+	 * The value used for the bottom of the MTBDD.
+	 */
+	static const HandleType BOTTOM;
+
+private:  // Private methods
+
+	SlabLeafAllocator(const SlabLeafAllocator&);
+	SlabLeafAllocator& operator=(const SlabLeafAllocator&);
+
+
+	static inline size_t getHashOfLeaf(const LeafType& leaf)
+	{
+		return boost::hash<LeafType>()(leaf);
+	}
+
+	inline LeafType& leafAt(size_t index)
+	{
+		// Assertions
+		assert(index < leavesCount_);
+
+		return blocks_[index / LeavesInBlock][index % LeavesInBlock];
+	}
+
+	inline const LeafType& leafAt(size_t index) const
+	{
+		// Assertions
+		assert(index < leavesCount_);
+
+		return blocks_[index / LeavesInBlock][index % LeavesInBlock];
+	}
+
+	inline size_t indexOfHandle(const HandleType& handle) const
+	{
+		return static_cast<size_t>(handle - BOTTOM);
+	}
+
+	inline HandleType handleOfIndex(size_t index) const
+	{
+		return static_cast<HandleType>(index) + BOTTOM;
+	}
+
+
+	/**
+	 * @brief  Appends a leaf to the slab
+	 *
+	 * Copies the leaf at the end of the slab (without inserting it into the
+	 * table).
+	 *
+	 * @param[in]  leaf  The leaf
+	 * @param[in]  hash  The hash of the leaf
+	 *
+	 * @returns  The index of the leaf in the slab
+	 */
+	size_t appendLeaf(const LeafType& leaf, size_t hash)
+	{
+		if (leavesCount_ == blocks_.size() * LeavesInBlock)
+		{	// in case a new block is needed
+			blocks_.push_back(static_cast<LeafType*>(
+				::operator new(LeavesInBlock * sizeof(LeafType))));
+		}
+
+		new (blocks_[leavesCount_ / LeavesInBlock] + leavesCount_ % LeavesInBlock)
+			LeafType(leaf);
+		hashes_.push_back(hash);
+
+		return leavesCount_++;
+	}
+
+
+	/**
+	 * @brief  Finds the bucket of a leaf
+	 *
+	 * Finds the bucket that contains given leaf, or the empty bucket where the
+	 * leaf should be inserted.
+	 *
+	 * @param[in]  leaf  The leaf
+	 * @param[in]  hash  The hash of the leaf
+	 *
+	 * @returns  Index of the bucket
+	 */
+	size_t findBucket(const LeafType& leaf, size_t hash) const
+	{
+		size_t mask = buckets_.size() - 1;
+		for (size_t i = hash & mask; ; i = (i + 1) & mask)
+		{	// linear probing (there is always some empty bucket)
+			size_t entry = buckets_[i];
+			if ((entry == 0) ||
+				((hashes_[entry - 1] == hash) && (leafAt(entry - 1) == leaf)))
+			{	// in case the bucket is empty or contains the leaf
+				return i;
+			}
+		}
+	}
+
+
+	/**
+	 * @brief  Doubles the number of buckets
+	 *
+	 * Doubles the number of buckets of the table and reinserts all leaves
+	 * using their stored hashes.
+	 */
+	void growBuckets()
+	{
+		BucketVector oldBuckets(2 * buckets_.size(), 0);
+		buckets_.swap(oldBuckets);
+
+		size_t mask = buckets_.size() - 1;
+		for (BucketVector::const_iterator itBuckets = oldBuckets.begin();
+			itBuckets != oldBuckets.end(); ++itBuckets)
+		{	// reinsert all leaves
+			if (*itBuckets != 0)
+			{
+				size_t i = hashes_[*itBuckets - 1] & mask;
+				while (buckets_[i] != 0)
+				{	// find an empty bucket
+					i = (i + 1) & mask;
+				}
+
+				buckets_[i] = *itBuckets;
+			}
+		}
+	}
+
+
+	/**
+	 * @brief  Inserts leaf at index into the table
+	 *
+	 * Inserts the leaf with given index in the slab into the table and grows
+	 * the table if needed.
+	 *
+	 * @param[in]  bucket  The (empty) bucket for the leaf
+	 * @param[in]  index   The index of the leaf
+	 */
+	void insertIntoBucket(size_t bucket, size_t index)
+	{
+		// Assertions
+		assert(buckets_[bucket] == 0);
+
+		buckets_[bucket] = index + 1;
+
+		if (2 * leavesCount_ > buckets_.size())
+		{	// keep the load factor at most 1/2
+			growBuckets();
+		}
+	}
+
+protected:// Protected methods
+
+	/**
+	 * @brief  Constructor
+	 *
+	 * The default constructor
+	 */
+	SlabLeafAllocator()
+		: blocks_(),
+			hashes_(),
+			buckets_(InitialBucketsCount, 0),
+			leavesCount_(0),
+			releaser_(new ReleaserMonadicApplyFunctor(this))
+	{
+		// reserve the first position for the bottom
+		LeafType bottom = LeafType();
+		appendLeaf(bottom, getHashOfLeaf(bottom));
+	}
+
+
+	/**
+	 * @brief  Sets the value of bottom
+	 *
+	 * Sets the value of bottom of the MTBDD. This method needs to be called
+	 * before any other, otherwise the internal structure of mapping may be
+	 * inconsistent.
+	 *
+	 * @see  BOTTOM
+	 *
+	 * @param[in]  leaf  The value of the bottom
+	 */
+	void setBottom(const LeafType& leaf)
+	{
+		size_t index = indexOfHandle(BOTTOM);
+
+		leafAt(index) = leaf;
+		hashes_[index] = getHashOfLeaf(leaf);
+
+		size_t bucket = findBucket(leaf, hashes_[index]);
+		if (buckets_[bucket] == 0)
+		{	// in case the bottom is not in the table yet
+			insertIntoBucket(bucket, index);
+		}
+	}
+
+
+	/**
+	 * @brief  Creates a leaf
+	 *
+	 * Attempts to first find the leaf in the container and in case it is not
+	 * there creates a new one and returns reference to it.
+	 *
+	 * @param[in]  leaf  The value of the leaf
+	 *
+	 * @returns  Handle to the leaf
+	 */
+	HandleType createLeaf(const LeafType& leaf)
+	{
+		size_t hash = getHashOfLeaf(leaf);
+
+		// first attempt to find the leaf if it already exists
+		size_t bucket = findBucket(leaf, hash);
+		if (buckets_[bucket] != 0)
+		{	// in case the leaf is already present
+			return handleOfIndex(buckets_[bucket] - 1);
+		}
+
+		// in case the leaf is not in the structure yet
+		size_t index = appendLeaf(leaf, hash);
+		insertIntoBucket(bucket, index);
+
+		SFTA_STATISTICS(CountLeafCreated());
+
+		return handleOfIndex(index);
+	}
+
+
+	/**
+	 * @brief  Returns a leaf associated with given handle
+	 *
+	 * Returns the leaf that is at given container associated with given handle.
+	 *
+	 * @param[in]  handle  The handle the leaf for which is to be found
+	 *
+	 * @returns  The leaf associated with given handle
+	 */
+	LeafType& getLeafOfHandle(const HandleType& handle)
+	{
+		if (indexOfHandle(handle) >= leavesCount_)
+		{	// in case it couldn't be found
+			throw std::runtime_error("Trying to access leaf \""
+				+ Convert::ToString(handle) + "\" that is not managed.");
+		}
+
+		return leafAt(indexOfHandle(handle));
+	}
+
+
+	/**
+	 * @brief  @copybrief getLeafOfHandle()
+	 *
+	 * @copydetails  getLeafOfHandle()
+	 */
+	const LeafType& getLeafOfHandle(const HandleType& handle) const
+	{
+		if (indexOfHandle(handle) >= leavesCount_)
+		{	// in case it couldn't be found
+			throw std::runtime_error("Trying to access leaf \""
+				+ Convert::ToString(handle) + "\" that is not managed.");
+		}
+
+		return leafAt(indexOfHandle(handle));
+	}
+
+
+	/**
+	 * @brief  Returns all handles
+	 *
+	 * Returns a std::vector of all handles that have a leaf associated in the
+	 * container
+	 *
+	 * @returns  A std::vector vector of all handles
+	 */
+	std::vector<HandleType> getAllHandles() const
+	{
+		std::vector<HandleType> result;
+		result.reserve(leavesCount_);
+
+		for (size_t i = 0; i < leavesCount_; ++i)
+		{	// push back all handles that have associated a leaf in the container
+			result.push_back(handleOfIndex(i));
+		}
+
+		return result;
+	}
+
+
+	/**
+	 * @brief  Gets the release functor
+	 *
+	 * Returns the release monadic Apply functor. This functor takes care of
+	 * properly releasing given leaf.
+	 *
+	 * @returns  Proper release monadic Apply functor
+	 */
+	inline AbstractMonadicApplyFunctor* getLeafReleaser()
+	{
+		return releaser_;
+	}
+
+
+	/**
+	 * @brief  Serialization method
+	 *
+	 * This method serializes the object into std::string
+	 */
+	std::string serialize() const
+	{
+		std::string result;
+
+		result += "<slableafallocator>\n";
+
+		for (size_t i = 0; i < leavesCount_; ++i)
+		{
+			result += "<pairing>";
+			result += "<left>";
+			result += Convert::ToString(handleOfIndex(i));
+			result += "</left>";
+			result += "<right>";
+			result += Convert::ToString(leafAt(i));
+			result += "</right>";
+			result += "</pairing>";
+			result += "\n";
+		}
+
+		result += "</slableafallocator>";
+
+		return result;
+	}
+
+
+	/**
+	 * @brief  Destructor
+	 *
+	 * The destructor.
+	 */
+	~SlabLeafAllocator()
+	{
+		delete releaser_;
+
+		for (size_t i = 0; i < leavesCount_; ++i)
+		{	// destroy all leaves
+			leafAt(i).~LeafType();
+		}
+
+		for (typename BlockVector::iterator itBlocks = blocks_.begin();
+			itBlocks != blocks_.end(); ++itBlocks)
+		{	// release all blocks
+			::operator delete(*itBlocks);
+		}
+	}
+};
+
+
+// The bottom of the MTBDD
+template
+<
+	typename L,
+	typename H,
+	class AMAF
+>
+const typename SFTA::Private::SlabLeafAllocator<L, H, AMAF>::HandleType
+	SFTA::Private::SlabLeafAllocator<L, H, AMAF>::BOTTOM = 0;
+
+#endif
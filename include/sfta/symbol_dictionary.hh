@@ -11,8 +11,21 @@
 #ifndef _SFTA_SYMBOL_DICTIONARY_HH_
 #define _SFTA_SYMBOL_DICTIONARY_HH_
 
+// Standard library header files
+#include <algorithm>
+#include <cassert>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <tr1/unordered_map>
+#include <vector>
+
 // SFTA header files
 #include <sfta/convert.hh>
+#include <sfta/memory_usage.hh>
+
+// Boost library headers
+#include <boost/functional/hash.hpp>
 
 
 // insert the class into proper namespace
@@ -33,9 +46,36 @@ namespace SFTA
  * @date    2010
  *
  * This class can be used as a two-way dictionary for two different types.
+ * Input symbols are ranked, i.e., they are translated together with their
+ * arity, and each arity has its own dense code space. The arity occupies the
+ * first variables of the output symbol and the position of the symbol among
+ * the symbols of its arity follows, so that a transition diagram that only
+ * contains symbols of one arity (such as the one for a left-hand side of a
+ * bottom-up automaton) spans just the codes of that arity, while codes of
+ * different arities never collide.
+ *
+ * The width of output symbols is not fixed in advance. The position is
+ * encoded in a sequence of @e fields of variables: a field of @e f variables
+ * holds positions <tt>0 .. 2^f - 2</tt> and its last value is an escape
+ * denoting that the position continues in the next field. The first field is
+ * just wide enough for the alphabet registered using TranslateAll() and a new
+ * field is appended whenever the code space is exhausted. An output symbol
+ * only spans the fields up to the one holding its position, i.e., the
+ * variables above are <em>don't care</em>. Since no output symbol ever
+ * matches the escape of an earlier field, symbols encoded before the width
+ * grew need not be changed: extending them with don't care variables keeps
+ * all codes disjoint.
+ *
+ * Optionally, the values of fields can be encoded using the Gray code, so
+ * that symbols registered one after another get codes that differ in a
+ * single variable.
  *
  * @tparam  InputSymbol    Input symbol type.
- * @tparam  OutputSymbol   Output symbol type.
+ * @tparam  OutputSymbol   Output symbol type. It needs to provide the
+ *                         constructor from the number of variables and an
+ *                         index, the ToIndex() method that gives the index
+ *                         back, VariablesCount() and GetIthVariableValue()
+ *                         with the ZERO and ONE values.
  */
 template
 <
@@ -49,52 +89,337 @@ public:   // Public data types
 	typedef InputSymbol InputSymbolType;
 	typedef OutputSymbol OutputSymbolType;
 
+	typedef std::pair<InputSymbolType, size_t> RankedSymbolType;
+	typedef std::vector<RankedSymbolType> RankedSymbolVector;
+
 private:  // Private data types
 
-	typedef std::map<InputSymbolType, OutputSymbolType> I2OMapType;
-	typedef std::map<OutputSymbolType, InputSymbolType> O2IMapType;
+	typedef std::tr1::unordered_map<RankedSymbolType, OutputSymbolType,
+		boost::hash<RankedSymbolType> > I2OMapType;
+	typedef std::vector<InputSymbolType> O2IVectorType;
+	typedef std::vector<O2IVectorType> ArityToO2IVectorType;
+
+	typedef std::vector<size_t> FieldVector;
 
 	typedef SFTA::Private::Convert Convert;
 
+	enum
+	{
+		// the default number of variables used for the arity
+		DefaultArityBits = 4
+	};
+
 private:  // Private data members
 
 	I2OMapType i2o_;
-	O2IMapType o2i_;
 
-	OutputSymbolType nextSymbol_;
+	/**
+	 * @brief  Inverse translation
+	 *
+	 * Dense tables (one for each arity) indexed by the position of the output
+	 * symbol in the code space of its arity.
+	 */
+	ArityToO2IVectorType o2i_;
+
+	RankedSymbolVector symbols_;
+
+	size_t arityBits_;
+
+	/**
+	 * @brief  Widths of fields
+	 *
+	 * The numbers of variables of the fields that encode the position of a
+	 * symbol, from the lowest variables to the highest.
+	 */
+	FieldVector fieldBits_;
+
+	/**
+	 * @brief  The number of variables of all fields
+	 */
+	size_t indexBits_;
+
+	/**
+	 * @brief  The number of positions that can be encoded in all fields
+	 */
+	size_t capacity_;
+
+	bool grayCoding_;
+
+private:  // Private methods
+
+	static inline size_t toGray(size_t position)
+	{
+		return position ^ (position >> 1);
+	}
+
+	static size_t fromGray(size_t code)
+	{
+		size_t position = code;
+		for (size_t shift = 1;
+			shift < static_cast<size_t>(std::numeric_limits<size_t>::digits);
+			shift <<= 1)
+		{	// fold all higher bits
+			position ^= position >> shift;
+		}
+
+		return position;
+	}
+
+	static inline size_t maxCodeBits()
+	{
+		// keep one bit spare so that shifts by the width are defined
+		return static_cast<size_t>(std::numeric_limits<size_t>::digits) - 1;
+	}
+
+	static inline size_t fieldCapacity(size_t bits)
+	{
+		return (static_cast<size_t>(1) << bits) - 1;
+	}
+
+	/**
+	 * @brief  The smallest field for given number of positions
+	 *
+	 * Returns the smallest number of variables of a field that can hold given
+	 * number of positions (and the escape).
+	 */
+	static size_t bitsForPositions(size_t count)
+	{
+		size_t bits = 1;
+		while ((bits < maxCodeBits()) && (fieldCapacity(bits) < count))
+		{	// find the smallest sufficient width
+			++bits;
+		}
+
+		return bits;
+	}
+
+	inline size_t encodeFieldValue(size_t value) const
+	{
+		return grayCoding_? toGray(value) : value;
+	}
+
+	inline size_t decodeFieldValue(size_t value) const
+	{
+		return grayCoding_? fromGray(value) : value;
+	}
+
+	/**
+	 * @brief  Makes room for positions
+	 *
+	 * Appends a field if the code space cannot hold given number of positions
+	 * for an arity. A field appended on demand is at least as wide as all the
+	 * previous fields together so that the code space grows geometrically.
+	 *
+	 * @param[in]  count  The number of positions
+	 */
+	void reservePositions(size_t count)
+	{
+		if (count <= capacity_)
+		{	// in case there is enough space
+			return;
+		}
+
+		size_t bits = std::max(bitsForPositions(count - capacity_), indexBits_);
+		if (arityBits_ + indexBits_ + bits > maxCodeBits())
+		{	// in case the code would not fit into an index
+			throw std::runtime_error(__func__ +
+				std::string(": too many symbols: ") + Convert::ToString(count));
+		}
+
+		fieldBits_.push_back(bits);
+		indexBits_ += bits;
+		capacity_ += fieldCapacity(bits);
+	}
+
+	OutputSymbolType encode(size_t position, size_t arity) const
+	{
+		size_t code = arity;
+		size_t shift = arityBits_;
+		for (FieldVector::const_iterator itFields = fieldBits_.begin();
+			itFields != fieldBits_.end(); ++itFields)
+		{	// find the field that holds the position
+			size_t capacity = fieldCapacity(*itFields);
+			if (position < capacity)
+			{	// in case the position fits into the field
+				code |= encodeFieldValue(position) << shift;
+				return OutputSymbolType(shift + *itFields, code);
+			}
+
+			// the escape value is the one after the last position
+			code |= encodeFieldValue(capacity) << shift;
+			position -= capacity;
+			shift += *itFields;
+		}
+
+		assert(false);       // fail gracefully
+		return OutputSymbolType(0, 0);
+	}
+
+	/**
+	 * @brief  Reads variables of a pattern
+	 *
+	 * Reads variables <tt>shift .. shift + bits - 1</tt> of an output symbol
+	 * that may contain don't care variables as a mask of the cared variables
+	 * and their values. Variables missing in the symbol are don't care.
+	 *
+	 * @param[in]   symbol  The output symbol
+	 * @param[in]   shift   The index of the first variable
+	 * @param[in]   bits    The number of variables
+	 * @param[out]  care    The mask of variables that are not don't care
+	 * @param[out]  value   The values of the cared variables
+	 */
+	static void readPattern(const OutputSymbolType& symbol, size_t shift,
+		size_t bits, size_t& care, size_t& value)
+	{
+		care = 0;
+		value = 0;
+		for (size_t i = 0; (i < bits) && (shift + i < symbol.VariablesCount()); ++i)
+		{	// read the cared variables
+			size_t bit = static_cast<size_t>(1) << i;
+			switch (symbol.GetIthVariableValue(shift + i))
+			{
+				case OutputSymbolType::ZERO: care |= bit; break;
+				case OutputSymbolType::ONE:  care |= bit; value |= bit; break;
+				default: break;
+			}
+		}
+	}
+
+	static size_t bitsCount(size_t mask)
+	{
+		size_t result = 0;
+		for (; mask != 0; mask &= mask - 1)
+		{	// clear the lowest set bit
+			++result;
+		}
+
+		return result;
+	}
+
+	/**
+	 * @brief  Positions matched by a pattern
+	 *
+	 * Appends the positions (lower than @p count) the codes of which share a
+	 * concrete symbol with the pattern. The fields are decoded from the cared
+	 * variables of the pattern: in each field, either the values consistent
+	 * with the pattern or the positions of known symbols are enumerated
+	 * (whichever is fewer) and the next field is only visited if the escape
+	 * is consistent with the pattern. Every position is appended at most once.
+	 *
+	 * @param[in]   symbol     The output symbol
+	 * @param[in]   count      The number of known positions
+	 * @param[out]  positions  The vector the positions are appended to
+	 */
+	void collectPositions(const OutputSymbolType& symbol, size_t count,
+		std::vector<size_t>& positions) const
+	{
+		size_t base = 0;
+		size_t shift = arityBits_;
+		for (FieldVector::const_iterator itFields = fieldBits_.begin();
+			(itFields != fieldBits_.end()) && (base < count); ++itFields)
+		{	// decode the fields while the escape is consistent with the pattern
+			size_t capacity = fieldCapacity(*itFields);
+			size_t known = std::min(capacity, count - base);
+
+			size_t care, value;
+			readPattern(symbol, shift, *itFields, care, value);
+
+			size_t dontCares = capacity & ~care;
+			size_t dontCaresCount = bitsCount(dontCares);
+			if ((dontCaresCount < *itFields) &&
+				((static_cast<size_t>(1) << dontCaresCount) <= known))
+			{	// enumerate the values consistent with the pattern
+				size_t subset = 0;
+				do
+				{
+					size_t position = decodeFieldValue(value | subset);
+					if (position < known)
+					{	// in case it is the position of a symbol (not the escape)
+						positions.push_back(base + position);
+					}
+
+					subset = (subset - dontCares) & dontCares;
+				} while (subset != 0);
+			}
+			else
+			{	// check the positions of known symbols
+				for (size_t position = 0; position < known; ++position)
+				{
+					if ((encodeFieldValue(position) & care) == value)
+					{
+						positions.push_back(base + position);
+					}
+				}
+			}
+
+			if ((encodeFieldValue(capacity) & care) != value)
+			{	// in case the pattern excludes the escape
+				return;
+			}
+
+			base += capacity;
+			shift += *itFields;
+		}
+	}
 
 public:   // Public methods
 
 
-	SymbolDictionary(const OutputSymbolType& initialSymbol)
+	/**
+	 * @brief  Constructor
+	 *
+	 * Creates an empty dictionary, the width of output symbols is given by
+	 * the symbols registered later.
+	 *
+	 * @param[in]  arityBits    The number of variables used for the arity
+	 */
+	explicit SymbolDictionary(size_t arityBits = DefaultArityBits)
 		: i2o_(),
 			o2i_(),
-			nextSymbol_(initialSymbol)
-	{ }
+			symbols_(),
+			arityBits_(arityBits),
+			fieldBits_(),
+			indexBits_(0),
+			capacity_(0),
+			grayCoding_(false)
+	{
+		if (arityBits_ >= maxCodeBits())
+		{	// in case there is no space for the position
+			throw std::runtime_error(__func__ +
+				std::string(": arities of ") + Convert::ToString(arityBits_) +
+				" bits leave no space for symbols");
+		}
+	}
 
 
-	OutputSymbolType Translate(const InputSymbolType& symbol)
+	OutputSymbolType Translate(const InputSymbolType& symbol, size_t arity)
 	{
+		RankedSymbolType rankedSymbol(symbol, arity);
+
 		typename I2OMapType::const_iterator itSymbol;
-		if ((itSymbol = i2o_.find(symbol)) == i2o_.end())
+		if ((itSymbol = i2o_.find(rankedSymbol)) == i2o_.end())
 		{	// in case a new symbol appeared
-			OutputSymbolType newSymbol = nextSymbol_;
-			++nextSymbol_;
-
-			if (!(i2o_.insert(std::make_pair(symbol, newSymbol))).second)
-			{
+			if ((arity >> arityBits_) != 0)
+			{	// in case the arity cannot be encoded
 				throw std::runtime_error(__func__ +
-					std::string(": inserting already existing translation ") +
-					Convert::ToString(symbol) + " -> " + Convert::ToString(newSymbol));
+					std::string(": arity out of range ") + Convert::ToString(symbol) +
+					":" + Convert::ToString(arity));
 			}
 
-			if (!(o2i_.insert(std::make_pair(newSymbol, symbol))).second)
-			{
-				throw std::runtime_error(__func__ +
-					std::string(": inserting already existing inverse translation ") +
-					Convert::ToString(newSymbol) + " -> " + Convert::ToString(symbol));
+			if (arity >= o2i_.size())
+			{	// in case this is the first symbol of the arity
+				o2i_.resize(arity + 1);
 			}
 
+			O2IVectorType& arityO2I = o2i_[arity];
+			reservePositions(arityO2I.size() + 1);
+
+			OutputSymbolType newSymbol = encode(arityO2I.size(), arity);
+
+			i2o_.insert(std::make_pair(rankedSymbol, newSymbol));
+			arityO2I.push_back(symbol);
+			symbols_.push_back(rankedSymbol);
+
 			return newSymbol;
 		}
 
@@ -102,32 +427,224 @@ public:   // Public methods
 	}
 
 
-	std::vector<InputSymbolType> GetVectorOfInputSymbols() const
+	/**
+	 * @brief  Sets the Gray coding of positions
+	 *
+	 * Enables or disables encoding of the positions of symbols in the code
+	 * spaces of their arities using the Gray code. It can only be changed
+	 * while the dictionary is empty.
+	 *
+	 * @param[in]  grayCoding  Should the Gray code be used?
+	 */
+	void SetGrayCoding(bool grayCoding)
 	{
-		std::vector<InputSymbolType> result;
+		if ((grayCoding != grayCoding_) && !symbols_.empty())
+		{	// in case some symbols have already been encoded
+			throw std::runtime_error(__func__ +
+				std::string(": the dictionary is not empty"));
+		}
+
+		grayCoding_ = grayCoding;
+	}
 
-		for (typename I2OMapType::const_iterator itSymbols = i2o_.begin();
-			itSymbols != i2o_.end(); ++itSymbols)
-		{
-			result.push_back(itSymbols->first);
+
+	/**
+	 * @brief  Registers a whole alphabet
+	 *
+	 * Translates all symbols of given ranked alphabet at once (e.g. the
+	 * alphabet declared in the @c Ops line of a Timbuk file), so that the
+	 * dictionary does not need to grow during later translations. The code
+	 * space is extended by at most one field that is just wide enough for the
+	 * alphabet.
+	 *
+	 * @param[in]  symbols  The symbols of the alphabet with their arities
+	 */
+	void TranslateAll(const RankedSymbolVector& symbols)
+	{
+		i2o_.rehash(i2o_.size() + symbols.size());
+		symbols_.reserve(symbols_.size() + symbols.size());
+
+		std::vector<size_t> counts;
+		for (size_t arity = 0; arity < o2i_.size(); ++arity)
+		{	// start with the symbols that are already known
+			counts.push_back(o2i_[arity].size());
 		}
 
-		return result;
+		size_t maxCount = 0;
+		for (typename RankedSymbolVector::const_iterator itSymbols =
+			symbols.begin(); itSymbols != symbols.end(); ++itSymbols)
+		{	// count new symbols of each arity
+			if ((itSymbols->second >> arityBits_) != 0)
+			{	// arities out of range are reported by Translate()
+				continue;
+			}
+
+			if (i2o_.find(*itSymbols) == i2o_.end())
+			{	// in case the symbol is new
+				if (itSymbols->second >= counts.size())
+				{
+					counts.resize(itSymbols->second + 1, 0);
+				}
+
+				maxCount = std::max(maxCount, ++counts[itSymbols->second]);
+			}
+		}
+
+		reservePositions(maxCount);
+
+		for (typename RankedSymbolVector::const_iterator itSymbols =
+			symbols.begin(); itSymbols != symbols.end(); ++itSymbols)
+		{	// translate all symbols
+			Translate(itSymbols->first, itSymbols->second);
+		}
 	}
 
 
-	InputSymbolType TranslateInverse(const OutputSymbolType& symbol)
+	/**
+	 * @brief  Returns all symbols
+	 *
+	 * Returns all symbols together with their arities in the order in which
+	 * they were registered.
+	 *
+	 * @returns  The vector of ranked symbols
+	 */
+	inline const RankedSymbolVector& GetVectorOfRankedSymbols() const
 	{
-		typename O2IMapType::const_iterator itSymbol;
-		if ((itSymbol = o2i_.find(symbol)) == o2i_.end())
-		{	// in case a new symbol appeared
-			throw std::runtime_error(__func__ +
-				std::string(": invalid translation from ") + Convert::ToString(symbol));
+		return symbols_;
+	}
+
+
+	/**
+	 * @brief  Returns the width of output symbols
+	 *
+	 * Returns the number of variables spanned by the longest output symbol,
+	 * i.e., the number of variables the code space currently occupies.
+	 *
+	 * @returns  The number of variables
+	 */
+	inline size_t GetSymbolWidth() const
+	{
+		return arityBits_ + indexBits_;
+	}
+
+
+	/**
+	 * @brief  Inverse translation
+	 *
+	 * Translates a concrete output symbol back to the input symbol. The
+	 * output symbol may be wider than the code of the input symbol (e.g. if it
+	 * comes from an MTBDD that tests variables of higher fields); the
+	 * variables above the field with the position are don't care in the code
+	 * and thus ignored. An output symbol that ends before the field with the
+	 * position does not denote a single input symbol and is rejected.
+	 *
+	 * @param[in]  symbol  The output symbol
+	 *
+	 * @returns  The input symbol
+	 */
+	const InputSymbolType& TranslateInverse(const OutputSymbolType& symbol) const
+	{
+		size_t code = symbol.ToIndex();
+		size_t arity = code & ((static_cast<size_t>(1) << arityBits_) - 1);
+
+		size_t position = 0;
+		size_t shift = arityBits_;
+		for (FieldVector::const_iterator itFields = fieldBits_.begin();
+			itFields != fieldBits_.end(); ++itFields)
+		{	// read the fields until one that does not contain the escape
+			if (shift + *itFields > symbol.VariablesCount())
+			{	// in case the field is not part of the symbol
+				break;
+			}
+
+			size_t capacity = fieldCapacity(*itFields);
+			size_t value = decodeFieldValue((code >> shift) & capacity);
+			if (value < capacity)
+			{	// in case the position ends in this field
+				position += value;
+				if ((arity < o2i_.size()) && (position < o2i_[arity].size()))
+				{	// in case the symbol is known
+					return o2i_[arity][position];
+				}
+
+				break;
+			}
+
+			position += capacity;
+			shift += *itFields;
 		}
 
-		return itSymbol->second;
+		throw std::runtime_error(__func__ +
+			std::string(": invalid translation from ") + Convert::ToString(symbol));
+	}
+
+
+	/**
+	 * @brief  Inverse translation of a set of symbols
+	 *
+	 * Translates an output symbol that may contain don't care variables (such
+	 * as a path of an MTBDD) to all input symbols whose codes share a concrete
+	 * symbol with it. Every input symbol is listed at most once, so the don't
+	 * care variables above the fields of short codes are never expanded. The
+	 * symbols are ordered by arity and then by their positions.
+	 *
+	 * The fields are decoded from the cared variables of the pattern, so the
+	 * work is proportional to the number of returned symbols (and the don't
+	 * care variables of the pattern) rather than to the size of the alphabet.
+	 * Note that after reordering of variables, one code may be split among
+	 * several paths, so a symbol may be returned for several patterns.
+	 *
+	 * @param[in]  symbol  The output symbol
+	 *
+	 * @returns  The vector of input symbols
+	 */
+	std::vector<InputSymbolType> TranslateInverseAll(
+		const OutputSymbolType& symbol) const
+	{
+		std::vector<InputSymbolType> result;
+
+		size_t arityCare, arityValue;
+		readPattern(symbol, 0, arityBits_, arityCare, arityValue);
+
+		std::vector<size_t> positions;
+		for (size_t arity = 0; arity < o2i_.size(); ++arity)
+		{	// decode the positions of symbols of arities matched by the pattern
+			if ((arity & arityCare) != arityValue)
+			{
+				continue;
+			}
+
+			const O2IVectorType& arityO2I = o2i_[arity];
+
+			positions.clear();
+			collectPositions(symbol, arityO2I.size(), positions);
+			std::sort(positions.begin(), positions.end());
+
+			for (std::vector<size_t>::const_iterator itPositions = positions.begin();
+				itPositions != positions.end(); ++itPositions)
+			{
+				result.push_back(arityO2I[*itPositions]);
+			}
+		}
+
+		return result;
 	}
 
+	/**
+	 * @brief  Memory used by the dictionary
+	 *
+	 * Returns the estimated number of bytes allocated by the dictionary on
+	 * the heap.
+	 *
+	 * @returns  The number of bytes
+	 */
+	size_t GetMemoryUsage() const
+	{
+		typedef SFTA::Private::MemoryEstimate MemoryEstimate;
+
+		return MemoryEstimate::Of(i2o_) + MemoryEstimate::Of(o2i_) +
+			MemoryEstimate::Of(symbols_) + MemoryEstimate::Of(fieldBits_);
+	}
 };
 
 #endif
@@ -0,0 +1,355 @@
+/*****************************************************************************
+ *  Symbolic Finite Tree Automata Library
+ *
+ *  Description:
+ *    File with the SymbolStatistics class.
+ *
+ *****************************************************************************/
+
+#ifndef _SFTA_SYMBOL_STATISTICS_HH_
+#define _SFTA_SYMBOL_STATISTICS_HH_
+
+// Standard library headers
+#include <algorithm>
+#include <cassert>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// SFTA headers
+#include <sfta/set.hh>
+#include <sfta/vector.hh>
+
+
+// insert the class into proper namespace
+namespace SFTA
+{
+	class SymbolStatistics;
+}
+
+
+/**
+ * @brief   Statistics of symbols of automata
+ *
+ * Class that provides the same building interface as automata covers but
+ * instead of building an automaton it only collects statistics about the
+ * usage of symbols in transitions. These are then used to compute an order in
+ * which symbols should be registered in a SymbolDictionary so that the
+ * resulting MTBDDs are small. Symbols that are used together (i.e., that
+ * appear with the same left-hand side and lead to the same set of states)
+ * should get close codes, because the MTBDD can then share the paths
+ * leading to the same leaf.
+ */
+class SFTA::SymbolStatistics
+{
+public:   // Public data types
+
+	typedef std::string StateType;
+	typedef std::string SymbolType;
+
+	typedef SFTA::Vector<StateType> LeftHandSideType;
+	typedef SFTA::Set<StateType> RightHandSideType;
+
+	typedef std::pair<SymbolType, size_t> RankedSymbolType;
+	typedef std::vector<RankedSymbolType> RankedSymbolVector;
+
+	/**
+	 * @brief  Encoding strategy
+	 *
+	 * Strategy that determines the order in which symbols are registered.
+	 */
+	enum EncodingStrategy
+	{
+		ENCODING_FIRST_SEEN,     ///< in the order of first occurrence
+		ENCODING_FREQUENCY,      ///< the most frequent symbols first
+		ENCODING_GRAY,           ///< first occurrence with the Gray code
+		ENCODING_COOCCURRENCE    ///< symbols used together get adjacent codes
+	};
+
+private:  // Private data types
+
+	typedef std::map<RankedSymbolType, size_t> SymbolToIndexMap;
+
+	typedef std::vector<size_t> IndexVector;
+
+	typedef std::pair<LeftHandSideType, SymbolType> LhsSymbolPairType;
+	typedef std::map<LhsSymbolPairType, RightHandSideType> LhsSymbolToRhsMap;
+
+	typedef std::pair<LeftHandSideType, RightHandSideType> LhsRhsPairType;
+	typedef std::map<LhsRhsPairType, IndexVector> LhsRhsToSymbolsMap;
+
+	typedef std::map<std::pair<size_t, size_t>, size_t> WeightMap;
+
+	/**
+	 * @brief  Comparator of symbols according to frequency
+	 *
+	 * Orders indices of symbols according to descending frequency, ties are
+	 * broken by the order of first occurrence.
+	 */
+	class FrequencyCompare
+	{
+	private:  // Private data members
+
+		const IndexVector* frequencies_;
+
+	public:   // Public methods
+
+		explicit FrequencyCompare(const IndexVector& frequencies)
+			: frequencies_(&frequencies)
+		{ }
+
+		bool operator()(size_t lhs, size_t rhs) const
+		{
+			if ((*frequencies_)[lhs] != (*frequencies_)[rhs])
+			{	// in case the frequencies differ
+				return (*frequencies_)[lhs] > (*frequencies_)[rhs];
+			}
+
+			return lhs < rhs;
+		}
+	};
+
+private:  // Private data members
+
+	RankedSymbolVector symbols_;
+
+	SymbolToIndexMap symbolToIndex_;
+
+	IndexVector frequencies_;
+
+	LhsSymbolToRhsMap lhsSymbolToRhs_;
+
+private:  // Private methods
+
+	size_t getSymbolIndex(const SymbolType& symbol, size_t arity)
+	{
+		RankedSymbolType rankedSymbol(symbol, arity);
+		SymbolToIndexMap::const_iterator itSymbols =
+			symbolToIndex_.find(rankedSymbol);
+		if (itSymbols != symbolToIndex_.end())
+		{	// in case the symbol is already known
+			return itSymbols->second;
+		}
+
+		size_t index = symbols_.size();
+		symbols_.push_back(rankedSymbol);
+		frequencies_.push_back(0);
+		symbolToIndex_.insert(std::make_pair(rankedSymbol, index));
+
+		return index;
+	}
+
+	static inline size_t getWeight(const WeightMap& weights, size_t lhs,
+		size_t rhs)
+	{
+		WeightMap::const_iterator itWeights =
+			weights.find(std::make_pair(std::min(lhs, rhs), std::max(lhs, rhs)));
+
+		return (itWeights == weights.end())? 0 : itWeights->second;
+	}
+
+	IndexVector computeCooccurrenceOrder() const
+	{
+		// group symbols by the pairs of left-hand sides and right-hand sides
+		LhsRhsToSymbolsMap groups;
+		for (LhsSymbolToRhsMap::const_iterator itTrans = lhsSymbolToRhs_.begin();
+			itTrans != lhsSymbolToRhs_.end(); ++itTrans)
+		{	// for each left-hand side and symbol
+			SymbolToIndexMap::const_iterator itSymbols =
+				symbolToIndex_.find(RankedSymbolType(itTrans->first.second,
+					itTrans->first.first.size()));
+			assert(itSymbols != symbolToIndex_.end());
+
+			groups[LhsRhsPairType(itTrans->first.first, itTrans->second)].push_back(
+				itSymbols->second);
+		}
+
+		// the weight of a pair of symbols is the number of groups they share
+		WeightMap weights;
+		for (LhsRhsToSymbolsMap::const_iterator itGroups = groups.begin();
+			itGroups != groups.end(); ++itGroups)
+		{	// for each group
+			const IndexVector& group = itGroups->second;
+			for (size_t i = 0; i < group.size(); ++i)
+			{
+				for (size_t j = i + 1; j < group.size(); ++j)
+				{
+					++weights[std::make_pair(std::min(group[i], group[j]),
+						std::max(group[i], group[j]))];
+				}
+			}
+		}
+
+		// greedily chain symbols of each arity, starting with the most frequent
+		// one and always appending the unplaced symbol of the same arity that
+		// is the most tightly bound to the last placed one
+		IndexVector candidates = computeFrequencyOrder();
+		std::vector<bool> placed(symbols_.size(), false);
+		IndexVector result;
+		for (size_t i = 0; i < candidates.size(); ++i)
+		{	// for each symbol in the order of frequency
+			if (placed[candidates[i]])
+			{	// in case the symbol has already been placed
+				continue;
+			}
+
+			size_t last = candidates[i];
+			placed[last] = true;
+			result.push_back(last);
+
+			while (true)
+			{	// while there are symbols bound to the last one
+				size_t best = symbols_.size();
+				size_t bestWeight = 0;
+				for (size_t j = i + 1; j < candidates.size(); ++j)
+				{	// find the most tightly bound unplaced symbol of the same arity
+					size_t cand = candidates[j];
+					if (placed[cand] || (symbols_[cand].second != symbols_[last].second))
+					{	// in case the symbol is not eligible
+						continue;
+					}
+
+					size_t weight = getWeight(weights, last, cand);
+					if (weight > bestWeight)
+					{	// in case we found a better candidate
+						best = cand;
+						bestWeight = weight;
+					}
+				}
+
+				if (best == symbols_.size())
+				{	// in case there is no bound symbol
+					break;
+				}
+
+				last = best;
+				placed[last] = true;
+				result.push_back(last);
+			}
+		}
+
+		return result;
+	}
+
+	IndexVector computeFrequencyOrder() const
+	{
+		IndexVector result(symbols_.size());
+		for (size_t i = 0; i < result.size(); ++i)
+		{	// start with the order of first occurrence
+			result[i] = i;
+		}
+
+		std::sort(result.begin(), result.end(), FrequencyCompare(frequencies_));
+
+		return result;
+	}
+
+public:   // Public methods
+
+	SymbolStatistics()
+		: symbols_(),
+			symbolToIndex_(),
+			frequencies_(),
+			lhsSymbolToRhs_()
+	{ }
+
+	inline void AddState(const StateType& /* state */)
+	{ }
+
+	inline void SetStateFinal(const StateType& /* state */)
+	{ }
+
+	inline void SetStateInitial(const StateType& /* state */)
+	{ }
+
+	void AddSymbols(const RankedSymbolVector& symbols)
+	{
+		for (RankedSymbolVector::const_iterator itSymbols = symbols.begin();
+			itSymbols != symbols.end(); ++itSymbols)
+		{	// for each symbol
+			getSymbolIndex(itSymbols->first, itSymbols->second);
+		}
+	}
+
+	void AddTransition(const LeftHandSideType& lhs, const SymbolType& symbol,
+		const RightHandSideType& rhs)
+	{
+		++frequencies_[getSymbolIndex(symbol, lhs.size())];
+
+		RightHandSideType& states = lhsSymbolToRhs_[LhsSymbolPairType(lhs, symbol)];
+		states.insert(rhs.begin(), rhs.end());
+	}
+
+	/**
+	 * @brief  Clears the statistics
+	 *
+	 * Clears all statistics collected so far.
+	 */
+	void Clear()
+	{
+		symbols_.clear();
+		symbolToIndex_.clear();
+		frequencies_.clear();
+		lhsSymbolToRhs_.clear();
+	}
+
+	/**
+	 * @brief  Returns the order of symbols
+	 *
+	 * Returns the ranked symbols in the order in which they should be
+	 * registered in a SymbolDictionary according to given strategy.
+	 *
+	 * @param[in]  strategy  The encoding strategy
+	 *
+	 * @returns  Vector of ranked symbols
+	 */
+	RankedSymbolVector GetSymbolOrder(EncodingStrategy strategy) const
+	{
+		IndexVector order;
+		switch (strategy)
+		{
+			case ENCODING_FIRST_SEEN:
+			case ENCODING_GRAY:
+				return symbols_;
+
+			case ENCODING_FREQUENCY:
+				order = computeFrequencyOrder();
+				break;
+
+			case ENCODING_COOCCURRENCE:
+				order = computeCooccurrenceOrder();
+				break;
+
+			default:
+				throw std::runtime_error(__func__ +
+					std::string(": invalid encoding strategy"));
+		}
+
+		RankedSymbolVector result;
+		for (IndexVector::const_iterator itOrder = order.begin();
+			itOrder != order.end(); ++itOrder)
+		{	// for each index of a symbol
+			result.push_back(symbols_[*itOrder]);
+		}
+
+		return result;
+	}
+
+	/**
+	 * @brief  Does the strategy use the Gray code?
+	 *
+	 * Returns @p true if the given strategy requires the positions of symbols
+	 * to be encoded using the Gray code.
+	 *
+	 * @param[in]  strategy  The encoding strategy
+	 *
+	 * @returns  @p true if the Gray code is to be used, @p false otherwise
+	 */
+	static inline bool UsesGrayCoding(EncodingStrategy strategy)
+	{
+		return (strategy == ENCODING_GRAY) || (strategy == ENCODING_COOCCURRENCE);
+	}
+};
+
+#endif
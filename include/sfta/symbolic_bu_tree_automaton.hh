@@ -13,6 +13,8 @@
 
 // SFTA headers
 #include <sfta/abstract_bu_tree_automaton.hh>
+#include <sfta/bitmap_set.hh>
+#include <sfta/memory_usage.hh>
 #include <sfta/ordered_vector.hh>
 #include <sfta/vector_map.hh>
 
@@ -134,6 +136,7 @@ public:   // Public data types
 private:  // Private data types
 
 	typedef SFTA::Private::Convert Convert;
+	typedef SFTA::Private::BitmapSet<StateType> StateBitmapType;
 	typedef typename MTBDDTTWrapperType::SharedMTBDDType SharedMTBDDType;
 	typedef typename SharedMTBDDType::DescriptionType TransitionMapType;
 
@@ -144,6 +147,10 @@ private:  // Private data members
 
 	StateSetType finalStates_;
 
+	StateBitmapType statesBitmap_;
+
+	StateBitmapType finalStatesBitmap_;
+
 	TTWrapperPtrType ttWrapper_;
 
 	RootType sinkSuperState_;
@@ -173,6 +180,8 @@ protected:// Protected methods
 	{
 		states_.insert(aut.states_);
 		finalStates_.insert(aut.finalStates_);
+		statesBitmap_.insert(aut.statesBitmap_);
+		finalStatesBitmap_.insert(aut.finalStatesBitmap_);
 
 		// also copy superstates
 		rootMap_.insert(aut.rootMap_);
@@ -208,7 +217,7 @@ protected:// Protected methods
 
 	inline bool isStateLocal(const StateType& state) const
 	{
-		return (states_.find(state) != states_.end());
+		return statesBitmap_.Contains(state);
 	}
 
 	bool vectorContainsLocalStates(const LeftHandSideType& vec) const
@@ -235,6 +244,8 @@ public:   // Public methods
 	SymbolicBUTreeAutomaton()
 		: states_(),
 			finalStates_(),
+			statesBitmap_(),
+			finalStatesBitmap_(),
 			ttWrapper_(new MTBDDTTWrapperType()),
 			sinkSuperState_(GetTTWrapper()->GetMTBDD()->CreateRoot()),
 			rootMap_(sinkSuperState_)
@@ -256,6 +267,8 @@ public:   // Public methods
 		: ParentClass(aut),
 			states_(aut.states_),
 			finalStates_(aut.finalStates_),
+			statesBitmap_(aut.statesBitmap_),
+			finalStatesBitmap_(aut.finalStatesBitmap_),
 			ttWrapper_(aut.ttWrapper_),
 			sinkSuperState_(aut.sinkSuperState_),
 			rootMap_(aut.rootMap_)
@@ -267,6 +280,8 @@ public:   // Public methods
 	explicit SymbolicBUTreeAutomaton(TTWrapperPtrType ttWrapper)
 		: states_(),
 			finalStates_(),
+			statesBitmap_(),
+			finalStatesBitmap_(),
 			ttWrapper_(ttWrapper),
 			sinkSuperState_(GetTTWrapper()->GetMTBDD()->CreateRoot()),
 			rootMap_(sinkSuperState_)
@@ -284,6 +299,7 @@ public:   // Public methods
 	{
 		StateType newState = GetTTWrapper()->CreateState();
 		states_.insert(newState);
+		statesBitmap_.insert(newState);
 
 		return newState;
 	}
@@ -294,6 +310,7 @@ public:   // Public methods
 		assert(isStateLocal(state));
 
 		finalStates_.insert(state);
+		finalStatesBitmap_.insert(state);
 	}
 
 	virtual bool IsStateFinal(const StateType& state) const
@@ -301,7 +318,21 @@ public:   // Public methods
 		// Assertions
 		assert(isStateLocal(state));
 
-		return finalStates_.find(state) != finalStates_.end();
+		return finalStatesBitmap_.Contains(state);
+	}
+
+	/**
+	 * @brief  Checks whether a set contains a final state
+	 *
+	 * Checks whether at least one state of given set of states is final.
+	 *
+	 * @param[in]  states  The set of states
+	 *
+	 * @returns  @p true if some state of the set is final, @p false otherwise
+	 */
+	inline bool ContainsFinalState(const StateSetType& states) const
+	{
+		return finalStatesBitmap_.ContainsAnyOf(states.begin(), states.end());
 	}
 
 	virtual void AddTransition(const LeftHandSideType& lhs,
@@ -398,6 +429,34 @@ public:   // Public methods
 		return result;
 	}
 
+	/**
+	 * @brief  Returns the memory footprint of the automaton
+	 *
+	 * Returns the estimated memory used by the containers of states, by the
+	 * map of roots and by the part of the shared MTBDD that is reachable from
+	 * the roots of the automaton.
+	 *
+	 * @returns  The footprint of the automaton
+	 */
+	MemoryUsage GetMemoryUsage() const
+	{
+		std::vector<RootType> roots(1, sinkSuperState_);
+		for (typename LHSRootContainerType::const_iterator itRoot = rootMap_.begin();
+			itRoot != rootMap_.end(); ++itRoot)
+		{
+			roots.push_back(itRoot->second);
+		}
+
+		MemoryUsage usage;
+		usage.stateContainers = states_.GetMemoryUsage() +
+			finalStates_.GetMemoryUsage() + statesBitmap_.GetMemoryUsage() +
+			finalStatesBitmap_.GetMemoryUsage();
+		usage.rootMap = SFTA::Private::MemoryEstimate::Of(rootMap_);
+		usage.mtbdd = ttWrapper_->GetMTBDD()->GetMemoryUsage(roots);
+
+		return usage;
+	}
+
 	virtual std::string ToString() const
 	{
 		std::string result;
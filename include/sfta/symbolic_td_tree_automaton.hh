@@ -13,6 +13,8 @@
 
 // SFTA headers
 #include <sfta/abstract_td_tree_automaton.hh>
+#include <sfta/bitmap_set.hh>
+#include <sfta/memory_usage.hh>
 #include <sfta/ordered_vector.hh>
 
 // Loki headers
@@ -136,6 +138,7 @@ public:   // Public data types
 private:  // Private data types
 
 	typedef SFTA::Private::Convert Convert;
+	typedef SFTA::Private::BitmapSet<StateType> StateBitmapType;
 	typedef typename MTBDDTTWrapperType::SharedMTBDDType SharedMTBDDType;
 	typedef typename SharedMTBDDType::DescriptionType TransitionMapType;
 
@@ -145,6 +148,10 @@ private:  // Private data members
 
 	StateSetType initialStates_;
 
+	StateBitmapType statesBitmap_;
+
+	StateBitmapType initialStatesBitmap_;
+
 	TTWrapperPtrType ttWrapper_;
 
 	RootType sinkState_;
@@ -183,6 +190,8 @@ protected:// Protected methods
 	{
 		states_.insert(aut.states_);
 		initialStates_.insert(aut.initialStates_);
+		statesBitmap_.insert(aut.statesBitmap_);
+		initialStatesBitmap_.insert(aut.initialStatesBitmap_);
 
 		// also copy MTBDD root nodes
 		rootMap_.insert(aut.rootMap_.begin(), aut.rootMap_.end());
@@ -225,7 +234,7 @@ protected:// Protected methods
 
 	inline bool isStateLocal(const StateType& state) const
 	{
-		return (states_.find(state) != states_.end());
+		return statesBitmap_.Contains(state);
 	}
 
 
@@ -239,6 +248,8 @@ public:   // Public methods
 	SymbolicTDTreeAutomaton()
 		: states_(),
 			initialStates_(),
+			statesBitmap_(),
+			initialStatesBitmap_(),
 			ttWrapper_(new MTBDDTTWrapperType()),
 			sinkState_(GetTTWrapper()->GetMTBDD()->CreateRoot()),
 			rootMap_(sinkState_)
@@ -260,6 +271,8 @@ public:   // Public methods
 		: ParentClass(aut),
 			states_(aut.states_),
 			initialStates_(aut.initialStates_),
+			statesBitmap_(aut.statesBitmap_),
+			initialStatesBitmap_(aut.initialStatesBitmap_),
 			ttWrapper_(aut.ttWrapper_),
 			sinkState_(aut.sinkState_),
 			rootMap_(aut.rootMap_)
@@ -271,6 +284,8 @@ public:   // Public methods
 	explicit SymbolicTDTreeAutomaton(TTWrapperPtrType ttWrapper)
 		: states_(),
 			initialStates_(),
+			statesBitmap_(),
+			initialStatesBitmap_(),
 			ttWrapper_(ttWrapper),
 			sinkState_(GetTTWrapper()->GetMTBDD()->CreateRoot()),
 			rootMap_(sinkState_)
@@ -289,19 +304,21 @@ public:   // Public methods
 	{
 		StateType newState = GetTTWrapper()->CreateState();
 		states_.insert(newState);
+		statesBitmap_.insert(newState);
 
 		return newState;
 	}
 
 	virtual void AddState(const StateType& state)
 	{
-		if (states_.find(state) != states_.end())
+		if (isStateLocal(state))
 		{	// in case the state is already there
 			throw std::runtime_error(__func__ +
 				std::string(": an attempt to insert already present state"));
 		}
 
 		states_.insert(state);
+		statesBitmap_.insert(state);
 	}
 
 	virtual void SetStateInitial(const StateType& state)
@@ -310,6 +327,7 @@ public:   // Public methods
 		assert(isStateLocal(state));
 
 		initialStates_.insert(state);
+		initialStatesBitmap_.insert(state);
 	}
 
 	virtual bool IsStateInitial(const StateType& state) const
@@ -317,7 +335,7 @@ public:   // Public methods
 		// Assertions
 		assert(isStateLocal(state));
 
-		return initialStates_.find(state) != initialStates_.end();
+		return initialStatesBitmap_.Contains(state);
 	}
 
 	virtual void AddTransition(const LeftHandSideType& lhs,
@@ -412,6 +430,34 @@ public:   // Public methods
 		return result;
 	}
 
+	/**
+	 * @brief  Returns the memory footprint of the automaton
+	 *
+	 * Returns the estimated memory used by the containers of states, by the
+	 * map of roots and by the part of the shared MTBDD that is reachable from
+	 * the roots of the automaton.
+	 *
+	 * @returns  The footprint of the automaton
+	 */
+	MemoryUsage GetMemoryUsage() const
+	{
+		std::vector<RootType> roots(1, sinkState_);
+		for (typename LHSRootContainerType::const_iterator itRoot = rootMap_.begin();
+			itRoot != rootMap_.end(); ++itRoot)
+		{
+			roots.push_back(itRoot->second);
+		}
+
+		MemoryUsage usage;
+		usage.stateContainers = states_.GetMemoryUsage() +
+			initialStates_.GetMemoryUsage() + statesBitmap_.GetMemoryUsage() +
+			initialStatesBitmap_.GetMemoryUsage();
+		usage.rootMap = SFTA::Private::MemoryEstimate::Of(rootMap_);
+		usage.mtbdd = ttWrapper_->GetMTBDD()->GetMemoryUsage(roots);
+
+		return usage;
+	}
+
 	virtual std::string ToString() const
 	{
 		std::string result;
@@ -77,16 +77,34 @@ public:   // Public methods
 
 
 	explicit TABuildingDirector(AbstractTABuilderType* builder)
-		: defaultTa_(64 /* TODO: horrible constant */),
+		: defaultTa_(),
 			builder_(builder),
-			symbolDic_(new SymbolDictionaryType(
-				typename SymbolDictionaryType::OutputSymbolType(64 /* TODO: also change to something nice */, 0)))
+			symbolDic_(new SymbolDictionaryType())
 	{ }
 
 
+	/**
+	 * @brief  Registers symbols
+	 *
+	 * Registers the given symbols in the symbol dictionary shared by all
+	 * constructed automata, in the given order, before any automaton is
+	 * constructed. The order (together with the choice of the Gray code)
+	 * determines the encoding of symbols in MTBDDs.
+	 *
+	 * @param[in]  symbols     Ranked symbols in the order of registration
+	 * @param[in]  grayCoding  Should positions of symbols be Gray-coded?
+	 */
+	void RegisterSymbols(const typename SymbolDictionaryType::RankedSymbolVector&
+		symbols, bool grayCoding)
+	{
+		symbolDic_->SetGrayCoding(grayCoding);
+		symbolDic_->TranslateAll(symbols);
+	}
+
+
 	TreeAutomatonType* Construct(std::istream& is)
 	{
-		TreeAutomatonType* result = new TreeAutomatonType(defaultTa_.GetBDDSize(),
+		TreeAutomatonType* result = new TreeAutomatonType(
 			defaultTa_.GetTTWrapper(), symbolDic_);
 
 		builder_->Build(is, result);
@@ -16,8 +16,11 @@
 #include <sfta/cudd_shared_mtbdd.hh>
 #include <sfta/dual_map_leaf_allocator.hh>
 #include <sfta/map_root_allocator.hh>
+#include <sfta/memory_usage.hh>
 #include <sfta/mtbdd_transition_table_wrapper.hh>
 #include <sfta/nd_symbolic_td_tree_automaton.hh>
+#include <sfta/operation_context.hh>
+#include <sfta/operation_statistics.hh>
 #include <sfta/set.hh>
 #include <sfta/sfta.hh>
 #include <sfta/symbol_dictionary.hh>
@@ -109,6 +112,9 @@ public:   // Public data types
 
 	typedef Loki::SmartPtr<SymbolDictionaryType> SymbolDictionaryPtrType;
 
+	typedef typename SymbolDictionaryType::RankedSymbolType RankedSymbolType;
+	typedef typename SymbolDictionaryType::RankedSymbolVector RankedSymbolVector;
+
 
 	/**
 	 * @brief  Class with operations
@@ -118,11 +124,68 @@ public:   // Public data types
 	 */
 	class Operation
 	{
+	private:  // Private data members
+
+		/**
+		 * @brief  Statistics of the last operation
+		 *
+		 * Statistics collected during the last operation performed by the
+		 * object.
+		 */
+		mutable OperationStatistics statistics_;
+
+		/**
+		 * @brief  Context of operations
+		 *
+		 * The context with limits of operations performed by the object, or
+		 * null pointer if the operations are not limited.
+		 */
+		OperationContext* context_;
+
+	private:  // Private methods
+
+		Operation(const Operation&);
+		Operation& operator=(const Operation&);
+
 	public:   // Public methods
 
+		Operation()
+			: statistics_(),
+				context_(static_cast<OperationContext*>(0))
+		{ }
+
 		Type* Union(Type* lhs, Type* rhs) const;
 
 		Type* Intersection(Type* lhs, Type* rhs) const;
+
+		/**
+		 * @brief  Returns statistics
+		 *
+		 * Returns the statistics collected during the last operation performed
+		 * by the object. The statistics are empty unless the library is
+		 * compiled with SFTA_ENABLE_STATISTICS defined.
+		 *
+		 * @returns  Statistics of the last operation
+		 */
+		inline const OperationStatistics& GetStatistics() const
+		{
+			return statistics_;
+		}
+
+		/**
+		 * @brief  Sets the context of operations
+		 *
+		 * Makes subsequent operations performed by the object check the
+		 * deadline, the cancellation flag and the memory budget of @p context
+		 * (which needs to outlive the operations). An interrupted operation
+		 * throws SFTA::OperationInterrupted, i.e., its result is unknown.
+		 *
+		 * @param[in]  context  The context, or null pointer for no limits
+		 */
+		inline void SetContext(OperationContext* context)
+		{
+			context_ = context;
+		}
 	};
 
 private:  // Private data members
@@ -133,9 +196,6 @@ private:  // Private data members
 
 	SymbolDictionaryPtrType symbolDict_;
 
-	size_t bddSize_;
-
-	InternalSymbolType nextSymbol_;
 
 
 private:  // Private methods
@@ -158,52 +218,75 @@ private:  // Private methods
 
 	std::string initialStatesToString(const InternalStateVector& vec) const;
 
-	static std::string symbolsToString(const std::vector<SymbolType>& vec);
+	static std::string symbolsToString(const RankedSymbolVector& vec);
 
 public:   // Public methods
 
-	TDTreeAutomatonCover(size_t bddSize)
+	TDTreeAutomatonCover()
 		: automaton_(new NDSymbolicTDTreeAutomaton()),
 			state2internalStateMap_(),
-			symbolDict_(),
-			bddSize_(bddSize),
-			nextSymbol_(bddSize, 0)
+			symbolDict_()
 	{ }
 
-	TDTreeAutomatonCover(size_t bddSize, TTWrapperPtr wrapper, SymbolDictionaryPtrType symbolDict)
+	TDTreeAutomatonCover(TTWrapperPtr wrapper, SymbolDictionaryPtrType symbolDict)
 		: automaton_(new NDSymbolicTDTreeAutomaton(wrapper)),
 			state2internalStateMap_(),
-			symbolDict_(symbolDict),
-			bddSize_(bddSize),
-			nextSymbol_(bddSize, 0)
+			symbolDict_(symbolDict)
 	{ }
 
-	TDTreeAutomatonCover(size_t bddSize, NDSymbolicTDTreeAutomaton* automaton, SymbolDictionaryPtrType symbolDict)
+	TDTreeAutomatonCover(NDSymbolicTDTreeAutomaton* automaton, SymbolDictionaryPtrType symbolDict)
 		: automaton_(automaton),
 			state2internalStateMap_(),
-			symbolDict_(symbolDict),
-			bddSize_(bddSize),
-			nextSymbol_(bddSize, 0)
+			symbolDict_(symbolDict)
 	{ }
 
 
 	void AddState(const StateType& state);
 
-	void AddSymbol(const SymbolType& symbol);
+	void AddSymbol(const SymbolType& symbol, size_t arity);
+
+	void AddSymbols(const RankedSymbolVector& symbols);
 
 	void AddTransition(const LeftHandSideType& lhs, const SymbolType& symbol,
 		const RightHandSideType& rhs);
 
 	void SetStateInitial(const StateType& state);
 
-	inline size_t GetBDDSize() const
+	inline TTWrapperPtr GetTTWrapper()
 	{
-		return bddSize_;
+		return automaton_->GetTTWrapper();
 	}
 
-	inline TTWrapperPtr GetTTWrapper()
+	/**
+	 * @brief  Reorders variables of the MTBDD
+	 *
+	 * Reorders the variables of the shared MTBDD of the automaton (and all
+	 * automata sharing it) using sifting.
+	 */
+	inline void ReorderVariables()
 	{
-		return automaton_->GetTTWrapper();
+		automaton_->GetTTWrapper()->GetMTBDD()->ReorderVariables();
+	}
+
+	inline size_t GetMTBDDNodeCount()
+	{
+		return automaton_->GetTTWrapper()->GetMTBDD()->GetNodeCount();
+	}
+
+	inline SFTA::Private::CUDDFacade::Telemetry GetMTBDDTelemetry()
+	{
+		return automaton_->GetTTWrapper()->GetMTBDD()->GetTelemetry();
+	}
+
+	/**
+	 * @brief  Returns the memory footprint of the shared MTBDD
+	 *
+	 * Returns the footprint of the whole shared MTBDD of the automaton (and
+	 * all automata sharing it).
+	 */
+	inline MTBDDMemoryUsage GetMTBDDMemoryUsage()
+	{
+		return automaton_->GetTTWrapper()->GetMTBDD()->GetMemoryUsage();
 	}
 
 	inline Operation* GetOperation() const
@@ -216,6 +299,15 @@ public:   // Public methods
 		return symbolDict_;
 	}
 
+	/**
+	 * @brief  Returns the memory footprint of the automaton
+	 *
+	 * Returns the estimated memory used by the automaton, including the map
+	 * of names of states and the part of the shared MTBDD reachable only from
+	 * the automaton.
+	 */
+	MemoryUsage GetMemoryUsage() const;
+
 	std::string ToString() const;
 };
 
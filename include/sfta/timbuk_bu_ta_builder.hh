@@ -17,6 +17,7 @@
 // SFTA header files
 #include <sfta/abstract_ta_builder.hh>
 #include <sfta/convert.hh>
+#include <sfta/trace.hh>
 
 // Boost header files
 #include <boost/algorithm/string.hpp>
@@ -63,12 +64,16 @@ private:  // Private data types
 	typedef typename BUTreeAutomatonType::LeftHandSideType LeftHandSideType;
 	typedef typename BUTreeAutomatonType::RightHandSideType RightHandSideType;
 
+	typedef typename BUTreeAutomatonType::RankedSymbolVector RankedSymbolVector;
+
 	typedef SFTA::Private::Convert Convert;
 
 public:   // Public methods 
 
 	virtual void Build(std::istream& is, BUTreeAutomatonType* automaton) const
 	{
+		SFTA_TRACE_SPAN("TimbukBUTABuilder::Build");
+
 		bool readingTransitions = false;
 		std::string str;
 		while (std::getline(is, str))
@@ -131,7 +136,27 @@ public:   // Public methods
 				continue;
 			}
 			else if (spl[0] == "Ops")
-			{	// we dispose of definition of arity for operations
+			{	// we register the ranked alphabet
+				RankedSymbolVector symbols;
+				for (size_t i = 1; i < spl.size(); ++i)
+				{	// for each symbol in the list
+					std::string symbolName = spl[i];
+					size_t pos = symbolName.find(':');
+					if (pos == symbolName.npos)
+					{	// in case the arity is missing
+						throw std::runtime_error(__func__ +
+							std::string(": missing arity of symbol ") + symbolName);
+					}
+
+					size_t arity = Convert::FromString<size_t>(symbolName.substr(pos + 1));
+					symbolName.erase(pos);
+
+					symbols.push_back(typename RankedSymbolVector::value_type(
+						symbolName, arity));
+				}
+
+				automaton->AddSymbols(symbols);
+
 				continue;
 			}
 			else if (spl[0] == "Automaton")
@@ -0,0 +1,301 @@
+/*****************************************************************************
+ *  Symbolic Finite Tree Automata Library
+ *
+ *  Description:
+ *    Header file with the Tracer class, which records scoped spans of
+ *    operations and exports them as a timeline in the Chrome trace-event
+ *    format.
+ *
+ *****************************************************************************/
+
+#ifndef _SFTA_TRACE_HH_
+#define _SFTA_TRACE_HH_
+
+// Standard library headers
+#include <cstdlib>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// POSIX headers
+#include <time.h>
+#include <unistd.h>
+
+// Boost headers
+#include <boost/cstdint.hpp>
+
+
+// insert the classes into proper namespace
+namespace SFTA
+{
+	namespace Private
+	{
+		class Tracer;
+		class TraceSpan;
+	}
+}
+
+
+#define SFTA_TRACE_JOIN_IMPL(x, y) x ## y
+#define SFTA_TRACE_JOIN(x, y) SFTA_TRACE_JOIN_IMPL(x, y)
+
+/**
+ * @brief  Records a span for the rest of the block
+ *
+ * Declares a guard that records a span with given name (which needs to be
+ * a string literal) from the declaration to the end of the enclosing block
+ * if tracing is enabled.
+ */
+#define SFTA_TRACE_SPAN(name) \
+	SFTA::Private::TraceSpan SFTA_TRACE_JOIN(sftaTraceSpan, __LINE__)(name)
+
+
+/**
+ * @brief   Recorder of trace spans
+ *
+ * The class that collects spans recorded by SFTA::Private::TraceSpan and
+ * writes them as complete events of the Chrome trace-event format (which can
+ * be viewed in chrome://tracing or Perfetto). Tracing is enabled either by
+ * setting the SFTA_TRACE environment variable to the name of the output file
+ * or by calling Start(). The spans are written when Stop() is called or at
+ * the exit of the program. When tracing is disabled, a span costs a single
+ * test of a flag.
+ */
+class SFTA::Private::Tracer
+{
+private:  // Private data types
+
+	/**
+	 * @brief  A recorded span
+	 *
+	 * The name of the span is a string literal, so only the pointer is kept.
+	 */
+	struct Event
+	{
+		const char* name;
+		boost::uint64_t start;
+		boost::uint64_t end;
+
+		Event(const char* eventName, boost::uint64_t eventStart,
+			boost::uint64_t eventEnd)
+			: name(eventName),
+				start(eventStart),
+				end(eventEnd)
+		{ }
+	};
+
+	typedef std::vector<Event> EventVector;
+
+	enum
+	{
+		// the maximum number of recorded events (the rest are dropped)
+		MaxEvents = 1 << 20
+	};
+
+private:  // Private data members
+
+	bool enabled_;
+
+	std::string filename_;
+
+	EventVector events_;
+
+	size_t droppedEvents_;
+
+	boost::uint64_t origin_;
+
+private:  // Private methods
+
+	Tracer()
+		: enabled_(false),
+			filename_(),
+			events_(),
+			droppedEvents_(0),
+			origin_(0)
+	{
+		const char* filename = std::getenv("SFTA_TRACE");
+		if ((filename != static_cast<const char*>(0)) && (*filename != '\0'))
+		{	// in case tracing is requested by the environment
+			Start(filename);
+		}
+	}
+
+	Tracer(const Tracer&);
+	Tracer& operator=(const Tracer&);
+
+	~Tracer()
+	{
+		try
+		{
+			Stop();
+		}
+		catch (...)
+		{	// the destructor must not throw
+		}
+	}
+
+public:   // Public methods
+
+	/**
+	 * @brief  Returns the tracer
+	 *
+	 * Returns the only instance of the tracer.
+	 */
+	static Tracer& GetInstance()
+	{
+		static Tracer tracer;
+		return tracer;
+	}
+
+	static inline bool IsEnabled()
+	{
+		return GetInstance().enabled_;
+	}
+
+	/**
+	 * @brief  Returns the current time
+	 *
+	 * Returns the value of the monotonic clock in microseconds.
+	 */
+	static inline boost::uint64_t Now()
+	{
+		timespec now;
+		clock_gettime(CLOCK_MONOTONIC, &now);
+
+		return static_cast<boost::uint64_t>(now.tv_sec) * 1000000 +
+			static_cast<boost::uint64_t>(now.tv_nsec) / 1000;
+	}
+
+	/**
+	 * @brief  Starts tracing
+	 *
+	 * Enables recording of spans that are to be written to file @p filename.
+	 * Spans recorded before are discarded.
+	 *
+	 * @param[in]  filename  The name of the output file
+	 */
+	void Start(const std::string& filename)
+	{
+		filename_ = filename;
+		events_.clear();
+		droppedEvents_ = 0;
+		origin_ = Now();
+		enabled_ = true;
+	}
+
+	/**
+	 * @brief  Records a span
+	 *
+	 * @param[in]  name   The name of the span (a string literal)
+	 * @param[in]  start  The start of the span (see Now())
+	 * @param[in]  end    The end of the span (see Now())
+	 */
+	inline void Record(const char* name, boost::uint64_t start,
+		boost::uint64_t end)
+	{
+		if (events_.size() < MaxEvents)
+		{
+			events_.push_back(Event(name, start, end));
+		}
+		else
+		{
+			++droppedEvents_;
+		}
+	}
+
+	/**
+	 * @brief  Stops tracing
+	 *
+	 * Disables recording of spans and writes the recorded spans to the
+	 * output file given to Start().
+	 */
+	void Stop()
+	{
+		if (!enabled_)
+		{	// in case there is nothing to be written
+			return;
+		}
+
+		enabled_ = false;
+
+		std::ofstream ofs(filename_.c_str());
+		if (ofs.fail())
+		{
+			throw std::runtime_error(__func__ +
+				std::string(": could not open file ") + filename_);
+		}
+
+		long pid = static_cast<long>(getpid());
+
+		ofs << "{\"traceEvents\": [\n";
+		for (size_t i = 0; i < events_.size(); ++i)
+		{
+			const Event& event = events_[i];
+			ofs << ((i == 0)? "" : ",\n") << "{\"name\": \"" << event.name
+				<< "\", \"cat\": \"sfta\", \"ph\": \"X\", \"ts\": "
+				<< (event.start - origin_) << ", \"dur\": " << (event.end - event.start)
+				<< ", \"pid\": " << pid << ", \"tid\": " << pid << "}";
+		}
+
+		ofs << "\n], \"displayTimeUnit\": \"ms\", \"otherData\": {\"dropped_events\": "
+			<< droppedEvents_ << "}}\n";
+
+		events_.clear();
+	}
+
+	/**
+	 * @brief  Discards tracing
+	 *
+	 * Disables recording of spans and frees the recorded spans without
+	 * writing them. A child process created by fork() calls this so that it
+	 * neither keeps a copy of the spans of its parent nor records its own.
+	 */
+	void Discard()
+	{
+		enabled_ = false;
+		droppedEvents_ = 0;
+		EventVector().swap(events_);
+	}
+};
+
+
+/**
+ * @brief   Scoped trace span
+ *
+ * A guard that records a span from its construction to its destruction in
+ * SFTA::Private::Tracer if tracing is enabled. Use SFTA_TRACE_SPAN().
+ */
+class SFTA::Private::TraceSpan
+{
+private:  // Private data members
+
+	const char* name_;
+
+	bool active_;
+
+	boost::uint64_t start_;
+
+private:  // Private methods
+
+	TraceSpan(const TraceSpan&);
+	TraceSpan& operator=(const TraceSpan&);
+
+public:   // Public methods
+
+	explicit TraceSpan(const char* name)
+		: name_(name),
+			active_(Tracer::IsEnabled()),
+			start_(active_? Tracer::Now() : 0)
+	{ }
+
+	~TraceSpan()
+	{
+		if (active_ && Tracer::IsEnabled())
+		{
+			Tracer::GetInstance().Record(name_, start_, Tracer::Now());
+		}
+	}
+};
+
+#endif
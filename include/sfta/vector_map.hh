@@ -13,12 +13,19 @@
 
 
 // Standard library headers
+#include <algorithm>
+#include <cassert>
+#include <stdexcept>
 #include <tr1/unordered_map>
+#include <vector>
 
 
 // Boost library headers
 #include <boost/functional/hash.hpp>
 
+// SFTA headers
+#include <sfta/memory_usage.hh>
+
 
 // insert the class into proper namespace
 namespace SFTA
@@ -38,7 +45,9 @@ namespace SFTA
  * @date    2010
  *
  * This class implements map that projects vectors of elements to arbitrary
- * elements.
+ * elements. Vectors of arity up to @c MaxFlatArity are stored in flat hash
+ * tables with open addressing (one for each arity) that keep the vector
+ * inline in the slot, longer vectors are stored in a general hash table.
  *
  * @tparam  KeyElement   Data type that is used as contained type of the vector.
  * @tparam  Value        Data type that is used as the image of the function.
@@ -73,44 +82,191 @@ private:  // Private data types
 
 	typedef SFTA::Private::Convert Convert;
 
+
+	enum
+	{
+		// the maximum arity of vectors stored in flat hash tables
+		MaxFlatArity = 4
+	};
+
+
 	/**
-	 * @brief  Hasher structure for a single key
+	 * @brief  Flat hash table for vectors of fixed arity
 	 *
-	 * This class is a hasher for a single key.
+	 * Hash table with open addressing and linear probing that maps vectors of
+	 * fixed arity to values. Vectors are stored inline in the slots of the
+	 * table, so that neither lookups nor iteration allocate memory. Items are
+	 * never removed from the table.
+	 *
+	 * @tparam  Arity  The arity of stored vectors.
 	 */
-	struct HasherUnary
+	template <size_t Arity>
+	class FlatHashTable
 	{
-		size_t operator()(const KeyElementType& key) const
+	public:   // Public data types
+
+		struct Slot
 		{
-			return boost::hash_value(key);
-		}
-	};
+			bool occupied;
+			KeyElementType key[Arity];
+			ValueType value;
+		};
 
-	typedef std::tr1::unordered_map<KeyElementType, ValueType, HasherUnary>
-		HashTableUnary;
+	private:  // Private data types
 
+		enum
+		{
+			// the initial number of slots (needs to be a power of 2)
+			InitialSlotsCount = 16
+		};
 
-	typedef std::pair<KeyElementType, KeyElementType> KeyElementPairType;
+		typedef std::vector<Slot> SlotVector;
 
+	private:  // Private data members
 
-	/**
-	 * @brief  Hasher structure for a pair of keys
-	 *
-	 * This class is a hasher for a pair of keys.
-	 */
-	struct HasherBinary
-	{
-		size_t operator()(const KeyElementPairType& key) const
+		SlotVector slots_;
+
+		size_t size_;
+
+	private:  // Private methods
+
+		static size_t hashKey(const KeyElementType* key)
 		{
-			size_t seed  = 0;
-			boost::hash_combine(seed, key.first);
-			boost::hash_combine(seed, key.second);
+			size_t seed = 0;
+			for (size_t i = 0; i < Arity; ++i)
+			{
+				boost::hash_combine(seed, key[i]);
+			}
+
+			// finalization mix (from MurmurHash3) so that the low bits used for
+			// indexing depend on all bits of the hash
+			seed ^= seed >> 16;
+			seed *= 0x85ebca6b;
+			seed ^= seed >> 13;
+			seed *= 0xc2b2ae35;
+			seed ^= seed >> 16;
+
 			return seed;
 		}
+
+		size_t findSlot(const KeyElementType* key) const
+		{
+			size_t mask = slots_.size() - 1;
+			for (size_t i = hashKey(key) & mask; ; i = (i + 1) & mask)
+			{	// linear probing (there is always some free slot)
+				const Slot& slot = slots_[i];
+				if (!slot.occupied || std::equal(key, key + Arity, slot.key))
+				{	// in case the slot is free or contains the key
+					return i;
+				}
+			}
+		}
+
+		void grow()
+		{
+			SlotVector oldSlots(2 * slots_.size(), Slot());
+			slots_.swap(oldSlots);
+
+			for (typename SlotVector::const_iterator itSlots = oldSlots.begin();
+				itSlots != oldSlots.end(); ++itSlots)
+			{	// reinsert all items
+				if (itSlots->occupied)
+				{
+					slots_[findSlot(itSlots->key)] = *itSlots;
+				}
+			}
+		}
+
+		Slot& insertSlot(const KeyElementType* key)
+		{
+			size_t index = findSlot(key);
+			if (slots_[index].occupied)
+			{	// in case the key is already in the table
+				return slots_[index];
+			}
+
+			if (2 * (size_ + 1) > slots_.size())
+			{	// keep the load factor at most 1/2
+				grow();
+				index = findSlot(key);
+			}
+
+			Slot& slot = slots_[index];
+			slot.occupied = true;
+			std::copy(key, key + Arity, slot.key);
+			++size_;
+
+			return slot;
+		}
+
+	public:   // Public methods
+
+		FlatHashTable()
+			: slots_(InitialSlotsCount, Slot()),
+				size_(0)
+		{ }
+
+		const ValueType* Find(const KeyElementType* key) const
+		{
+			const Slot& slot = slots_[findSlot(key)];
+			return (slot.occupied)? &slot.value : static_cast<const ValueType*>(0);
+		}
+
+		void Set(const KeyElementType* key, const ValueType& value)
+		{
+			insertSlot(key).value = value;
+		}
+
+		void Insert(const FlatHashTable& table)
+		{
+			for (typename SlotVector::const_iterator itSlots = table.slots_.begin();
+				itSlots != table.slots_.end(); ++itSlots)
+			{	// insert items that are not in the table yet
+				if (itSlots->occupied)
+				{
+					size_t oldSize = size_;
+					Slot& slot = insertSlot(itSlots->key);
+					if (size_ != oldSize)
+					{	// in case the item is new
+						slot.value = itSlots->value;
+					}
+				}
+			}
+		}
+
+		inline size_t SlotsCount() const
+		{
+			return slots_.size();
+		}
+
+		inline const Slot& GetSlot(size_t index) const
+		{
+			// Assertions
+			assert(index < slots_.size());
+
+			return slots_[index];
+		}
+
+		size_t GetMemoryUsage() const
+		{
+			size_t result = slots_.capacity() * sizeof(Slot);
+			for (typename SlotVector::const_iterator itSlots = slots_.begin();
+				itSlots != slots_.end(); ++itSlots)
+			{	// add memory used by values
+				if (itSlots->occupied)
+				{
+					result += SFTA::Private::MemoryEstimate::Of(itSlots->value);
+				}
+			}
+
+			return result;
+		}
 	};
 
-	typedef std::tr1::unordered_map<KeyElementPairType, ValueType, HasherBinary>
-		HashTableBinary;
+	typedef FlatHashTable<1> HashTableUnary;
+	typedef FlatHashTable<2> HashTableBinary;
+	typedef FlatHashTable<3> HashTableTernary;
+	typedef FlatHashTable<4> HashTableQuaternary;
 
 
 	/**
@@ -133,7 +289,11 @@ private:  // Private data types
 	/**
 	 * @brief  Constant iterator
 	 *
-	 * The class for constant iterator.
+	 * The class for constant iterator. The iterator keeps a single buffer for
+	 * the current item, which is overwritten in place on increments. The
+	 * buffer of the key is resized only when the iterator moves to vectors of
+	 * another arity, so iterating over the flat hash tables does not
+	 * allocate memory.
 	 */
 	struct Tconst_iterator
 	{
@@ -145,6 +305,8 @@ private:  // Private data types
 			ITERATOR_NULLARY,
 			ITERATOR_UNARY,
 			ITERATOR_BINARY,
+			ITERATOR_TERNARY,
+			ITERATOR_QUATERNARY,
 			ITERATOR_NNARY,
 			ITERATOR_END
 		};
@@ -158,8 +320,7 @@ private:  // Private data types
 
 		IteratorState state_;
 
-		typename HashTableUnary::const_iterator itUnary_;
-		typename HashTableBinary::const_iterator itBinary_;
+		size_t slot_;               // the next slot of the flat table to visit
 		typename HashTableNnary::const_iterator itNnary_;
 
 	private:  // Private methods
@@ -169,33 +330,23 @@ private:  // Private data types
 			state_ = ITERATOR_INVALID;
 		}
 
-		void updateIndexValue()
+		template <size_t Arity>
+		bool findNextSlot(const FlatHashTable<Arity>& table)
 		{
-			// Assertions
-			assert(state_ != ITERATOR_INVALID);
-			assert(state_ != ITERATOR_END);
-
-			IndexType index;
-			switch (state_)
-			{
-				case ITERATOR_NULLARY:
-					indexValue_ = std::make_pair(index, vecMap_->container0_); break;
-
-				case ITERATOR_UNARY:
-					index.push_back(itUnary_->first);
-					indexValue_ = std::make_pair(index, itUnary_->second); break;
-
-				case ITERATOR_BINARY:
-					index.push_back(itBinary_->first.first);
-					index.push_back(itBinary_->first.second);
-					indexValue_ = std::make_pair(index, itBinary_->second); break;
-
-				case ITERATOR_NNARY:
-					indexValue_ = std::make_pair(itNnary_->first, itNnary_->second); break;
-
-				default: throw std::logic_error(__func__ +
-					std::string(": invalid iterator state")); break;
+			for ( ; slot_ < table.SlotsCount(); ++slot_)
+			{	// find the next occupied slot
+				const typename FlatHashTable<Arity>::Slot& slot = table.GetSlot(slot_);
+				if (slot.occupied)
+				{	// the buffer already has the size unless the arity changed
+					indexValue_.first.resize(Arity);
+					std::copy(slot.key, slot.key + Arity, indexValue_.first.begin());
+					indexValue_.second = slot.value;
+					++slot_;
+					return true;
+				}
 			}
+
+			return false;
 		}
 
 	public:   // Public methods
@@ -204,8 +355,7 @@ private:  // Private data types
 			: vecMap_(vecMap),
 				indexValue_(),
 				state_((end)? ITERATOR_END : ITERATOR_INVALID),
-				itUnary_(),
-				itBinary_(),
+				slot_(0),
 				itNnary_()
 		{
 			// Assertions
@@ -213,6 +363,7 @@ private:  // Private data types
 
 			if (state_ != ITERATOR_END)
 			{
+				indexValue_.first.reserve(MaxFlatArity);
 				reset();
 				++(*this);
 			}
@@ -223,8 +374,7 @@ private:  // Private data types
 			: vecMap_(it.vecMap_),
 				indexValue_(it.indexValue_),
 				state_(it.state_),
-				itUnary_(it.itUnary_),
-				itBinary_(it.itBinary_),
+				slot_(it.slot_),
 				itNnary_(it.itNnary_)
 		{
 			// Assertions
@@ -239,8 +389,7 @@ private:  // Private data types
 				vecMap_ = rhs.vecMap_;
 				indexValue_ = rhs.indexValue_;
 				state_ = rhs.state_;
-				itUnary_ = rhs.itUnary_;
-				itBinary_ = rhs.itBinary_;
+				slot_ = rhs.slot_;
 				itNnary_ = rhs.itNnary_;
 			}
 
@@ -264,61 +413,50 @@ private:  // Private data types
 						if (vecMap_->container0_ != vecMap_->defaultValue_)
 						{
 							sound = true;
-							updateIndexValue();
+							indexValue_.first.clear();
+							indexValue_.second = vecMap_->container0_;
 						}
 
 						break;
 
 					case ITERATOR_NULLARY:
 						state_ = ITERATOR_UNARY;
-						itUnary_ = vecMap_->container1_.begin();
-						if (itUnary_ != vecMap_->container1_.end())
+						slot_ = 0;
+						break;
+
+					case ITERATOR_UNARY:
+						if (!(sound = findNextSlot(vecMap_->container1_)))
 						{
-							sound = true;
-							updateIndexValue();
-							++itUnary_;
+							state_ = ITERATOR_BINARY;
+							slot_ = 0;
 						}
 
 						break;
 
-					case ITERATOR_UNARY:
-						if (itUnary_ == vecMap_->container1_.end())
+					case ITERATOR_BINARY:
+						if (!(sound = findNextSlot(vecMap_->container2_)))
 						{
-							state_ = ITERATOR_BINARY;
-							itBinary_ = vecMap_->container2_.begin();
-							if (itBinary_ != vecMap_->container2_.end())
-							{
-								sound = true;
-								updateIndexValue();
-								++itBinary_;
-							}
+							state_ = ITERATOR_TERNARY;
+							slot_ = 0;
 						}
-						else
+
+						break;
+
+					case ITERATOR_TERNARY:
+						if (!(sound = findNextSlot(vecMap_->container3_)))
 						{
-							sound = true;
-							updateIndexValue();
-							++itUnary_;
+							state_ = ITERATOR_QUATERNARY;
+							slot_ = 0;
 						}
 
 						break;
 
-					case ITERATOR_BINARY:
-						if (itBinary_ == vecMap_->container2_.end())
+					case ITERATOR_QUATERNARY:
+						if (!(sound = findNextSlot(vecMap_->container4_)))
 						{
 							state_ = ITERATOR_NNARY;
+							slot_ = 0;
 							itNnary_ = vecMap_->containerN_.begin();
-							if (itNnary_ != vecMap_->containerN_.end())
-							{
-								sound = true;
-								updateIndexValue();
-								++itNnary_;
-							}
-						}
-						else
-						{
-							sound = true;
-							updateIndexValue();
-							++itBinary_;
 						}
 
 						break;
@@ -332,7 +470,9 @@ private:  // Private data types
 						else
 						{
 							sound = true;
-							updateIndexValue();
+							indexValue_.first.assign(itNnary_->first.begin(),
+								itNnary_->first.end());
+							indexValue_.second = itNnary_->second;
 							++itNnary_;
 						}
 
@@ -368,8 +508,10 @@ private:  // Private data types
 			{
 				case ITERATOR_INVALID: return false; break;
 				case ITERATOR_NULLARY: return true; break;
-				case ITERATOR_UNARY: return itUnary_ == rhs.itUnary_; break;
-				case ITERATOR_BINARY: return itBinary_ == rhs.itBinary_; break;
+				case ITERATOR_UNARY:
+				case ITERATOR_BINARY:
+				case ITERATOR_TERNARY:
+				case ITERATOR_QUATERNARY: return slot_ == rhs.slot_; break;
 				case ITERATOR_NNARY: return itNnary_ == rhs.itNnary_; break;
 				case ITERATOR_END: return true; break;
 				default: throw std::logic_error(__func__ +
@@ -413,52 +555,35 @@ private:  // Private data members
 
 	HashTableBinary container2_;
 
-	HashTableNnary containerN_;
-
-private:  // Private methods
+	HashTableTernary container3_;
 
+	HashTableQuaternary container4_;
 
-	const ValueType& getValueForArity0(const IndexType& lhs) const
-	{
-		// Assertions
-		assert(lhs.size() == 0);
-
-		return container0_;
-	}
-
-	const ValueType& getValueForArity1(const IndexType& lhs) const
-	{
-		// Assertions
-		assert(lhs.size() == 1);
+	HashTableNnary containerN_;
 
-		typename HashTableUnary::const_iterator it;
-		if ((it = container1_.find(lhs[0])) == container1_.end())
-		{	// in case the value is not in the hash table
-			return defaultValue_;
-		}
+private:  // Private methods
 
-		return it->second;
-	}
 
-	const ValueType& getValueForArity2(const IndexType& lhs) const
+	template <size_t Arity>
+	const ValueType& getValueForFlatArity(const FlatHashTable<Arity>& table,
+		const IndexType& lhs) const
 	{
 		// Assertions
-		assert(lhs.size() == 2);
+		assert(lhs.size() == Arity);
 
-		typename HashTableBinary::const_iterator it;
-		if ((it = container2_.find(std::make_pair(lhs[0], lhs[1]))) ==
-			container2_.end())
+		const ValueType* value = table.Find(&lhs[0]);
+		if (value == static_cast<const ValueType*>(0))
 		{	// in case the value is not in the hash table
 			return defaultValue_;
 		}
 
-		return it->second;
+		return *value;
 	}
 
 	const ValueType& getValueForArityN(const IndexType& lhs) const
 	{
 		// Assertions
-		assert(lhs.size() > 2);
+		assert(lhs.size() > MaxFlatArity);
 
 		typename HashTableNnary::const_iterator it;
 		if ((it = containerN_.find(lhs)) == containerN_.end())
@@ -470,23 +595,15 @@ private:  // Private methods
 	}
 
 
-	void setValueForArity0(const IndexType& lhs, const ValueType& value)
-	{
-		// Assertions
-		assert(lhs.size() == 0);
-
-		container0_ = value;
-	}
-
-	void setValueForArity1(const IndexType& lhs, const ValueType& value)
+	void setValueForArityN(const IndexType& lhs, const ValueType& value)
 	{
 		// Assertions
-		assert(lhs.size() == 1);
+		assert(lhs.size() > MaxFlatArity);
 
-		typename HashTableUnary::iterator itHash;
-		if ((itHash = container1_.find(lhs[0])) == container1_.end())
+		typename HashTableNnary::iterator itHash;
+		if ((itHash = containerN_.find(lhs)) == containerN_.end())
 		{
-			container1_.insert(std::make_pair(lhs[0], value));
+			containerN_.insert(std::make_pair(lhs, value));
 		}
 		else
 		{
@@ -494,35 +611,21 @@ private:  // Private methods
 		}
 	}
 
-	void setValueForArity2(const IndexType& lhs, const ValueType& value)
-	{
-		// Assertions
-		assert(lhs.size() == 2);
-
-		typename HashTableBinary::iterator itHash;
-		if ((itHash = container2_.find(std::make_pair(lhs[0], lhs[1]))) == container2_.end())
-		{
-			container2_.insert(std::make_pair(std::make_pair(lhs[0], lhs[1]), value));
-		}
-		else
-		{
-			itHash->second = value;
-		}
-	}
 
-	void setValueForArityN(const IndexType& lhs, const ValueType& value)
+	template <size_t Arity>
+	static void collectItemsWith(const FlatHashTable<Arity>& table,
+		const KeyElementType& elem, IndexValueArray& result)
 	{
-		// Assertions
-		assert(lhs.size() > 2);
-
-		typename HashTableNnary::iterator itHash;
-		if ((itHash = containerN_.find(lhs)) == containerN_.end())
-		{
-			containerN_.insert(std::make_pair(lhs, value));
-		}
-		else
-		{
-			itHash->second = value;
+		for (size_t i = 0; i < table.SlotsCount(); ++i)
+		{	// traverse the whole table
+			const typename FlatHashTable<Arity>::Slot& slot = table.GetSlot(i);
+			if (slot.occupied && (std::find(slot.key, slot.key + Arity, elem)
+				!= slot.key + Arity))
+			{	// in case the desired element is in the vector
+				IndexType index;
+				index.assign(slot.key, slot.key + Arity);
+				result[Arity].push_back(std::make_pair(index, slot.value));
+			}
 		}
 	}
 
@@ -533,6 +636,8 @@ public:   // Public methods
 			container0_(defaultValue_),
 			container1_(),
 			container2_(),
+			container3_(),
+			container4_(),
 			containerN_()
 	{ }
 
@@ -540,9 +645,11 @@ public:   // Public methods
 	{
 		switch (index.size())
 		{
-			case 0: return getValueForArity0(index); break;
-			case 1: return getValueForArity1(index); break;
-			case 2: return getValueForArity2(index); break;
+			case 0: return container0_; break;
+			case 1: return getValueForFlatArity(container1_, index); break;
+			case 2: return getValueForFlatArity(container2_, index); break;
+			case 3: return getValueForFlatArity(container3_, index); break;
+			case 4: return getValueForFlatArity(container4_, index); break;
 			default: return getValueForArityN(index); break;
 		}
 	}
@@ -551,9 +658,11 @@ public:   // Public methods
 	{
 		switch (index.size())
 		{
-			case 0: setValueForArity0(index, value); break;
-			case 1: setValueForArity1(index, value); break;
-			case 2: setValueForArity2(index, value); break;
+			case 0: container0_ = value; break;
+			case 1: container1_.Set(&index[0], value); break;
+			case 2: container2_.Set(&index[0], value); break;
+			case 3: container3_.Set(&index[0], value); break;
+			case 4: container4_.Set(&index[0], value); break;
 			default: setValueForArityN(index, value); break;
 		}
 	}
@@ -563,17 +672,16 @@ public:   // Public methods
 		const TSet<KeyElementType>& elemDomain) const
 	{
 		typedef TSet<KeyElementType> DomainSetType;
-		// start with arrays for nullary, unary and binary vectors
-		IndexValueArray result(3);
+		// start with arrays for vectors stored in flat hash tables
+		IndexValueArray result(MaxFlatArity + 1);
 
 
 		{	// for unary items
-			typename HashTableUnary::const_iterator itUnary;
-			if ((itUnary = container1_.find(elem)) != container1_.end())
+			const ValueType* value = container1_.Find(&elem);
+			if (value != static_cast<const ValueType*>(0))
 			{	// in case the value is in the hash table
-				IndexType index;
-				index.push_back(elem);
-				IndexValueType valuePair = std::make_pair(index, itUnary->second);
+				IndexType index(1, elem);
+				IndexValueType valuePair = std::make_pair(index, *value);
 
 				result[1].push_back(valuePair);
 			}
@@ -585,17 +693,14 @@ public:   // Public methods
 			itDom != elemDomain.end(); ++itDom)
 		{
 			// when desired element is at the first position
-			KeyElementPairType binaryKey;
-			binaryKey.first = elem;
-			binaryKey.second = *itDom;
+			KeyElementType binaryKey[2] = {elem, *itDom};
 
-			typename HashTableBinary::const_iterator itBinary;
-			if ((itBinary = container2_.find(binaryKey)) != container2_.end())
+			const ValueType* value = container2_.Find(binaryKey);
+			if (value != static_cast<const ValueType*>(0))
 			{	// in case the value is in the hash table
 				IndexType index;
-				index.push_back(elem);
-				index.push_back(*itDom);
-				IndexValueType valuePair = std::make_pair(index, itBinary->second);
+				index.assign(binaryKey, binaryKey + 2);
+				IndexValueType valuePair = std::make_pair(index, *value);
 
 				result[2].push_back(valuePair);
 			}
@@ -606,21 +711,24 @@ public:   // Public methods
 			}
 
 			// when desired element is at the second position
-			binaryKey.first = *itDom;
-			binaryKey.second = elem;
+			std::swap(binaryKey[0], binaryKey[1]);
 
-			if ((itBinary = container2_.find(binaryKey)) != container2_.end())
+			if ((value = container2_.Find(binaryKey)) != static_cast<const ValueType*>(0))
 			{	// in case the value is in the hash table
 				IndexType index;
-				index.push_back(*itDom);
-				index.push_back(elem);
-				IndexValueType valuePair = std::make_pair(index, itBinary->second);
+				index.assign(binaryKey, binaryKey + 2);
+				IndexValueType valuePair = std::make_pair(index, *value);
 
 				result[2].push_back(valuePair);
 			}
 		}
 
 
+		// for ternary and quaternary items
+		collectItemsWith(container3_, elem, result);
+		collectItemsWith(container4_, elem, result);
+
+
 		// for n-nary items
 		for (typename HashTableNnary::const_iterator itNnary = containerN_.begin();
 			itNnary != containerN_.end(); ++itNnary)
@@ -651,8 +759,10 @@ public:   // Public methods
 	void insert(const VectorMap& vecMap)
 	{
 		// copy all vectors (without the nullary one)
-		container1_.insert(vecMap.container1_.begin(), vecMap.container1_.end());
-		container2_.insert(vecMap.container2_.begin(), vecMap.container2_.end());
+		container1_.Insert(vecMap.container1_);
+		container2_.Insert(vecMap.container2_);
+		container3_.Insert(vecMap.container3_);
+		container4_.Insert(vecMap.container4_);
 		containerN_.insert(vecMap.containerN_.begin(), vecMap.containerN_.end());
 	}
 
@@ -665,6 +775,23 @@ public:   // Public methods
 	{
 		return const_iterator(this, true);
 	}
+
+	/**
+	 * @brief  Memory used by the map
+	 *
+	 * Returns the estimated number of bytes allocated by the map on the heap.
+	 *
+	 * @returns  The number of bytes
+	 */
+	size_t GetMemoryUsage() const
+	{
+		typedef SFTA::Private::MemoryEstimate MemoryEstimate;
+
+		return MemoryEstimate::Of(defaultValue_) + MemoryEstimate::Of(container0_) +
+			container1_.GetMemoryUsage() + container2_.GetMemoryUsage() +
+			container3_.GetMemoryUsage() + container4_.GetMemoryUsage() +
+			MemoryEstimate::Of(containerN_);
+	}
 };
 
 #endif
@@ -8,17 +8,64 @@
  *
  *****************************************************************************/
 
+// Standard library headers
+#include <set>
+
 #include <sfta/bu_tree_automaton_cover.hh>
+#include <sfta/trace.hh>
+
+
+namespace
+{
+	/**
+	 * @brief  Appends a transition
+	 *
+	 * Appends the line of a transition unless it has already been appended.
+	 * After reordering of variables, the code of a symbol may be split among
+	 * several paths of the MTBDD that lead to the same states.
+	 *
+	 * @param[in,out]  result    The output
+	 * @param[in,out]  appended  The lines appended so far
+	 * @param[in]      line      The line of the transition
+	 */
+	void appendTransition(std::string& result, std::set<std::string>& appended,
+		const std::string& line)
+	{
+		if (appended.insert(line).second)
+		{	// in case the transition is new
+			result += line;
+		}
+	}
+
+	/**
+	 * @brief  Measures thread CPU time
+	 *
+	 * Returns the thread CPU time (in seconds) elapsed since @p start and
+	 * restarts the measurement.
+	 */
+	double lapThreadTime(timespec& start)
+	{
+		timespec now;
+		clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+		double result = (now.tv_sec - start.tv_sec) +
+			1e-9 * (now.tv_nsec - start.tv_nsec);
+		start = now;
+
+		return result;
+	}
+}
 
 
 // Methods of BUTreeAutomatonCover
 
 std::string SFTA::BUTreeAutomatonCover::ToString() const
 {
+	SFTA_TRACE_SPAN("BUTreeAutomatonCover::ToString");
+
 	std::string result;
 
 	result += "Ops";
-	result += symbolsToString(symbolDict_->GetVectorOfInputSymbols());
+	result += symbolsToString(symbolDict_->GetVectorOfRankedSymbols());
 	result += "\n";
 	result += "\n";
 	result += "Automaton aut";
@@ -37,6 +84,7 @@ std::string SFTA::BUTreeAutomatonCover::ToString() const
 
 	typedef std::vector<InternalTransitionType> TransitionVector;
 
+	std::set<std::string> appended;
 	TransitionVector trans = automaton_->GetVectorOfTransitions();
 	for (typename TransitionVector::const_iterator itTrans = trans.begin();
 		itTrans != trans.end(); ++itTrans)
@@ -60,11 +108,9 @@ std::string SFTA::BUTreeAutomatonCover::ToString() const
 			for (typename InternalRightHandSideType::const_iterator itRhs = rhs.begin();
 				 itRhs != rhs.end(); ++itRhs)
 			{
-				result += Convert::ToString(*itSymbols);
-				result += (outputLhs.empty()? " " : Convert::ToString(outputLhs));
-				result += " -> ";
-				result += Convert::ToString(translateInternalStateToState(*itRhs));
-				result += "\n";
+				appendTransition(result, appended, Convert::ToString(*itSymbols) +
+					(outputLhs.empty()? " " : Convert::ToString(outputLhs)) + " -> " +
+					Convert::ToString(translateInternalStateToState(*itRhs)) + "\n");
 			}
 		}
 	}
@@ -111,8 +157,8 @@ void SFTA::BUTreeAutomatonCover::AddTransition(const LeftHandSideType& lhs,
 		}
 	}
 
-	// translate the symbol
-	InternalSymbolType internalSymbol = symbolDict_->Translate(symbol);
+	// translate the symbol (its arity is given by the left-hand side)
+	InternalSymbolType internalSymbol = symbolDict_->Translate(symbol, lhs.size());
 
 	// retrieve the original right-hand side
 	InternalRightHandSideType origRhs =
@@ -152,17 +198,26 @@ void SFTA::BUTreeAutomatonCover::AddState(const StateType& state)
 }
 
 
+SFTA::MemoryUsage SFTA::BUTreeAutomatonCover::GetMemoryUsage() const
+{
+	MemoryUsage usage = automaton_->GetMemoryUsage();
+	usage.stateNames = SFTA::Private::MemoryEstimate::Of(state2internalStateMap_);
+	usage.symbolDictionary = symbolDict_->GetMemoryUsage();
+
+	return usage;
+}
+
+
 std::string SFTA::BUTreeAutomatonCover::symbolsToString(
-	const std::vector<SymbolType>& vec)
+	const RankedSymbolVector& vec)
 {
 	std::string result;
 
-	typedef std::vector<SymbolType> VectorOfSymbols;
-
-	for (typename VectorOfSymbols::const_iterator itSymbols = vec.begin();
+	for (typename RankedSymbolVector::const_iterator itSymbols = vec.begin();
 		itSymbols != vec.end(); ++itSymbols)
 	{
-		result += " " + Convert::ToString(*itSymbols) + ":0";
+		result += " " + Convert::ToString(itSymbols->first) + ":" +
+			Convert::ToString(itSymbols->second);
 	}
 
 	return result;
@@ -200,18 +255,8 @@ std::vector<SFTA::BUTreeAutomatonCover::SymbolType>
 	SFTA::BUTreeAutomatonCover::translateInternalSymbolToSymbols(
 	const InternalSymbolType& internalSymbol) const
 {
-	std::vector<SymbolType> result;
-
-	typedef std::vector<InternalSymbolType> InternalSymbolVector;
-
-	InternalSymbolVector symbols = internalSymbol.GetVectorOfConcreteSymbols();
-	for (typename InternalSymbolVector::const_iterator itSym = symbols.begin();
-		itSym != symbols.end(); ++itSym)
-	{
-		result.push_back(symbolDict_->TranslateInverse(*itSym));
-	}
-
-	return result;
+	// don't care variables above short codes are not expanded
+	return symbolDict_->TranslateInverseAll(internalSymbol);
 }
 
 SFTA::BUTreeAutomatonCover::StateType
@@ -258,9 +303,15 @@ SFTA::BUTreeAutomatonCover::Type*
 	assert(lhs != static_cast<Type*>(0));
 	assert(rhs != static_cast<Type*>(0));
 
-	if (lhs->GetBDDSize() != rhs->GetBDDSize())
-	{	// check if the BDD sizes match
-		throw std::runtime_error("The sizes of BDDs do not match!");
+	statistics_.Reset();
+	SFTA_STATISTICS_SCOPE(&statistics_);
+	OperationContext::Scope contextScope(context_);
+	SFTA_TRACE_SPAN("BUTreeAutomatonCover::Union");
+
+	if (lhs->GetSymbolDictionary() != rhs->GetSymbolDictionary())
+	{	// symbols of automata with different dictionaries cannot be matched
+		throw std::runtime_error(__func__ +
+			std::string(": the automata do not share the symbol dictionary"));
 	}
 
 	typedef typename NDSymbolicBUTreeAutomaton::HierarchyRoot AbstractAutomaton;
@@ -277,7 +328,7 @@ SFTA::BUTreeAutomatonCover::Type*
 			std::string(": cannot convert to proper type"));
 	}
 
-	return new Type(lhs->GetBDDSize(), result, lhs->GetSymbolDictionary());
+	return new Type(result, lhs->GetSymbolDictionary());
 }
 
 
@@ -288,9 +339,15 @@ SFTA::BUTreeAutomatonCover::Type*
 	assert(lhs != static_cast<Type*>(0));
 	assert(rhs != static_cast<Type*>(0));
 
-	if (lhs->GetBDDSize() != rhs->GetBDDSize())
-	{	// check if the BDD sizes match
-		throw std::runtime_error("The sizes of BDDs do not match!");
+	statistics_.Reset();
+	SFTA_STATISTICS_SCOPE(&statistics_);
+	OperationContext::Scope contextScope(context_);
+	SFTA_TRACE_SPAN("BUTreeAutomatonCover::Intersection");
+
+	if (lhs->GetSymbolDictionary() != rhs->GetSymbolDictionary())
+	{	// symbols of automata with different dictionaries cannot be matched
+		throw std::runtime_error(__func__ +
+			std::string(": the automata do not share the symbol dictionary"));
 	}
 
 	typedef typename NDSymbolicBUTreeAutomaton::HierarchyRoot AbstractAutomaton;
@@ -307,7 +364,7 @@ SFTA::BUTreeAutomatonCover::Type*
 			std::string(": cannot convert to proper type"));
 	}
 
-	return new Type(lhs->GetBDDSize(), result, lhs->GetSymbolDictionary());
+	return new Type(result, lhs->GetSymbolDictionary());
 }
 
 
@@ -318,6 +375,11 @@ SFTA::BUTreeAutomatonCover::SimulationRelationType
 	// Assertions
 	assert(aut != static_cast<Type*>(0));
 
+	statistics_.Reset();
+	SFTA_STATISTICS_SCOPE(&statistics_);
+	OperationContext::Scope contextScope(context_);
+	SFTA_TRACE_SPAN("BUTreeAutomatonCover::ComputeSimulationPreorder");
+
 	SimulationRelationType result;
 
 	typedef typename NDSymbolicBUTreeAutomaton::HierarchyRoot AbstractAutomaton;
@@ -359,6 +421,11 @@ bool SFTA::BUTreeAutomatonCover::Operation::DoesLanguageInclusionHoldUpwards(
 	assert(lhs != static_cast<Type*>(0));
 	assert(rhs != static_cast<Type*>(0));
 
+	statistics_.Reset();
+	SFTA_STATISTICS_SCOPE(&statistics_);
+	OperationContext::Scope contextScope(context_);
+	SFTA_TRACE_SPAN("BUTreeAutomatonCover::DoesLanguageInclusionHoldUpwards");
+
 	typedef typename NDSymbolicBUTreeAutomaton::HierarchyRoot AbstractAutomaton;
 	typedef typename AbstractAutomaton::Operation InternalOperationType;
 	typedef typename InternalOperationType::SimulationRelationType
@@ -374,62 +441,18 @@ bool SFTA::BUTreeAutomatonCover::Operation::DoesLanguageInclusionHoldUpwards(
 bool SFTA::BUTreeAutomatonCover::Operation::DoesLanguageInclusionHoldDownwards(
 	const Type* lhs, const Type* rhs) const
 {
-	// Assertions
-	assert(lhs != static_cast<Type*>(0));
-	assert(rhs != static_cast<Type*>(0));
-
-	typedef typename NDSymbolicBUTreeAutomaton::HierarchyRoot AbstractAutomaton;
-	typedef typename AbstractAutomaton::Operation InternalOperationType;
-	typedef typename InternalOperationType::SimulationRelationType
-		InternalSimulationType;
-
-	// compute simulations
-	std::auto_ptr<InternalOperationType> oper(lhs->getAutomaton()->GetOperation());
-	std::auto_ptr<InternalSimulationType> lhsSim(
-		oper->ComputeSimulationPreorder((lhs->getAutomaton()).get()));
-	std::auto_ptr<InternalSimulationType> rhsSim(
-		oper->ComputeSimulationPreorder((rhs->getAutomaton()).get()));
-
-	// convert automata to top-down
-	std::auto_ptr<typename NDSymbolicBUTreeAutomaton::NDSymbolicTDTreeAutomatonType>
-		lhsTD(lhs->getAutomaton()->GetTopDownAutomaton());
-	std::auto_ptr<typename NDSymbolicBUTreeAutomaton::NDSymbolicTDTreeAutomatonType>
-		rhsTD(rhs->getAutomaton()->GetTopDownAutomaton());
-
-	// check language inclusion
-	std::auto_ptr<InternalOperationType> tdOper(lhsTD.get()->GetOperation());
-	return tdOper->CheckLanguageInclusion(lhsTD.get(), rhsTD.get(), lhsSim.get(),
-		rhsSim.get());
+	InclusionProfile profile;
+	return DoesLanguageInclusionHoldDownwardsProfiled(lhs, rhs,
+		INCLUSION_SIM_SEPARATE, &profile);
 }
 
 
 bool SFTA::BUTreeAutomatonCover::Operation::
 	DoesLanguageInclusionHoldDownwardsSimBoth(const Type* lhs, const Type* rhs) const
 {
-	// Assertions
-	assert(lhs != static_cast<Type*>(0));
-	assert(rhs != static_cast<Type*>(0));
-
-	typedef typename NDSymbolicBUTreeAutomaton::HierarchyRoot AbstractAutomaton;
-	typedef typename AbstractAutomaton::Operation InternalOperationType;
-	typedef typename InternalOperationType::SimulationRelationType
-		InternalSimulationType;
-
-	// compute simulations
-	std::auto_ptr<InternalOperationType> oper(lhs->getAutomaton()->GetOperation());
-	std::auto_ptr<AbstractAutomaton> united(oper->Union((lhs->getAutomaton().get()),
-		(rhs->getAutomaton()).get()));
-	std::auto_ptr<InternalSimulationType> sim(oper->ComputeSimulationPreorder(united.get()));
-
-	// convert automata to top-down
-	std::auto_ptr<typename NDSymbolicBUTreeAutomaton::NDSymbolicTDTreeAutomatonType>
-		lhsTD(lhs->getAutomaton()->GetTopDownAutomaton());
-	std::auto_ptr<typename NDSymbolicBUTreeAutomaton::NDSymbolicTDTreeAutomatonType>
-		rhsTD(rhs->getAutomaton()->GetTopDownAutomaton());
-
-	// check language inclusion
-	std::auto_ptr<InternalOperationType> tdOper(lhsTD.get()->GetOperation());
-	return tdOper->CheckLanguageInclusion(lhsTD.get(), rhsTD.get(), sim.get(), sim.get());
+	InclusionProfile profile;
+	return DoesLanguageInclusionHoldDownwardsProfiled(lhs, rhs,
+		INCLUSION_SIM_BOTH, &profile);
 }
 
 bool SFTA::BUTreeAutomatonCover::Operation::
@@ -437,32 +460,11 @@ bool SFTA::BUTreeAutomatonCover::Operation::
 	const Type* lhs, const Type* rhs, timespec* start) const
 {
 	// Assertions
-	assert(lhs != static_cast<Type*>(0));
-	assert(rhs != static_cast<Type*>(0));
 	assert(start != static_cast<timespec*>(0));
 
-	typedef typename NDSymbolicBUTreeAutomaton::HierarchyRoot AbstractAutomaton;
-	typedef typename AbstractAutomaton::Operation InternalOperationType;
-	typedef typename InternalOperationType::SimulationRelationType
-		InternalSimulationType;
-
-	// compute simulations
-	std::auto_ptr<InternalOperationType> oper(lhs->getAutomaton()->GetOperation());
-	std::auto_ptr<AbstractAutomaton> united(oper->Union((lhs->getAutomaton().get()),
-		(rhs->getAutomaton()).get()));
-	std::auto_ptr<InternalSimulationType> sim(oper->ComputeSimulationPreorder(united.get()));
-
-	// convert automata to top-down
-	std::auto_ptr<typename NDSymbolicBUTreeAutomaton::NDSymbolicTDTreeAutomatonType>
-		lhsTD(lhs->getAutomaton()->GetTopDownAutomaton());
-	std::auto_ptr<typename NDSymbolicBUTreeAutomaton::NDSymbolicTDTreeAutomatonType>
-		rhsTD(rhs->getAutomaton()->GetTopDownAutomaton());
-
-	clock_gettime(CLOCK_THREAD_CPUTIME_ID, start);
-
-	// check language inclusion
-	std::auto_ptr<InternalOperationType> tdOper(lhsTD.get()->GetOperation());
-	return tdOper->CheckLanguageInclusion(lhsTD.get(), rhsTD.get(), sim.get(), sim.get());
+	InclusionProfile profile;
+	return DoesLanguageInclusionHoldDownwardsProfiled(lhs, rhs,
+		INCLUSION_SIM_BOTH, &profile, start);
 }
 
 
@@ -471,56 +473,77 @@ bool SFTA::BUTreeAutomatonCover::Operation::
 	const Type* rhs, timespec* start) const
 {
 	// Assertions
-	assert(lhs != static_cast<Type*>(0));
-	assert(rhs != static_cast<Type*>(0));
 	assert(start != static_cast<timespec*>(0));
 
-	typedef typename NDSymbolicBUTreeAutomaton::HierarchyRoot AbstractAutomaton;
-	typedef typename AbstractAutomaton::Operation InternalOperationType;
-	typedef typename InternalOperationType::SimulationRelationType
-		InternalSimulationType;
-
-	// compute simulations
-	std::auto_ptr<InternalOperationType> oper(lhs->getAutomaton()->GetOperation());
-	std::auto_ptr<InternalSimulationType> lhsSim(
-		oper->ComputeSimulationPreorder((lhs->getAutomaton()).get()));
-	std::auto_ptr<InternalSimulationType> rhsSim(
-		oper->ComputeSimulationPreorder((rhs->getAutomaton()).get()));
-
-	// convert automata to top-down
-	std::auto_ptr<typename NDSymbolicBUTreeAutomaton::NDSymbolicTDTreeAutomatonType>
-		lhsTD(lhs->getAutomaton()->GetTopDownAutomaton());
-	std::auto_ptr<typename NDSymbolicBUTreeAutomaton::NDSymbolicTDTreeAutomatonType>
-		rhsTD(rhs->getAutomaton()->GetTopDownAutomaton());
-
-	clock_gettime(CLOCK_THREAD_CPUTIME_ID, start);
-
-	// check language inclusion
-	std::auto_ptr<InternalOperationType> tdOper(lhsTD.get()->GetOperation());
-	return tdOper->CheckLanguageInclusion(lhsTD.get(), rhsTD.get(), lhsSim.get(),
-		rhsSim.get());
+	InclusionProfile profile;
+	return DoesLanguageInclusionHoldDownwardsProfiled(lhs, rhs,
+		INCLUSION_SIM_SEPARATE, &profile, start);
 }
 
 
 bool SFTA::BUTreeAutomatonCover::Operation::
 	DoesLanguageInclusionHoldDownwardsWithoutSim(const Type* lhs,
 	const Type* rhs, timespec* start) const
+{
+	InclusionProfile profile;
+	return DoesLanguageInclusionHoldDownwardsProfiled(lhs, rhs,
+		INCLUSION_SIM_NONE, &profile, start);
+}
+
+
+bool SFTA::BUTreeAutomatonCover::Operation::
+	DoesLanguageInclusionHoldDownwardsProfiled(const Type* lhs,
+	const Type* rhs, InclusionSimulationType simulation,
+	InclusionProfile* profile, timespec* checkStart) const
 {
 	// Assertions
 	assert(lhs != static_cast<Type*>(0));
 	assert(rhs != static_cast<Type*>(0));
+	assert(profile != static_cast<InclusionProfile*>(0));
+
+	statistics_.Reset();
+	SFTA_STATISTICS_SCOPE(&statistics_);
+	OperationContext::Scope contextScope(context_);
+	SFTA_TRACE_SPAN("BUTreeAutomatonCover::DoesLanguageInclusionHoldDownwardsProfiled");
 
 	typedef typename NDSymbolicBUTreeAutomaton::HierarchyRoot AbstractAutomaton;
 	typedef typename AbstractAutomaton::Operation InternalOperationType;
 	typedef typename InternalOperationType::SimulationRelationType
 		InternalSimulationType;
 
+	timespec start;
+	clock_gettime(CLOCK_THREAD_CPUTIME_ID, &start);
+
 	// compute simulations
 	std::auto_ptr<InternalOperationType> oper(lhs->getAutomaton()->GetOperation());
-	std::auto_ptr<InternalSimulationType> lhsSim(
-		oper->GetIdentityRelation((lhs->getAutomaton()).get()));
-	std::auto_ptr<InternalSimulationType> rhsSim(
-		oper->GetIdentityRelation((rhs->getAutomaton()).get()));
+	std::auto_ptr<InternalSimulationType> lhsSim;
+	std::auto_ptr<InternalSimulationType> rhsSim;
+	switch (simulation)
+	{
+		case INCLUSION_SIM_SEPARATE:
+			lhsSim.reset(oper->ComputeSimulationPreorder((lhs->getAutomaton()).get()));
+			rhsSim.reset(oper->ComputeSimulationPreorder((rhs->getAutomaton()).get()));
+			break;
+
+		case INCLUSION_SIM_BOTH:
+		{
+			std::auto_ptr<AbstractAutomaton> united(oper->Union(
+				(lhs->getAutomaton()).get(), (rhs->getAutomaton()).get()));
+			lhsSim.reset(oper->ComputeSimulationPreorder(united.get()));
+			break;
+		}
+
+		case INCLUSION_SIM_NONE:
+			lhsSim.reset(oper->GetIdentityRelation((lhs->getAutomaton()).get()));
+			rhsSim.reset(oper->GetIdentityRelation((rhs->getAutomaton()).get()));
+			break;
+
+		default:
+			throw std::runtime_error(__func__ +
+				std::string(": invalid simulation type"));
+	}
+
+	profile->simulation = lapThreadTime(start);
 
 	// convert automata to top-down
 	std::auto_ptr<typename NDSymbolicBUTreeAutomaton::NDSymbolicTDTreeAutomatonType>
@@ -528,10 +551,19 @@ bool SFTA::BUTreeAutomatonCover::Operation::
 	std::auto_ptr<typename NDSymbolicBUTreeAutomaton::NDSymbolicTDTreeAutomatonType>
 		rhsTD(rhs->getAutomaton()->GetTopDownAutomaton());
 
-	clock_gettime(CLOCK_THREAD_CPUTIME_ID, start);
+	profile->conversion = lapThreadTime(start);
 
-	// check language inclusion
+	if (checkStart != static_cast<timespec*>(0))
+	{	// in case the caller measures the check on its own
+		*checkStart = start;
+	}
+
+	// check language inclusion (the union shares one relation)
 	std::auto_ptr<InternalOperationType> tdOper(lhsTD.get()->GetOperation());
-	return tdOper->CheckLanguageInclusion(lhsTD.get(), rhsTD.get(), lhsSim.get(),
-		rhsSim.get());
+	bool result = tdOper->CheckLanguageInclusion(lhsTD.get(), rhsTD.get(),
+		lhsSim.get(), (simulation == INCLUSION_SIM_BOTH)? lhsSim.get() : rhsSim.get());
+
+	profile->check = lapThreadTime(start);
+
+	return result;
 }
@@ -10,40 +10,32 @@
 
 
 // Standard library headers
+#include <cerrno>
 #include <cstdlib>
+#include <cstring>
 #include <ctime>
 #include <getopt.h>
 #include <fstream>
 #include <iostream>
 
+// POSIX headers
+#include <signal.h>
+
 // Log4cpp headers
 #include <log4cpp/Category.hh>
 #include <log4cpp/OstreamAppender.hh>
 #include <log4cpp/BasicLayout.hh>
 
 // SFTA library headers
-#include <sfta/bu_tree_automaton_cover.hh>
-#include <sfta/convert.hh>
-#include <sfta/ta_building_director.hh>
-#include <sfta/td_tree_automaton_cover.hh>
-#include <sfta/timbuk_bu_ta_builder.hh>
-#include <sfta/timbuk_td_ta_builder.hh>
-
-
-
-typedef SFTA::BUTreeAutomatonCover BUTreeAutomaton;
-typedef SFTA::TDTreeAutomatonCover TDTreeAutomaton;
-
-typedef SFTA::TABuildingDirector<BUTreeAutomaton> BUTABuildingDirector;
-typedef SFTA::TABuildingDirector<TDTreeAutomaton> TDTABuildingDirector;
-
-typedef SFTA::AbstractTABuilder<BUTreeAutomaton> AbstractBUTABuilder;
-typedef SFTA::AbstractTABuilder<TDTreeAutomaton> AbstractTDTABuilder;
+#include <sfta/operation_statistics.hh>
+#include <sfta/trace.hh>
 
-typedef SFTA::TimbukBUTABuilder<BUTreeAutomaton> TimbukBUTABuilder;
-typedef SFTA::TimbukTDTABuilder<TDTreeAutomaton> TimbukTDTABuilder;
+// sfta program headers
+#include "sfta_batch.hh"
+#include "sfta_benchmark.hh"
+#include "sfta_common.hh"
+#include "sfta_daemon.hh"
 
-typedef SFTA::Private::Convert Convert;
 
 enum OperationType
 {
@@ -58,12 +50,33 @@ enum OperationType
 	OPERATION_DOWN_INCLUSION_NOTIME,
 	OPERATION_DOWN_INCLUSION_NOSIM,
 	OPERATION_UP_INCLUSION,
+	OPERATION_DAEMON,
+	OPERATION_BATCH,
+	OPERATION_BENCHMARK,
 
 	OPERATION_HELP,
 
 	OPERATION_LAST            // just for checking boundary
 };
 
+enum LongOptionType
+{
+	LONG_OPTION_ENCODING = 256,
+	LONG_OPTION_SIFT,
+	LONG_OPTION_BATCH,
+	LONG_OPTION_WORKERS,
+	LONG_OPTION_TIME_LIMIT,
+	LONG_OPTION_MEMORY_LIMIT,
+	LONG_OPTION_BENCHMARK,
+	LONG_OPTION_METHOD,
+	LONG_OPTION_WARMUP,
+	LONG_OPTION_REPETITIONS,
+	LONG_OPTION_STATS,
+	LONG_OPTION_TRACE,
+	LONG_OPTION_TIMEOUT,
+	LONG_OPTION_MEMORY_BUDGET
+};
+
 void printHelp(const std::string& programName)
 {
 	std::cout << "usage: " << programName << " (-l|--load)                   <file1>\n";
@@ -75,6 +88,34 @@ void printHelp(const std::string& programName)
 	std::cout << "   or: " << programName << " (-o|--down-inclusion-nosim)   <file1> <file2>\n";
 	std::cout << "   or: " << programName << " (-w|--down-inclusion-notime)  <file1> <file2>\n";
 	std::cout << "   or: " << programName << " (-p|--up-inclusion)           <file1> <file2>\n";
+	std::cout << "   or: " << programName << " (-d|--daemon)                 [<socket>]\n";
+	std::cout << "   or: " << programName << " --batch                       <manifest>\n";
+	std::cout << "   or: " << programName << " --benchmark                   <file1> <file2>\n";
+	std::cout << "\n";
+	std::cout << "    --encoding=<first-seen|frequency|gray|cooccurrence>\n";
+	std::cout << "                           the order in which symbols are encoded in MTBDDs\n";
+	std::cout << "                           (default first-seen).\n";
+	std::cout << "    --sift                 reorder variables of the MTBDD using sifting after\n";
+	std::cout << "                           loading.\n";
+	std::cout << "    --stats                print statistics of the operation (antichain size,\n";
+	std::cout << "                           cache hits, Apply calls, ...; needs the library to\n";
+	std::cout << "                           be compiled with SFTA_ENABLE_STATISTICS) and the\n";
+	std::cout << "                           telemetry of the MTBDD manager (nodes, computed\n";
+	std::cout << "                           table, garbage collection, ...) and the memory\n";
+	std::cout << "                           footprint of the automaton and the shared MTBDD as\n";
+	std::cout << "                           a JSON object to the standard error output.\n";
+	std::cout << "    --trace=<file>         write a timeline of the operations of the library\n";
+	std::cout << "                           to <file> in the Chrome trace-event format (the\n";
+	std::cout << "                           same as setting the SFTA_TRACE environment\n";
+	std::cout << "                           variable).\n";
+	std::cout << "    --timeout=<sec>        interrupt an operation that runs longer than <sec>\n";
+	std::cout << "                           seconds of wall time.\n";
+	std::cout << "    --memory-budget=<MB>   interrupt an operation once the resident memory of\n";
+	std::cout << "                           the process exceeds <MB> megabytes.\n";
+	std::cout << "                           The result of an interrupted operation (also by\n";
+	std::cout << "                           SIGINT) is printed as \"unknown\" and the reason\n";
+	std::cout << "                           to the standard error output (\"unknown REASON\" in\n";
+	std::cout << "                           --daemon and --batch).\n";
 	std::cout << "\n";
 	std::cout << "    -l, --load             load an automaton from <file1>.\n";
 	std::cout << "    -u, --union            create an automaton with language that is the union\n";
@@ -101,6 +142,47 @@ void printHelp(const std::string& programName)
 	std::cout << "    -p, --up-inclusion     check whether the language of the automaton from\n";
 	std::cout << "                           <file1> is a subset of the language of the automaton\n";
 	std::cout << "                           from <file2> (upward processing).\n";
+	std::cout << "    -d, --daemon           keep running and execute commands read from the\n";
+	std::cout << "                           standard input, or from clients of the UNIX socket\n";
+	std::cout << "                           <socket>, one per line:\n";
+	std::cout << "                             load NAME FILE\n";
+	std::cout << "                             union NAME LHS RHS\n";
+	std::cout << "                             intersection NAME LHS RHS\n";
+	std::cout << "                             inclusion LHS RHS [down|down-simboth|down-nosim|up]\n";
+	std::cout << "                             simulation NAME\n";
+	std::cout << "                             free NAME\n";
+	std::cout << "                             list | quit | shutdown\n";
+	std::cout << "                           Each command is answered by a line starting with\n";
+	std::cout << "                           \"ok\", \"unknown\" or \"error\".\n";
+	std::cout << "    --batch                run the jobs listed in <manifest>, one per line:\n";
+	std::cout << "                             load FILE\n";
+	std::cout << "                             union LHS RHS\n";
+	std::cout << "                             intersection LHS RHS\n";
+	std::cout << "                             inclusion LHS RHS [down|down-simboth|down-nosim|up]\n";
+	std::cout << "                             simulation FILE\n";
+	std::cout << "                           and print the result of each job as a JSON object\n";
+	std::cout << "                           on a separate line. The object gives the CPU time\n";
+	std::cout << "                           of the worker (null if the job did not finish) and\n";
+	std::cout << "                           the wall time of the job.\n";
+	std::cout << "    --workers=<n>          the number of worker processes of --batch\n";
+	std::cout << "                           (default 1).\n";
+	std::cout << "    --time-limit=<sec>     the wall time limit of a single job of --batch.\n";
+	std::cout << "    --memory-limit=<MB>    the memory limit of a worker process of --batch.\n";
+	std::cout << "                           A worker keeps the automata of its previous jobs,\n";
+	std::cout << "                           so the limit caps all of them together rather\n";
+	std::cout << "                           than a single job.\n";
+	std::cout << "    --benchmark            repeatedly check whether the language of the automaton\n";
+	std::cout << "                           from <file1> is a subset of the language of the\n";
+	std::cout << "                           automaton from <file2> and print statistics of the\n";
+	std::cout << "                           time of parsing, simulation, conversion to top-down\n";
+	std::cout << "                           and the check itself, MTBDD sizes and the peak RSS\n";
+	std::cout << "                           of the process over all runs as a JSON object.\n";
+	std::cout << "    --method=<down|down-simboth|down-nosim|up>\n";
+	std::cout << "                           the inclusion method of --benchmark (default down).\n";
+	std::cout << "    --warmup=<n>           the number of unmeasured runs of --benchmark\n";
+	std::cout << "                           (default 1).\n";
+	std::cout << "    --repetitions=<n>      the number of measured runs of --benchmark\n";
+	std::cout << "                           (default 10).\n";
 }
 
 void needsArguments(size_t value, size_t needsToBe)
@@ -127,7 +209,81 @@ void specifyOperation(OperationType& oper, OperationType value)
 }
 
 
-void performUnion(bool isTopDown, const std::string& lhsFile,
+SymbolStatistics::EncodingStrategy parseEncoding(const std::string& str)
+{
+	if (str == "first-seen")
+	{
+		return SymbolStatistics::ENCODING_FIRST_SEEN;
+	}
+	else if (str == "frequency")
+	{
+		return SymbolStatistics::ENCODING_FREQUENCY;
+	}
+	else if (str == "gray")
+	{
+		return SymbolStatistics::ENCODING_GRAY;
+	}
+	else if (str == "cooccurrence")
+	{
+		return SymbolStatistics::ENCODING_COOCCURRENCE;
+	}
+
+	throw std::runtime_error("Invalid encoding: " + str);
+}
+
+
+template <class Operation, class TreeAutomaton>
+void reportStatistics(const Operation& op, TreeAutomaton& ta,
+	const LoadOptions& options)
+{
+	if (options.stats)
+	{	// in case statistics of the operation were requested
+		if (!SFTA::OperationStatistics::IsEnabled())
+		{
+			SFTA_LOGGER_WARN("Statistics are not collected, compile with "
+				"SFTA_ENABLE_STATISTICS");
+		}
+
+		std::cerr << "{\"operation\": " << op.GetStatistics().ToString()
+			<< ", \"mtbdd\": " << ta.GetMTBDDTelemetry().ToString()
+			<< ", \"memory\": {\"automaton\": " << ta.GetMemoryUsage().ToString()
+			<< ", \"shared_mtbdd\": " << ta.GetMTBDDMemoryUsage().ToString() << "}}\n";
+	}
+}
+
+/**
+ * @brief  Handler of SIGINT
+ *
+ * Cancels the running operation. The handler is installed only for a single
+ * interrupt, so that the next one terminates the program.
+ */
+extern "C" void cancelOperation(int)
+{
+	operationContext().Cancel();
+}
+
+
+void installCancellation()
+{
+	// make sure the context exists before the handler can be run
+	operationContext();
+
+	struct sigaction action;
+	std::memset(&action, 0, sizeof(action));
+	action.sa_handler = cancelOperation;
+	action.sa_flags = SA_RESETHAND;
+	sigemptyset(&action.sa_mask);
+
+	if (sigaction(SIGINT, &action, static_cast<struct sigaction*>(0)) != 0)
+	{
+		throw std::runtime_error("Could not install handler of SIGINT: " +
+			std::string(std::strerror(errno)));
+	}
+}
+
+
+void performUnion(bool isTopDown, const LoadOptions& options,
+	const std::string& lhsFile,
 	const std::string& rhsFile)
 {
 	std::ifstream ifsLhs(lhsFile.c_str());
@@ -147,13 +303,20 @@ void performUnion(bool isTopDown, const std::string& lhsFile,
 		std::auto_ptr<AbstractBUTABuilder> builder(new TimbukBUTABuilder());
 		BUTABuildingDirector director(builder.get());
 
+		registerSymbols(director, options, ifsLhs, &ifsRhs);
+
 		std::auto_ptr<BUTreeAutomaton> taLhs(director.Construct(ifsLhs));
 		std::auto_ptr<BUTreeAutomaton> taRhs(director.Construct(ifsRhs));
 
+		reportNodeCount(*taRhs, options);
+
 		std::auto_ptr<BUTreeAutomaton::Operation> op(taLhs->GetOperation());
+		limitOperation(*op, options);
 
 		std::auto_ptr<BUTreeAutomaton> taUnion(op->Union(taLhs.get(), taRhs.get()));
 
+		reportStatistics(*op, *taLhs, options);
+
 		std::cout << taUnion->ToString();
 	}
 	else
@@ -161,19 +324,27 @@ void performUnion(bool isTopDown, const std::string& lhsFile,
 		std::auto_ptr<AbstractTDTABuilder> builder(new TimbukTDTABuilder());
 		TDTABuildingDirector director(builder.get());
 
+		registerSymbols(director, options, ifsLhs, &ifsRhs);
+
 		std::auto_ptr<TDTreeAutomaton> taLhs(director.Construct(ifsLhs));
 		std::auto_ptr<TDTreeAutomaton> taRhs(director.Construct(ifsRhs));
 
+		reportNodeCount(*taRhs, options);
+
 		std::auto_ptr<TDTreeAutomaton::Operation> op(taLhs->GetOperation());
+		limitOperation(*op, options);
 
 		std::auto_ptr<TDTreeAutomaton> taUnion(op->Union(taLhs.get(), taRhs.get()));
 
+		reportStatistics(*op, *taLhs, options);
+
 		std::cout << taUnion->ToString();
 	}
 }
 
 
-void performIntersection(bool isTopDown, const std::string& lhsFile,
+void performIntersection(bool isTopDown, const LoadOptions& options,
+	const std::string& lhsFile,
 	const std::string& rhsFile)
 {
 	std::ifstream ifsLhs(lhsFile.c_str());
@@ -193,14 +364,21 @@ void performIntersection(bool isTopDown, const std::string& lhsFile,
 		std::auto_ptr<AbstractBUTABuilder> builder(new TimbukBUTABuilder());
 		BUTABuildingDirector director(builder.get());
 
+		registerSymbols(director, options, ifsLhs, &ifsRhs);
+
 		std::auto_ptr<BUTreeAutomaton> taLhs(director.Construct(ifsLhs));
 		std::auto_ptr<BUTreeAutomaton> taRhs(director.Construct(ifsRhs));
 
+		reportNodeCount(*taRhs, options);
+
 		std::auto_ptr<BUTreeAutomaton::Operation> op(taLhs->GetOperation());
+		limitOperation(*op, options);
 
 
 		//clock_t start = clock();
 		std::auto_ptr<BUTreeAutomaton> taUnion(op->Intersection(taLhs.get(), taRhs.get()));
+
+		reportStatistics(*op, *taLhs, options);
 		//clock_t finish = clock();
 		//SFTA_LOGGER_INFO("Duration: " + Convert::ToString(static_cast<double>(finish - start) / CLOCKS_PER_SEC) + " s");
 
@@ -211,19 +389,27 @@ void performIntersection(bool isTopDown, const std::string& lhsFile,
 		std::auto_ptr<AbstractTDTABuilder> builder(new TimbukTDTABuilder());
 		TDTABuildingDirector director(builder.get());
 
+		registerSymbols(director, options, ifsLhs, &ifsRhs);
+
 		std::auto_ptr<TDTreeAutomaton> taLhs(director.Construct(ifsLhs));
 		std::auto_ptr<TDTreeAutomaton> taRhs(director.Construct(ifsRhs));
 
+		reportNodeCount(*taRhs, options);
+
 		std::auto_ptr<TDTreeAutomaton::Operation> op(taLhs->GetOperation());
+		limitOperation(*op, options);
 
 		std::auto_ptr<TDTreeAutomaton> taUnion(op->Intersection(taLhs.get(), taRhs.get()));
 
+		reportStatistics(*op, *taLhs, options);
+
 		std::cout << taUnion->ToString();
 	}
 }
 
 
-void performLoad(bool isTopDown, const std::string& file)
+void performLoad(bool isTopDown, const LoadOptions& options,
+	const std::string& file)
 {
 	std::ifstream ifs(file.c_str());
 	if (ifs.fail())
@@ -236,8 +422,12 @@ void performLoad(bool isTopDown, const std::string& file)
 		std::auto_ptr<AbstractBUTABuilder> builder(new TimbukBUTABuilder());
 		BUTABuildingDirector director(builder.get());
 
+		registerSymbols(director, options, ifs);
+
 		std::auto_ptr<BUTreeAutomaton> ta(director.Construct(ifs));
 
+		reportNodeCount(*ta, options);
+
 		std::cout << ta->ToString();
 	}
 	else
@@ -245,14 +435,19 @@ void performLoad(bool isTopDown, const std::string& file)
 		std::auto_ptr<AbstractTDTABuilder> builder(new TimbukTDTABuilder());
 		TDTABuildingDirector director(builder.get());
 
+		registerSymbols(director, options, ifs);
+
 		std::auto_ptr<TDTreeAutomaton> ta(director.Construct(ifs));
 
+		reportNodeCount(*ta, options);
+
 		std::cout << ta->ToString();
 	}
 }
 
 
-void performComputationOfSimulation(bool isTopDown, const std::string& file)
+void performComputationOfSimulation(bool isTopDown, const LoadOptions& options,
+	const std::string& file)
 {
 	std::ifstream ifs(file.c_str());
 	if (ifs.fail())
@@ -265,14 +460,21 @@ void performComputationOfSimulation(bool isTopDown, const std::string& file)
 		std::auto_ptr<AbstractBUTABuilder> builder(new TimbukBUTABuilder());
 		BUTABuildingDirector director(builder.get());
 
+		registerSymbols(director, options, ifs);
+
 		std::auto_ptr<BUTreeAutomaton> ta(director.Construct(ifs));
 
+		reportNodeCount(*ta, options);
+
 		std::auto_ptr<BUTreeAutomaton::Operation> op(ta->GetOperation());
+		limitOperation(*op, options);
 
 		typedef BUTreeAutomaton::SimulationRelationType SimulationRelationType;
 
 		SimulationRelationType sim = op->ComputeSimulationPreorder(ta.get());
 
+		reportStatistics(*op, *ta, options);
+
 		std::string resultString = Convert::ToString(sim);
 
 		std::cout << resultString << "\n";
@@ -284,7 +486,8 @@ void performComputationOfSimulation(bool isTopDown, const std::string& file)
 }
 
 
-void performCheckingDownwardInclusion(bool isTopDown, const std::string& lhsFile,
+void performCheckingDownwardInclusion(bool isTopDown, const LoadOptions& options,
+	const std::string& lhsFile,
 	const std::string& rhsFile)
 {
 	std::ifstream ifsLhs(lhsFile.c_str());
@@ -304,10 +507,15 @@ void performCheckingDownwardInclusion(bool isTopDown, const std::string& lhsFile
 		std::auto_ptr<AbstractBUTABuilder> builder(new TimbukBUTABuilder());
 		BUTABuildingDirector director(builder.get());
 
+		registerSymbols(director, options, ifsLhs, &ifsRhs);
+
 		std::auto_ptr<BUTreeAutomaton> taLhs(director.Construct(ifsLhs));
 		std::auto_ptr<BUTreeAutomaton> taRhs(director.Construct(ifsRhs));
 
+		reportNodeCount(*taRhs, options);
+
 		std::auto_ptr<BUTreeAutomaton::Operation> op(taLhs->GetOperation());
+		limitOperation(*op, options);
 
 		bool result;
 
@@ -320,6 +528,8 @@ void performCheckingDownwardInclusion(bool isTopDown, const std::string& lhsFile
 		clock_gettime(CLOCK_THREAD_CPUTIME_ID, &tmp);
 		double t = (tmp.tv_sec - start.tv_sec) + 1e-9*(tmp.tv_nsec - start.tv_nsec);
 
+		reportStatistics(*op, *taLhs, options);
+
 		std::cout << (result? "1" : "0") << "\n";
 		std::cerr << t << "\n";
 	}
@@ -330,7 +540,8 @@ void performCheckingDownwardInclusion(bool isTopDown, const std::string& lhsFile
 }
 
 
-void performCheckingDownwardInclusionSimBoth(bool isTopDown, const std::string& lhsFile,
+void performCheckingDownwardInclusionSimBoth(bool isTopDown, const LoadOptions& options,
+	const std::string& lhsFile,
 	const std::string& rhsFile)
 {
 	std::ifstream ifsLhs(lhsFile.c_str());
@@ -350,10 +561,15 @@ void performCheckingDownwardInclusionSimBoth(bool isTopDown, const std::string&
 		std::auto_ptr<AbstractBUTABuilder> builder(new TimbukBUTABuilder());
 		BUTABuildingDirector director(builder.get());
 
+		registerSymbols(director, options, ifsLhs, &ifsRhs);
+
 		std::auto_ptr<BUTreeAutomaton> taLhs(director.Construct(ifsLhs));
 		std::auto_ptr<BUTreeAutomaton> taRhs(director.Construct(ifsRhs));
 
+		reportNodeCount(*taRhs, options);
+
 		std::auto_ptr<BUTreeAutomaton::Operation> op(taLhs->GetOperation());
+		limitOperation(*op, options);
 
 		bool result;
 
@@ -366,6 +582,8 @@ void performCheckingDownwardInclusionSimBoth(bool isTopDown, const std::string&
 		clock_gettime(CLOCK_THREAD_CPUTIME_ID, &tmp);
 		double t = (tmp.tv_sec - start.tv_sec) + 1e-9*(tmp.tv_nsec - start.tv_nsec);
 
+		reportStatistics(*op, *taLhs, options);
+
 		std::cout << (result? "1" : "0") << "\n";
 		std::cerr << t << "\n";
 	}
@@ -376,7 +594,8 @@ void performCheckingDownwardInclusionSimBoth(bool isTopDown, const std::string&
 }
 
 
-void performCheckingDownwardInclusionSimBothNoSimTime(bool isTopDown, const std::string& lhsFile,
+void performCheckingDownwardInclusionSimBothNoSimTime(bool isTopDown, const LoadOptions& options,
+	const std::string& lhsFile,
 	const std::string& rhsFile)
 {
 	std::ifstream ifsLhs(lhsFile.c_str());
@@ -396,10 +615,15 @@ void performCheckingDownwardInclusionSimBothNoSimTime(bool isTopDown, const std:
 		std::auto_ptr<AbstractBUTABuilder> builder(new TimbukBUTABuilder());
 		BUTABuildingDirector director(builder.get());
 
+		registerSymbols(director, options, ifsLhs, &ifsRhs);
+
 		std::auto_ptr<BUTreeAutomaton> taLhs(director.Construct(ifsLhs));
 		std::auto_ptr<BUTreeAutomaton> taRhs(director.Construct(ifsRhs));
 
+		reportNodeCount(*taRhs, options);
+
 		std::auto_ptr<BUTreeAutomaton::Operation> op(taLhs->GetOperation());
+		limitOperation(*op, options);
 
 		bool result;
 
@@ -411,6 +635,8 @@ void performCheckingDownwardInclusionSimBothNoSimTime(bool isTopDown, const std:
 		clock_gettime(CLOCK_THREAD_CPUTIME_ID, &tmp);
 		double t = (tmp.tv_sec - start.tv_sec) + 1e-9*(tmp.tv_nsec - start.tv_nsec);
 
+		reportStatistics(*op, *taLhs, options);
+
 		std::cout << (result? "1" : "0") << "\n";
 		std::cerr << t << "\n";
 	}
@@ -421,7 +647,8 @@ void performCheckingDownwardInclusionSimBothNoSimTime(bool isTopDown, const std:
 }
 
 
-void performCheckingDownwardInclusionWithoutTime(bool isTopDown, const std::string& lhsFile,
+void performCheckingDownwardInclusionWithoutTime(bool isTopDown, const LoadOptions& options,
+	const std::string& lhsFile,
 	const std::string& rhsFile)
 {
 	std::ifstream ifsLhs(lhsFile.c_str());
@@ -441,10 +668,15 @@ void performCheckingDownwardInclusionWithoutTime(bool isTopDown, const std::stri
 		std::auto_ptr<AbstractBUTABuilder> builder(new TimbukBUTABuilder());
 		BUTABuildingDirector director(builder.get());
 
+		registerSymbols(director, options, ifsLhs, &ifsRhs);
+
 		std::auto_ptr<BUTreeAutomaton> taLhs(director.Construct(ifsLhs));
 		std::auto_ptr<BUTreeAutomaton> taRhs(director.Construct(ifsRhs));
 
+		reportNodeCount(*taRhs, options);
+
 		std::auto_ptr<BUTreeAutomaton::Operation> op(taLhs->GetOperation());
+		limitOperation(*op, options);
 
 		bool result;
 
@@ -455,6 +687,8 @@ void performCheckingDownwardInclusionWithoutTime(bool isTopDown, const std::stri
 		clock_gettime(CLOCK_THREAD_CPUTIME_ID, &tmp);
 		double t = (tmp.tv_sec - start.tv_sec) + 1e-9*(tmp.tv_nsec - start.tv_nsec);
 
+		reportStatistics(*op, *taLhs, options);
+
 		std::cout << (result? "1" : "0") << "\n";
 		std::cerr << t << "\n";
 	}
@@ -465,7 +699,7 @@ void performCheckingDownwardInclusionWithoutTime(bool isTopDown, const std::stri
 }
 
 
-void performCheckingDownwardInclusionWithoutSim(bool isTopDown,
+void performCheckingDownwardInclusionWithoutSim(bool isTopDown, const LoadOptions& options,
 	const std::string& lhsFile, const std::string& rhsFile)
 {
 	std::ifstream ifsLhs(lhsFile.c_str());
@@ -485,10 +719,15 @@ void performCheckingDownwardInclusionWithoutSim(bool isTopDown,
 		std::auto_ptr<AbstractBUTABuilder> builder(new TimbukBUTABuilder());
 		BUTABuildingDirector director(builder.get());
 
+		registerSymbols(director, options, ifsLhs, &ifsRhs);
+
 		std::auto_ptr<BUTreeAutomaton> taLhs(director.Construct(ifsLhs));
 		std::auto_ptr<BUTreeAutomaton> taRhs(director.Construct(ifsRhs));
 
+		reportNodeCount(*taRhs, options);
+
 		std::auto_ptr<BUTreeAutomaton::Operation> op(taLhs->GetOperation());
+		limitOperation(*op, options);
 
 		bool result;
 
@@ -500,6 +739,8 @@ void performCheckingDownwardInclusionWithoutSim(bool isTopDown,
 		clock_gettime(CLOCK_THREAD_CPUTIME_ID, &tmp);
 		double t = (tmp.tv_sec - start.tv_sec) + 1e-9*(tmp.tv_nsec - start.tv_nsec);
 
+		reportStatistics(*op, *taLhs, options);
+
 		std::cout << (result? "1" : "0") << "\n";
 		std::cerr << t << "\n";
 	}
@@ -510,7 +751,8 @@ void performCheckingDownwardInclusionWithoutSim(bool isTopDown,
 }
 
 
-void performCheckingUpwardInclusion(bool isTopDown, const std::string& lhsFile,
+void performCheckingUpwardInclusion(bool isTopDown, const LoadOptions& options,
+	const std::string& lhsFile,
 	const std::string& rhsFile)
 {
 	std::ifstream ifsLhs(lhsFile.c_str());
@@ -530,10 +772,15 @@ void performCheckingUpwardInclusion(bool isTopDown, const std::string& lhsFile,
 		std::auto_ptr<AbstractBUTABuilder> builder(new TimbukBUTABuilder());
 		BUTABuildingDirector director(builder.get());
 
+		registerSymbols(director, options, ifsLhs, &ifsRhs);
+
 		std::auto_ptr<BUTreeAutomaton> taLhs(director.Construct(ifsLhs));
 		std::auto_ptr<BUTreeAutomaton> taRhs(director.Construct(ifsRhs));
 
+		reportNodeCount(*taRhs, options);
+
 		std::auto_ptr<BUTreeAutomaton::Operation> op(taLhs->GetOperation());
+		limitOperation(*op, options);
 
 		bool result;
 
@@ -546,6 +793,8 @@ void performCheckingUpwardInclusion(bool isTopDown, const std::string& lhsFile,
 		clock_gettime(CLOCK_THREAD_CPUTIME_ID, &tmp);
 		double t = (tmp.tv_sec - start.tv_sec) + 1e-9*(tmp.tv_nsec - start.tv_nsec);
 
+		reportStatistics(*op, *taLhs, options);
+
 		std::cout << (result? "1" : "0") << "\n";
 		std::cerr << t << "\n";
 	}
@@ -580,7 +829,7 @@ int main(int argc, char* argv[])
 	{
 		startLogger();
 
-		const char* getoptString = "uihlbtsnmawop";
+		const char* getoptString = "uihlbtsnmawopd";
 		option longOptions[] = {
 			{"union",                      0, static_cast<int*>(0), 'u'},
 			{"intersection",               0, static_cast<int*>(0), 'i'},
@@ -595,12 +844,30 @@ int main(int argc, char* argv[])
 			{"down-inclusion-notime",      0, static_cast<int*>(0), 'w'},
 			{"down-inclusion-nosim",       0, static_cast<int*>(0), 'o'},
 			{"up-inclusion",               0, static_cast<int*>(0), 'p'},
+			{"daemon",                     0, static_cast<int*>(0), 'd'},
+			{"encoding",                   1, static_cast<int*>(0), LONG_OPTION_ENCODING},
+			{"sift",                       0, static_cast<int*>(0), LONG_OPTION_SIFT},
+			{"batch",                      0, static_cast<int*>(0), LONG_OPTION_BATCH},
+			{"workers",                    1, static_cast<int*>(0), LONG_OPTION_WORKERS},
+			{"time-limit",                 1, static_cast<int*>(0), LONG_OPTION_TIME_LIMIT},
+			{"memory-limit",               1, static_cast<int*>(0), LONG_OPTION_MEMORY_LIMIT},
+			{"benchmark",                  0, static_cast<int*>(0), LONG_OPTION_BENCHMARK},
+			{"method",                     1, static_cast<int*>(0), LONG_OPTION_METHOD},
+			{"warmup",                     1, static_cast<int*>(0), LONG_OPTION_WARMUP},
+			{"repetitions",                1, static_cast<int*>(0), LONG_OPTION_REPETITIONS},
+			{"stats",                      0, static_cast<int*>(0), LONG_OPTION_STATS},
+			{"trace",                      1, static_cast<int*>(0), LONG_OPTION_TRACE},
+			{"timeout",                    1, static_cast<int*>(0), LONG_OPTION_TIMEOUT},
+			{"memory-budget",              1, static_cast<int*>(0), LONG_OPTION_MEMORY_BUDGET},
 
 			{static_cast<const char*>(0),  0, static_cast<int*>(0), 0}
 		};
 
 		OperationType operation = OPERATION_INVALID;
 		bool isTopDown = false;
+		LoadOptions options;
+		BatchOptions batchOptions;
+		BenchmarkOptions benchOptions;
 
 		int opt, optIndex;
 		while ((opt = getopt_long(argc, argv,
@@ -619,8 +886,23 @@ int main(int argc, char* argv[])
 				case 'w': specifyOperation(operation, OPERATION_DOWN_INCLUSION_NOTIME); break;
 				case 'p': specifyOperation(operation, OPERATION_UP_INCLUSION); break;
 				case 'o': specifyOperation(operation, OPERATION_DOWN_INCLUSION_NOSIM); break;
+				case 'd': specifyOperation(operation, OPERATION_DAEMON); break;
 				case 'b': isTopDown = false; break;
 				case 't': isTopDown = true; break;
+				case LONG_OPTION_ENCODING: options.encoding = parseEncoding(optarg); break;
+				case LONG_OPTION_SIFT: options.sift = true; break;
+				case LONG_OPTION_BATCH: specifyOperation(operation, OPERATION_BATCH); break;
+				case LONG_OPTION_WORKERS: batchOptions.workers = Convert::FromString<size_t>(optarg); break;
+				case LONG_OPTION_TIME_LIMIT: batchOptions.timeLimit = Convert::FromString<double>(optarg); break;
+				case LONG_OPTION_MEMORY_LIMIT: batchOptions.memoryLimit = Convert::FromString<size_t>(optarg); break;
+				case LONG_OPTION_BENCHMARK: specifyOperation(operation, OPERATION_BENCHMARK); break;
+				case LONG_OPTION_METHOD: benchOptions.method = optarg; break;
+				case LONG_OPTION_WARMUP: benchOptions.warmup = Convert::FromString<size_t>(optarg); break;
+				case LONG_OPTION_REPETITIONS: benchOptions.repetitions = Convert::FromString<size_t>(optarg); break;
+				case LONG_OPTION_STATS: options.stats = true; break;
+				case LONG_OPTION_TRACE: SFTA::Private::Tracer::GetInstance().Start(optarg); break;
+				case LONG_OPTION_TIMEOUT: options.timeout = Convert::FromString<double>(optarg); break;
+				case LONG_OPTION_MEMORY_BUDGET: options.memoryBudget = Convert::FromString<size_t>(optarg); break;
 				default: throw std::runtime_error("Invalid command line parameter."); break;
 			}
 		}
@@ -641,6 +923,11 @@ int main(int argc, char* argv[])
 		}
 
 
+		if ((operation != OPERATION_DAEMON) && (operation != OPERATION_BATCH))
+		{	// the daemon and the batch mode keep the default handling of SIGINT
+			installCancellation();
+		}
+
 		switch (operation)
 		{
 			case OPERATION_HELP:
@@ -649,56 +936,78 @@ int main(int argc, char* argv[])
 
 			case OPERATION_UNION:
 				needsArguments(inputs.size(), 2);
-				performUnion(isTopDown, inputs[0], inputs[1]);
+				performUnion(isTopDown, options, inputs[0], inputs[1]);
 				break;
 
 			case OPERATION_INTERSECTION:
 				needsArguments(inputs.size(), 2);
-				performIntersection(isTopDown, inputs[0], inputs[1]);
+				performIntersection(isTopDown, options, inputs[0], inputs[1]);
 				break;
 
 			case OPERATION_LOAD:
 				needsArguments(inputs.size(), 1);
-				performLoad(isTopDown, inputs[0]);
+				performLoad(isTopDown, options, inputs[0]);
 				break;
 
 			case OPERATION_SIMULATION:
 				needsArguments(inputs.size(), 1);
-				performComputationOfSimulation(isTopDown, inputs[0]);
+				performComputationOfSimulation(isTopDown, options, inputs[0]);
 				break;
 
 			case OPERATION_DOWN_INCLUSION:
 				needsArguments(inputs.size(), 2);
-				performCheckingDownwardInclusion(isTopDown, inputs[0], inputs[1]);
+				performCheckingDownwardInclusion(isTopDown, options, inputs[0], inputs[1]);
 				break;
 
 			case OPERATION_DOWN_INCLUSION_SIMBOTH:
 				needsArguments(inputs.size(), 2);
-				performCheckingDownwardInclusionSimBoth(isTopDown, inputs[0], inputs[1]);
+				performCheckingDownwardInclusionSimBoth(isTopDown, options, inputs[0], inputs[1]);
 				break;
 
 			case OPERATION_DOWN_INCLUSION_SIMBOTH_NOTIME:
 				needsArguments(inputs.size(), 2);
-				performCheckingDownwardInclusionSimBothNoSimTime(isTopDown, inputs[0], inputs[1]);
+				performCheckingDownwardInclusionSimBothNoSimTime(isTopDown, options, inputs[0], inputs[1]);
 				break;
 
 			case OPERATION_DOWN_INCLUSION_NOTIME:
 				needsArguments(inputs.size(), 2);
-				performCheckingDownwardInclusionWithoutTime(isTopDown, inputs[0], inputs[1]);
+				performCheckingDownwardInclusionWithoutTime(isTopDown, options, inputs[0], inputs[1]);
 				break;
 
 			case OPERATION_DOWN_INCLUSION_NOSIM:
 				needsArguments(inputs.size(), 2);
-				performCheckingDownwardInclusionWithoutSim(isTopDown, inputs[0], inputs[1]);
+				performCheckingDownwardInclusionWithoutSim(isTopDown, options, inputs[0], inputs[1]);
 				break;
 
 			case OPERATION_UP_INCLUSION:
 				needsArguments(inputs.size(), 2);
-				performCheckingUpwardInclusion(isTopDown, inputs[0], inputs[1]);
+				performCheckingUpwardInclusion(isTopDown, options, inputs[0], inputs[1]);
+				break;
+
+			case OPERATION_DAEMON:
+				performDaemon(isTopDown, options, inputs);
+				break;
+
+			case OPERATION_BATCH:
+				needsArguments(inputs.size(), 1);
+				performBatch(isTopDown, options, batchOptions, inputs[0]);
+				break;
+
+			case OPERATION_BENCHMARK:
+				needsArguments(inputs.size(), 2);
+				performBenchmark(isTopDown, options, benchOptions, inputs[0], inputs[1]);
 				break;
 
 			default: throw std::runtime_error("Invalid operation type.");break;
 		}
+
+		// write the trace here so that a failure to write it is reported
+		SFTA::Private::Tracer::GetInstance().Stop();
+	}
+	catch (SFTA::OperationInterrupted& ex)
+	{	// the result of the operation is unknown
+		std::cout << "unknown\n";
+		std::cerr << "The operation was interrupted: " << ex.what() << "\n";
 	}
 	catch (std::exception& ex)
 	{
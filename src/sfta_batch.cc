@@ -0,0 +1,694 @@
+/*****************************************************************************
+ *  Symbolic Finite Tree Automata Library
+ *
+ *  Description:
+ *    Source file with the batch mode of the sfta program.
+ *
+ *****************************************************************************/
+
+// Standard library headers
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <list>
+#include <memory>
+#include <new>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+// POSIX headers
+#include <signal.h>
+#include <sys/resource.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// Boost headers
+#include <boost/algorithm/string.hpp>
+
+// SFTA headers
+#include <sfta/cudd_facade.hh>
+#include <sfta/trace.hh>
+
+// sfta program headers
+#include "sfta_batch.hh"
+#include "sfta_daemon.hh"
+
+
+/**
+ * @brief  A job of the batch mode
+ *
+ * A single line of the manifest: an operation followed by its operands.
+ */
+struct BatchJob
+{
+	size_t id;
+	std::vector<std::string> tokens;
+
+	BatchJob()
+		: id(0),
+			tokens()
+	{ }
+};
+
+
+/**
+ * @brief  The number of input files of a job
+ *
+ * The operands of a job that are files, i.e., all of them except the
+ * inclusion checking method.
+ */
+size_t batchJobFileCount(const std::vector<std::string>& tokens)
+{
+	return (tokens[0] == "inclusion")? 2 : tokens.size() - 1;
+}
+
+
+/**
+ * @brief  Exit code of a worker that ran out of memory in CUDD
+ */
+const int WORKER_EXIT_OUT_OF_MEMORY = 3;
+
+
+/**
+ * @brief  Handler of memory exhausted in CUDD
+ *
+ * CUDD cannot be left by an exception, so a worker that runs out of memory
+ * inside CUDD exits with a distinct code and the parent reports its job as
+ * <tt>memout</tt>.
+ */
+void exitWorkerOutOfMemory(long)
+{
+	_exit(WORKER_EXIT_OUT_OF_MEMORY);
+}
+
+
+std::vector<BatchJob> loadManifest(const std::string& file)
+{
+	std::ifstream ifs(file.c_str());
+	if (ifs.fail())
+	{
+		throw std::runtime_error("Could not open file " + file);
+	}
+
+	std::vector<BatchJob> jobs;
+	std::string line;
+	for (size_t lineNo = 1; std::getline(ifs, line); ++lineNo)
+	{	// every line that is not empty or a comment is a job
+		boost::trim(line);
+		if (line.empty() || (line[0] == '#'))
+		{
+			continue;
+		}
+
+		BatchJob job;
+		job.id = jobs.size();
+		boost::algorithm::split(job.tokens, line, isspace,
+			boost::algorithm::token_compress_on);
+
+		const std::string& op = job.tokens[0];
+		size_t operands = job.tokens.size() - 1;
+		if (!(((op == "load" || op == "simulation") && (operands == 1)) ||
+			((op == "union" || op == "intersection") && (operands == 2)) ||
+			((op == "inclusion") && (operands == 2 || operands == 3))))
+		{
+			throw std::runtime_error(file + ":" + Convert::ToString(lineNo) +
+				": invalid job: " + line);
+		}
+
+		jobs.push_back(job);
+	}
+
+	return jobs;
+}
+
+
+/**
+ * @brief  Executes a job in a worker
+ *
+ * Executes the job given by @p tokens in the session of the worker. Parsed
+ * input files stay loaded in the session (named by their paths) so that
+ * later jobs with the same files do not parse them again.
+ *
+ * @returns  The reply of the session
+ */
+template <class TreeAutomaton>
+std::string executeBatchJob(DaemonSession<TreeAutomaton>& session,
+	const std::vector<std::string>& tokens)
+{
+	// the name of the result cannot clash with a path in the manifest
+	const std::string resultName = ":result";
+	std::string reply;
+
+	size_t files = batchJobFileCount(tokens);
+	for (size_t i = 1; i <= files; ++i)
+	{	// make sure input files are loaded
+		if (!session.HasAutomaton(tokens[i]))
+		{
+			session.Execute("load " + tokens[i] + " " + tokens[i], reply);
+			if (reply != "ok")
+			{
+				return reply;
+			}
+		}
+	}
+
+	if ((tokens[0] == "union") || (tokens[0] == "intersection"))
+	{	// the result is not kept
+		session.Execute(tokens[0] + " " + resultName + " " + tokens[1] + " " +
+			tokens[2], reply);
+		std::string freeReply;
+		session.Execute("free " + resultName, freeReply);
+		return reply;
+	}
+	else if (tokens[0] == "load")
+	{
+		return "ok";
+	}
+
+	std::string command = tokens[0];
+	for (size_t i = 1; i < tokens.size(); ++i)
+	{
+		command += " " + tokens[i];
+	}
+
+	session.Execute(command, reply);
+	return reply;
+}
+
+
+/**
+ * @brief  The main loop of a worker process
+ *
+ * Receives jobs as lines <tt>ID OPERATION OPERANDS...</tt> and answers each
+ * by <tt>ID STATUS SECONDS RESULT</tt>.
+ */
+template <class TreeAutomaton>
+void runBatchWorker(SFTA::AbstractTABuilder<TreeAutomaton>* builder,
+	const LoadOptions& options, SocketLineChannel& channel)
+{
+	DaemonSession<TreeAutomaton> session(builder, options, true);
+
+	std::string line;
+	while (channel.ReadLine(line))
+	{	// process jobs until the parent closes the connection
+		std::vector<std::string> tokens;
+		boost::algorithm::split(tokens, line, isspace,
+			boost::algorithm::token_compress_on);
+
+		std::string id = tokens[0];
+		tokens.erase(tokens.begin());
+
+		timespec start;
+		clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &start);
+
+		std::string status;
+		std::string result;
+		bool outOfMemory = false;
+		try
+		{
+			std::string reply = executeBatchJob(session, tokens);
+			status = reply.substr(0, reply.find(' '));
+			result = (reply.find(' ') == std::string::npos)?
+				std::string() : reply.substr(reply.find(' ') + 1);
+		}
+		catch (std::bad_alloc&)
+		{	// the state of the worker cannot be trusted anymore
+			status = "memout";
+			outOfMemory = true;
+		}
+
+		channel.WriteLine(id + " " + status + " " +
+			Convert::ToString(secondsSince(start, CLOCK_PROCESS_CPUTIME_ID)) + " " +
+			result);
+
+		if (outOfMemory)
+		{	// the parent starts a fresh worker
+			return;
+		}
+	}
+}
+
+
+/**
+ * @brief  Worker process of the batch mode
+ *
+ * A forked process with its own shared MTBDD (and CUDD manager) that keeps
+ * the automata it has parsed. The parent communicates with it over a socket.
+ */
+class BatchWorker
+{
+private:
+
+	size_t index_;
+
+	pid_t pid_;
+
+	std::auto_ptr<SocketLineChannel> channel_;
+
+	int fd_;
+
+	long job_;
+
+	timespec start_;
+
+	std::set<std::string> files_;
+
+	BatchWorker(const BatchWorker&);
+	BatchWorker& operator=(const BatchWorker&);
+
+public:
+
+	explicit BatchWorker(size_t index)
+		: index_(index),
+			pid_(-1),
+			channel_(),
+			fd_(-1),
+			job_(-1),
+			start_(),
+			files_()
+	{ }
+
+	void Start(bool isTopDown, const LoadOptions& options,
+		const BatchOptions& batchOptions, const std::vector<int>& foreignFds)
+	{
+		int fds[2];
+		if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0)
+		{
+			throw std::runtime_error("Could not create socket pair: " +
+				std::string(strerror(errno)));
+		}
+
+		// do not let the child flush our buffers
+		std::cout.flush();
+		std::cerr.flush();
+
+		pid_t pid = fork();
+		if (pid < 0)
+		{
+			close(fds[0]);
+			close(fds[1]);
+			throw std::runtime_error("Could not fork a worker: " +
+				std::string(strerror(errno)));
+		}
+
+		if (pid == 0)
+		{	// the worker
+			// spans of the worker would never be written as it leaves by _exit()
+			SFTA::Private::Tracer::GetInstance().Discard();
+
+			close(fds[0]);
+			for (std::vector<int>::const_iterator itFds = foreignFds.begin();
+				itFds != foreignFds.end(); ++itFds)
+			{	// close connections to other workers
+				close(*itFds);
+			}
+
+			int exitCode = EXIT_SUCCESS;
+			try
+			{
+				if (batchOptions.memoryLimit > 0)
+				{	// limit the address space of the worker (shared by all its jobs)
+					rlimit limit;
+					limit.rlim_cur = static_cast<rlim_t>(batchOptions.memoryLimit) * 1024 * 1024;
+					limit.rlim_max = limit.rlim_cur;
+					setrlimit(RLIMIT_AS, &limit);
+				}
+
+				SFTA::Private::CUDDFacade::SetOutOfMemoryHandler(exitWorkerOutOfMemory);
+
+				SocketLineChannel channel(fds[1]);
+				if (!isTopDown)
+				{
+					runBatchWorker<BUTreeAutomaton>(new TimbukBUTABuilder(), options,
+						channel);
+				}
+				else
+				{
+					runBatchWorker<TDTreeAutomaton>(new TimbukTDTABuilder(), options,
+						channel);
+				}
+			}
+			catch (std::exception& ex)
+			{
+				std::cerr << "Worker " << index_ << " failed: " << ex.what() << "\n";
+				exitCode = EXIT_FAILURE;
+			}
+
+			// skip destructors and buffers inherited from the parent
+			std::cerr.flush();
+			_exit(exitCode);
+		}
+
+		close(fds[1]);
+		pid_ = pid;
+		fd_ = fds[0];
+		channel_.reset(new SocketLineChannel(fds[0]));
+		job_ = -1;
+		files_.clear();
+	}
+
+	/**
+	 * @brief  Stops the worker
+	 *
+	 * Kills the worker (if it is running) and waits for it.
+	 *
+	 * @returns  The status of the worker as returned by waitpid()
+	 */
+	int Stop(bool kill)
+	{
+		int status = 0;
+		if (pid_ > 0)
+		{
+			channel_.reset();
+			if (kill)
+			{
+				::kill(pid_, SIGKILL);
+			}
+
+			while ((waitpid(pid_, &status, 0) < 0) && (errno == EINTR))
+			{ }
+		}
+
+		pid_ = -1;
+		fd_ = -1;
+		job_ = -1;
+		return status;
+	}
+
+	void Assign(const BatchJob& job)
+	{
+		std::string line = Convert::ToString(job.id);
+		for (size_t i = 0; i < job.tokens.size(); ++i)
+		{
+			line += " " + job.tokens[i];
+		}
+
+		job_ = static_cast<long>(job.id);
+		clock_gettime(CLOCK_MONOTONIC, &start_);
+		files_.insert(job.tokens.begin() + 1,
+			job.tokens.begin() + 1 + batchJobFileCount(job.tokens));
+
+		channel_->WriteLine(line);
+	}
+
+	/**
+	 * @brief  The score of a job
+	 *
+	 * The number of input files of the job the worker has already loaded.
+	 */
+	size_t Affinity(const BatchJob& job) const
+	{
+		size_t score = 0;
+		size_t files = batchJobFileCount(job.tokens);
+		for (size_t i = 1; i <= files; ++i)
+		{
+			score += files_.count(job.tokens[i]);
+		}
+
+		return score;
+	}
+
+	bool ReadReply(std::string& line)
+	{
+		return channel_->ReadLine(line);
+	}
+
+	void Finish()
+	{
+		job_ = -1;
+	}
+
+	inline bool IsBusy() const
+	{
+		return job_ >= 0;
+	}
+
+	inline long GetJob() const
+	{
+		return job_;
+	}
+
+	inline int GetFd() const
+	{
+		return fd_;
+	}
+
+	inline size_t GetIndex() const
+	{
+		return index_;
+	}
+
+	inline double GetElapsed() const
+	{
+		return secondsSince(start_, CLOCK_MONOTONIC);
+	}
+
+	~BatchWorker()
+	{	// an idle worker exits when its connection is closed
+		Stop(IsBusy());
+	}
+};
+
+
+/**
+ * @brief  Formats the result of a job as a JSON object
+ *
+ * @param[in]  cpuTime   The CPU time of the worker spent on the job, or
+ *                       a negative number if it is not known (the job did
+ *                       not finish)
+ * @param[in]  wallTime  The wall time of the job measured by the parent
+ */
+std::string formatBatchResult(const BatchJob& job, const std::string& status,
+	const std::string& result, double cpuTime, double wallTime, size_t worker)
+{
+	std::string inputs;
+	size_t files = batchJobFileCount(job.tokens);
+	for (size_t i = 1; i <= files; ++i)
+	{
+		inputs += ((i > 1)? "," : "") + toJSONString(job.tokens[i]);
+	}
+
+	std::string line = "{\"id\":" + Convert::ToString(job.id) +
+		",\"operation\":" + toJSONString(job.tokens[0]);
+	if (job.tokens.size() > files + 1)
+	{	// in case a method is given
+		line += ",\"method\":" + toJSONString(job.tokens.back());
+	}
+
+	line += ",\"inputs\":[" + inputs + "]" +
+		",\"status\":" + toJSONString(status) +
+		",\"result\":" + toJSONString(result) +
+		",\"cpu_time\":" + ((cpuTime < 0)? "null" : Convert::ToString(cpuTime)) +
+		",\"wall_time\":" + Convert::ToString(wallTime) +
+		",\"worker\":" + Convert::ToString(worker) + "}";
+
+	return line;
+}
+
+
+std::vector<int> collectWorkerFds(const std::vector<BatchWorker*>& workers)
+{
+	std::vector<int> fds;
+	for (size_t i = 0; i < workers.size(); ++i)
+	{
+		if (workers[i]->GetFd() >= 0)
+		{
+			fds.push_back(workers[i]->GetFd());
+		}
+	}
+
+	return fds;
+}
+
+
+/**
+ * @brief  Runs jobs of a manifest in parallel
+ *
+ * Schedules the jobs of the manifest to a pool of worker processes and
+ * writes a JSON object with the result of every job on a separate line of
+ * the standard output (in the order of completion). An idle worker prefers
+ * jobs whose input files it has already parsed.
+ */
+void performBatch(bool isTopDown, const LoadOptions& options,
+	const BatchOptions& batchOptions, const std::string& manifest)
+{
+	enum
+	{
+		// how many pending jobs are considered when choosing the next job
+		SchedulingWindow = 64
+	};
+
+	std::vector<BatchJob> jobs = loadManifest(manifest);
+	std::list<size_t> pending;
+	for (size_t i = 0; i < jobs.size(); ++i)
+	{
+		pending.push_back(i);
+	}
+
+	std::vector<BatchWorker*> workers;
+	try
+	{
+		for (size_t i = 0; i < std::max(batchOptions.workers, static_cast<size_t>(1)); ++i)
+		{
+			workers.push_back(new BatchWorker(i));
+			workers.back()->Start(isTopDown, options, batchOptions,
+				collectWorkerFds(workers));
+		}
+
+		size_t finished = 0;
+		while (finished < jobs.size())
+		{	// until all jobs are finished
+			for (size_t i = 0; i < workers.size(); ++i)
+			{	// give work to idle workers
+				BatchWorker& worker = *workers[i];
+				if (worker.IsBusy() || pending.empty())
+				{
+					continue;
+				}
+
+				std::list<size_t>::iterator best = pending.begin();
+				size_t bestScore = 0;
+				size_t window = 0;
+				for (std::list<size_t>::iterator itPending = pending.begin();
+					(itPending != pending.end()) && (window < SchedulingWindow);
+					++itPending, ++window)
+				{	// choose the job with the most files already loaded
+					size_t score = worker.Affinity(jobs[*itPending]);
+					if (score > bestScore)
+					{
+						best = itPending;
+						bestScore = score;
+					}
+				}
+
+				worker.Assign(jobs[*best]);
+				pending.erase(best);
+			}
+
+			fd_set readFds;
+			FD_ZERO(&readFds);
+			int maxFd = -1;
+			double wait = 1.0;
+			for (size_t i = 0; i < workers.size(); ++i)
+			{	// wait for busy workers
+				if (workers[i]->IsBusy())
+				{
+					FD_SET(workers[i]->GetFd(), &readFds);
+					maxFd = std::max(maxFd, workers[i]->GetFd());
+					if (batchOptions.timeLimit > 0)
+					{
+						wait = std::min(wait, std::max(0.0,
+							batchOptions.timeLimit - workers[i]->GetElapsed()));
+					}
+				}
+			}
+
+			timeval timeout;
+			timeout.tv_sec = static_cast<time_t>(wait);
+			timeout.tv_usec = static_cast<suseconds_t>((wait - timeout.tv_sec) * 1e6);
+			if (select(maxFd + 1, &readFds, static_cast<fd_set*>(0),
+				static_cast<fd_set*>(0), &timeout) < 0)
+			{
+				if (errno == EINTR)
+				{
+					continue;
+				}
+
+				throw std::runtime_error("select() failed: " +
+					std::string(strerror(errno)));
+			}
+
+			for (size_t i = 0; i < workers.size(); ++i)
+			{	// collect results and enforce limits
+				BatchWorker& worker = *workers[i];
+				if (!worker.IsBusy())
+				{
+					continue;
+				}
+
+				const BatchJob& job = jobs[static_cast<size_t>(worker.GetJob())];
+				if (FD_ISSET(worker.GetFd(), &readFds))
+				{	// in case the worker has replied
+					std::string line;
+					if (!worker.ReadReply(line))
+					{	// in case the worker died
+						double elapsed = worker.GetElapsed();
+						int status = worker.Stop(false);
+						if (WIFEXITED(status) &&
+							(WEXITSTATUS(status) == WORKER_EXIT_OUT_OF_MEMORY))
+						{	// in case CUDD ran out of memory
+							std::cout << formatBatchResult(job, "memout", "", -1, elapsed,
+								worker.GetIndex()) << "\n" << std::flush;
+						}
+						else
+						{
+							std::string reason = WIFSIGNALED(status)?
+								"killed by signal " + Convert::ToString(WTERMSIG(status)) :
+								"exited with status " + Convert::ToString(WEXITSTATUS(status));
+							std::cout << formatBatchResult(job, "crashed", reason, -1, elapsed,
+								worker.GetIndex()) << "\n" << std::flush;
+						}
+						++finished;
+
+						worker.Start(isTopDown, options, batchOptions,
+							collectWorkerFds(workers));
+						continue;
+					}
+
+					// the reply is "ID STATUS SECONDS RESULT"
+					std::istringstream iss(line);
+					std::string id, status;
+					double seconds = 0;
+					iss >> id >> status >> seconds;
+					std::string result;
+					std::getline(iss >> std::ws, result);
+
+					std::cout << formatBatchResult(job, status, result, seconds,
+						worker.GetElapsed(), worker.GetIndex()) << "\n" << std::flush;
+					++finished;
+
+					worker.Finish();
+					if (status == "memout")
+					{	// the worker exits after running out of memory
+						worker.Stop(false);
+						worker.Start(isTopDown, options, batchOptions,
+							collectWorkerFds(workers));
+					}
+				}
+				else if ((batchOptions.timeLimit > 0) &&
+					(worker.GetElapsed() >= batchOptions.timeLimit))
+				{	// in case the job ran out of time
+					double elapsed = worker.GetElapsed();
+					worker.Stop(true);
+					std::cout << formatBatchResult(job, "timeout", "", -1, elapsed,
+						worker.GetIndex()) << "\n" << std::flush;
+					++finished;
+
+					worker.Start(isTopDown, options, batchOptions,
+						collectWorkerFds(workers));
+				}
+			}
+		}
+	}
+	catch (...)
+	{
+		for (size_t i = 0; i < workers.size(); ++i)
+		{
+			delete workers[i];
+		}
+
+		throw;
+	}
+
+	for (size_t i = 0; i < workers.size(); ++i)
+	{
+		delete workers[i];
+	}
+}
@@ -0,0 +1,51 @@
+/*****************************************************************************
+ *  Symbolic Finite Tree Automata Library
+ *
+ *  Description:
+ *    Header file with the batch mode of the sfta program, which runs jobs
+ *    of a manifest in a pool of worker processes.
+ *
+ *****************************************************************************/
+
+#ifndef _SFTA_BATCH_HH_
+#define _SFTA_BATCH_HH_
+
+// Standard library headers
+#include <string>
+
+// sfta program headers
+#include "sfta_common.hh"
+
+
+/**
+ * @brief  Limits and parallelism of the batch mode
+ *
+ * The time limit applies to every job. The memory limit caps the address
+ * space of a whole worker process, which keeps the automata parsed for its
+ * previous jobs, so it is not a limit of a single job: whether a job runs
+ * out of memory may depend on the jobs that ran before it in its worker.
+ */
+struct BatchOptions
+{
+	size_t workers;
+	double timeLimit;         ///< seconds of wall time per job, 0 = no limit
+	size_t memoryLimit;       ///< megabytes per worker (not per job), 0 = no limit
+
+	BatchOptions()
+		: workers(1),
+			timeLimit(0),
+			memoryLimit(0)
+	{ }
+};
+
+
+/**
+ * @brief  Runs jobs of a manifest in parallel
+ *
+ * Runs the jobs listed in @p manifest in worker processes and prints the
+ * result of every job as a JSON object on a separate line.
+ */
+void performBatch(bool isTopDown, const LoadOptions& options,
+	const BatchOptions& batchOptions, const std::string& manifest);
+
+#endif
@@ -0,0 +1,244 @@
+/*****************************************************************************
+ *  Symbolic Finite Tree Automata Library
+ *
+ *  Description:
+ *    Source file with the benchmark mode of the sfta program.
+ *
+ *****************************************************************************/
+
+// Standard library headers
+#include <algorithm>
+#include <cassert>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+// POSIX headers
+#include <sys/resource.h>
+
+// sfta program headers
+#include "sfta_benchmark.hh"
+
+
+/**
+ * @brief  Measurements of a single run of the benchmark mode
+ *
+ * Thread CPU times (in seconds) of the phases of a run and sizes of the
+ * shared MTBDD.
+ */
+struct BenchmarkRun
+{
+	double parse;
+	double simulation;
+	double conversion;
+	double check;
+	bool result;
+	size_t nodesAfterParse;
+	size_t nodesAfterCheck;
+
+	BenchmarkRun()
+		: parse(0),
+			simulation(0),
+			conversion(0),
+			check(0),
+			result(false),
+			nodesAfterParse(0),
+			nodesAfterCheck(0)
+	{ }
+};
+
+
+/**
+ * @brief  Returns a percentile of samples
+ *
+ * Computes the @p p-th percentile of sorted samples, interpolating linearly
+ * between the closest ranks.
+ */
+double percentile(const std::vector<double>& sorted, double p)
+{
+	assert(!sorted.empty());
+
+	double rank = (p / 100.0) * (sorted.size() - 1);
+	size_t lower = static_cast<size_t>(rank);
+	if (lower + 1 >= sorted.size())
+	{
+		return sorted.back();
+	}
+
+	return sorted[lower] + (rank - lower) * (sorted[lower + 1] - sorted[lower]);
+}
+
+
+std::string summarizeSamples(std::vector<double> samples)
+{
+	assert(!samples.empty());
+
+	std::string raw;
+	double sum = 0;
+	for (size_t i = 0; i < samples.size(); ++i)
+	{	// samples are kept in the order of runs
+		raw += ((i > 0)? "," : "") + Convert::ToString(samples[i]);
+		sum += samples[i];
+	}
+
+	std::sort(samples.begin(), samples.end());
+
+	return "{\"min\":" + Convert::ToString(samples.front()) +
+		",\"median\":" + Convert::ToString(percentile(samples, 50)) +
+		",\"mean\":" + Convert::ToString(sum / samples.size()) +
+		",\"p10\":" + Convert::ToString(percentile(samples, 10)) +
+		",\"p90\":" + Convert::ToString(percentile(samples, 90)) +
+		",\"max\":" + Convert::ToString(samples.back()) +
+		",\"samples\":[" + raw + "]}";
+}
+
+
+BenchmarkRun runBenchmark(const LoadOptions& options,
+	const BenchmarkOptions& benchOptions, const std::string& lhsFile,
+	const std::string& rhsFile)
+{
+	std::ifstream ifsLhs(lhsFile.c_str());
+	if (ifsLhs.fail())
+	{
+		throw std::runtime_error("Could not open file " + lhsFile);
+	}
+
+	std::ifstream ifsRhs(rhsFile.c_str());
+	if (ifsRhs.fail())
+	{
+		throw std::runtime_error("Could not open file " + rhsFile);
+	}
+
+	BenchmarkRun run;
+
+	timespec start;
+	clock_gettime(CLOCK_THREAD_CPUTIME_ID, &start);
+
+	// every run builds its own shared MTBDD
+	std::auto_ptr<AbstractBUTABuilder> builder(new TimbukBUTABuilder());
+	BUTABuildingDirector director(builder.get());
+
+	registerSymbols(director, options, ifsLhs, &ifsRhs);
+
+	std::auto_ptr<BUTreeAutomaton> taLhs(director.Construct(ifsLhs));
+	std::auto_ptr<BUTreeAutomaton> taRhs(director.Construct(ifsRhs));
+
+	if (options.sift)
+	{
+		taRhs->ReorderVariables();
+	}
+
+	run.parse = secondsSince(start, CLOCK_THREAD_CPUTIME_ID);
+	run.nodesAfterParse = taRhs->GetMTBDDNodeCount();
+
+	std::auto_ptr<BUTreeAutomaton::Operation> op(taLhs->GetOperation());
+	limitOperation(*op, options);
+	if (benchOptions.method == "up")
+	{	// upward checking has no other phases
+		clock_gettime(CLOCK_THREAD_CPUTIME_ID, &start);
+		run.result = op->DoesLanguageInclusionHoldUpwards(taLhs.get(), taRhs.get());
+		run.check = secondsSince(start, CLOCK_THREAD_CPUTIME_ID);
+	}
+	else
+	{
+		BUTreeAutomaton::InclusionSimulationType simulation;
+		if (benchOptions.method == "down")
+		{
+			simulation = BUTreeAutomaton::INCLUSION_SIM_SEPARATE;
+		}
+		else if (benchOptions.method == "down-simboth")
+		{
+			simulation = BUTreeAutomaton::INCLUSION_SIM_BOTH;
+		}
+		else if (benchOptions.method == "down-nosim")
+		{
+			simulation = BUTreeAutomaton::INCLUSION_SIM_NONE;
+		}
+		else
+		{
+			throw std::runtime_error("Invalid inclusion method: " +
+				benchOptions.method);
+		}
+
+		BUTreeAutomaton::InclusionProfile profile;
+		run.result = op->DoesLanguageInclusionHoldDownwardsProfiled(taLhs.get(),
+			taRhs.get(), simulation, &profile);
+
+		run.simulation = profile.simulation;
+		run.conversion = profile.conversion;
+		run.check = profile.check;
+	}
+
+	run.nodesAfterCheck = taRhs->GetMTBDDNodeCount();
+
+	return run;
+}
+
+
+/**
+ * @brief  Benchmarks inclusion checking
+ *
+ * Runs the inclusion check of the automata from @p lhsFile and @p rhsFile
+ * repeatedly (each time from scratch, after a number of warm-up runs that
+ * are not measured) and prints a JSON object with statistics of the thread
+ * CPU time of the individual phases, the peak resident set size, and the
+ * sizes of the shared MTBDD.
+ */
+void performBenchmark(bool isTopDown, const LoadOptions& options,
+	const BenchmarkOptions& benchOptions, const std::string& lhsFile,
+	const std::string& rhsFile)
+{
+	if (isTopDown)
+	{
+		throw std::runtime_error("Benchmarking is not supported for top-down automata.");
+	}
+
+	if (benchOptions.repetitions == 0)
+	{
+		throw std::runtime_error("The number of repetitions needs to be positive.");
+	}
+
+	for (size_t i = 0; i < benchOptions.warmup; ++i)
+	{	// warm up caches and the allocator
+		runBenchmark(options, benchOptions, lhsFile, rhsFile);
+	}
+
+	std::vector<double> parse, simulation, conversion, check, total;
+	BenchmarkRun run;
+	for (size_t i = 0; i < benchOptions.repetitions; ++i)
+	{	// measured runs
+		BenchmarkRun current = runBenchmark(options, benchOptions, lhsFile, rhsFile);
+		if ((i > 0) && (current.result != run.result))
+		{
+			throw std::runtime_error("Runs of the benchmark gave different results.");
+		}
+
+		run = current;
+		parse.push_back(run.parse);
+		simulation.push_back(run.simulation);
+		conversion.push_back(run.conversion);
+		check.push_back(run.check);
+		total.push_back(run.parse + run.simulation + run.conversion + run.check);
+	}
+
+	// the maximum over the life of the process, not of a single run
+	rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+
+	std::cout << "{\"lhs\":" << toJSONString(lhsFile)
+		<< ",\"rhs\":" << toJSONString(rhsFile)
+		<< ",\"method\":" << toJSONString(benchOptions.method)
+		<< ",\"result\":" << (run.result? "1" : "0")
+		<< ",\"warmup\":" << benchOptions.warmup
+		<< ",\"repetitions\":" << benchOptions.repetitions
+		<< ",\"phases\":{\"parse\":" << summarizeSamples(parse)
+		<< ",\"simulation\":" << summarizeSamples(simulation)
+		<< ",\"conversion\":" << summarizeSamples(conversion)
+		<< ",\"check\":" << summarizeSamples(check)
+		<< ",\"total\":" << summarizeSamples(total) << "}"
+		<< ",\"process_peak_rss_kb\":" << usage.ru_maxrss
+		<< ",\"mtbdd_nodes\":{\"after_parse\":" << run.nodesAfterParse
+		<< ",\"after_check\":" << run.nodesAfterCheck << "}}\n";
+}
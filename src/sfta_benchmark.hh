@@ -0,0 +1,48 @@
+/*****************************************************************************
+ *  Symbolic Finite Tree Automata Library
+ *
+ *  Description:
+ *    Header file with the benchmark mode of the sfta program, which
+ *    measures phases of repeated checks of language inclusion.
+ *
+ *****************************************************************************/
+
+#ifndef _SFTA_BENCHMARK_HH_
+#define _SFTA_BENCHMARK_HH_
+
+// Standard library headers
+#include <string>
+
+// sfta program headers
+#include "sfta_common.hh"
+
+
+/**
+ * @brief  Options of the benchmark mode
+ */
+struct BenchmarkOptions
+{
+	std::string method;
+	size_t warmup;
+	size_t repetitions;
+
+	BenchmarkOptions()
+		: method("down"),
+			warmup(1),
+			repetitions(10)
+	{ }
+};
+
+
+/**
+ * @brief  Benchmarks inclusion checking
+ *
+ * Repeatedly checks inclusion of the languages of the automata from
+ * @p lhsFile and @p rhsFile and prints statistics of the runs as a JSON
+ * object.
+ */
+void performBenchmark(bool isTopDown, const LoadOptions& options,
+	const BenchmarkOptions& benchOptions, const std::string& lhsFile,
+	const std::string& rhsFile);
+
+#endif
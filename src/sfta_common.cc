@@ -0,0 +1,71 @@
+/*****************************************************************************
+ *  Symbolic Finite Tree Automata Library
+ *
+ *  Description:
+ *    Source file with helpers shared by the drivers of the sfta program.
+ *
+ *****************************************************************************/
+
+// Standard library headers
+#include <cstdio>
+
+// sfta program headers
+#include "sfta_common.hh"
+
+
+void collectStatistics(SymbolStatistics& stats, std::istream& is)
+{
+	TimbukStatisticsBuilder builder;
+	builder.Build(is, &stats);
+
+	// rewind the stream so that the automaton can be built from it
+	is.clear();
+	is.seekg(0);
+}
+
+
+SFTA::OperationContext& operationContext()
+{
+	static SFTA::OperationContext context;
+	return context;
+}
+
+
+std::string toJSONString(const std::string& str)
+{
+	std::string result = "\"";
+	for (std::string::const_iterator itStr = str.begin(); itStr != str.end();
+		++itStr)
+	{	// escape special characters
+		switch (*itStr)
+		{
+			case '"': result += "\\\""; break;
+			case '\\': result += "\\\\"; break;
+			case '\n': result += "\\n"; break;
+			case '\t': result += "\\t"; break;
+			case '\r': result += "\\r"; break;
+			default:
+				if (static_cast<unsigned char>(*itStr) < 0x20)
+				{	// other control characters
+					char buf[8];
+					std::sprintf(buf, "\\u%04x", static_cast<unsigned>(*itStr));
+					result += buf;
+				}
+				else
+				{
+					result += *itStr;
+				}
+				break;
+		}
+	}
+
+	return result + "\"";
+}
+
+
+double secondsSince(const timespec& start, clockid_t clock)
+{
+	timespec now;
+	clock_gettime(clock, &now);
+	return (now.tv_sec - start.tv_sec) + 1e-9 * (now.tv_nsec - start.tv_nsec);
+}
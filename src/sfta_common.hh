@@ -0,0 +1,155 @@
+/*****************************************************************************
+ *  Symbolic Finite Tree Automata Library
+ *
+ *  Description:
+ *    Header file with declarations shared by the drivers of the sfta
+ *    program: the types of automata and their builders, options of loading
+ *    of automata and helpers for loading automata and limiting operations.
+ *
+ *****************************************************************************/
+
+#ifndef _SFTA_COMMON_HH_
+#define _SFTA_COMMON_HH_
+
+// Standard library headers
+#include <istream>
+#include <string>
+
+// POSIX headers
+#include <time.h>
+
+// SFTA headers
+#include <sfta/bu_tree_automaton_cover.hh>
+#include <sfta/convert.hh>
+#include <sfta/operation_context.hh>
+#include <sfta/symbol_statistics.hh>
+#include <sfta/ta_building_director.hh>
+#include <sfta/td_tree_automaton_cover.hh>
+#include <sfta/timbuk_bu_ta_builder.hh>
+#include <sfta/timbuk_td_ta_builder.hh>
+
+
+typedef SFTA::BUTreeAutomatonCover BUTreeAutomaton;
+typedef SFTA::TDTreeAutomatonCover TDTreeAutomaton;
+
+typedef SFTA::TABuildingDirector<BUTreeAutomaton> BUTABuildingDirector;
+typedef SFTA::TABuildingDirector<TDTreeAutomaton> TDTABuildingDirector;
+
+typedef SFTA::AbstractTABuilder<BUTreeAutomaton> AbstractBUTABuilder;
+typedef SFTA::AbstractTABuilder<TDTreeAutomaton> AbstractTDTABuilder;
+
+typedef SFTA::TimbukBUTABuilder<BUTreeAutomaton> TimbukBUTABuilder;
+typedef SFTA::TimbukTDTABuilder<TDTreeAutomaton> TimbukTDTABuilder;
+
+typedef SFTA::SymbolStatistics SymbolStatistics;
+typedef SFTA::TimbukBUTABuilder<SymbolStatistics> TimbukStatisticsBuilder;
+
+typedef SFTA::Private::Convert Convert;
+
+
+/**
+ * @brief  Options of loading of automata
+ *
+ * Options that determine how automata are loaded into the shared MTBDD and
+ * how operations on them are limited.
+ */
+struct LoadOptions
+{
+	SymbolStatistics::EncodingStrategy encoding;
+	bool sift;
+	bool stats;
+	double timeout;           ///< seconds of wall time per operation, 0 = no limit
+	size_t memoryBudget;      ///< megabytes of resident memory, 0 = no limit
+
+	LoadOptions()
+		: encoding(SymbolStatistics::ENCODING_FIRST_SEEN),
+			sift(false),
+			stats(false),
+			timeout(0),
+			memoryBudget(0)
+	{ }
+};
+
+
+void collectStatistics(SymbolStatistics& stats, std::istream& is);
+
+
+template <class Director>
+void registerSymbols(Director& director, const LoadOptions& options,
+	std::istream& first, std::istream* second = static_cast<std::istream*>(0))
+{
+	if (options.encoding == SymbolStatistics::ENCODING_FIRST_SEEN)
+	{	// in case symbols are encoded in the order of appearance
+		return;
+	}
+
+	SymbolStatistics stats;
+	collectStatistics(stats, first);
+	if (second != static_cast<std::istream*>(0))
+	{
+		collectStatistics(stats, *second);
+	}
+
+	director.RegisterSymbols(stats.GetSymbolOrder(options.encoding),
+		SymbolStatistics::UsesGrayCoding(options.encoding));
+}
+
+
+template <class TreeAutomaton>
+void reportNodeCount(TreeAutomaton& ta, const LoadOptions& options)
+{
+	SFTA_LOGGER_INFO("MTBDD nodes after loading: " +
+		Convert::ToString(ta.GetMTBDDNodeCount()) + " (symbols of " +
+		Convert::ToString(ta.GetSymbolDictionary()->GetSymbolWidth()) +
+		" variables)");
+
+	if (options.sift)
+	{	// in case variables should be reordered
+		ta.ReorderVariables();
+
+		SFTA_LOGGER_INFO("MTBDD nodes after sifting: " +
+			Convert::ToString(ta.GetMTBDDNodeCount()));
+	}
+}
+
+
+/**
+ * @brief  Returns the context of operations
+ *
+ * Returns the context that carries the limits of operations of the program.
+ */
+SFTA::OperationContext& operationContext();
+
+
+/**
+ * @brief  Limits an operation
+ *
+ * Makes @p op check the limits given in @p options (and cancellation by
+ * SIGINT). The deadline starts now.
+ */
+template <class Operation>
+void limitOperation(Operation& op, const LoadOptions& options)
+{
+	SFTA::OperationContext& context = operationContext();
+	context.SetTimeout(options.timeout);
+	context.SetMemoryBudget(options.memoryBudget * 1024 * 1024);
+
+	op.SetContext(&context);
+}
+
+/**
+ * @brief  Escapes a string for JSON
+ *
+ * Returns @p str as a JSON string literal (including the quotes).
+ */
+std::string toJSONString(const std::string& str);
+
+
+/**
+ * @brief  Seconds elapsed on a clock
+ *
+ * Returns the number of seconds elapsed on @p clock since @p start.
+ */
+double secondsSince(const timespec& start, clockid_t clock);
+
+#endif
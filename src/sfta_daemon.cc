@@ -0,0 +1,201 @@
+/*****************************************************************************
+ *  Symbolic Finite Tree Automata Library
+ *
+ *  Description:
+ *    Source file with the daemon mode of the sfta program.
+ *
+ *****************************************************************************/
+
+// Standard library headers
+#include <iostream>
+
+// POSIX headers
+#include <sys/stat.h>
+#include <sys/un.h>
+
+// sfta program headers
+#include "sfta_daemon.hh"
+
+
+bool checkInclusion(const BUTreeAutomaton::Operation& op,
+	const BUTreeAutomaton* lhs, const BUTreeAutomaton* rhs,
+	const std::string& method)
+{
+	timespec start;
+
+	if (method == "down")
+	{
+		return op.DoesLanguageInclusionHoldDownwards(lhs, rhs);
+	}
+	else if (method == "down-simboth")
+	{
+		return op.DoesLanguageInclusionHoldDownwardsSimBoth(lhs, rhs);
+	}
+	else if (method == "down-nosim")
+	{
+		return op.DoesLanguageInclusionHoldDownwardsWithoutSim(lhs, rhs, &start);
+	}
+	else if (method == "up")
+	{
+		return op.DoesLanguageInclusionHoldUpwards(lhs, rhs);
+	}
+
+	throw std::runtime_error("Invalid inclusion method: " + method);
+}
+
+
+bool checkInclusion(const TDTreeAutomaton::Operation&,
+	const TDTreeAutomaton*, const TDTreeAutomaton*, const std::string&)
+{
+	throw std::runtime_error("Inclusion is not supported for top-down automata.");
+}
+
+
+std::string computeSimulation(const BUTreeAutomaton::Operation& op,
+	const BUTreeAutomaton* aut)
+{
+	return Convert::ToString(op.ComputeSimulationPreorder(aut));
+}
+
+
+std::string computeSimulation(const TDTreeAutomaton::Operation&,
+	const TDTreeAutomaton*)
+{
+	throw std::runtime_error("Simulation is not supported for top-down automata.");
+}
+
+
+template <class TreeAutomaton>
+typename DaemonSession<TreeAutomaton>::CommandResult serveChannel(
+	DaemonSession<TreeAutomaton>& session, LineChannel& channel)
+{
+	typedef DaemonSession<TreeAutomaton> SessionType;
+
+	std::string line;
+	while (channel.ReadLine(line))
+	{	// process commands until the end of the input
+		std::string reply;
+		typename SessionType::CommandResult res = session.Execute(line, reply);
+		if (res != SessionType::COMMAND_CONTINUE)
+		{
+			channel.WriteLine("ok");
+			return res;
+		}
+
+		if (!reply.empty())
+		{
+			channel.WriteLine(reply);
+		}
+	}
+
+	return SessionType::COMMAND_QUIT;
+}
+
+
+template <class TreeAutomaton>
+void serveSocket(DaemonSession<TreeAutomaton>& session, const std::string& path)
+{
+	typedef DaemonSession<TreeAutomaton> SessionType;
+
+	sockaddr_un addr;
+	std::memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	if (path.size() >= sizeof(addr.sun_path))
+	{
+		throw std::runtime_error("Socket path too long: " + path);
+	}
+
+	std::strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+
+	struct stat st;
+	if ((stat(path.c_str(), &st) == 0) && S_ISSOCK(st.st_mode))
+	{	// remove a stale socket, but never any other file
+		unlink(path.c_str());
+	}
+
+	int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (fd < 0)
+	{
+		throw std::runtime_error("Could not create socket: " +
+			std::string(strerror(errno)));
+	}
+
+	if ((bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) ||
+		(listen(fd, 16) != 0))
+	{
+		std::string msg = strerror(errno);
+		close(fd);
+		throw std::runtime_error("Could not listen on " + path + ": " + msg);
+	}
+
+	SFTA_LOGGER_INFO("Listening on " + path);
+
+	typename SessionType::CommandResult res = SessionType::COMMAND_CONTINUE;
+	while (res != SessionType::COMMAND_SHUTDOWN)
+	{	// serve clients one after another
+		int clientFd = accept(fd, static_cast<sockaddr*>(0),
+			static_cast<socklen_t*>(0));
+		if (clientFd < 0)
+		{
+			if (errno == EINTR)
+			{
+				continue;
+			}
+
+			std::string msg = strerror(errno);
+			close(fd);
+			unlink(path.c_str());
+			throw std::runtime_error("Could not accept a connection: " + msg);
+		}
+
+		SocketLineChannel channel(clientFd);
+		try
+		{
+			res = serveChannel(session, channel);
+		}
+		catch (std::exception& ex)
+		{	// a broken connection does not stop the daemon
+			SFTA_LOGGER_WARN(std::string("Connection closed: ") + ex.what());
+		}
+	}
+
+	close(fd);
+	unlink(path.c_str());
+}
+
+
+template <class TreeAutomaton>
+void runDaemon(SFTA::AbstractTABuilder<TreeAutomaton>* builder,
+	const LoadOptions& options, const std::vector<std::string>& inputs)
+{
+	DaemonSession<TreeAutomaton> session(builder, options);
+
+	if (inputs.empty())
+	{	// in case commands are read from the standard input
+		StreamLineChannel channel(std::cin, std::cout);
+		serveChannel(session, channel);
+	}
+	else
+	{
+		serveSocket(session, inputs[0]);
+	}
+}
+
+
+void performDaemon(bool isTopDown, const LoadOptions& options,
+	const std::vector<std::string>& inputs)
+{
+	if (inputs.size() > 1)
+	{
+		throw std::runtime_error("The daemon mode takes at most 1 argument.");
+	}
+
+	if (!isTopDown)
+	{
+		runDaemon<BUTreeAutomaton>(new TimbukBUTABuilder(), options, inputs);
+	}
+	else
+	{
+		runDaemon<TDTreeAutomaton>(new TimbukTDTABuilder(), options, inputs);
+	}
+}
@@ -0,0 +1,465 @@
+/*****************************************************************************
+ *  Symbolic Finite Tree Automata Library
+ *
+ *  Description:
+ *    Header file with the session of the daemon mode of the sfta program,
+ *    which keeps automata resident and executes commands on them, and with
+ *    line-oriented channels the commands are received over.
+ *
+ *****************************************************************************/
+
+#ifndef _SFTA_DAEMON_HH_
+#define _SFTA_DAEMON_HH_
+
+// Standard library headers
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <istream>
+#include <map>
+#include <memory>
+#include <new>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// POSIX headers
+#include <sys/socket.h>
+#include <unistd.h>
+
+// Boost headers
+#include <boost/algorithm/string.hpp>
+
+// sfta program headers
+#include "sfta_common.hh"
+
+
+/**
+ * @brief  Line-oriented channel
+ *
+ * Abstract channel over which the daemon mode receives commands and sends
+ * replies, one per line.
+ */
+class LineChannel
+{
+public:
+
+	virtual bool ReadLine(std::string& line) = 0;
+
+	virtual void WriteLine(const std::string& line) = 0;
+
+	virtual ~LineChannel()
+	{ }
+};
+
+
+/**
+ * @brief  Channel over a pair of streams
+ */
+class StreamLineChannel
+	: public LineChannel
+{
+private:
+
+	std::istream& is_;
+	std::ostream& os_;
+
+	StreamLineChannel(const StreamLineChannel&);
+	StreamLineChannel& operator=(const StreamLineChannel&);
+
+public:
+
+	StreamLineChannel(std::istream& is, std::ostream& os)
+		: is_(is),
+			os_(os)
+	{ }
+
+	virtual bool ReadLine(std::string& line)
+	{
+		return !std::getline(is_, line).fail();
+	}
+
+	virtual void WriteLine(const std::string& line)
+	{
+		os_ << line << "\n" << std::flush;
+	}
+};
+
+
+/**
+ * @brief  Channel over a connected socket
+ */
+class SocketLineChannel
+	: public LineChannel
+{
+private:
+
+	int fd_;
+
+	std::string buffer_;
+
+	SocketLineChannel(const SocketLineChannel&);
+	SocketLineChannel& operator=(const SocketLineChannel&);
+
+public:
+
+	explicit SocketLineChannel(int fd)
+		: fd_(fd),
+			buffer_()
+	{ }
+
+	virtual bool ReadLine(std::string& line)
+	{
+		size_t pos;
+		while ((pos = buffer_.find('\n')) == std::string::npos)
+		{	// until there is a whole line in the buffer
+			char chunk[4096];
+			ssize_t received = recv(fd_, chunk, sizeof(chunk), 0);
+			if ((received < 0) && (errno == EINTR))
+			{	// in case the call was interrupted
+				continue;
+			}
+
+			if (received <= 0)
+			{	// in case the peer closed the connection (or an error occurred)
+				if (buffer_.empty())
+				{
+					return false;
+				}
+
+				line.swap(buffer_);
+				buffer_.clear();
+				return true;
+			}
+
+			buffer_.append(chunk, static_cast<size_t>(received));
+		}
+
+		line = buffer_.substr(0, pos);
+		buffer_.erase(0, pos + 1);
+
+		return true;
+	}
+
+	virtual void WriteLine(const std::string& line)
+	{
+		std::string data = line + "\n";
+		size_t sent = 0;
+		while (sent < data.size())
+		{	// until all data is sent
+			ssize_t res = send(fd_, data.data() + sent, data.size() - sent,
+				MSG_NOSIGNAL);
+			if ((res < 0) && (errno == EINTR))
+			{	// in case the call was interrupted
+				continue;
+			}
+
+			if (res <= 0)
+			{	// in case the peer is gone
+				throw std::runtime_error("Could not send a reply: " +
+					std::string(strerror(errno)));
+			}
+
+			sent += static_cast<size_t>(res);
+		}
+	}
+
+	~SocketLineChannel()
+	{
+		close(fd_);
+	}
+};
+
+
+/**
+ * @brief  Checks language inclusion
+ *
+ * Checks whether the language of @p lhs is a subset of the language of
+ * @p rhs using @p method (down, down-simboth, down-nosim or up). Inclusion
+ * is not supported for top-down automata.
+ */
+bool checkInclusion(const BUTreeAutomaton::Operation& op,
+	const BUTreeAutomaton* lhs, const BUTreeAutomaton* rhs,
+	const std::string& method);
+
+
+bool checkInclusion(const TDTreeAutomaton::Operation& op,
+	const TDTreeAutomaton* lhs, const TDTreeAutomaton* rhs,
+	const std::string& method);
+
+
+/**
+ * @brief  Computes the simulation preorder
+ *
+ * Returns the maximum simulation preorder of @p aut as a string. Simulation
+ * is not supported for top-down automata.
+ */
+std::string computeSimulation(const BUTreeAutomaton::Operation& op,
+	const BUTreeAutomaton* aut);
+
+
+std::string computeSimulation(const TDTreeAutomaton::Operation& op,
+	const TDTreeAutomaton* aut);
+
+
+/**
+ * @brief  Session of the daemon mode
+ *
+ * Keeps named automata resident in a single shared transition table wrapper
+ * and executes commands on them. Commands and their replies are:
+ *
+ *   @li  <tt>load NAME FILE</tt>  -> <tt>ok</tt>
+ *   @li  <tt>union NAME LHS RHS</tt>  -> <tt>ok</tt>
+ *   @li  <tt>intersection NAME LHS RHS</tt>  -> <tt>ok</tt>
+ *   @li  <tt>inclusion LHS RHS [down|down-simboth|down-nosim|up]</tt>
+ *        -> <tt>ok 1</tt> or <tt>ok 0</tt>
+ *   @li  <tt>simulation NAME</tt>  -> <tt>ok RELATION</tt>
+ *   @li  <tt>free NAME</tt>  -> <tt>ok</tt>
+ *   @li  <tt>list</tt>  -> <tt>ok NAME...</tt>
+ *   @li  <tt>quit</tt>  -> <tt>ok</tt> and closes the connection
+ *   @li  <tt>shutdown</tt>  -> <tt>ok</tt> and stops the daemon
+ *
+ * A failed command is answered by <tt>error MESSAGE</tt>, also when it runs
+ * out of memory (unless the session propagates std::bad_alloc, as workers of
+ * the batch mode do).
+ */
+template <class TreeAutomaton>
+class DaemonSession
+{
+public:
+
+	enum CommandResult
+	{
+		COMMAND_CONTINUE,
+		COMMAND_QUIT,
+		COMMAND_SHUTDOWN
+	};
+
+private:
+
+	typedef TreeAutomaton TreeAutomatonType;
+	typedef SFTA::AbstractTABuilder<TreeAutomatonType> AbstractBuilderType;
+	typedef SFTA::TABuildingDirector<TreeAutomatonType> DirectorType;
+	typedef typename TreeAutomatonType::Operation OperationType;
+
+	typedef std::map<std::string, TreeAutomatonType*> AutomatonMap;
+	typedef std::vector<std::string> StringVector;
+
+	std::auto_ptr<AbstractBuilderType> builder_;
+
+	DirectorType director_;
+
+	LoadOptions options_;
+
+	AutomatonMap automata_;
+
+	/// Whether running out of memory is left to the caller
+	bool propagateOutOfMemory_;
+
+	DaemonSession(const DaemonSession&);
+	DaemonSession& operator=(const DaemonSession&);
+
+	TreeAutomatonType* getAutomaton(const std::string& name) const
+	{
+		typename AutomatonMap::const_iterator itAut = automata_.find(name);
+		if (itAut == automata_.end())
+		{
+			throw std::runtime_error("Unknown automaton " + name);
+		}
+
+		return itAut->second;
+	}
+
+	void storeAutomaton(const std::string& name, std::auto_ptr<TreeAutomatonType> aut)
+	{
+		typename AutomatonMap::iterator itAut = automata_.find(name);
+		if (itAut != automata_.end())
+		{	// in case the name is taken, the old automaton is replaced
+			delete itAut->second;
+			itAut->second = aut.release();
+		}
+		else
+		{
+			automata_.insert(std::make_pair(name, aut.get()));
+			aut.release();
+		}
+	}
+
+	static void needsOperands(const StringVector& cmd, size_t minCount,
+		size_t maxCount)
+	{
+		if ((cmd.size() < minCount + 1) || (cmd.size() > maxCount + 1))
+		{
+			throw std::runtime_error("Wrong number of operands of " + cmd[0]);
+		}
+	}
+
+	std::string load(const std::string& name, const std::string& file)
+	{
+		std::ifstream ifs(file.c_str());
+		if (ifs.fail())
+		{
+			throw std::runtime_error("Could not open file " + file);
+		}
+
+		registerSymbols(director_, options_, ifs);
+
+		std::auto_ptr<TreeAutomatonType> aut(director_.Construct(ifs));
+		reportNodeCount(*aut, options_);
+
+		storeAutomaton(name, aut);
+
+		return "ok";
+	}
+
+public:
+
+	DaemonSession(AbstractBuilderType* builder, const LoadOptions& options,
+		bool propagateOutOfMemory = false)
+		: builder_(builder),
+			director_(builder),
+			options_(options),
+			automata_(),
+			propagateOutOfMemory_(propagateOutOfMemory)
+	{ }
+
+	CommandResult Execute(const std::string& line, std::string& reply)
+	{
+		std::string str = boost::trim_copy(line);
+
+		StringVector cmd;
+		boost::algorithm::split(cmd, str, isspace,
+			boost::algorithm::token_compress_on);
+
+		reply = "ok";
+		if (cmd.empty() || cmd[0].empty() || (cmd[0][0] == '#'))
+		{	// in case of an empty line or a comment
+			reply.clear();
+			return COMMAND_CONTINUE;
+		}
+
+		try
+		{
+			// a cancellation or an interruption of a previous command is cleared
+			operationContext().Reset();
+
+			if (cmd[0] == "load")
+			{
+				needsOperands(cmd, 2, 2);
+				reply = load(cmd[1], cmd[2]);
+			}
+			else if ((cmd[0] == "union") || (cmd[0] == "intersection"))
+			{
+				needsOperands(cmd, 3, 3);
+				TreeAutomatonType* lhs = getAutomaton(cmd[2]);
+				TreeAutomatonType* rhs = getAutomaton(cmd[3]);
+
+				std::auto_ptr<OperationType> op(lhs->GetOperation());
+				limitOperation(*op, options_);
+				std::auto_ptr<TreeAutomatonType> result((cmd[0] == "union")?
+					op->Union(lhs, rhs) : op->Intersection(lhs, rhs));
+
+				storeAutomaton(cmd[1], result);
+			}
+			else if (cmd[0] == "inclusion")
+			{
+				needsOperands(cmd, 2, 3);
+				const TreeAutomatonType* lhs = getAutomaton(cmd[1]);
+				const TreeAutomatonType* rhs = getAutomaton(cmd[2]);
+
+				std::auto_ptr<OperationType> op(lhs->GetOperation());
+				limitOperation(*op, options_);
+				bool result = checkInclusion(*op, lhs, rhs,
+					(cmd.size() > 3)? cmd[3] : "down");
+
+				reply = (result? "ok 1" : "ok 0");
+			}
+			else if (cmd[0] == "simulation")
+			{
+				needsOperands(cmd, 1, 1);
+				const TreeAutomatonType* aut = getAutomaton(cmd[1]);
+
+				std::auto_ptr<OperationType> op(aut->GetOperation());
+				limitOperation(*op, options_);
+				reply = "ok " + computeSimulation(*op, aut);
+			}
+			else if (cmd[0] == "free")
+			{
+				needsOperands(cmd, 1, 1);
+				delete getAutomaton(cmd[1]);
+				automata_.erase(cmd[1]);
+			}
+			else if (cmd[0] == "list")
+			{
+				needsOperands(cmd, 0, 0);
+				for (typename AutomatonMap::const_iterator itAut = automata_.begin();
+					itAut != automata_.end(); ++itAut)
+				{
+					reply += " " + itAut->first;
+				}
+			}
+			else if (cmd[0] == "quit")
+			{
+				return COMMAND_QUIT;
+			}
+			else if (cmd[0] == "shutdown")
+			{
+				return COMMAND_SHUTDOWN;
+			}
+			else
+			{
+				throw std::runtime_error("Unknown command " + cmd[0]);
+			}
+		}
+		catch (std::bad_alloc&)
+		{
+			if (propagateOutOfMemory_)
+			{	// running out of memory is left to the caller
+				throw;
+			}
+
+			reply = "error out of memory";
+		}
+		catch (SFTA::OperationInterrupted& ex)
+		{	// the result of the command is unknown
+			reply = std::string("unknown ") + ex.what();
+		}
+		catch (std::exception& ex)
+		{	// errors are reported to the client and the session goes on
+			std::string msg = ex.what();
+			std::replace(msg.begin(), msg.end(), '\n', ' ');
+			reply = "error " + msg;
+		}
+
+		return COMMAND_CONTINUE;
+	}
+
+	inline bool HasAutomaton(const std::string& name) const
+	{
+		return automata_.find(name) != automata_.end();
+	}
+
+	~DaemonSession()
+	{
+		for (typename AutomatonMap::iterator itAut = automata_.begin();
+			itAut != automata_.end(); ++itAut)
+		{	// delete all resident automata
+			delete itAut->second;
+		}
+	}
+};
+
+
+/**
+ * @brief  Runs the daemon mode
+ *
+ * Executes commands read from the standard input, or from clients of the
+ * UNIX socket given as the only element of @p inputs, until the end of the
+ * input or the shutdown command.
+ */
+void performDaemon(bool isTopDown, const LoadOptions& options,
+	const std::vector<std::string>& inputs);
+
+#endif
@@ -0,0 +1,147 @@
+/*****************************************************************************
+ *  Symbolic Finite Tree Automata Library
+ *
+ *  Description:
+ *    Source file for sfta-generate program, which generates random tree
+ *    automata in the Timbuk format.
+ *
+ *****************************************************************************/
+
+
+// Standard library headers
+#include <cstdlib>
+#include <getopt.h>
+#include <fstream>
+#include <iostream>
+
+// Boost headers
+#include <boost/algorithm/string.hpp>
+
+// SFTA headers
+#include <sfta/convert.hh>
+#include <sfta/random_ta_generator.hh>
+
+
+typedef SFTA::RandomTAGenerator RandomTAGenerator;
+
+typedef SFTA::Private::Convert Convert;
+
+
+void printHelp(const std::string& programName)
+{
+	std::cout << "usage: " << programName << " -n <states> [options]\n";
+	std::cout << "\n";
+	std::cout << "Generates a random bottom-up tree automaton according to the\n";
+	std::cout << "Tabakov-Vardi model and writes it in the Timbuk format.\n";
+	std::cout << "\n";
+	std::cout << "    -n, --states=<n>       the number of states.\n";
+	std::cout << "    -a, --arities=<list>   comma-separated arities of symbols of the\n";
+	std::cout << "                           alphabet (default 0,2).\n";
+	std::cout << "    -r, --transition-density=<r>\n";
+	std::cout << "                           the number of transitions per state and\n";
+	std::cout << "                           symbol (default 2.0).\n";
+	std::cout << "    -f, --final-density=<f>\n";
+	std::cout << "                           the ratio of final states (default 0.5).\n";
+	std::cout << "    -b, --symbol-bits=<n>  generate symbolic symbols over {0,1,X} of\n";
+	std::cout << "                           length <n> (default 0, i.e., plain names).\n";
+	std::cout << "    -x, --dont-care-density=<x>\n";
+	std::cout << "                           the ratio of X in symbolic symbols\n";
+	std::cout << "                           (default 0.3).\n";
+	std::cout << "    -s, --seed=<n>         the seed of the generator (default 0).\n";
+	std::cout << "    -o, --output=<file>    the output file (default the standard output).\n";
+	std::cout << "    -h, --help             print this help.\n";
+}
+
+
+std::vector<size_t> parseArities(const std::string& str)
+{
+	std::vector<std::string> spl;
+	boost::algorithm::split(spl, str, boost::algorithm::is_any_of(","));
+
+	std::vector<size_t> result;
+	for (size_t i = 0; i < spl.size(); ++i)
+	{
+		result.push_back(Convert::FromString<size_t>(boost::trim_copy(spl[i])));
+	}
+
+	return result;
+}
+
+
+int main(int argc, char* argv[])
+{
+	// Assertions
+	assert(argc >= 1);
+
+	try
+	{
+		const char* getoptString = "n:a:r:f:b:x:s:o:h";
+		option longOptions[] = {
+			{"states",                     1, static_cast<int*>(0), 'n'},
+			{"arities",                    1, static_cast<int*>(0), 'a'},
+			{"transition-density",         1, static_cast<int*>(0), 'r'},
+			{"final-density",              1, static_cast<int*>(0), 'f'},
+			{"symbol-bits",                1, static_cast<int*>(0), 'b'},
+			{"dont-care-density",          1, static_cast<int*>(0), 'x'},
+			{"seed",                       1, static_cast<int*>(0), 's'},
+			{"output",                     1, static_cast<int*>(0), 'o'},
+			{"help",                       0, static_cast<int*>(0), 'h'},
+
+			{static_cast<const char*>(0),  0, static_cast<int*>(0), 0}
+		};
+
+		RandomTAGenerator::Parameters params;
+		params.states = 0;
+		std::string output;
+
+		int opt, optIndex;
+		while ((opt = getopt_long(argc, argv,
+			getoptString, longOptions, &optIndex)) != -1)
+		{
+			switch (opt)
+			{
+				case 'n': params.states = Convert::FromString<size_t>(optarg); break;
+				case 'a': params.arities = parseArities(optarg); break;
+				case 'r': params.transitionDensity = Convert::FromString<double>(optarg); break;
+				case 'f': params.finalDensity = Convert::FromString<double>(optarg); break;
+				case 'b': params.symbolBits = Convert::FromString<size_t>(optarg); break;
+				case 'x': params.dontCareDensity = Convert::FromString<double>(optarg); break;
+				case 's': params.seed = Convert::FromString<boost::uint64_t>(optarg); break;
+				case 'o': output = optarg; break;
+				case 'h': printHelp(argv[0]); return EXIT_SUCCESS;
+				default: throw std::runtime_error("Invalid command line parameter."); break;
+			}
+		}
+
+		if ((params.states == 0) || (optind != argc))
+		{
+			throw std::runtime_error("Invalid command line parameters.");
+		}
+
+		RandomTAGenerator generator(params);
+
+		if (output.empty())
+		{
+			generator.WriteTimbuk(std::cout);
+		}
+		else
+		{
+			std::ofstream ofs(output.c_str());
+			if (ofs.fail())
+			{
+				throw std::runtime_error("Could not open file " + output);
+			}
+
+			generator.WriteTimbuk(ofs);
+		}
+	}
+	catch (std::exception& ex)
+	{
+		std::cerr << "An error occured: " << ex.what() << "\n";
+		std::cerr << "Run " << argv[0] << " -h   for detailed help.\n";
+
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
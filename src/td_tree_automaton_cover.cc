@@ -8,7 +8,35 @@
  *
  *****************************************************************************/
 
+// Standard library headers
+#include <set>
+
 #include <sfta/td_tree_automaton_cover.hh>
+#include <sfta/trace.hh>
+
+
+namespace
+{
+	/**
+	 * @brief  Appends a transition
+	 *
+	 * Appends the line of a transition unless it has already been appended.
+	 * After reordering of variables, the code of a symbol may be split among
+	 * several paths of the MTBDD that lead to the same states.
+	 *
+	 * @param[in,out]  result    The output
+	 * @param[in,out]  appended  The lines appended so far
+	 * @param[in]      line      The line of the transition
+	 */
+	void appendTransition(std::string& result, std::set<std::string>& appended,
+		const std::string& line)
+	{
+		if (appended.insert(line).second)
+		{	// in case the transition is new
+			result += line;
+		}
+	}
+}
 
 
 // Methods of TDTreeAutomatonCover
@@ -30,10 +58,12 @@ std::string SFTA::TDTreeAutomatonCover::statesToString(
 
 std::string SFTA::TDTreeAutomatonCover::ToString() const
 {
+	SFTA_TRACE_SPAN("TDTreeAutomatonCover::ToString");
+
 	std::string result;
 
 	result += "Ops";
-	result += symbolsToString(symbolDict_->GetVectorOfInputSymbols());
+	result += symbolsToString(symbolDict_->GetVectorOfRankedSymbols());
 	result += "\n";
 	result += "\n";
 	result += "Automaton dedecek";
@@ -52,6 +82,7 @@ std::string SFTA::TDTreeAutomatonCover::ToString() const
 
 	typedef std::vector<InternalTransitionType> TransitionVector;
 
+	std::set<std::string> appended;
 	TransitionVector trans = automaton_->GetVectorOfTransitions();
 	for (typename TransitionVector::const_iterator itTrans = trans.begin();
 		itTrans != trans.end(); ++itTrans)
@@ -66,10 +97,9 @@ std::string SFTA::TDTreeAutomatonCover::ToString() const
 
 			if (rhs.empty())
 			{	// in case there is nullary transition
-				result += Convert::ToString(*itSymbols);
-				result += " -> ";
-				result += Convert::ToString(translateInternalStateToState(itTrans->lhs));
-				result += "\n";
+				appendTransition(result, appended, Convert::ToString(*itSymbols) +
+					" -> " + Convert::ToString(translateInternalStateToState(itTrans->lhs)) +
+					"\n");
 			}
 
 			for (typename InternalRightHandSideType::const_iterator itRhs = rhs.begin();
@@ -80,20 +110,18 @@ std::string SFTA::TDTreeAutomatonCover::ToString() const
 					throw std::runtime_error(__func__ + std::string(": invalid type"));
 
 				}
-				const typename InternalDualStateType::VectorType& vecRhs =
+				typename InternalDualStateType::VectorView vecRhs =
 					itRhs->GetVector();
 				SFTA::Vector<StateType> outputRhs;
-				for (typename InternalDualStateType::VectorType::const_iterator
+				for (typename InternalDualStateType::VectorView::const_iterator
 					itVecRhs = vecRhs.begin(); itVecRhs != vecRhs.end(); ++itVecRhs)
 				{
 					outputRhs.push_back(translateInternalStateToState(*itVecRhs));
 				}
 
-				result += Convert::ToString(*itSymbols);
-				result += (outputRhs.empty()? " " : Convert::ToString(outputRhs));
-				result += " -> ";
-				result += Convert::ToString(translateInternalStateToState(itTrans->lhs));
-				result += "\n";
+				appendTransition(result, appended, Convert::ToString(*itSymbols) +
+					(outputRhs.empty()? " " : Convert::ToString(outputRhs)) + " -> " +
+					Convert::ToString(translateInternalStateToState(itTrans->lhs)) + "\n");
 			}
 		}
 
@@ -137,8 +165,15 @@ void SFTA::TDTreeAutomatonCover::AddTransition( const LeftHandSideType& lhs,
 		internalLhs = itStates->second;
 	}
 
-	// translate the symbol
-	InternalSymbolType internalSymbol = symbolDict_->Translate(symbol);
+	if (rhs.empty())
+	{	// in case there is nothing to add (and the arity is unknown)
+		return;
+	}
+
+	// translate the symbol (its arity is given by the tuples on the
+	// right-hand side)
+	size_t arity = rhs.begin()->size();
+	InternalSymbolType internalSymbol = symbolDict_->Translate(symbol, arity);
 
 	// retrieve the original right-hand side
 	InternalRightHandSideType origRhs =
@@ -165,6 +200,13 @@ void SFTA::TDTreeAutomatonCover::AddTransition( const LeftHandSideType& lhs,
 			newSuperState.push_back(itStates->second);
 		}
 
+		if (newSuperState.size() != arity)
+		{	// in case the arities of tuples do not match
+			throw std::runtime_error(__func__ +
+				std::string(": tuples of different arities for symbol = " +
+				Convert::ToString(symbol)));
+		}
+
 		origRhs.insert(newSuperState);
 	}
 
@@ -173,9 +215,16 @@ void SFTA::TDTreeAutomatonCover::AddTransition( const LeftHandSideType& lhs,
 }
 
 
-void SFTA::TDTreeAutomatonCover::AddSymbol(const SymbolType& symbol)
+void SFTA::TDTreeAutomatonCover::AddSymbol(const SymbolType& symbol,
+	size_t arity)
+{
+	symbolDict_->Translate(symbol, arity);
+}
+
+
+void SFTA::TDTreeAutomatonCover::AddSymbols(const RankedSymbolVector& symbols)
 {
-	symbolDict_->Translate(symbol);
+	symbolDict_->TranslateAll(symbols);
 }
 
 
@@ -193,17 +242,26 @@ void SFTA::TDTreeAutomatonCover::AddState(const StateType& state)
 }
 
 
+SFTA::MemoryUsage SFTA::TDTreeAutomatonCover::GetMemoryUsage() const
+{
+	MemoryUsage usage = automaton_->GetMemoryUsage();
+	usage.stateNames = SFTA::Private::MemoryEstimate::Of(state2internalStateMap_);
+	usage.symbolDictionary = symbolDict_->GetMemoryUsage();
+
+	return usage;
+}
+
+
 std::string SFTA::TDTreeAutomatonCover::symbolsToString(
-	const std::vector<SymbolType>& vec)
+	const RankedSymbolVector& vec)
 {
 	std::string result;
 
-	typedef std::vector<SymbolType> VectorOfSymbols;
-
-	for (typename VectorOfSymbols::const_iterator itSymbols = vec.begin();
+	for (typename RankedSymbolVector::const_iterator itSymbols = vec.begin();
 		itSymbols != vec.end(); ++itSymbols)
 	{
-		result += " " + Convert::ToString(*itSymbols) + ":0";
+		result += " " + Convert::ToString(itSymbols->first) + ":" +
+			Convert::ToString(itSymbols->second);
 	}
 
 	return result;
@@ -229,18 +287,8 @@ std::vector<SFTA::TDTreeAutomatonCover::SymbolType>
 	SFTA::TDTreeAutomatonCover::translateInternalSymbolToSymbols(
 	const InternalSymbolType& internalSymbol) const
 {
-	std::vector<SymbolType> result;
-
-	typedef std::vector<InternalSymbolType> InternalSymbolVector;
-
-	InternalSymbolVector symbols = internalSymbol.GetVectorOfConcreteSymbols();
-	for (typename InternalSymbolVector::const_iterator itSym = symbols.begin();
-		itSym != symbols.end(); ++itSym)
-	{
-		result.push_back(symbolDict_->TranslateInverse(*itSym));
-	}
-
-	return result;
+	// don't care variables above short codes are not expanded
+	return symbolDict_->TranslateInverseAll(internalSymbol);
 }
 
 
@@ -254,9 +302,15 @@ SFTA::TDTreeAutomatonCover::Type*
 	assert(lhs != static_cast<Type*>(0));
 	assert(rhs != static_cast<Type*>(0));
 
-	if (lhs->GetBDDSize() != rhs->GetBDDSize())
-	{	// in case the BDD sizes do not match
-		throw std::runtime_error("BDD sizes do not match!");
+	statistics_.Reset();
+	SFTA_STATISTICS_SCOPE(&statistics_);
+	OperationContext::Scope contextScope(context_);
+	SFTA_TRACE_SPAN("TDTreeAutomatonCover::Union");
+
+	if (lhs->GetSymbolDictionary() != rhs->GetSymbolDictionary())
+	{	// symbols of automata with different dictionaries cannot be matched
+		throw std::runtime_error(__func__ +
+			std::string(": the automata do not share the symbol dictionary"));
 	}
 
 	typedef typename NDSymbolicTDTreeAutomaton::HierarchyRoot AbstractAutomaton;
@@ -273,7 +327,7 @@ SFTA::TDTreeAutomatonCover::Type*
 			std::string(": cannot convert to proper type"));
 	}
 
-	return new Type(lhs->GetBDDSize(), result, lhs->GetSymbolDictionary());
+	return new Type(result, lhs->GetSymbolDictionary());
 }
 
 
@@ -284,9 +338,15 @@ SFTA::TDTreeAutomatonCover::Type*
 	assert(lhs != static_cast<Type*>(0));
 	assert(rhs != static_cast<Type*>(0));
 
-	if (lhs->GetBDDSize() != rhs->GetBDDSize())
-	{	// in case the BDD sizes do not match
-		throw std::runtime_error("BDD sizes do not match!");
+	statistics_.Reset();
+	SFTA_STATISTICS_SCOPE(&statistics_);
+	OperationContext::Scope contextScope(context_);
+	SFTA_TRACE_SPAN("TDTreeAutomatonCover::Intersection");
+
+	if (lhs->GetSymbolDictionary() != rhs->GetSymbolDictionary())
+	{	// symbols of automata with different dictionaries cannot be matched
+		throw std::runtime_error(__func__ +
+			std::string(": the automata do not share the symbol dictionary"));
 	}
 
 	typedef typename NDSymbolicTDTreeAutomaton::HierarchyRoot AbstractAutomaton;
@@ -303,5 +363,5 @@ SFTA::TDTreeAutomatonCover::Type*
 			std::string(": cannot convert to proper type"));
 	}
 
-	return new Type(lhs->GetBDDSize(), result, lhs->GetSymbolDictionary());
+	return new Type(result, lhs->GetSymbolDictionary());
 }
@@ -0,0 +1,246 @@
+#!/bin/sh
+#
+# Benchmarks operations of the sfta program over the automata pool and over
+# generated families of automata, saves the results in JSON and compares them
+# with a baseline.
+#
+# usage: benchmark.sh [-b <baseline>] [-o <results>] [-t <threshold>]
+#                     [-r <repetitions>] [-u] [<sfta>]
+#    or: benchmark.sh -s
+#
+#   -b  the baseline file (default benchmark_baseline.json)
+#   -o  the file for results (default benchmark_results.json)
+#   -t  the maximal allowed ratio of the new and the baseline time (default 1.5)
+#   -r  the number of repetitions of each measurement (default 5)
+#   -u  store the results as the new baseline
+#   -s  only test the comparison of results with a baseline
+#
+# Every benchmark is the median wall time of a run of sfta in seconds.
+# The script fails if some benchmark is slower than the baseline by more than
+# the threshold (differences under 0.05 s are ignored as noise). It also fails
+# if there is no baseline yet, unless -u is given to record one.
+
+DIRPATH=$(dirname "$0")
+ECHO=/bin/echo
+
+# Defaults
+BASELINE=benchmark_baseline.json
+RESULTS=benchmark_results.json
+THRESHOLD=1.5
+REPETITIONS=5
+UPDATE=0
+SELF_TEST=0
+MIN_DIFFERENCE=0.05
+
+while getopts "b:o:t:r:us" opt ; do
+  case ${opt} in
+    b) BASELINE=${OPTARG} ;;
+    o) RESULTS=${OPTARG} ;;
+    t) THRESHOLD=${OPTARG} ;;
+    r) REPETITIONS=${OPTARG} ;;
+    u) UPDATE=1 ;;
+    s) SELF_TEST=1 ;;
+    *) exit 1 ;;
+  esac
+done
+shift $((OPTIND - 1))
+
+# The green colour
+green='\e[1;32m'
+red='\e[1;31m'
+endcolor='\e[0m'
+
+# Prints benchmarks of the results ($2) slower than in the baseline ($1) by
+# more than the threshold (values are converted to numbers, so that they are
+# not compared as strings)
+compare() {
+  awk -v threshold=${THRESHOLD} -v mindiff=${MIN_DIFFERENCE} '
+    function parse(line, kv) {
+      if (match(line, /"[^"]*": [0-9.eE+-]+/)) {
+        kv = substr(line, RSTART, RLENGTH)
+        key = kv; sub(/^"/, "", key); sub(/": .*$/, "", key)
+        value = kv; sub(/^.*": /, "", value)
+        return 1
+      }
+      return 0
+    }
+    FNR == NR { if (parse($0)) { base[key] = value + 0 } ; next }
+    parse($0) && (key in base) {
+      if ((value + 0 > base[key] * threshold) && (value - base[key] > mindiff)) {
+        printf("%s: %s s (baseline %s s)\n", key, value, base[key])
+      }
+    }' $1 $2
+}
+
+# Tests the comparison on fixed results, including slowdowns that add an
+# integer digit
+if [ ${SELF_TEST} -eq 1 ] ; then
+  BASELINE_TMP=$(mktemp)
+  RESULTS_TMP=$(mktemp)
+
+  cat > ${BASELINE_TMP} <<EOF
+{
+  "same": 2.25,
+  "faster": 2.25,
+  "slower": 2.25,
+  "slower by a digit": 2.25,
+  "slower by two digits": 9.5,
+  "noise": 0.01,
+  "within threshold": 8.5,
+  "removed": 1
+}
+EOF
+
+  cat > ${RESULTS_TMP} <<EOF
+{
+  "same": 2.25,
+  "faster": 1.5,
+  "slower": 4.0,
+  "slower by a digit": 10.5,
+  "slower by two digits": 105,
+  "noise": 0.05,
+  "within threshold": 12.5,
+  "added": 100
+}
+EOF
+
+  slower=$(compare ${BASELINE_TMP} ${RESULTS_TMP} | sed 's/:.*//')
+  expected=$(printf "slower\nslower by a digit\nslower by two digits")
+
+  rm ${BASELINE_TMP}
+  rm ${RESULTS_TMP}
+
+  ${ECHO} -n "Testing the comparison with a baseline:        "
+  if [ "${slower}" = "${expected}" ] ; then
+    ${ECHO} -e "${green}PASSED${endcolor}"
+    exit 0
+  else
+    ${ECHO} -e "${red}FAILED${endcolor}"
+    ${ECHO} "${slower}"
+    exit 1
+  fi
+fi
+
+# Programs
+SFTA=${1:-${DIRPATH}/../build/src/sfta}
+
+# Automata pool directory and the pairs of automata for binary operations
+AUT_DIR=${DIRPATH}/automata
+AUT_PAIRS=${DIRPATH}/benchmark_automata.txt
+
+# Moduli of the generated family of automata
+FAMILY_MODULI="4 8 16 32 64"
+
+# Create temporary files and directories
+FAMILY_DIR=$(mktemp -d)
+RESULTS_TMP=$(mktemp)
+
+# Prints the median of numbers on the standard input
+median() {
+  sort -n | awk '{ v[NR] = $1 } END {
+    if (NR % 2) { print v[(NR + 1) / 2] } else { print (v[NR / 2] + v[NR / 2 + 1]) / 2 } }'
+}
+
+# Records the time of a benchmark
+record() {
+  ${ECHO} "$1 $2" >> ${RESULTS_TMP}
+  ${ECHO} "$1: $2 s"
+}
+
+# Measures the median wall time of running sfta with given parameters
+measure() {
+  name=$1
+  shift
+
+  i=0
+  times=""
+  while [ ${i} -lt ${REPETITIONS} ] ; do
+    start=$(date +%s.%N)
+    ${SFTA} "$@" > /dev/null 2>&1 || { ${ECHO} "${name}: failed" ; return 1 ; }
+    end=$(date +%s.%N)
+    times="${times} $(${ECHO} "${start} ${end}" | awk '{ print $2 - $1 }')"
+    i=$((i + 1))
+  done
+
+  record "${name}" $(${ECHO} ${times} | tr ' ' '\n' | median)
+}
+
+# Runs all benchmarks over given automata
+benchmark_unary() {
+  measure "load $1" --load $2
+  measure "simulation $1" --simulation $2
+}
+
+benchmark_binary() {
+  measure "union $1 $2" --union $3 $4
+  measure "intersection $1 $2" --intersection $3 $4
+  measure "inclusion-down $1 $2" --down-inclusion $3 $4
+  measure "inclusion-down-simboth $1 $2" --down-inclusion-simboth $3 $4
+  measure "inclusion-down-nosim $1 $2" --down-inclusion-nosim $3 $4
+  measure "inclusion-up $1 $2" --up-inclusion $3 $4
+}
+
+result=0
+
+${ECHO} "Benchmarking the automata pool"
+
+for aut_file in ${AUT_DIR}/* ; do
+  benchmark_unary $(basename ${aut_file}) ${aut_file} || result=1
+done
+
+while read aut1 aut2 ; do
+  benchmark_binary ${aut1} ${aut2} ${AUT_DIR}/${aut1} ${AUT_DIR}/${aut2} || result=1
+done < ${AUT_PAIRS}
+
+${ECHO} "Benchmarking generated automata"
+
+for modulus in ${FAMILY_MODULI} ; do
+  awk -f ${DIRPATH}/counter_family.awk ${modulus} > ${FAMILY_DIR}/counter${modulus}
+done
+
+prev=""
+for modulus in ${FAMILY_MODULI} ; do
+  aut=counter${modulus}
+  benchmark_unary ${aut} ${FAMILY_DIR}/${aut} || result=1
+  if [ -n "${prev}" ] ; then
+    benchmark_binary ${aut} ${prev} ${FAMILY_DIR}/${aut} ${FAMILY_DIR}/${prev} || result=1
+    benchmark_binary ${prev} ${aut} ${FAMILY_DIR}/${prev} ${FAMILY_DIR}/${aut} || result=1
+  fi
+  prev=${aut}
+done
+
+# Save the results as a JSON object (one benchmark per line)
+awk 'BEGIN { print "{" }
+  { name = $0; sub(/ [^ ]*$/, "", name);
+    printf("%s  \"%s\": %s", (NR > 1)? ",\n" : "", name, $NF) }
+  END { print "\n}" }' ${RESULTS_TMP} > ${RESULTS}
+
+${ECHO} "Results saved to ${RESULTS}"
+
+if [ ${UPDATE} -eq 1 ] ; then
+  cp ${RESULTS} ${BASELINE}
+  ${ECHO} "Baseline saved to ${BASELINE}"
+elif [ ! -f ${BASELINE} ] ; then
+  result=1
+  ${ECHO} "No baseline ${BASELINE}, record one using -u"
+  ${ECHO} -e "${red}NO BASELINE${endcolor}"
+else
+  ${ECHO} "Comparing with ${BASELINE} (threshold ${THRESHOLD})"
+
+  # Print benchmarks slower than the baseline by more than the threshold
+  slower=$(compare ${BASELINE} ${RESULTS})
+
+  if [ -n "${slower}" ] ; then
+    result=1
+    ${ECHO} "${slower}"
+    ${ECHO} -e "${red}SLOWDOWN DETECTED${endcolor}"
+  else
+    ${ECHO} -e "${green}NO SLOWDOWN${endcolor}"
+  fi
+fi
+
+# Remove temporary files
+rm -r ${FAMILY_DIR}
+rm ${RESULTS_TMP}
+
+exit ${result}
@@ -0,0 +1,35 @@
+# Awk script that generates a member of a family of finite tree automata in
+# the Timbuk format. The automaton with modulus n (given as ARGV[1]) accepts
+# binary trees whose number of inner nodes is divisible by n, so that the
+# language of the automaton with modulus 2n is included in the language of
+# the automaton with modulus n (but not vice versa).
+
+BEGIN {
+  modulus = ARGV[1]
+  ARGV[1] = ""
+  if (modulus <= 0) {
+    printf("Fatal error: need to specify modulus as ARGV[1]!\n") > "/dev/stderr"
+    exit 1
+  }
+
+  printf("Ops a:0 f:2\n\n")
+  printf("Automaton counter%d\n\n", modulus)
+
+  printf("States")
+  for (i = 0; i < modulus; ++i) {
+    printf(" q%d:0", i)
+  }
+  printf("\n\n")
+
+  printf("Final States q0\n\n")
+
+  printf("Transitions\n")
+  printf("a -> q0\n")
+  for (i = 0; i < modulus; ++i) {
+    for (j = 0; j < modulus; ++j) {
+      printf("f(q%d,q%d) -> q%d\n", i, j, (i + j + 1) % modulus)
+    }
+  }
+
+  exit 0
+}
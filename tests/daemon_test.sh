@@ -0,0 +1,95 @@
+#!/bin/sh
+
+# Runs a scripted session of the daemon mode of sfta on the standard input
+# and compares the replies with the expected ones.
+#
+# usage: daemon_test.sh [<sfta>]
+
+DIRPATH=$(dirname "$0")
+ECHO=/bin/echo
+
+# Programs
+SFTA=${1:-${DIRPATH}/../build/src/sfta}
+
+# Automata pool directory
+AUT_DIR=${DIRPATH}/automata
+
+# Create temporary files
+EXPECTED_TMP=$(mktemp)
+REPLIES_TMP=$(mktemp)
+
+# Set the initial value of the result
+result=0
+
+# The green colour
+green='\e[1;32m'
+red='\e[1;31m'
+endcolor='\e[0m'
+
+${ECHO} -n "Testing a session of the daemon mode:          "
+
+# Empty lines and comments are not answered, the relation computed by the
+# simulation command is not compared
+${SFTA} --daemon > ${REPLIES_TMP} <<EOF || result=1
+# load two automata
+load a ${AUT_DIR}/A11
+
+load b ${AUT_DIR}/A12
+union u a b
+intersection i a b
+inclusion a u
+inclusion a u up
+inclusion i a down-nosim
+inclusion i b down-simboth
+inclusion a a
+simulation a
+list
+free i
+list
+load c no-such-file
+inclusion a missing
+inclusion a b bogus
+union u a
+frobnicate
+quit
+load d ${AUT_DIR}/A13
+EOF
+
+cat > ${EXPECTED_TMP} <<EOF
+ok
+ok
+ok
+ok
+ok 1
+ok 1
+ok 1
+ok 1
+ok 1
+ok RELATION
+ok a b i u
+ok
+ok a b u
+error Could not open file no-such-file
+error Unknown automaton missing
+error Invalid inclusion method: bogus
+error Wrong number of operands of union
+error Unknown command frobnicate
+ok
+EOF
+
+# the reply to the simulation command is the tenth one
+sed -i '10s/^ok .*$/ok RELATION/' ${REPLIES_TMP}
+
+if diff -u ${EXPECTED_TMP} ${REPLIES_TMP}
+then
+  ${ECHO} -e "${green}PASSED${endcolor}"
+else
+  result=1
+  ${ECHO} -e "${red}FAILED${endcolor}"
+fi
+
+# Remove temporary files
+rm ${EXPECTED_TMP}
+rm ${REPLIES_TMP}
+
+exit ${result}
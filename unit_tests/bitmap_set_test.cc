@@ -0,0 +1,117 @@
+/*****************************************************************************
+ *  Symbolic Finite Tree Automata Library
+ *
+ *  Description:
+ *    Test suite for BitmapSet class.
+ *
+ *****************************************************************************/
+
+// Standard library headers
+#include <vector>
+
+// SFTA headers
+#include <sfta/bitmap_set.hh>
+
+// Boost headers
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE BitmapSet
+#include <boost/test/unit_test.hpp>
+
+// testing headers
+#include "log_fixture.hh"
+
+
+/******************************************************************************
+ *                                  Fixtures                                  *
+ ******************************************************************************/
+
+/**
+ * @brief  Fixture for BitmapSet
+ *
+ * Fixture with a set of elements on both sides of word boundaries.
+ */
+class BitmapSetFixture : public LogFixture
+{
+public:   // Public data types
+
+	typedef SFTA::Private::BitmapSet<unsigned> SetType;
+
+protected:// Protected data members
+
+	SetType set_;
+
+public:   // Public methods
+
+	BitmapSetFixture()
+		: set_()
+	{
+		set_.insert(0);
+		set_.insert(63);
+		set_.insert(64);
+		set_.insert(200);
+	}
+};
+
+
+/******************************************************************************
+ *                              Start of testing                              *
+ ******************************************************************************/
+
+
+BOOST_FIXTURE_TEST_SUITE(suite, BitmapSetFixture)
+
+BOOST_AUTO_TEST_CASE(membership)
+{
+	BOOST_CHECK(set_.Contains(0));
+	BOOST_CHECK(set_.Contains(63));
+	BOOST_CHECK(set_.Contains(64));
+	BOOST_CHECK(set_.Contains(200));
+
+	BOOST_CHECK(!set_.Contains(1));
+	BOOST_CHECK(!set_.Contains(65));
+	BOOST_CHECK(!set_.Contains(199));
+
+	// elements above the bitmap are not contained
+	BOOST_CHECK(!set_.Contains(1000));
+	BOOST_CHECK(!SetType().Contains(0));
+}
+
+BOOST_AUTO_TEST_CASE(union_of_sets)
+{
+	SetType other;
+	other.insert(5);
+	other.insert(1000);
+
+	set_.insert(other);
+
+	BOOST_CHECK(set_.Contains(5));
+	BOOST_CHECK(set_.Contains(1000));
+	BOOST_CHECK(set_.Contains(200));
+	BOOST_CHECK(!set_.Contains(999));
+
+	// the smaller set grows only with its own elements
+	other.insert(SetType());
+	BOOST_CHECK(!other.Contains(200));
+}
+
+BOOST_AUTO_TEST_CASE(contains_any_of)
+{
+	std::vector<unsigned> elements;
+	BOOST_CHECK(!set_.ContainsAnyOf(elements.begin(), elements.end()));
+
+	elements.push_back(1);
+	elements.push_back(1000);
+	BOOST_CHECK(!set_.ContainsAnyOf(elements.begin(), elements.end()));
+
+	elements.push_back(64);
+	BOOST_CHECK(set_.ContainsAnyOf(elements.begin(), elements.end()));
+}
+
+BOOST_AUTO_TEST_CASE(memory_usage)
+{
+	// the bitmap spans four words up to the element 200
+	BOOST_CHECK(set_.GetMemoryUsage() >= 4 * sizeof(boost::uint64_t));
+	BOOST_CHECK_EQUAL(SetType().GetMemoryUsage(), 0u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
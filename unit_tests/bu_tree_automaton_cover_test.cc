@@ -0,0 +1,151 @@
+/*****************************************************************************
+ *  Symbolic Finite Tree Automata Library
+ *
+ *  Description:
+ *    Test suite for BUTreeAutomatonCover class.
+ *
+ *****************************************************************************/
+
+// Standard library headers
+#include <memory>
+#include <sstream>
+
+// SFTA headers
+#include <sfta/bu_tree_automaton_cover.hh>
+#include <sfta/operation_context.hh>
+#include <sfta/ta_building_director.hh>
+#include <sfta/timbuk_bu_ta_builder.hh>
+
+using SFTA::BUTreeAutomatonCover;
+using SFTA::OperationContext;
+using SFTA::OperationInterrupted;
+
+// Boost headers
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE BUTreeAutomatonCover
+#include <boost/test/unit_test.hpp>
+
+// testing headers
+#include "log_fixture.hh"
+
+
+/******************************************************************************
+ *                                  Constants                                 *
+ ******************************************************************************/
+
+/**
+ * An automaton accepting trees with a leaf b in the rightmost branch
+ */
+const char* const LHS_AUTOMATON =
+	"Ops a:0 b:0 f:2\n"
+	"Automaton lhs\n"
+	"States p q\n"
+	"Final States q\n"
+	"Transitions\n"
+	"a -> p\n"
+	"b -> q\n"
+	"f(p,q) -> q\n"
+	"f(q,q) -> q\n";
+
+/**
+ * An automaton accepting trees with a leaf b
+ */
+const char* const RHS_AUTOMATON =
+	"Ops a:0 b:0 f:2\n"
+	"Automaton rhs\n"
+	"States r s\n"
+	"Final States s\n"
+	"Transitions\n"
+	"a -> r\n"
+	"b -> s\n"
+	"f(r,r) -> r\n"
+	"f(r,s) -> s\n"
+	"f(s,r) -> s\n"
+	"f(s,s) -> s\n";
+
+
+/******************************************************************************
+ *                                  Fixtures                                  *
+ ******************************************************************************/
+
+/**
+ * @brief  Fixture for BUTreeAutomatonCover
+ *
+ * Fixture that constructs automata sharing an MTBDD.
+ */
+class BUTreeAutomatonCoverFixture : public LogFixture
+{
+public:   // Public data types
+
+	typedef BUTreeAutomatonCover::Type Type;
+
+private:  // Private data types
+
+	typedef SFTA::TimbukBUTABuilder<BUTreeAutomatonCover> BuilderType;
+	typedef SFTA::TABuildingDirector<BUTreeAutomatonCover> DirectorType;
+
+private:  // Private data members
+
+	BuilderType builder_;
+
+	DirectorType director_;
+
+private:  // Private methods
+
+	BUTreeAutomatonCoverFixture(const BUTreeAutomatonCoverFixture&);
+	BUTreeAutomatonCoverFixture& operator=(const BUTreeAutomatonCoverFixture&);
+
+public:   // Public methods
+
+	BUTreeAutomatonCoverFixture()
+		: builder_(),
+			director_(&builder_)
+	{ }
+
+	Type* construct(const char* automaton)
+	{
+		std::istringstream is(automaton);
+		return director_.Construct(is);
+	}
+};
+
+
+/******************************************************************************
+ *                              Start of testing                              *
+ ******************************************************************************/
+
+
+BOOST_FIXTURE_TEST_SUITE(suite, BUTreeAutomatonCoverFixture)
+
+BOOST_AUTO_TEST_CASE(interrupted_operations_release_roots)
+{
+	std::auto_ptr<Type> lhs(construct(LHS_AUTOMATON));
+	std::auto_ptr<Type> rhs(construct(RHS_AUTOMATON));
+
+	std::auto_ptr<Type::Operation> op(lhs->GetOperation());
+
+	size_t roots = lhs->GetMTBDDMemoryUsage().roots;
+
+	OperationContext context;
+	context.Cancel();
+	op->SetContext(&context);
+
+	BOOST_CHECK_THROW(op->Intersection(lhs.get(), rhs.get()), OperationInterrupted);
+	BOOST_CHECK_EQUAL(lhs->GetMTBDDMemoryUsage().roots, roots);
+
+	BOOST_CHECK_THROW(op->Union(lhs.get(), rhs.get()), OperationInterrupted);
+	BOOST_CHECK_EQUAL(lhs->GetMTBDDMemoryUsage().roots, roots);
+
+	BOOST_CHECK_THROW(op->DoesLanguageInclusionHoldDownwards(lhs.get(), rhs.get()),
+		OperationInterrupted);
+
+	// the operations work once the context is cleared
+	context.Reset();
+
+	std::auto_ptr<Type> product(op->Intersection(lhs.get(), rhs.get()));
+	BOOST_CHECK(lhs->GetMTBDDMemoryUsage().roots > roots);
+	BOOST_CHECK(op->DoesLanguageInclusionHoldUpwards(lhs.get(), rhs.get()));
+	BOOST_CHECK(!op->DoesLanguageInclusionHoldUpwards(rhs.get(), lhs.get()));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,336 @@
+/*****************************************************************************
+ *  Symbolic Finite Tree Automata Library
+ *
+ *  Description:
+ *    Test suite for CompactVariableAssignment class. The results are compared
+ *    with a model of the former representation that stored every variable in
+ *    two bits of a char.
+ *
+ *****************************************************************************/
+
+// Standard library headers
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// SFTA headers
+#include <sfta/compact_variable_assignment.hh>
+
+using SFTA::Private::CompactVariableAssignment;
+
+// Boost headers
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE CompactVariableAssignment
+#include <boost/test/unit_test.hpp>
+#include <boost/random/mersenne_twister.hpp>
+
+// testing headers
+#include "log_fixture.hh"
+
+
+/******************************************************************************
+ *                                  Constants                                 *
+ ******************************************************************************/
+
+/**
+ * The seed of the pseudorandom number generator
+ */
+const unsigned PRNG_SEED = 917263;
+
+/**
+ * The number of random assignments compared with the model
+ */
+const unsigned RANDOM_CASES = 500;
+
+/**
+ * Lengths of random assignments (within a word, at the word boundary and
+ * spanning several words)
+ */
+const size_t RANDOM_LENGTHS[] = {1, 7, 63, 64, 65, 130};
+
+const size_t RANDOM_LENGTHS_SIZE =
+	sizeof(RANDOM_LENGTHS) / sizeof(const size_t);
+
+
+/******************************************************************************
+ *                                   Model                                    *
+ ******************************************************************************/
+
+/**
+ * @brief  Rank of a value in the ordering of assignments
+ *
+ * The former ordering of the values of a variable: 0 < X < 1.
+ */
+int modelRank(char value)
+{
+	switch (value)
+	{
+		case '0': return 0;
+		case 'X': return 1;
+		case '1': return 2;
+		default: throw std::runtime_error("Invalid value");
+	}
+}
+
+/**
+ * @brief  The former operator<()
+ *
+ * Shorter assignments are smaller, assignments of the same length are
+ * compared from the variable with the highest index.
+ */
+bool modelLess(const std::string& lhs, const std::string& rhs)
+{
+	if (lhs.length() != rhs.length())
+	{
+		return lhs.length() < rhs.length();
+	}
+
+	for (size_t i = lhs.length(); i > 0; --i)
+	{
+		if (lhs[i - 1] != rhs[i - 1])
+		{
+			return modelRank(lhs[i - 1]) < modelRank(rhs[i - 1]);
+		}
+	}
+
+	return false;
+}
+
+/**
+ * @brief  The former operator++()
+ *
+ * Increments the assignment read as a binary number with the variable with
+ * the lowest index being the least significant.
+ */
+std::string modelIncrement(std::string asgn)
+{
+	for (size_t i = 0; i < asgn.length(); ++i)
+	{
+		if (asgn[i] == '0')
+		{
+			asgn[i] = '1';
+			break;
+		}
+
+		asgn[i] = '0';
+	}
+
+	return asgn;
+}
+
+/**
+ * @brief  The former expansion of don't care variables
+ */
+void modelExpand(std::string& asgn, size_t pos, std::vector<std::string>& result)
+{
+	if (pos == asgn.length())
+	{
+		result.push_back(asgn);
+	}
+	else if (asgn[pos] == 'X')
+	{	// fork on the don't care variable
+		asgn[pos] = '0';
+		modelExpand(asgn, pos + 1, result);
+		asgn[pos] = '1';
+		modelExpand(asgn, pos + 1, result);
+		asgn[pos] = 'X';
+	}
+	else
+	{
+		modelExpand(asgn, pos + 1, result);
+	}
+}
+
+
+/******************************************************************************
+ *                                  Fixtures                                  *
+ ******************************************************************************/
+
+/**
+ * @brief  Fixture for CompactVariableAssignment
+ *
+ * Fixture with a pseudorandom generator of assignments.
+ */
+class CompactVariableAssignmentFixture : public LogFixture
+{
+protected:// Protected data members
+
+	boost::mt19937 prnGen_;
+
+public:   // Public methods
+
+	CompactVariableAssignmentFixture()
+		: prnGen_(PRNG_SEED)
+	{ }
+
+	std::string randomAssignment(size_t length, bool concrete)
+	{
+		static const char VALUES[] = {'0', '1', 'X'};
+
+		std::string result;
+		for (size_t i = 0; i < length; ++i)
+		{
+			result += VALUES[prnGen_() % (concrete? 2 : 3)];
+		}
+
+		return result;
+	}
+
+	std::string randomAssignment(bool concrete)
+	{
+		return randomAssignment(
+			RANDOM_LENGTHS[prnGen_() % RANDOM_LENGTHS_SIZE], concrete);
+	}
+};
+
+
+/******************************************************************************
+ *                              Start of testing                              *
+ ******************************************************************************/
+
+
+BOOST_FIXTURE_TEST_SUITE(suite, CompactVariableAssignmentFixture)
+
+BOOST_AUTO_TEST_CASE(values_of_variables)
+{
+	for (unsigned i = 0; i < RANDOM_CASES; ++i)
+	{
+		std::string str = randomAssignment(false);
+		CompactVariableAssignment asgn(str);
+
+		BOOST_CHECK_EQUAL(asgn.VariablesCount(), str.length());
+		BOOST_CHECK_EQUAL(asgn.ToString(), str);
+
+		// setting the values one by one gives the same assignment
+		CompactVariableAssignment other(str.length());
+		for (size_t j = 0; j < str.length(); ++j)
+		{
+			other.SetIthVariableValue(j, asgn.GetIthVariableValue(j));
+		}
+
+		BOOST_CHECK(other == asgn);
+	}
+
+	// variables added later are don't care
+	CompactVariableAssignment asgn("10");
+	asgn.AddVariablesUpTo(69);
+	BOOST_CHECK_EQUAL(asgn.ToString(), "10" + std::string(68, 'X'));
+
+	// the index sets the lowest variables first
+	BOOST_CHECK_EQUAL(CompactVariableAssignment(4, 6).ToString(), "0110");
+}
+
+BOOST_AUTO_TEST_CASE(ordering)
+{
+	for (unsigned i = 0; i < RANDOM_CASES; ++i)
+	{
+		std::string lhs = randomAssignment(false);
+		std::string rhs = randomAssignment(false);
+		if (prnGen_() % 2 == 0)
+		{	// make the assignments differ in a single variable
+			rhs = lhs;
+			rhs[prnGen_() % rhs.length()] = "01X"[prnGen_() % 3];
+		}
+
+		CompactVariableAssignment lhsAsgn(lhs);
+		CompactVariableAssignment rhsAsgn(rhs);
+
+		BOOST_CHECK_EQUAL(lhsAsgn < rhsAsgn, modelLess(lhs, rhs));
+		BOOST_CHECK_EQUAL(rhsAsgn < lhsAsgn, modelLess(rhs, lhs));
+		BOOST_CHECK_EQUAL(lhsAsgn == rhsAsgn, lhs == rhs);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(increment)
+{
+	for (unsigned i = 0; i < RANDOM_CASES; ++i)
+	{
+		std::string str = randomAssignment(true);
+		CompactVariableAssignment asgn(str);
+
+		BOOST_CHECK_EQUAL((++asgn).ToString(), modelIncrement(str));
+	}
+
+	// the carry crosses the word boundary and wraps around
+	CompactVariableAssignment asgn(std::string(64, '1') + "0");
+	BOOST_CHECK_EQUAL((++asgn).ToString(), std::string(64, '0') + "1");
+	asgn = CompactVariableAssignment(std::string(65, '1'));
+	BOOST_CHECK_EQUAL((++asgn).ToString(), std::string(65, '0'));
+
+	BOOST_CHECK_THROW(++CompactVariableAssignment("0X1"), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(expansion_of_dont_cares)
+{
+	for (unsigned i = 0; i < RANDOM_CASES; ++i)
+	{
+		// at most 8 don't cares so that the expansion stays small
+		std::string str = randomAssignment(RANDOM_LENGTHS[prnGen_() % 4], true);
+		for (size_t j = 0; j < 8; ++j)
+		{
+			str[prnGen_() % str.length()] = 'X';
+		}
+
+		std::vector<std::string> expected;
+		modelExpand(str, 0, expected);
+
+		CompactVariableAssignment asgn(str);
+		std::vector<CompactVariableAssignment> symbols =
+			asgn.GetVectorOfConcreteSymbols();
+
+		std::vector<std::string> result;
+		for (size_t j = 0; j < symbols.size(); ++j)
+		{
+			result.push_back(symbols[j].ToString());
+			BOOST_CHECK(asgn.Matches(symbols[j]));
+			BOOST_CHECK_EQUAL(symbols[j].DontCaresCount(), 0u);
+		}
+
+		// the order differs from the former one, the set of symbols does not
+		std::sort(expected.begin(), expected.end());
+		std::sort(result.begin(), result.end());
+		BOOST_CHECK(result == expected);
+		BOOST_CHECK_EQUAL(asgn.DontCaresCount(),
+			static_cast<size_t>(std::count(str.begin(), str.end(), 'X')));
+	}
+
+	// don't cares are incremented with the lowest variable being the least
+	// significant
+	std::vector<CompactVariableAssignment> symbols =
+		CompactVariableAssignment("X1X").GetVectorOfConcreteSymbols();
+	BOOST_REQUIRE_EQUAL(symbols.size(), 4u);
+	BOOST_CHECK_EQUAL(symbols[0].ToString(), "010");
+	BOOST_CHECK_EQUAL(symbols[1].ToString(), "110");
+	BOOST_CHECK_EQUAL(symbols[2].ToString(), "011");
+	BOOST_CHECK_EQUAL(symbols[3].ToString(), "111");
+}
+
+BOOST_AUTO_TEST_CASE(matching_and_overlapping)
+{
+	CompactVariableAssignment pattern("1X0X");
+
+	BOOST_CHECK(pattern.Matches(CompactVariableAssignment("1100")));
+	BOOST_CHECK(pattern.Matches(CompactVariableAssignment("1X0X")));
+	BOOST_CHECK(!pattern.Matches(CompactVariableAssignment("XX0X")));
+	BOOST_CHECK(!pattern.Matches(CompactVariableAssignment("1110")));
+
+	// missing variables are don't care
+	BOOST_CHECK(pattern.Matches(CompactVariableAssignment("1X0X11")));
+	BOOST_CHECK(!pattern.Matches(CompactVariableAssignment("1X")));
+
+	BOOST_CHECK(pattern.Overlaps(CompactVariableAssignment("XX0X")));
+	BOOST_CHECK(pattern.Overlaps(CompactVariableAssignment("X1X1")));
+	BOOST_CHECK(pattern.Overlaps(CompactVariableAssignment("1")));
+	BOOST_CHECK(CompactVariableAssignment("X1X1X1").Overlaps(pattern));
+	BOOST_CHECK(!pattern.Overlaps(CompactVariableAssignment("0XXX")));
+	BOOST_CHECK(!pattern.Overlaps(CompactVariableAssignment("XX1")));
+
+	// the variables in the second word are compared as well
+	CompactVariableAssignment wide(std::string(64, 'X') + "1");
+	BOOST_CHECK(!wide.Overlaps(CompactVariableAssignment(std::string(64, 'X') + "0")));
+	BOOST_CHECK(wide.Overlaps(CompactVariableAssignment(std::string(64, '0'))));
+	BOOST_CHECK(!wide.Matches(CompactVariableAssignment(std::string(64, '0'))));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -12,6 +12,9 @@
 #include <sfta/convert.hh>
 #include <sfta/cudd_facade.hh>
 #include <sfta/formula_parser.hh>
+#include <sfta/operation_context.hh>
+using SFTA::OperationContext;
+using SFTA::OperationInterrupted;
 using SFTA::Private::CUDDFacade;
 using SFTA::Private::Convert;
 using SFTA::Private::FormulaParser;
@@ -1083,4 +1086,139 @@ BOOST_AUTO_TEST_CASE(monadic_apply)
 }
 
 
+BOOST_AUTO_TEST_CASE(interrupted_apply)
+{
+	CUDDFacade facade;
+
+	// load test cases
+	ListOfTestCasesType testCases;
+	ListOfTestCasesType failedCases;
+	loadStandardTests(testCases, failedCases);
+
+	CUDDFacade::Node* node = CreateMTBDDForTestCases(facade, testCases);
+
+	class SquareMonadicApplyFunctor
+		: public CUDDFacade::AbstractMonadicApplyFunctor
+	{
+	public:
+
+		virtual ValueType operator()(const ValueType& val)
+		{
+			return val*val;
+		}
+	};
+
+	SquareMonadicApplyFunctor squarer;
+
+	OperationContext context;
+	context.Cancel();
+
+	{
+		OperationContext::Scope scope(&context);
+		BOOST_CHECK_THROW(facade.MonadicApply(node, &squarer), OperationInterrupted);
+	}
+
+	// the interrupted Apply must not leave bogus results in the cache
+	CUDDFacade::Node* squaredNode = facade.MonadicApply(node, &squarer);
+	facade.Ref(squaredNode);
+
+	BOOST_CHECK_MESSAGE(ValueTableToString(GetValueTable(facade, squaredNode))
+		== SQUARED_TEST_CASES_TABLE,
+		"Stored table " + ValueTableToString(GetValueTable(facade, squaredNode))
+		+ Convert::ToString(" is not equal to expected table ")
+		+ SQUARED_TEST_CASES_TABLE);
+
+	facade.RecursiveDeref(squaredNode);
+	facade.RecursiveDeref(node);
+}
+
+
+BOOST_AUTO_TEST_CASE(telemetry_and_gc_hooks)
+{
+	CUDDFacade facade;
+
+	class CountingHookFunctor
+		: public CUDDFacade::AbstractHookFunctor
+	{
+	private:
+
+		unsigned preCount_;
+		unsigned postCount_;
+
+	public:
+
+		CountingHookFunctor()
+			: preCount_(0),
+				postCount_(0)
+		{ }
+
+		virtual void operator()(CUDDFacade::HookType type,
+			const CUDDFacade::Telemetry& telemetry)
+		{
+			BOOST_CHECK(telemetry.peakNodes >= telemetry.liveNodes);
+
+			if (type == CUDDFacade::HOOK_PRE_GC)
+			{
+				++preCount_;
+			}
+			else
+			{
+				++postCount_;
+			}
+		}
+
+		unsigned GetPreCount() const
+		{
+			return preCount_;
+		}
+
+		unsigned GetPostCount() const
+		{
+			return postCount_;
+		}
+	};
+
+	CountingHookFunctor counter;
+	facade.AddHook(CUDDFacade::HOOK_PRE_GC, &counter);
+	facade.AddHook(CUDDFacade::HOOK_POST_GC, &counter);
+
+	// load test cases
+	ListOfTestCasesType testCases;
+	ListOfTestCasesType failedCases;
+	loadStandardTests(testCases, failedCases);
+
+	CUDDFacade::Node* node = CreateMTBDDForTestCases(facade, testCases);
+
+	CUDDFacade::Telemetry telemetry = facade.GetTelemetry();
+	BOOST_CHECK_MESSAGE(telemetry.liveNodes >= facade.GetDagSize(node),
+		"Live nodes " + Convert::ToString(telemetry.liveNodes)
+		+ " are fewer than the nodes of the MTBDD");
+	BOOST_CHECK(telemetry.peakNodes >= telemetry.liveNodes);
+	BOOST_CHECK(telemetry.uniqueSlots > 0);
+	BOOST_CHECK(telemetry.memoryInUse > 0);
+	BOOST_CHECK((telemetry.cacheHitRate >= 0) && (telemetry.cacheHitRate <= 1));
+
+	// reordering collects garbage
+	facade.RecursiveDeref(node);
+	facade.ReorderSift();
+
+	telemetry = facade.GetTelemetry();
+	BOOST_CHECK(telemetry.garbageCollections > 0);
+	BOOST_CHECK(telemetry.reorderings > 0);
+	BOOST_CHECK(counter.GetPreCount() > 0);
+	BOOST_CHECK_MESSAGE(counter.GetPreCount() == counter.GetPostCount(),
+		"Pre-GC hook invoked " + Convert::ToString(counter.GetPreCount())
+		+ " times but post-GC hook invoked "
+		+ Convert::ToString(counter.GetPostCount()) + " times");
+
+	// removed hooks are not invoked any more
+	unsigned invocations = counter.GetPreCount();
+	facade.RemoveHook(CUDDFacade::HOOK_PRE_GC, &counter);
+	facade.RemoveHook(CUDDFacade::HOOK_POST_GC, &counter);
+	facade.ReorderSift();
+
+	BOOST_CHECK(counter.GetPreCount() == invocations);
+}
+
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -734,6 +734,65 @@ BOOST_AUTO_TEST_CASE(monadic_apply)
 }
 
 
+BOOST_AUTO_TEST_CASE(root_transfer)
+{
+	CuddMTBDDCC* source = new CuddMTBDDCC();
+	source->SetBottomValue(0);
+
+	CuddMTBDDCC* target = new CuddMTBDDCC();
+	target->SetBottomValue(0);
+
+	// load test cases
+	ListOfTestCasesType testCases;
+	ListOfTestCasesType failedCases;
+	loadStandardTests(testCases, failedCases);
+
+	RootType root = createMTBDDForTestCases(source, testCases);
+
+	// apply functor that squares values in leaves
+	class SquareMonadicApplyFunctor
+		: public ASMTBDDCC::AbstractMonadicApplyFunctorType
+	{
+	public:
+
+		virtual LeafType operator()(const LeafType& val)
+		{
+			return val * val;
+		}
+	};
+
+	SquareMonadicApplyFunctor func;
+
+	RootType transferredRoot = target->TransferRoot(*source, root, &func);
+
+	// the source is no longer needed
+	delete source;
+
+	for (ListOfTestCasesType::const_iterator itTests = testCases.begin();
+		itTests != testCases.end(); ++itTests)
+	{	// test that the test cases have been transferred properly
+#if DEBUG
+		BOOST_TEST_MESSAGE("Finding transferred " + *itTests);
+#endif
+		FormulaParser::ParserResultUnsignedType prsRes =
+			FormulaParser::ParseExpressionUnsigned(*itTests);
+		LeafType leafValue = static_cast<LeafType>(prsRes.first);
+		leafValue *= leafValue;
+		MyVariableAssignment asgn = varListToAsgn(prsRes.second);
+
+		ASMTBDDCC::LeafContainer res;
+		res.push_back(&leafValue);
+
+		BOOST_CHECK_MESSAGE(
+			compareTwoLeafContainers(target->GetValue(transferredRoot, asgn), res),
+			*itTests + " != " + leafContainerToString(target->GetValue(transferredRoot, asgn)));
+	}
+
+
+	delete target;
+}
+
+
 BOOST_AUTO_TEST_CASE(apply)
 {
 	ASMTBDDCC* bdd = new CuddMTBDDCC();
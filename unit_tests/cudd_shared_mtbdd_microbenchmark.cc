@@ -0,0 +1,510 @@
+/*****************************************************************************
+ *  Symbolic Finite Tree Automata Library
+ *
+ *  Description:
+ *    Microbenchmarks of primitive operations of CUDDSharedMTBDD class with
+ *    different leaf allocators.
+ *
+ *****************************************************************************/
+
+// Standard library headers
+#include <cstdlib>
+#include <ctime>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// SFTA headers
+#include <sfta/compact_variable_assignment.hh>
+#include <sfta/convert.hh>
+#include <sfta/cudd_shared_mtbdd.hh>
+#include <sfta/dual_hash_table_leaf_allocator.hh>
+#include <sfta/dual_map_leaf_allocator.hh>
+#include <sfta/map_leaf_allocator.hh>
+#include <sfta/map_root_allocator.hh>
+#include <sfta/slab_leaf_allocator.hh>
+
+using SFTA::AbstractSharedMTBDD;
+using SFTA::CUDDSharedMTBDD;
+using SFTA::Private::CUDDFacade;
+using SFTA::Private::Convert;
+
+// Boost headers
+#include <boost/random/mersenne_twister.hpp>
+
+// Log4cpp headers
+#include <log4cpp/Category.hh>
+#include <log4cpp/OstreamAppender.hh>
+
+
+/******************************************************************************
+ *                                  Constants                                 *
+ ******************************************************************************/
+
+
+/**
+ * Numbers of variables of the MTBDD to be swept
+ */
+const size_t VARIABLE_COUNTS[] = {8, 16, 32};
+
+/**
+ * Numbers of distinct leaves to be swept
+ */
+const size_t LEAF_COUNTS[] = {2, 16, 256};
+
+/**
+ * Ratios of entries shared among roots to be swept
+ */
+const double SHARING_RATIOS[] = {0.0, 0.5, 1.0};
+
+/**
+ * Number of roots in the MTBDD
+ */
+const size_t NUM_ROOTS = 8;
+
+/**
+ * The default number of entries of a root
+ */
+const size_t DEFAULT_OPERATIONS = 1000;
+
+/**
+ * The seed of the pseudorandom number generator
+ */
+const unsigned PRNG_SEED = 781436;
+
+
+/******************************************************************************
+ *                               Infrastructure                               *
+ ******************************************************************************/
+
+
+/**
+ * @brief  Configuration of a benchmark
+ */
+struct Configuration
+{
+	size_t variables;
+	size_t leaves;
+	double sharing;
+	size_t operations;
+
+	Configuration()
+		: variables(0),
+			leaves(0),
+			sharing(0),
+			operations(0)
+	{ }
+};
+
+
+/**
+ * @brief  Measures thread CPU time
+ */
+class Stopwatch
+{
+private:  // Private data members
+
+	timespec start_;
+
+public:   // Public methods
+
+	Stopwatch()
+		: start_()
+	{
+		Restart();
+	}
+
+	inline void Restart()
+	{
+		clock_gettime(CLOCK_THREAD_CPUTIME_ID, &start_);
+	}
+
+	double Elapsed() const
+	{
+		timespec now;
+		clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+		return (now.tv_sec - start_.tv_sec) + 1e-9 * (now.tv_nsec - start_.tv_nsec);
+	}
+};
+
+
+/**
+ * @brief  Prints a result of a benchmark
+ *
+ * Prints the result as a JSON object on a separate line.
+ */
+void report(const std::string& allocator, const Configuration& config,
+	const std::string& operation, size_t count, double seconds,
+	const std::string& extra = "")
+{
+	std::cout << "{\"allocator\":\"" << allocator << "\""
+		<< ",\"variables\":" << config.variables
+		<< ",\"leaves\":" << config.leaves
+		<< ",\"sharing\":" << config.sharing
+		<< ",\"operation\":\"" << operation << "\""
+		<< ",\"count\":" << count
+		<< ",\"seconds\":" << seconds
+		<< ",\"ns_per_op\":" << ((count > 0)? 1e9 * seconds / count : 0)
+		<< extra << "}\n";
+}
+
+
+/******************************************************************************
+ *                                 Benchmarks                                 *
+ ******************************************************************************/
+
+
+/**
+ * @brief  Benchmarks of a leaf allocator
+ *
+ * Benchmarks of primitive operations of CUDDSharedMTBDD with given leaf
+ * allocator (and SFTA::Private::MapRootAllocator).
+ *
+ * @tparam  LeafAllocator  The leaf allocator
+ */
+template
+<
+	template <typename, typename, class> class LeafAllocator
+>
+class Benchmark
+{
+private:  // Private data types
+
+	typedef unsigned RootType;
+	typedef unsigned LeafType;
+	typedef SFTA::Private::CompactVariableAssignment VariableAssignmentType;
+
+	typedef AbstractSharedMTBDD<RootType, LeafType, VariableAssignmentType>
+		ASMTBDD;
+
+	typedef CUDDSharedMTBDD<RootType, LeafType, VariableAssignmentType,
+		LeafAllocator, SFTA::Private::MapRootAllocator> MTBDDType;
+
+	typedef LeafAllocator<LeafType, CUDDFacade::ValueType,
+		CUDDFacade::AbstractMonadicApplyFunctor> LeafAllocatorType;
+
+	typedef std::pair<VariableAssignmentType, LeafType> EntryType;
+	typedef std::vector<EntryType> EntryVector;
+
+	/**
+	 * @brief  Leaf allocator with public interning
+	 */
+	class InterningAllocator
+		: public LeafAllocatorType
+	{
+	public:
+
+		inline CUDDFacade::ValueType Intern(const LeafType& leaf)
+		{
+			return LeafAllocatorType::createLeaf(leaf);
+		}
+	};
+
+	class AddApplyFunctor
+		: public ASMTBDD::AbstractApplyFunctorType
+	{
+	private:
+
+		LeafType leaves_;
+
+	public:
+
+		explicit AddApplyFunctor(LeafType leaves)
+			: leaves_(leaves)
+		{ }
+
+		virtual LeafType operator()(const LeafType& lhs, const LeafType& rhs)
+		{
+			return (lhs + rhs) % leaves_ + 1;
+		}
+	};
+
+	class AddTernaryApplyFunctor
+		: public ASMTBDD::AbstractTernaryApplyFunctorType
+	{
+	private:
+
+		LeafType leaves_;
+
+	public:
+
+		explicit AddTernaryApplyFunctor(LeafType leaves)
+			: leaves_(leaves)
+		{ }
+
+		virtual LeafType operator()(const LeafType& lhs, const LeafType& mhs,
+			const LeafType& rhs)
+		{
+			return (lhs + mhs + rhs) % leaves_ + 1;
+		}
+	};
+
+	class IncrementMonadicApplyFunctor
+		: public ASMTBDD::AbstractMonadicApplyFunctorType
+	{
+	private:
+
+		LeafType leaves_;
+
+	public:
+
+		explicit IncrementMonadicApplyFunctor(LeafType leaves)
+			: leaves_(leaves)
+		{ }
+
+		virtual LeafType operator()(const LeafType& val)
+		{
+			return val % leaves_ + 1;
+		}
+	};
+
+private:  // Private data members
+
+	std::string name_;
+
+	Configuration config_;
+
+	boost::mt19937 prng_;
+
+private:  // Private methods
+
+	Benchmark(const Benchmark&);
+	Benchmark& operator=(const Benchmark&);
+
+	VariableAssignmentType randomAssignment()
+	{
+		VariableAssignmentType asgn(config_.variables);
+		for (size_t i = 0; i < config_.variables; ++i)
+		{
+			asgn.SetIthVariableValue(i, (prng_() % 2)?
+				VariableAssignmentType::ONE : VariableAssignmentType::ZERO);
+		}
+
+		return asgn;
+	}
+
+	inline LeafType randomLeaf()
+	{
+		return static_cast<LeafType>(prng_() % config_.leaves) + 1;
+	}
+
+	/**
+	 * @brief  Generates entries of roots
+	 *
+	 * Generates the entries of every root; an entry is shared by all roots
+	 * with the probability given by the sharing ratio.
+	 */
+	std::vector<EntryVector> generateEntries()
+	{
+		EntryVector shared;
+		for (size_t i = 0; i < config_.operations; ++i)
+		{
+			shared.push_back(EntryType(randomAssignment(), randomLeaf()));
+		}
+
+		std::vector<EntryVector> result(NUM_ROOTS);
+		for (size_t root = 0; root < NUM_ROOTS; ++root)
+		{
+			for (size_t i = 0; i < config_.operations; ++i)
+			{
+				if ((prng_() % 1000) < config_.sharing * 1000)
+				{
+					result[root].push_back(shared[i]);
+				}
+				else
+				{
+					result[root].push_back(EntryType(randomAssignment(), randomLeaf()));
+				}
+			}
+		}
+
+		return result;
+	}
+
+	void benchmarkInterning()
+	{
+		std::vector<LeafType> leaves;
+		for (size_t i = 0; i < NUM_ROOTS * config_.operations; ++i)
+		{
+			leaves.push_back(randomLeaf());
+		}
+
+		InterningAllocator allocator;
+
+		Stopwatch watch;
+		for (size_t i = 0; i < leaves.size(); ++i)
+		{
+			allocator.Intern(leaves[i]);
+		}
+
+		report(name_, config_, "LeafInterning", leaves.size(), watch.Elapsed());
+	}
+
+	void benchmarkMTBDD()
+	{
+		std::vector<EntryVector> entries = generateEntries();
+		std::vector<VariableAssignmentType> queries;
+		for (size_t i = 0; i < config_.operations; ++i)
+		{
+			queries.push_back(randomAssignment());
+		}
+
+		MTBDDType bdd;
+		bdd.SetBottomValue(0);
+
+		Stopwatch watch;
+
+		// CreateRoot and EraseRoot of empty roots
+		for (size_t i = 0; i < config_.operations; ++i)
+		{
+			bdd.EraseRoot(bdd.CreateRoot());
+		}
+
+		report(name_, config_, "CreateRoot/EraseRoot", config_.operations,
+			watch.Elapsed());
+
+		// SetValue
+		std::vector<RootType> roots;
+		watch.Restart();
+		for (size_t root = 0; root < NUM_ROOTS; ++root)
+		{
+			roots.push_back(bdd.CreateRoot());
+			for (size_t i = 0; i < entries[root].size(); ++i)
+			{
+				bdd.SetValue(roots.back(), entries[root][i].first,
+					entries[root][i].second);
+			}
+		}
+
+		report(name_, config_, "SetValue", NUM_ROOTS * config_.operations,
+			watch.Elapsed(), ",\"nodes\":" + Convert::ToString(bdd.GetNodeCount()));
+
+		// GetValue
+		size_t found = 0;
+		watch.Restart();
+		for (size_t root = 0; root < NUM_ROOTS; ++root)
+		{
+			for (size_t i = 0; i < queries.size(); ++i)
+			{
+				found += bdd.GetValue(roots[root], queries[i]).size();
+			}
+		}
+
+		report(name_, config_, "GetValue", NUM_ROOTS * queries.size(),
+			watch.Elapsed(), ",\"leaves_found\":" + Convert::ToString(found));
+
+		// binary Apply
+		std::vector<RootType> results;
+		AddApplyFunctor addFunc(static_cast<LeafType>(config_.leaves));
+		watch.Restart();
+		for (size_t root = 0; root + 1 < NUM_ROOTS; ++root)
+		{
+			results.push_back(bdd.Apply(roots[root], roots[root + 1], &addFunc));
+		}
+
+		report(name_, config_, "Apply", NUM_ROOTS - 1, watch.Elapsed());
+
+		// ternary Apply
+		AddTernaryApplyFunctor ternaryFunc(static_cast<LeafType>(config_.leaves));
+		watch.Restart();
+		for (size_t root = 0; root + 2 < NUM_ROOTS; ++root)
+		{
+			results.push_back(bdd.TernaryApply(roots[root], roots[root + 1],
+				roots[root + 2], &ternaryFunc));
+		}
+
+		report(name_, config_, "TernaryApply", NUM_ROOTS - 2, watch.Elapsed());
+
+		// monadic Apply
+		IncrementMonadicApplyFunctor monadicFunc(static_cast<LeafType>(config_.leaves));
+		watch.Restart();
+		for (size_t root = 0; root < NUM_ROOTS; ++root)
+		{
+			results.push_back(bdd.MonadicApply(roots[root], &monadicFunc));
+		}
+
+		report(name_, config_, "MonadicApply", NUM_ROOTS, watch.Elapsed());
+
+		// EraseRoot of populated roots
+		results.insert(results.end(), roots.begin(), roots.end());
+		watch.Restart();
+		for (size_t i = 0; i < results.size(); ++i)
+		{
+			bdd.EraseRoot(results[i]);
+		}
+
+		report(name_, config_, "EraseRoot", results.size(), watch.Elapsed());
+	}
+
+public:   // Public methods
+
+	Benchmark(const std::string& name, const Configuration& config)
+		: name_(name),
+			config_(config),
+			prng_(PRNG_SEED)
+	{ }
+
+	void Run()
+	{
+		benchmarkInterning();
+		benchmarkMTBDD();
+	}
+};
+
+
+template
+<
+	template <typename, typename, class> class LeafAllocator
+>
+void sweep(const std::string& name, size_t operations)
+{
+	for (size_t v = 0; v < sizeof(VARIABLE_COUNTS) / sizeof(size_t); ++v)
+	{
+		for (size_t l = 0; l < sizeof(LEAF_COUNTS) / sizeof(size_t); ++l)
+		{
+			for (size_t s = 0; s < sizeof(SHARING_RATIOS) / sizeof(double); ++s)
+			{
+				Configuration config;
+				config.variables = VARIABLE_COUNTS[v];
+				config.leaves = LEAF_COUNTS[l];
+				config.sharing = SHARING_RATIOS[s];
+				config.operations = operations;
+
+				Benchmark<LeafAllocator> benchmark(name, config);
+				benchmark.Run();
+			}
+		}
+	}
+}
+
+
+int main(int argc, char* argv[])
+{
+	try
+	{
+		// only warnings are logged
+		log4cpp::Appender* app1  = new log4cpp::OstreamAppender("ClogAppender", &std::clog);
+		log4cpp::Category::getInstance("SFTA").setAdditivity(false);
+		log4cpp::Category::getInstance("SFTA").addAppender(app1);
+		log4cpp::Category::getInstance("SFTA").setPriority(log4cpp::Priority::WARN);
+
+		size_t operations = (argc > 1)?
+			Convert::FromString<size_t>(argv[1]) : DEFAULT_OPERATIONS;
+
+		sweep<SFTA::Private::MapLeafAllocator>("MapLeafAllocator", operations);
+		sweep<SFTA::Private::DualMapLeafAllocator>("DualMapLeafAllocator",
+			operations);
+		sweep<SFTA::Private::DualHashTableLeafAllocator>(
+			"DualHashTableLeafAllocator", operations);
+		sweep<SFTA::Private::SlabLeafAllocator>("SlabLeafAllocator", operations);
+	}
+	catch (std::exception& ex)
+	{
+		std::cerr << "An error occured: " << ex.what() << "\n";
+		std::cerr << "usage: " << argv[0] << " [<entries per root>]\n";
+
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
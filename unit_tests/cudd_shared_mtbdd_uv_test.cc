@@ -20,6 +20,7 @@
 
 using SFTA::AbstractSharedMTBDD;
 using SFTA::CUDDSharedMTBDD;
+using SFTA::MTBDDMemoryUsage;
 using SFTA::Private::Convert;
 using SFTA::Private::FormulaParser;
 
@@ -1006,6 +1007,52 @@ BOOST_AUTO_TEST_CASE(variable_trimming)
 	delete bdd;
 }
 
+BOOST_AUTO_TEST_CASE(memory_usage)
+{
+	CuddMTBDDUV* bdd = new CuddMTBDDUV();
+	bdd->SetBottomValue(LeafType());
+
+	ListOfTestCasesType testCases1;
+	ListOfTestCasesType testCases2;
+	loadStandardTests(testCases1, testCases2);
+
+	RootType root1 = createMTBDDForTestCases(bdd, testCases1);
+	RootType root2 = createMTBDDForTestCases(bdd, testCases2);
+
+	std::vector<RootType> roots1(1, root1);
+
+	MTBDDMemoryUsage usage1 = bdd->GetMemoryUsage(roots1);
+	MTBDDMemoryUsage usageAll = bdd->GetMemoryUsage();
+
+	BOOST_CHECK_EQUAL(usage1.roots, 1U);
+	BOOST_CHECK(usage1.leaves <= usage1.nodes);
+	BOOST_CHECK(usage1.exclusiveNodes <= usage1.nodes);
+	BOOST_CHECK(usage1.exclusiveLeaves <= usage1.leaves);
+	// the bottom is shared with the other root
+	BOOST_CHECK(usage1.exclusiveLeaves < usage1.leaves);
+	BOOST_CHECK(usage1.exclusiveNodeBytes > 0);
+
+	// everything is exclusive to the set of all roots
+	BOOST_CHECK_EQUAL(usageAll.nodes, usageAll.exclusiveNodes);
+	BOOST_CHECK_EQUAL(usageAll.leaves, usageAll.exclusiveLeaves);
+	BOOST_CHECK(usageAll.nodes >= usage1.nodes);
+
+	std::vector<RootType> roots12(roots1);
+	roots12.push_back(root2);
+	BOOST_CHECK(bdd->GetMemoryUsage(roots12).nodes <= usageAll.nodes);
+
+	// a copy of the MTBDD makes all its nodes shared
+	RootType root3 = createMTBDDForTestCases(bdd, testCases1);
+	usage1 = bdd->GetMemoryUsage(roots1);
+
+	BOOST_CHECK_EQUAL(usage1.exclusiveNodes, 0U);
+	BOOST_CHECK_EQUAL(usage1.exclusiveLeafBytes, 0U);
+
+	BOOST_CHECK(root3 != root1);
+
+	delete bdd;
+}
+
 #if 0
 BOOST_AUTO_TEST_CASE(serialization)
 {
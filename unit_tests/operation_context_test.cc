@@ -0,0 +1,128 @@
+/*****************************************************************************
+ *  Symbolic Finite Tree Automata Library
+ *
+ *  Description:
+ *    Test suite for OperationContext class.
+ *
+ *****************************************************************************/
+
+// POSIX headers
+#include <pthread.h>
+
+// SFTA headers
+#include <sfta/operation_context.hh>
+
+using SFTA::OperationContext;
+using SFTA::OperationInterrupted;
+
+// Boost headers
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE OperationContext
+#include <boost/test/unit_test.hpp>
+
+// testing headers
+#include "log_fixture.hh"
+
+
+/******************************************************************************
+ *                                  Fixtures                                  *
+ ******************************************************************************/
+
+/**
+ * @brief  Fixture for OperationContext
+ *
+ * Fixture with a context that is not current.
+ */
+class OperationContextFixture : public LogFixture
+{
+protected:// Protected data members
+
+	OperationContext context_;
+
+private:  // Private methods
+
+	OperationContextFixture(const OperationContextFixture&);
+	OperationContextFixture& operator=(const OperationContextFixture&);
+
+public:   // Public methods
+
+	OperationContextFixture()
+		: context_()
+	{ }
+
+	/**
+	 * @brief  Body of a thread
+	 *
+	 * Checks that the thread does not see the current context of another
+	 * thread and makes its own (cancelled) context current. The result of
+	 * the checks is stored into the bool pointed to by @p passed.
+	 */
+	static void* otherThread(void* passed)
+	{
+		bool& result = *static_cast<bool*>(passed);
+
+		// the context of the other thread is not visible
+		result = (OperationContext::GetCurrent() == static_cast<OperationContext*>(0));
+
+		OperationContext context;
+		context.Cancel();
+		OperationContext::Scope scope(&context);
+		result = result && (OperationContext::GetCurrent() == &context) &&
+			(OperationContext::PollCurrent() == OperationInterrupted::Cancelled);
+
+		return static_cast<void*>(0);
+	}
+};
+
+
+/******************************************************************************
+ *                              Start of testing                              *
+ ******************************************************************************/
+
+
+BOOST_FIXTURE_TEST_SUITE(suite, OperationContextFixture)
+
+BOOST_AUTO_TEST_CASE(scopes_nest)
+{
+	BOOST_CHECK(OperationContext::GetCurrent() == static_cast<OperationContext*>(0));
+
+	{
+		OperationContext::Scope scope(&context_);
+		BOOST_CHECK(OperationContext::GetCurrent() == &context_);
+
+		OperationContext inner;
+		{
+			OperationContext::Scope innerScope(&inner);
+			BOOST_CHECK(OperationContext::GetCurrent() == &inner);
+		}
+
+		// a scope without a context keeps the current one
+		{
+			OperationContext::Scope unlimitedScope(static_cast<OperationContext*>(0));
+			BOOST_CHECK(OperationContext::GetCurrent() == &context_);
+		}
+
+		BOOST_CHECK(OperationContext::GetCurrent() == &context_);
+	}
+
+	BOOST_CHECK(OperationContext::GetCurrent() == static_cast<OperationContext*>(0));
+}
+
+BOOST_AUTO_TEST_CASE(current_context_per_thread)
+{
+	OperationContext::Scope scope(&context_);
+
+	bool passed = false;
+	pthread_t thread;
+	BOOST_REQUIRE_EQUAL(pthread_create(&thread, static_cast<pthread_attr_t*>(0),
+		otherThread, &passed), 0);
+	BOOST_REQUIRE_EQUAL(pthread_join(thread, static_cast<void**>(0)), 0);
+	BOOST_CHECK(passed);
+
+	// the cancelled context of the other thread is not seen here
+	BOOST_CHECK(OperationContext::GetCurrent() == &context_);
+	BOOST_CHECK_EQUAL(OperationContext::PollCurrent(),
+		OperationInterrupted::NotInterrupted);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
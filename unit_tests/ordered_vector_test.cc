@@ -0,0 +1,363 @@
+/*****************************************************************************
+ *  Symbolic Finite Tree Automata Library
+ *
+ *  Description:
+ *    Test suite for OrderedVector class. The results are compared with
+ *    std::set, in particular around the transition of a set from the inline
+ *    storage to the heap.
+ *
+ *****************************************************************************/
+
+// Standard library headers
+#include <algorithm>
+#include <iterator>
+#include <set>
+#include <string>
+#include <vector>
+
+// SFTA headers
+#include <sfta/convert.hh>
+#include <sfta/ordered_vector.hh>
+
+using SFTA::Private::Convert;
+
+// Boost headers
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE OrderedVector
+#include <boost/test/unit_test.hpp>
+#include <boost/random/mersenne_twister.hpp>
+
+// testing headers
+#include "log_fixture.hh"
+
+
+/******************************************************************************
+ *                                  Constants                                 *
+ ******************************************************************************/
+
+/**
+ * The seed of the pseudorandom number generator
+ */
+const unsigned PRNG_SEED = 520613;
+
+/**
+ * The number of random sets compared with std::set
+ */
+const unsigned RANDOM_CASES = 200;
+
+/**
+ * The maximum size of a random set (well above the inline capacity)
+ */
+const unsigned MAX_RANDOM_SIZE = 40;
+
+/**
+ * The number of elements that fit into the inline storage of a set of
+ * unsigned integers (64 bytes, at most 8 elements)
+ */
+const size_t INLINE_ELEMENTS = 8;
+
+
+/******************************************************************************
+ *                                  Fixtures                                  *
+ ******************************************************************************/
+
+/**
+ * @brief  Fixture for OrderedVector
+ *
+ * Fixture with a pseudorandom generator of sets.
+ */
+class OrderedVectorFixture : public LogFixture
+{
+public:   // Public data types
+
+	typedef SFTA::OrderedVector<unsigned> NumberSet;
+	typedef SFTA::OrderedVector<std::string> StringSet;
+	typedef std::set<unsigned> ModelSet;
+
+protected:// Protected data members
+
+	boost::mt19937 prnGen_;
+
+public:   // Public methods
+
+	OrderedVectorFixture()
+		: prnGen_(PRNG_SEED)
+	{ }
+
+	/**
+	 * @brief  Fills a set and its model with random elements
+	 *
+	 * The elements are inserted one by one in random order, so that the set
+	 * is both appended to and inserted into in the middle.
+	 */
+	void randomSet(NumberSet& set, ModelSet& model)
+	{
+		size_t size = prnGen_() % MAX_RANDOM_SIZE;
+		for (size_t i = 0; i < size; ++i)
+		{
+			unsigned elem = prnGen_() % (2 * MAX_RANDOM_SIZE);
+			set.insert(elem);
+			model.insert(elem);
+		}
+	}
+
+	static bool matches(const NumberSet& set, const ModelSet& model)
+	{
+		return (set.size() == model.size()) &&
+			std::equal(set.begin(), set.end(), model.begin());
+	}
+};
+
+
+/******************************************************************************
+ *                              Start of testing                              *
+ ******************************************************************************/
+
+
+BOOST_FIXTURE_TEST_SUITE(suite, OrderedVectorFixture)
+
+BOOST_AUTO_TEST_CASE(inline_to_heap_transition)
+{
+	NumberSet set;
+	ModelSet model;
+
+	for (unsigned i = 0; i < 3 * INLINE_ELEMENTS; ++i)
+	{	// insert in descending order so that elements are shifted every time
+		unsigned elem = 1000 - 7 * i;
+		set.insert(elem);
+		model.insert(elem);
+
+		BOOST_CHECK(matches(set, model));
+		BOOST_CHECK_EQUAL(set.GetMemoryUsage() == 0, set.size() <= INLINE_ELEMENTS);
+		BOOST_CHECK(set.find(elem) != set.end());
+		BOOST_CHECK(set.find(elem + 1) == set.end());
+	}
+
+	// a set of the same elements built differently has the same hash
+	NumberSet other(std::vector<unsigned>(model.rbegin(), model.rend()));
+	BOOST_CHECK(other == set);
+	BOOST_CHECK_EQUAL(other.HashValue(), set.HashValue());
+
+	// clearing keeps the heap storage, which can be reused
+	set.clear();
+	BOOST_CHECK(set.empty());
+	BOOST_CHECK_EQUAL(set.HashValue(), NumberSet().HashValue());
+	set.insert(5);
+	BOOST_CHECK_EQUAL(set.size(), 1u);
+	BOOST_CHECK_EQUAL(set[0], 5u);
+}
+
+BOOST_AUTO_TEST_CASE(copies_across_storages)
+{
+	NumberSet small;
+	NumberSet large;
+	for (unsigned i = 0; i < INLINE_ELEMENTS; ++i)
+	{
+		small.insert(i);
+	}
+
+	for (unsigned i = 0; i < 4 * INLINE_ELEMENTS; ++i)
+	{
+		large.insert(100 + i);
+	}
+
+	NumberSet smallCopy(small);
+	NumberSet largeCopy(large);
+
+	// a set on the heap assigned to an inline one and vice versa
+	NumberSet tmp(small);
+	tmp = large;
+	BOOST_CHECK(tmp == large);
+	tmp = small;
+	BOOST_CHECK(tmp == small);
+
+	// swapping an inline set with a set on the heap
+	small.Swap(large);
+	BOOST_CHECK(small == largeCopy);
+	BOOST_CHECK(large == smallCopy);
+
+	// swapping two sets on the heap exchanges only the arrays
+	NumberSet largeToo(largeCopy);
+	largeToo.insert(1);
+	NumberSet largeTooCopy(largeToo);
+	largeToo.Swap(small);
+	BOOST_CHECK(largeToo == largeCopy);
+	BOOST_CHECK(small == largeTooCopy);
+}
+
+BOOST_AUTO_TEST_CASE(swap_passes_the_heap_array)
+{
+	NumberSet small;
+	NumberSet large;
+	small.insert(3);
+	for (unsigned i = 0; i < 4 * INLINE_ELEMENTS; ++i)
+	{
+		large.insert(i);
+	}
+
+	NumberSet smallCopy(small);
+	NumberSet largeCopy(large);
+	const unsigned* largeArray = &large[0];
+
+	// the array on the heap is not copied in either direction
+	small.Swap(large);
+	BOOST_CHECK(small == largeCopy);
+	BOOST_CHECK(large == smallCopy);
+	BOOST_CHECK_EQUAL(&small[0], largeArray);
+	BOOST_CHECK_EQUAL(large.GetMemoryUsage(), 0u);
+
+	small.Swap(large);
+	BOOST_CHECK(small == smallCopy);
+	BOOST_CHECK(large == largeCopy);
+	BOOST_CHECK_EQUAL(&large[0], largeArray);
+	BOOST_CHECK_EQUAL(small.GetMemoryUsage(), 0u);
+
+	// the swapped sets stay usable
+	small.insert(large);
+	large.insert(100);
+	BOOST_CHECK_EQUAL(small.size(), largeCopy.size());
+	BOOST_CHECK_EQUAL(large.size(), largeCopy.size() + 1);
+
+	// inserting a range into an empty set takes the new array over
+	NumberSet fromRange;
+	std::vector<unsigned> elements(largeCopy.begin(), largeCopy.end());
+	std::reverse(elements.begin(), elements.end());
+	fromRange.insert(elements.begin(), elements.end());
+	BOOST_CHECK(fromRange == largeCopy);
+	BOOST_CHECK_EQUAL(fromRange.HashValue(), largeCopy.HashValue());
+}
+
+BOOST_AUTO_TEST_CASE(intersection_and_difference)
+{
+	NumberSet empty;
+	NumberSet small;
+	NumberSet large;
+	NumberSet disjoint;
+	for (unsigned i = 0; i < 4; ++i)
+	{	// 0, 2, 4, 6
+		small.insert(2 * i);
+	}
+
+	for (unsigned i = 0; i < 4 * INLINE_ELEMENTS; ++i)
+	{	// 0, 1, ..., 31
+		large.insert(i);
+		disjoint.insert(1000 + i);
+	}
+
+	// empty sets
+	BOOST_CHECK(empty.Intersection(large).empty());
+	BOOST_CHECK(large.Intersection(empty).empty());
+	BOOST_CHECK(empty.Difference(large).empty());
+	BOOST_CHECK(large.Difference(empty) == large);
+	BOOST_CHECK_EQUAL(large.Difference(empty).HashValue(), large.HashValue());
+
+	// disjoint sets
+	BOOST_CHECK(large.Intersection(disjoint).empty());
+	BOOST_CHECK_EQUAL(large.Intersection(disjoint).HashValue(),
+		empty.HashValue());
+	BOOST_CHECK(large.Difference(disjoint) == large);
+	BOOST_CHECK(small.Difference(disjoint) == small);
+
+	// an inline set and a set on the heap
+	BOOST_CHECK(small.Intersection(large) == small);
+	BOOST_CHECK(large.Intersection(small) == small);
+	BOOST_CHECK_EQUAL(large.Intersection(small).HashValue(), small.HashValue());
+	BOOST_CHECK(small.Difference(large).empty());
+
+	NumberSet largeWithoutSmall = large.Difference(small);
+	BOOST_CHECK_EQUAL(largeWithoutSmall.size(), large.size() - small.size());
+	BOOST_CHECK(largeWithoutSmall.Intersection(small).empty());
+	BOOST_CHECK(largeWithoutSmall.Union(small) == large);
+	BOOST_CHECK_EQUAL(largeWithoutSmall.Union(small).HashValue(),
+		large.HashValue());
+
+	NumberSet largeTail = large.Difference(largeWithoutSmall.Difference(small));
+	BOOST_CHECK(largeTail == small);
+	BOOST_CHECK_EQUAL(large.Intersection(largeWithoutSmall).size(),
+		largeWithoutSmall.size());
+}
+
+BOOST_AUTO_TEST_CASE(operations_match_std_set)
+{
+	for (unsigned i = 0; i < RANDOM_CASES; ++i)
+	{
+		NumberSet lhs;
+		NumberSet rhs;
+		ModelSet lhsModel;
+		ModelSet rhsModel;
+		randomSet(lhs, lhsModel);
+		randomSet(rhs, rhsModel);
+
+		BOOST_REQUIRE(matches(lhs, lhsModel));
+		BOOST_REQUIRE(matches(rhs, rhsModel));
+
+		ModelSet unionModel(lhsModel);
+		unionModel.insert(rhsModel.begin(), rhsModel.end());
+
+		NumberSet unionSet = lhs.Union(rhs);
+		BOOST_CHECK(matches(unionSet, unionModel));
+
+		// the in-place union may move the set from the inline storage
+		NumberSet merged(lhs);
+		merged.insert(rhs);
+		BOOST_CHECK(matches(merged, unionModel));
+		BOOST_CHECK(merged == unionSet);
+		BOOST_CHECK_EQUAL(merged.HashValue(), unionSet.HashValue());
+
+		ModelSet intersectionModel;
+		std::set_intersection(lhsModel.begin(), lhsModel.end(), rhsModel.begin(),
+			rhsModel.end(), std::inserter(intersectionModel,
+			intersectionModel.begin()));
+		NumberSet intersectionSet = lhs.Intersection(rhs);
+		BOOST_CHECK(matches(intersectionSet, intersectionModel));
+		BOOST_CHECK_EQUAL(intersectionSet.HashValue(),
+			NumberSet(std::vector<unsigned>(intersectionModel.begin(),
+			intersectionModel.end())).HashValue());
+
+		ModelSet differenceModel;
+		std::set_difference(lhsModel.begin(), lhsModel.end(), rhsModel.begin(),
+			rhsModel.end(), std::inserter(differenceModel,
+			differenceModel.begin()));
+		NumberSet differenceSet = lhs.Difference(rhs);
+		BOOST_CHECK(matches(differenceSet, differenceModel));
+		BOOST_CHECK_EQUAL(differenceSet.HashValue(),
+			NumberSet(std::vector<unsigned>(differenceModel.begin(),
+			differenceModel.end())).HashValue());
+
+		BOOST_CHECK_EQUAL(lhs.IsSubsetOf(rhs), std::includes(rhsModel.begin(),
+			rhsModel.end(), lhsModel.begin(), lhsModel.end()));
+		BOOST_CHECK(lhs.IsSubsetOf(unionSet));
+		BOOST_CHECK_EQUAL(lhs == rhs, lhsModel == rhsModel);
+		BOOST_CHECK_EQUAL(lhs < rhs, lhsModel < rhsModel);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(non_trivial_elements)
+{
+	// only two strings fit into the inline storage
+	StringSet set;
+	std::set<std::string> model;
+	for (unsigned i = 0; i < 20; ++i)
+	{
+		std::string elem = "element number " + Convert::ToString(i % 13) +
+			" with a name too long for the small string optimization";
+		set.insert(elem);
+		model.insert(elem);
+	}
+
+	BOOST_REQUIRE_EQUAL(set.size(), model.size());
+	BOOST_CHECK(std::equal(set.begin(), set.end(), model.begin()));
+
+	StringSet copy(set);
+	StringSet small;
+	small.insert("a");
+	copy.Swap(small);
+	BOOST_CHECK_EQUAL(copy.size(), 1u);
+	BOOST_CHECK(small == set);
+
+	small.insert(copy);
+	BOOST_CHECK_EQUAL(small.size(), set.size() + 1);
+	BOOST_CHECK_EQUAL(small[0], "a");
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,175 @@
+/*****************************************************************************
+ *  Symbolic Finite Tree Automata Library
+ *
+ *  Description:
+ *    Test suite for RandomTAGenerator class.
+ *
+ *****************************************************************************/
+
+// Standard library headers
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+// SFTA headers
+#include <sfta/random_ta_generator.hh>
+
+using SFTA::RandomTAGenerator;
+
+// Boost headers
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE RandomTAGenerator
+#include <boost/test/unit_test.hpp>
+
+// testing headers
+#include "log_fixture.hh"
+
+
+/******************************************************************************
+ *                                  Constants                                 *
+ ******************************************************************************/
+
+/**
+ * The automaton generated with 3 states, transition density 1 and seed 42
+ * (the generator needs to give it on every platform)
+ */
+const char* const SMALL_AUTOMATON =
+	"Ops a0:0 a1:2\n"
+	"\n"
+	"Automaton random\n"
+	"\n"
+	"States q0:0 q1:0 q2:0\n"
+	"\n"
+	"Final States q1 q2\n"
+	"\n"
+	"Transitions\n"
+	"a0 -> q0\n"
+	"a0 -> q1\n"
+	"a0 -> q2\n"
+	"a1(q1,q2) -> q0\n"
+	"a1(q2,q1) -> q1\n"
+	"a1(q2,q2) -> q1\n";
+
+
+/******************************************************************************
+ *                                  Fixtures                                  *
+ ******************************************************************************/
+
+/**
+ * @brief  Fixture for RandomTAGenerator
+ *
+ * Fixture with parameters of a symbolic automaton of a moderate size.
+ */
+class RandomTAGeneratorFixture : public LogFixture
+{
+protected:// Protected data members
+
+	RandomTAGenerator::Parameters params_;
+
+public:   // Public methods
+
+	RandomTAGeneratorFixture()
+		: params_()
+	{
+		params_.states = 40;
+		params_.arities.push_back(0);
+		params_.arities.push_back(1);
+		params_.arities.push_back(2);
+		params_.arities.push_back(3);
+		params_.symbolBits = 12;
+		params_.seed = 1234;
+	}
+
+	static std::string timbuk(const RandomTAGenerator::Parameters& params)
+	{
+		std::ostringstream os;
+		RandomTAGenerator(params).WriteTimbuk(os);
+		return os.str();
+	}
+};
+
+
+/******************************************************************************
+ *                              Start of testing                              *
+ ******************************************************************************/
+
+
+BOOST_FIXTURE_TEST_SUITE(suite, RandomTAGeneratorFixture)
+
+BOOST_AUTO_TEST_CASE(same_seed_same_output)
+{
+	std::string output = timbuk(params_);
+	BOOST_CHECK(!output.empty());
+
+	// byte-identical output from another generator with the same parameters
+	BOOST_CHECK(timbuk(params_) == output);
+
+	RandomTAGenerator generator(params_);
+	std::ostringstream first;
+	std::ostringstream second;
+	generator.WriteTimbuk(first);
+	generator.WriteTimbuk(second);
+	BOOST_CHECK(first.str() == output);
+	BOOST_CHECK(second.str() == output);
+
+	// another seed gives another automaton
+	params_.seed = 1235;
+	BOOST_CHECK(timbuk(params_) != output);
+}
+
+BOOST_AUTO_TEST_CASE(output_is_portable)
+{
+	RandomTAGenerator::Parameters params;
+	params.states = 3;
+	params.transitionDensity = 1.0;
+	params.seed = 42;
+
+	BOOST_CHECK_EQUAL(timbuk(params), SMALL_AUTOMATON);
+}
+
+BOOST_AUTO_TEST_CASE(transitions_beyond_64_bits)
+{
+	// 100000^4 candidate transitions of the ternary symbol do not fit into
+	// 64 bits
+	RandomTAGenerator::Parameters params;
+	params.states = 100000;
+	params.arities.assign(1, 3);
+	params.transitionDensity = 0.01;
+	params.seed = 7;
+
+	std::istringstream output(timbuk(params));
+	std::set<std::string> transitions;
+	size_t lines = 0;
+	std::string line;
+	while (std::getline(output, line))
+	{	// collect the transitions
+		if (line.find(" -> ") != std::string::npos)
+		{
+			++lines;
+			transitions.insert(line);
+		}
+	}
+
+	BOOST_CHECK_EQUAL(lines, 1000u);
+	BOOST_CHECK_EQUAL(transitions.size(), lines);
+}
+
+BOOST_AUTO_TEST_CASE(invalid_parameters)
+{
+	RandomTAGenerator::Parameters params;
+	params.states = 0;
+	BOOST_CHECK_THROW(RandomTAGenerator generator(params), std::runtime_error);
+
+	params.states = 10;
+	params.finalDensity = 1.5;
+	BOOST_CHECK_THROW(RandomTAGenerator generator(params), std::runtime_error);
+
+	// symbols too short for the encoding of arities
+	params.finalDensity = 0.5;
+	params.arities.assign(1, 5);
+	params.symbolBits = 2;
+	BOOST_CHECK_THROW(timbuk(params), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
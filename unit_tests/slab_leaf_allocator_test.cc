@@ -0,0 +1,254 @@
+/*****************************************************************************
+ *  Symbolic Finite Tree Automata Library
+ *
+ *  Description:
+ *    Test suite for SlabLeafAllocator class.
+ *
+ *****************************************************************************/
+
+// Standard library headers
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// SFTA headers
+#include <sfta/convert.hh>
+#include <sfta/slab_leaf_allocator.hh>
+
+using SFTA::Private::Convert;
+
+// Boost headers
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE SlabLeafAllocator
+#include <boost/test/unit_test.hpp>
+
+// testing headers
+#include "log_fixture.hh"
+
+
+/******************************************************************************
+ *                                  Constants                                 *
+ ******************************************************************************/
+
+/**
+ * The number of leaves that need several blocks of the slab and several
+ * growths of the table
+ */
+const unsigned MANY_LEAVES = 5000;
+
+/**
+ * The number of distinct hashes of colliding leaves
+ */
+const unsigned COLLIDING_HASHES = 3;
+
+
+/******************************************************************************
+ *                                  Fixtures                                  *
+ ******************************************************************************/
+
+/**
+ * @brief  Leaf with colliding hashes
+ *
+ * Leaf the hashes of which are mostly the same, so that the table needs to
+ * probe.
+ */
+struct CollidingLeaf
+{
+	unsigned value;
+
+	CollidingLeaf()
+		: value(0)
+	{ }
+
+	explicit CollidingLeaf(unsigned val)
+		: value(val)
+	{ }
+
+	bool operator==(const CollidingLeaf& rhs) const
+	{
+		return value == rhs.value;
+	}
+
+	friend size_t hash_value(const CollidingLeaf& leaf)
+	{
+		return leaf.value % COLLIDING_HASHES;
+	}
+};
+
+/**
+ * @brief  Monadic Apply functor
+ *
+ * The abstract monadic Apply functor the allocator derives its releaser
+ * from.
+ */
+class AbstractMonadicApplyFunctor
+{
+public:
+
+	virtual unsigned operator()(const unsigned& val) = 0;
+
+	virtual ~AbstractMonadicApplyFunctor()
+	{ }
+};
+
+/**
+ * @brief  Allocator with public interface
+ *
+ * Makes the interface of the allocator, which is used by the MTBDD it is
+ * a policy of, accessible to tests.
+ */
+template <typename Leaf>
+class PublicSlabLeafAllocator
+	: public SFTA::Private::SlabLeafAllocator<Leaf, unsigned,
+		AbstractMonadicApplyFunctor>
+{
+private:  // Private data types
+
+	typedef SFTA::Private::SlabLeafAllocator<Leaf, unsigned,
+		AbstractMonadicApplyFunctor> LA;
+
+public:   // Public methods
+
+	using LA::BOTTOM;
+	using LA::setBottom;
+	using LA::createLeaf;
+	using LA::getLeafOfHandle;
+	using LA::getAllHandles;
+	using LA::getLeafReleaser;
+};
+
+/**
+ * @brief  Fixture for SlabLeafAllocator
+ *
+ * Fixture with an allocator of strings, the bottom of which is the empty
+ * string.
+ */
+class SlabLeafAllocatorFixture : public LogFixture
+{
+public:   // Public data types
+
+	typedef PublicSlabLeafAllocator<std::string> StringAllocator;
+	typedef PublicSlabLeafAllocator<CollidingLeaf> CollidingAllocator;
+
+protected:// Protected data members
+
+	StringAllocator allocator_;
+
+private:  // Private methods
+
+	SlabLeafAllocatorFixture(const SlabLeafAllocatorFixture&);
+	SlabLeafAllocatorFixture& operator=(const SlabLeafAllocatorFixture&);
+
+public:   // Public methods
+
+	SlabLeafAllocatorFixture()
+		: allocator_()
+	{
+		allocator_.setBottom("");
+	}
+
+	static std::string leafName(unsigned i)
+	{
+		return "leaf " + Convert::ToString(i);
+	}
+};
+
+
+/******************************************************************************
+ *                              Start of testing                              *
+ ******************************************************************************/
+
+
+BOOST_FIXTURE_TEST_SUITE(suite, SlabLeafAllocatorFixture)
+
+BOOST_AUTO_TEST_CASE(interning_identity)
+{
+	unsigned aHandle = allocator_.createLeaf("a");
+	unsigned bHandle = allocator_.createLeaf("b");
+
+	BOOST_CHECK(aHandle != bHandle);
+	BOOST_CHECK_EQUAL(allocator_.createLeaf("a"), aHandle);
+	BOOST_CHECK_EQUAL(allocator_.createLeaf(std::string("b")), bHandle);
+
+	BOOST_CHECK_EQUAL(allocator_.getLeafOfHandle(aHandle), "a");
+	BOOST_CHECK_EQUAL(allocator_.getLeafOfHandle(bHandle), "b");
+
+	// the bottom and the two leaves
+	BOOST_CHECK_EQUAL(allocator_.getAllHandles().size(), 3u);
+
+	// the releaser keeps the handles
+	BOOST_CHECK_EQUAL((*allocator_.getLeafReleaser())(aHandle), aHandle);
+}
+
+BOOST_AUTO_TEST_CASE(bottom_handle)
+{
+	BOOST_CHECK_EQUAL(allocator_.createLeaf(""), StringAllocator::BOTTOM);
+	BOOST_CHECK_EQUAL(allocator_.getLeafOfHandle(StringAllocator::BOTTOM), "");
+
+	std::vector<unsigned> handles = allocator_.getAllHandles();
+	BOOST_REQUIRE_EQUAL(handles.size(), 1u);
+	BOOST_CHECK_EQUAL(handles[0], StringAllocator::BOTTOM);
+
+	// a bottom other than the default leaf
+	StringAllocator other;
+	other.setBottom("bottom");
+	BOOST_CHECK_EQUAL(other.createLeaf("bottom"), StringAllocator::BOTTOM);
+	BOOST_CHECK(other.createLeaf("") != StringAllocator::BOTTOM);
+	BOOST_CHECK_EQUAL(other.getLeafOfHandle(StringAllocator::BOTTOM), "bottom");
+
+	// handles that were not created are not managed
+	BOOST_CHECK_THROW(allocator_.getLeafOfHandle(StringAllocator::BOTTOM + 1),
+		std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(growth_keeps_handles_and_leaves)
+{
+	std::vector<unsigned> handles;
+	const std::string* firstLeaf = static_cast<const std::string*>(0);
+
+	for (unsigned i = 0; i < MANY_LEAVES; ++i)
+	{	// the slab and the table grow several times
+		handles.push_back(allocator_.createLeaf(leafName(i)));
+		if (i == 0)
+		{
+			firstLeaf = &allocator_.getLeafOfHandle(handles[0]);
+		}
+	}
+
+	// leaves do not move when the slab grows
+	BOOST_CHECK_EQUAL(&allocator_.getLeafOfHandle(handles[0]), firstLeaf);
+	BOOST_CHECK_EQUAL(allocator_.getAllHandles().size(), MANY_LEAVES + 1);
+
+	for (unsigned i = 0; i < MANY_LEAVES; ++i)
+	{	// leaves are found after the table was rehashed
+		BOOST_CHECK_EQUAL(allocator_.createLeaf(leafName(i)), handles[i]);
+		BOOST_CHECK_EQUAL(allocator_.getLeafOfHandle(handles[i]), leafName(i));
+	}
+
+	BOOST_CHECK_EQUAL(allocator_.createLeaf(""), StringAllocator::BOTTOM);
+	BOOST_CHECK_EQUAL(allocator_.getAllHandles().size(), MANY_LEAVES + 1);
+}
+
+BOOST_AUTO_TEST_CASE(colliding_hashes)
+{
+	CollidingAllocator allocator;
+	allocator.setBottom(CollidingLeaf(0));
+
+	std::vector<unsigned> handles;
+	for (unsigned i = 0; i < MANY_LEAVES; ++i)
+	{	// long probe sequences that survive growths of the table
+		handles.push_back(allocator.createLeaf(CollidingLeaf(i)));
+	}
+
+	BOOST_CHECK_EQUAL(handles[0], CollidingAllocator::BOTTOM);
+	BOOST_CHECK_EQUAL(allocator.getAllHandles().size(), MANY_LEAVES);
+
+	for (unsigned i = MANY_LEAVES; i > 0; --i)
+	{
+		BOOST_CHECK_EQUAL(allocator.createLeaf(CollidingLeaf(i - 1)),
+			handles[i - 1]);
+		BOOST_CHECK_EQUAL(allocator.getLeafOfHandle(handles[i - 1]).value, i - 1);
+	}
+}
+
+BOOST_AUTO_TEST_SUITE_END()
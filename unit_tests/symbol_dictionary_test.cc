@@ -0,0 +1,271 @@
+/*****************************************************************************
+ *  Symbolic Finite Tree Automata Library
+ *
+ *  Description:
+ *    Test suite for SymbolDictionary class.
+ *
+ *****************************************************************************/
+
+// Standard library headers
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// SFTA headers
+#include <sfta/compact_variable_assignment.hh>
+#include <sfta/convert.hh>
+#include <sfta/symbol_dictionary.hh>
+
+using SFTA::Private::CompactVariableAssignment;
+using SFTA::Private::Convert;
+
+// Boost headers
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE SymbolDictionary
+#include <boost/test/unit_test.hpp>
+#include <boost/random/mersenne_twister.hpp>
+
+// testing headers
+#include "log_fixture.hh"
+
+
+/******************************************************************************
+ *                                  Constants                                 *
+ ******************************************************************************/
+
+/**
+ * The number of variables used for the arity
+ */
+const size_t ARITY_BITS = 4;
+
+/**
+ * The seed of the pseudorandom number generator
+ */
+const unsigned PRNG_SEED = 170513;
+
+/**
+ * The number of random patterns compared with the codes of all symbols
+ */
+const unsigned RANDOM_PATTERNS = 500;
+
+
+/******************************************************************************
+ *                                  Fixtures                                  *
+ ******************************************************************************/
+
+/**
+ * @brief  Fixture for SymbolDictionary
+ *
+ * Fixture with a dictionary that has registered the alphabet a:0 b:0 c:0 f:2.
+ */
+class SymbolDictionaryFixture : public LogFixture
+{
+public:   // Public data types
+
+	typedef SFTA::SymbolDictionary<std::string, CompactVariableAssignment>
+		DictionaryType;
+
+protected:// Protected data members
+
+	DictionaryType dict_;
+
+public:   // Public methods
+
+	SymbolDictionaryFixture()
+		: dict_(ARITY_BITS)
+	{
+		DictionaryType::RankedSymbolVector alphabet;
+		alphabet.push_back(std::make_pair("a", 0));
+		alphabet.push_back(std::make_pair("b", 0));
+		alphabet.push_back(std::make_pair("c", 0));
+		alphabet.push_back(std::make_pair("f", 2));
+
+		dict_.TranslateAll(alphabet);
+	}
+
+	/**
+	 * @brief  Inverse translation by brute force
+	 *
+	 * Returns the symbols whose codes overlap with the pattern, ordered by
+	 * arity and then by their positions.
+	 */
+	static std::vector<std::string> overlappingSymbols(DictionaryType& dict,
+		const CompactVariableAssignment& pattern)
+	{
+		const DictionaryType::RankedSymbolVector& symbols =
+			dict.GetVectorOfRankedSymbols();
+
+		std::vector<std::vector<std::string> > byArity(1 << ARITY_BITS);
+		for (size_t i = 0; i < symbols.size(); ++i)
+		{	// symbols of an arity are registered in the order of positions
+			if (dict.Translate(symbols[i].first, symbols[i].second).Overlaps(pattern))
+			{
+				byArity[symbols[i].second].push_back(symbols[i].first);
+			}
+		}
+
+		std::vector<std::string> result;
+		for (size_t arity = 0; arity < byArity.size(); ++arity)
+		{
+			result.insert(result.end(), byArity[arity].begin(), byArity[arity].end());
+		}
+
+		return result;
+	}
+};
+
+
+/******************************************************************************
+ *                              Start of testing                              *
+ ******************************************************************************/
+
+
+BOOST_FIXTURE_TEST_SUITE(suite, SymbolDictionaryFixture)
+
+BOOST_AUTO_TEST_CASE(first_field_fits_alphabet)
+{
+	// three symbols of arity 0 and the escape fit into a field of two variables
+	BOOST_CHECK_EQUAL(dict_.GetSymbolWidth(), ARITY_BITS + 2);
+
+	BOOST_CHECK_EQUAL(dict_.Translate("a", 0), CompactVariableAssignment(6, 0x00));
+	BOOST_CHECK_EQUAL(dict_.Translate("b", 0), CompactVariableAssignment(6, 0x10));
+	BOOST_CHECK_EQUAL(dict_.Translate("c", 0), CompactVariableAssignment(6, 0x20));
+	BOOST_CHECK_EQUAL(dict_.Translate("f", 2), CompactVariableAssignment(6, 0x02));
+
+	BOOST_CHECK_EQUAL(dict_.TranslateInverse(dict_.Translate("a", 0)), "a");
+	BOOST_CHECK_EQUAL(dict_.TranslateInverse(dict_.Translate("c", 0)), "c");
+	BOOST_CHECK_EQUAL(dict_.TranslateInverse(dict_.Translate("f", 2)), "f");
+}
+
+BOOST_AUTO_TEST_CASE(field_grows_on_demand)
+{
+	CompactVariableAssignment aCode = dict_.Translate("a", 0);
+
+	// the fourth symbol of arity 0 takes the escape into a new field
+	CompactVariableAssignment dCode = dict_.Translate("d", 0);
+	BOOST_CHECK_EQUAL(dict_.GetSymbolWidth(), ARITY_BITS + 4);
+	BOOST_CHECK_EQUAL(dCode, CompactVariableAssignment(8, 0x30));
+
+	// codes of older symbols do not change
+	BOOST_CHECK_EQUAL(dict_.Translate("a", 0), aCode);
+	BOOST_CHECK_EQUAL(dict_.TranslateInverse(dCode), "d");
+
+	// the variables above a short code are don't care
+	BOOST_CHECK_EQUAL(dict_.TranslateInverse(CompactVariableAssignment(8, 0xc0)),
+		"a");
+	BOOST_CHECK_EQUAL(dict_.TranslateInverse(CompactVariableAssignment(8, 0x50)),
+		"b");
+
+	// an escape without the next field does not denote a symbol
+	BOOST_CHECK_THROW(dict_.TranslateInverse(CompactVariableAssignment(6, 0x30)),
+		std::runtime_error);
+
+	// a position after the last symbol is unknown
+	BOOST_CHECK_THROW(dict_.TranslateInverse(CompactVariableAssignment(8, 0x70)),
+		std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(codes_stay_disjoint)
+{
+	const size_t SYMBOLS = 100;
+
+	std::vector<CompactVariableAssignment> codes;
+	for (size_t i = 0; i < SYMBOLS; ++i)
+	{	// register enough symbols to need several fields
+		codes.push_back(dict_.Translate("g" + Convert::ToString(i), 1));
+	}
+
+	codes.push_back(dict_.Translate("a", 0));
+	codes.push_back(dict_.Translate("f", 2));
+
+	for (size_t i = 0; i < codes.size(); ++i)
+	{
+		BOOST_CHECK(codes[i].VariablesCount() <= dict_.GetSymbolWidth());
+
+		for (size_t j = i + 1; j < codes.size(); ++j)
+		{
+			BOOST_CHECK_MESSAGE(!codes[i].Overlaps(codes[j]),
+				"codes " + Convert::ToString(codes[i]) + " and " +
+				Convert::ToString(codes[j]) + " overlap");
+		}
+	}
+
+	for (size_t i = 0; i < SYMBOLS; ++i)
+	{
+		BOOST_CHECK_EQUAL(dict_.TranslateInverse(codes[i]),
+			"g" + Convert::ToString(i));
+	}
+}
+
+BOOST_AUTO_TEST_CASE(inverse_of_pattern)
+{
+	dict_.Translate("d", 0);
+
+	// the universal pattern denotes every symbol exactly once
+	std::vector<std::string> all = dict_.TranslateInverseAll(
+		CompactVariableAssignment(dict_.GetSymbolWidth()));
+	BOOST_REQUIRE_EQUAL(all.size(), 5u);
+	BOOST_CHECK_EQUAL(all[0], "a");
+	BOOST_CHECK_EQUAL(all[3], "d");
+	BOOST_CHECK_EQUAL(all[4], "f");
+
+	// a pattern fixing the arity
+	BOOST_CHECK(dict_.TranslateInverseAll(CompactVariableAssignment("0100XXXX")) ==
+		std::vector<std::string>(1, "f"));
+
+	// a pattern fixing the first field to the escape
+	BOOST_CHECK(dict_.TranslateInverseAll(CompactVariableAssignment("000011XX")) ==
+		std::vector<std::string>(1, "d"));
+}
+
+BOOST_AUTO_TEST_CASE(inverse_of_random_patterns)
+{
+	boost::mt19937 prnGen(PRNG_SEED);
+
+	for (int gray = 0; gray < 2; ++gray)
+	{	// both codings
+		DictionaryType dict(ARITY_BITS);
+		dict.SetGrayCoding(gray != 0);
+
+		DictionaryType::RankedSymbolVector alphabet;
+		alphabet.push_back(std::make_pair("a", 0));
+		alphabet.push_back(std::make_pair("f", 1));
+		dict.TranslateAll(alphabet);
+
+		for (unsigned i = 0; i < 300; ++i)
+		{	// grow several fields
+			dict.Translate("g" + Convert::ToString(i), 1 + i % 3);
+			if (i % 5 == 0)
+			{
+				dict.Translate("c" + Convert::ToString(i), 0);
+			}
+		}
+
+		const DictionaryType::RankedSymbolVector& symbols =
+			dict.GetVectorOfRankedSymbols();
+		for (unsigned i = 0; i < RANDOM_PATTERNS; ++i)
+		{	// a code of a symbol with some variables set to don't care
+			const DictionaryType::RankedSymbolType& symbol =
+				symbols[prnGen() % symbols.size()];
+			CompactVariableAssignment pattern =
+				dict.Translate(symbol.first, symbol.second);
+			pattern.AddVariablesUpTo(dict.GetSymbolWidth() - 1);
+
+			unsigned dontCareRatio = 1 + prnGen() % 4;
+			for (size_t var = 0; var < pattern.VariablesCount(); ++var)
+			{
+				if (prnGen() % dontCareRatio != 0)
+				{
+					pattern.SetIthVariableValue(var, CompactVariableAssignment::DONT_CARE);
+				}
+			}
+
+			std::vector<std::string> expected = overlappingSymbols(dict, pattern);
+			BOOST_CHECK_MESSAGE(dict.TranslateInverseAll(pattern) == expected,
+				"pattern " + Convert::ToString(pattern) + " of " +
+				Convert::ToString(expected.size()) + " symbols");
+		}
+	}
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,326 @@
+/*****************************************************************************
+ *  Symbolic Finite Tree Automata Library
+ *
+ *  Description:
+ *    Test suite for VectorMap class. The results are compared with std::map
+ *    while the flat hash tables of the map grow.
+ *
+ *****************************************************************************/
+
+// Standard library headers
+#include <algorithm>
+#include <map>
+#include <vector>
+
+// SFTA headers
+#include <sfta/sfta.hh>
+#include <sfta/ordered_vector.hh>
+#include <sfta/vector.hh>
+#include <sfta/vector_map.hh>
+
+// Boost headers
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE VectorMap
+#include <boost/test/unit_test.hpp>
+#include <boost/random/mersenne_twister.hpp>
+
+// testing headers
+#include "log_fixture.hh"
+
+
+/******************************************************************************
+ *                                  Constants                                 *
+ ******************************************************************************/
+
+/**
+ * The seed of the pseudorandom number generator
+ */
+const unsigned PRNG_SEED = 311042;
+
+/**
+ * The number of random items set in the map (enough for every flat hash
+ * table to grow several times)
+ */
+const unsigned RANDOM_ITEMS = 4000;
+
+/**
+ * The number of distinct elements of keys
+ */
+const unsigned ELEMENTS = 12;
+
+/**
+ * The maximum arity of random keys (above the arity of flat hash tables)
+ */
+const unsigned MAX_ARITY = 6;
+
+/**
+ * The default value of the map
+ */
+const unsigned DEFAULT_VALUE = 0;
+
+
+/******************************************************************************
+ *                                  Fixtures                                  *
+ ******************************************************************************/
+
+/**
+ * @brief  Fixture for VectorMap
+ *
+ * Fixture with a map filled with random items and a std::map model of its
+ * content.
+ */
+class VectorMapFixture : public LogFixture
+{
+public:   // Public data types
+
+	typedef SFTA::VectorMap<unsigned, unsigned> MapType;
+	typedef MapType::IndexType IndexType;
+	typedef MapType::IndexValueType IndexValueType;
+	typedef std::map<std::vector<unsigned>, unsigned> ModelType;
+	typedef SFTA::OrderedVector<unsigned> DomainType;
+
+protected:// Protected data members
+
+	boost::mt19937 prnGen_;
+
+	MapType map_;
+
+	ModelType model_;
+
+	DomainType domain_;
+
+public:   // Public methods
+
+	VectorMapFixture()
+		: prnGen_(PRNG_SEED),
+			map_(DEFAULT_VALUE),
+			model_(),
+			domain_()
+	{
+		for (unsigned i = 0; i < ELEMENTS; ++i)
+		{
+			domain_.insert(i);
+		}
+	}
+
+	IndexType randomKey()
+	{
+		IndexType key(prnGen_() % (MAX_ARITY + 1));
+		for (size_t i = 0; i < key.size(); ++i)
+		{
+			key[i] = prnGen_() % ELEMENTS;
+		}
+
+		return key;
+	}
+
+	/**
+	 * @brief  Sets random items
+	 *
+	 * Sets @p count random items (some of them repeatedly) with values
+	 * different from the default value.
+	 */
+	void setRandomItems(MapType& map, ModelType& model, unsigned count)
+	{
+		for (unsigned i = 0; i < count; ++i)
+		{
+			IndexType key = randomKey();
+			unsigned value = 1 + prnGen_() % 1000;
+
+			map.SetValue(key, value);
+			model[key] = value;
+		}
+	}
+
+	static bool matches(const MapType& map, const ModelType& model)
+	{
+		for (ModelType::const_iterator itModel = model.begin();
+			itModel != model.end(); ++itModel)
+		{
+			IndexType key;
+			key.assign(itModel->first.begin(), itModel->first.end());
+			if (map.GetValue(key) != itModel->second)
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	static ModelType toModel(const MapType& map)
+	{
+		ModelType result;
+		for (MapType::const_iterator itMap = map.begin(); itMap != map.end();
+			++itMap)
+		{
+			BOOST_CHECK(result.insert(std::make_pair(itMap->first,
+				itMap->second)).second);
+		}
+
+		return result;
+	}
+};
+
+
+/******************************************************************************
+ *                              Start of testing                              *
+ ******************************************************************************/
+
+
+BOOST_FIXTURE_TEST_SUITE(suite, VectorMapFixture)
+
+BOOST_AUTO_TEST_CASE(insert_and_lookup)
+{
+	for (unsigned i = 0; i < RANDOM_ITEMS; i += RANDOM_ITEMS / 8)
+	{	// check the items after each batch, i.e. across resizes of tables
+		setRandomItems(map_, model_, RANDOM_ITEMS / 8);
+		BOOST_CHECK(matches(map_, model_));
+	}
+
+	// keys that were not set have the default value
+	for (unsigned i = 0; i < RANDOM_ITEMS; ++i)
+	{
+		IndexType key = randomKey();
+		if (model_.find(key) == model_.end())
+		{
+			BOOST_CHECK_EQUAL(map_.GetValue(key), DEFAULT_VALUE);
+		}
+	}
+
+	IndexType absent(2, ELEMENTS);
+	BOOST_CHECK_EQUAL(map_.GetValue(absent), DEFAULT_VALUE);
+
+	// iteration visits every item exactly once
+	BOOST_CHECK(toModel(map_) == model_);
+}
+
+BOOST_AUTO_TEST_CASE(items_with_element)
+{
+	setRandomItems(map_, model_, RANDOM_ITEMS);
+
+	for (unsigned elem = 0; elem < ELEMENTS; ++elem)
+	{
+		MapType::IndexValueArray items = map_.GetItemsWith(elem, domain_);
+
+		// the expected items grouped by arity (there is no nullary item)
+		MapType::IndexValueArray expected(items.size());
+		for (ModelType::const_iterator itModel = model_.begin();
+			itModel != model_.end(); ++itModel)
+		{
+			const std::vector<unsigned>& key = itModel->first;
+			if (std::find(key.begin(), key.end(), elem) != key.end())
+			{
+				BOOST_REQUIRE(key.size() < expected.size());
+
+				IndexType index;
+				index.assign(key.begin(), key.end());
+				expected[key.size()].push_back(std::make_pair(index, itModel->second));
+			}
+		}
+
+		for (size_t arity = 0; arity < items.size(); ++arity)
+		{	// the order of items is not specified
+			std::sort(items[arity].begin(), items[arity].end());
+			std::sort(expected[arity].begin(), expected[arity].end());
+			BOOST_CHECK(items[arity] == expected[arity]);
+		}
+	}
+
+	// binary items are searched only for elements of the domain
+	DomainType smallDomain;
+	smallDomain.insert(0);
+	MapType::IndexValueArray items = map_.GetItemsWith(1, smallDomain);
+	for (size_t i = 0; i < items[2].size(); ++i)
+	{
+		const IndexType& key = items[2][i].first;
+		BOOST_CHECK(((key[0] == 1) && (key[1] == 0)) ||
+			((key[0] == 0) && (key[1] == 1)));
+	}
+}
+
+BOOST_AUTO_TEST_CASE(overwrite_and_merge)
+{
+	setRandomItems(map_, model_, RANDOM_ITEMS);
+
+	// overwrite all items
+	for (ModelType::iterator itModel = model_.begin(); itModel != model_.end();
+		++itModel)
+	{
+		IndexType key;
+		key.assign(itModel->first.begin(), itModel->first.end());
+		itModel->second += 1000;
+		map_.SetValue(key, itModel->second);
+	}
+
+	BOOST_CHECK(matches(map_, model_));
+	BOOST_CHECK(toModel(map_) == model_);
+
+	// merging keeps the values of items that are already in the map (except
+	// the nullary one, which is not merged)
+	MapType other(DEFAULT_VALUE);
+	ModelType otherModel;
+	setRandomItems(other, otherModel, RANDOM_ITEMS);
+
+	map_.insert(other);
+	for (ModelType::const_iterator itOther = otherModel.begin();
+		itOther != otherModel.end(); ++itOther)
+	{
+		if (!itOther->first.empty())
+		{
+			model_.insert(*itOther);
+		}
+	}
+
+	BOOST_CHECK(matches(map_, model_));
+	BOOST_CHECK(toModel(map_) == model_);
+}
+
+BOOST_AUTO_TEST_CASE(setting_existing_key_does_not_grow)
+{
+	// fill the unary table up to its maximum load (half of the 16 slots)
+	for (unsigned i = 0; i < 8; ++i)
+	{
+		map_.SetValue(IndexType(1, i), i + 1);
+	}
+
+	size_t memory = map_.GetMemoryUsage();
+
+	// overwriting a value finds the key before the table would grow
+	map_.SetValue(IndexType(1, 3), 100);
+	BOOST_CHECK_EQUAL(map_.GetMemoryUsage(), memory);
+	BOOST_CHECK_EQUAL(map_.GetValue(IndexType(1, 3)), 100u);
+
+	// a new key makes the table grow
+	map_.SetValue(IndexType(1, 8), 9);
+	BOOST_CHECK(map_.GetMemoryUsage() > memory);
+	BOOST_CHECK_EQUAL(map_.GetValue(IndexType(1, 3)), 100u);
+	BOOST_CHECK_EQUAL(map_.GetValue(IndexType(1, 8)), 9u);
+}
+
+BOOST_AUTO_TEST_CASE(iteration_reuses_key_buffer)
+{
+	for (unsigned i = 0; i < RANDOM_ITEMS; ++i)
+	{	// keys stored in the flat hash tables only
+		IndexType key = randomKey();
+		if (!key.empty() && (key.size() <= 4))
+		{
+			map_.SetValue(key, 1 + i);
+			model_[key] = 1 + i;
+		}
+	}
+
+	BOOST_REQUIRE(map_.begin() != map_.end());
+
+	// the key is overwritten in place, it is never reallocated
+	MapType::const_iterator itMap = map_.begin();
+	const unsigned* keyBuffer = &itMap->first[0];
+	for (; itMap != map_.end(); ++itMap)
+	{
+		BOOST_CHECK_EQUAL(&itMap->first[0], keyBuffer);
+	}
+
+	BOOST_CHECK(toModel(map_) == model_);
+}
+
+BOOST_AUTO_TEST_SUITE_END()